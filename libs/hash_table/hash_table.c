@@ -2,19 +2,191 @@
 #include <stdlib.h>
 #include <string.h>
 
-#define INITIAL_TABLE_SIZE 256
-#define LOAD_FACTOR_THRESHOLD 0.75
+#define INITIAL_TABLE_SIZE 64
+#define LOAD_FACTOR_THRESHOLD 0.85
+#define KEY_BLOCK_SIZE 4096
+
+// Признак ключа, хранящегося в блоке ключей
+#define LONG_KEY UINT16_MAX
+
+// Наибольшая длина пробы, помещающаяся в метаданные
+#define MAX_DISTANCE 254
+
+#define META(distance, key_hash) ((uint16_t)((((distance) + 1u) << 8) | ((key_hash) >> 24)))
+#define META_DISTANCE(meta) ((uint32_t)((meta) >> 8) - 1u)
+
+/**
+ * Ключ, подготовленный к поиску: длина и хеш.
+ */
+typedef struct {
+    const char *key;
+    size_t length;
+    uint32_t hash;
+} KeyProbe;
+
+/**
+ * Вычисляет длину и хеш ключа за один проход: djb2 в 64 битах с финальным
+ * перемешиванием (как в MurmurHash3), чтобы младшие биты, по которым выбирается
+ * слот, зависели от всех символов ключа.
+ */
+static void prepare_key(const char *key, KeyProbe *probe) {
+    uint64_t hash = 5381;
+    size_t length = 0;
+    unsigned char c;
+    while ((c = (unsigned char)key[length])) {
+        hash = hash * 33 + c;
+        length++;
+    }
+
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDULL;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ULL;
+    hash ^= hash >> 33;
+
+    probe->key = key;
+    probe->length = length;
+    probe->hash = (uint32_t)hash;
+}
 
 /**
- * Хеш-функция, использующая алгоритм djb2.
+ * Копирует длинный ключ в блок ключей таблицы.
  */
-static unsigned int hash(const char *key) {
-    unsigned int hash = 5381;
-    int c;
-    while ((c = (unsigned char)*key++)) {
-        hash = ((hash << 5) + hash) + c;
+static const char *store_key(HashTable *table, const char *key, size_t length) {
+    length++;
+    HashKeyBlock *block = table->keys;
+    if (!block || block->capacity - block->used < length) {
+        size_t capacity = length > KEY_BLOCK_SIZE ? length : KEY_BLOCK_SIZE;
+        block = malloc(sizeof(HashKeyBlock) + capacity);
+        if (!block) {
+            return NULL;
+        }
+        block->next = table->keys;
+        block->used = 0;
+        block->capacity = capacity;
+        table->keys = block;
+    }
+    char *copy = block->data + block->used;
+    memcpy(copy, key, length);
+    block->used += length;
+    return copy;
+}
+
+/**
+ * Размещает элемент, вытесняя элементы с меньшей длиной пробы (Robin Hood).
+ * Ключа с таким значением в таблице быть не должно.
+ *
+ * @return true при успехе, false если длина пробы превысила MAX_DISTANCE
+ *         (таблица тогда остаётся корректной, но без одного из элементов в entry).
+ */
+static bool place_entry(uint16_t *meta, HashEntry *entries, size_t size, HashEntry *entry) {
+    size_t mask = size - 1;
+    size_t index = entry->hash & mask;
+    uint32_t distance = 0;
+
+    for (;;) {
+        if (meta[index] == 0) {
+            meta[index] = META(distance, entry->hash);
+            entries[index] = *entry;
+            return true;
+        }
+        uint32_t slot_distance = META_DISTANCE(meta[index]);
+        if (slot_distance < distance) {
+            HashEntry displaced = entries[index];
+            meta[index] = META(distance, entry->hash);
+            entries[index] = *entry;
+            *entry = displaced;
+            distance = slot_distance;
+        }
+        index = (index + 1) & mask;
+        if (++distance > MAX_DISTANCE) {
+            return false;
+        }
+    }
+}
+
+/**
+ * Сравнивает ключ слота с искомым ключом.
+ */
+static bool entry_matches(const HashEntry *entry, const KeyProbe *probe) {
+    if (entry->length != LONG_KEY) {
+        return entry->length == probe->length && memcmp(entry->k.inline_key, probe->key, probe->length) == 0;
+    }
+    return probe->length >= HASH_TABLE_INLINE_KEY && strcmp(entry->k.key, probe->key) == 0;
+}
+
+/**
+ * Ищет слот с ключом.
+ *
+ * @return Указатель на слот или NULL, если ключа нет.
+ */
+static HashEntry *find_entry(const HashTable *table, const KeyProbe *probe) {
+    size_t mask = table->size - 1;
+    size_t index = probe->hash & mask;
+    uint8_t tag = (uint8_t)(probe->hash >> 24);
+
+    for (uint32_t distance = 0;; distance++) {
+        uint16_t meta = table->meta[index];
+        if (meta == 0 || META_DISTANCE(meta) < distance) {
+            return NULL;
+        }
+        if ((uint8_t)meta == tag) {
+            HashEntry *slot = &table->entries[index];
+            if (slot->hash == probe->hash && entry_matches(slot, probe)) {
+                return slot;
+            }
+        }
+        index = (index + 1) & mask;
+    }
+}
+
+/**
+ * Ищет слот с ключом, вычисляя его длину и хеш.
+ */
+static HashEntry *lookup(const HashTable *table, const char *key) {
+    KeyProbe probe;
+    prepare_key(key, &probe);
+    return find_entry(table, &probe);
+}
+
+/**
+ * Переносит все элементы в массивы размера new_size.
+ *
+ * @return true при успехе, false при нехватке памяти.
+ */
+static bool rehash(HashTable *table, size_t new_size) {
+    for (;;) {
+        uint16_t *new_meta = calloc(new_size, sizeof(uint16_t));
+        HashEntry *new_entries = malloc(new_size * sizeof(HashEntry));
+        if (!new_meta || !new_entries) {
+            free(new_meta);
+            free(new_entries);
+            return false;
+        }
+
+        // Хеши закешированы, поэтому ключи не перечитываются
+        bool placed = true;
+        for (size_t i = 0; i < table->size && placed; i++) {
+            if (table->meta[i] != 0) {
+                HashEntry entry = table->entries[i];
+                placed = place_entry(new_meta, new_entries, new_size, &entry);
+            }
+        }
+
+        if (placed) {
+            free(table->meta);
+            free(table->entries);
+            table->meta = new_meta;
+            table->entries = new_entries;
+            table->size = new_size;
+            return true;
+        }
+
+        // Слишком длинная проба: пробуем таблицу вдвое больше
+        free(new_meta);
+        free(new_entries);
+        new_size *= 2;
     }
-    return hash;
 }
 
 HashTable *hash_table_create(void) {
@@ -24,8 +196,12 @@ HashTable *hash_table_create(void) {
     }
     table->size = INITIAL_TABLE_SIZE;
     table->count = 0;
-    table->buckets = calloc(table->size, sizeof(HashNode *));
-    if (!table->buckets) {
+    table->keys = NULL;
+    table->meta = calloc(table->size, sizeof(uint16_t));
+    table->entries = malloc(table->size * sizeof(HashEntry));
+    if (!table->meta || !table->entries) {
+        free(table->meta);
+        free(table->entries);
         free(table);
         return NULL;
     }
@@ -35,104 +211,79 @@ HashTable *hash_table_create(void) {
 void hash_table_destroy(HashTable *table, void (*free_value)(void *)) {
     if (!table) return;
 
-    for (size_t i = 0; i < table->size; i++) {
-        HashNode *node = table->buckets[i];
-        while (node) {
-            HashNode *temp = node;
-            node = node->next;
-            free(temp->key);
-            if (free_value) {
-                free_value(temp->value);
+    if (free_value) {
+        for (size_t i = 0; i < table->size; i++) {
+            if (table->meta[i] != 0) {
+                free_value(table->entries[i].value);
             }
-            free(temp);
         }
     }
-    free(table->buckets);
+
+    HashKeyBlock *block = table->keys;
+    while (block) {
+        HashKeyBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+    free(table->meta);
+    free(table->entries);
     free(table);
 }
 
 bool hash_table_insert(HashTable *table, const char *key, void *value) {
     if (!table || !key) return false;
 
-    if ((double)table->count / (double)table->size > LOAD_FACTOR_THRESHOLD) {
-        hash_table_resize(table);
+    KeyProbe probe;
+    prepare_key(key, &probe);
+    HashEntry *existing = find_entry(table, &probe);
+    if (existing) {
+        existing->value = value;
+        return true;
     }
 
-    unsigned int index = hash(key) % table->size;
-    HashNode *current = table->buckets[index];
-    while (current) {
-        if (strcmp(current->key, key) == 0) {
-            current->value = value;
-            return true;
-        }
-        current = current->next;
+    if ((double)(table->count + 1) / (double)table->size > LOAD_FACTOR_THRESHOLD &&
+        !rehash(table, table->size * 2)) {
+        return false;
     }
 
-    HashNode *new_node = malloc(sizeof(HashNode));
-    if (!new_node) {
-        return false;
+    HashEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.hash = probe.hash;
+    entry.value = value;
+    if (probe.length < HASH_TABLE_INLINE_KEY) {
+        entry.length = (uint16_t)probe.length;
+        memcpy(entry.k.inline_key, key, probe.length + 1);
+    } else {
+        entry.length = LONG_KEY;
+        entry.k.key = store_key(table, key, probe.length);
+        if (!entry.k.key) {
+            return false;
+        }
     }
-    new_node->key = strdup(key);
-    if (!new_node->key) {
-        free(new_node);
-        return false;
+
+    // Если проба оказалась слишком длинной, вытесненный элемент размещается после расширения
+    while (!place_entry(table->meta, table->entries, table->size, &entry)) {
+        if (!rehash(table, table->size * 2)) {
+            return false;
+        }
     }
-    new_node->value = value;
-    new_node->next = table->buckets[index];
-    table->buckets[index] = new_node;
     table->count++;
     return true;
 }
 
 bool hash_table_contains(const HashTable *table, const char *key) {
     if (!table || !key) return false;
-
-    unsigned int index = hash(key) % table->size;
-    HashNode *node = table->buckets[index];
-    while (node) {
-        if (strcmp(node->key, key) == 0) {
-            return true;
-        }
-        node = node->next;
-    }
-    return false;
+    return lookup(table, key) != NULL;
 }
 
 void *hash_table_get(const HashTable *table, const char *key) {
     if (!table || !key) return NULL;
 
-    unsigned int index = hash(key) % table->size;
-    HashNode *node = table->buckets[index];
-    while (node) {
-        if (strcmp(node->key, key) == 0) {
-            return node->value;
-        }
-        node = node->next;
-    }
-    return NULL;
+    const HashEntry *entry = lookup(table, key);
+    return entry ? entry->value : NULL;
 }
 
 void hash_table_resize(HashTable *table) {
     if (!table) return;
-
-    size_t new_size = table->size * 2;
-    HashNode **new_buckets = calloc(new_size, sizeof(HashNode *));
-    if (!new_buckets) {
-        return;
-    }
-
-    for (size_t i = 0; i < table->size; i++) {
-        HashNode *node = table->buckets[i];
-        while (node) {
-            HashNode *next_node = node->next;
-            unsigned int new_index = hash(node->key) % new_size;
-            node->next = new_buckets[new_index];
-            new_buckets[new_index] = node;
-            node = next_node;
-        }
-    }
-
-    free(table->buckets);
-    table->buckets = new_buckets;
-    table->size = new_size;
+    rehash(table, table->size * 2);
 }
@@ -3,23 +3,50 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
+
+// Ключи короче этой длины хранятся прямо в слоте
+#define HASH_TABLE_INLINE_KEY 16
 
 /**
- * Структура, представляющая узел хеш-таблицы.
+ * Слот хеш-таблицы (32 байта). Слоты лежат одним массивом параллельно массиву метаданных.
  */
-typedef struct HashNode {
-    char *key;
+typedef struct HashEntry {
+    uint32_t hash;      // Кешированный хеш ключа
+    uint16_t length;    // Длина ключа, если он хранится в слоте, иначе UINT16_MAX
     void *value;
-    struct HashNode *next;
-} HashNode;
+    union {
+        char inline_key[HASH_TABLE_INLINE_KEY]; // Короткий ключ с завершающим нулём
+        const char *key;                        // Длинный ключ в блоке ключей таблицы
+    } k;
+} HashEntry;
 
 /**
- * Структура, представляющая хеш-таблицу.
+ * Блок, в который подряд копируются ключи.
+ */
+typedef struct HashKeyBlock {
+    struct HashKeyBlock *next;
+    size_t used;
+    size_t capacity;
+    char data[];
+} HashKeyBlock;
+
+/**
+ * Хеш-таблица с открытой адресацией и вытеснением по схеме Robin Hood.
+ *
+ * Поиск идёт по компактному массиву метаданных (2 байта на слот): сравнивается
+ * байт хеша, и только при совпадении читается сам слот. Проба обрывается, как только
+ * длина пробы слота становится меньше пройденной, поэтому неуспешный поиск обычно
+ * не выходит за пределы метаданных. Короткие ключи лежат прямо в
+ * слоте, так что успешный поиск обычно читает одну строку кеша; длинные ключи
+ * копируются в общие блоки, а не в отдельные выделения памяти на каждый элемент.
  */
 typedef struct HashTable {
-    HashNode **buckets;
-    size_t size;
-    size_t count;
+    uint16_t *meta;       // Метаданные слотов: (длина пробы + 1) << 8 | байт хеша, 0 — пустой слот
+    HashEntry *entries;
+    size_t size;          // Количество слотов (степень двойки)
+    size_t count;         // Количество занятых слотов
+    HashKeyBlock *keys;   // Блоки с копиями ключей
 } HashTable;
 
 /**
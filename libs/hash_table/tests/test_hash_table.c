@@ -1,8 +1,11 @@
+#define _POSIX_C_SOURCE 199309L
+
 #include "../hash_table.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <time.h>
 
 void test_hash_table_create() {
     HashTable *table = hash_table_create();
@@ -88,12 +91,132 @@ void test_hash_table_resize() {
     hash_table_destroy(table, free);
 }
 
+void test_hash_table_long_keys() {
+    HashTable *table = hash_table_create();
+    assert(table != NULL);
+
+    // Ключи длиннее HASH_TABLE_INLINE_KEY хранятся вне слота
+    for (int i = 0; i < 500; i++) {
+        char key[64];
+        sprintf(key, "_OBJC_CLASS_$_VeryLongClassNameNumber%d", i);
+        bool inserted = hash_table_insert(table, key, (void *)(size_t)(i + 1));
+        assert(inserted);
+    }
+    assert(table->count == 500);
+
+    for (int i = 0; i < 500; i++) {
+        char key[64];
+        sprintf(key, "_OBJC_CLASS_$_VeryLongClassNameNumber%d", i);
+        assert((size_t)hash_table_get(table, key) == (size_t)(i + 1));
+    }
+    assert(!hash_table_contains(table, "_OBJC_CLASS_$_VeryLongClassNameNumber500"));
+    assert(!hash_table_contains(table, "_OBJC_CLASS_$"));
+
+    hash_table_insert(table, "_OBJC_CLASS_$_VeryLongClassNameNumber7", NULL);
+    assert(table->count == 500);
+    assert(hash_table_contains(table, "_OBJC_CLASS_$_VeryLongClassNameNumber7"));
+    assert(hash_table_get(table, "_OBJC_CLASS_$_VeryLongClassNameNumber7") == NULL);
+
+    printf("test_hash_table_long_keys passed.\n");
+    hash_table_destroy(table, NULL);
+}
+
+/**
+ * Возвращает текущее монотонное время в наносекундах.
+ */
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/**
+ * Детерминированно перемешивает ключи (линейный конгруэнтный генератор).
+ */
+static void shuffle_keys(char (*keys)[24], int count, unsigned int seed) {
+    for (int i = count - 1; i > 0; i--) {
+        seed = seed * 1103515245u + 12345u;
+        int j = (int)((seed >> 8) % (unsigned int)(i + 1));
+        char tmp[24];
+        memcpy(tmp, keys[i], sizeof(tmp));
+        memcpy(keys[i], keys[j], sizeof(tmp));
+        memcpy(keys[j], tmp, sizeof(tmp));
+    }
+}
+
+/**
+ * Замеряет вставку, успешный и неуспешный поиск на key_count ключах.
+ * Ключи перемешаны, а поиск идёт в ином порядке, чем вставка, чтобы обращения к
+ * памяти не становились последовательными. Печатает время одной операции;
+ * проверяет только корректность результатов.
+ */
+static void benchmark_hash_table_size(int key_count, int rounds) {
+    char (*keys)[24] = malloc((size_t)key_count * sizeof(*keys));
+    char (*missing)[24] = malloc((size_t)key_count * sizeof(*missing));
+    assert(keys != NULL && missing != NULL);
+    for (int i = 0; i < key_count; i++) {
+        sprintf(keys[i], "_symbol_%d", i);
+        sprintf(missing[i], "_missing_%d", i);
+    }
+    shuffle_keys(keys, key_count, 12345);
+    shuffle_keys(missing, key_count, 54321);
+
+    HashTable *table = hash_table_create();
+    assert(table != NULL);
+
+    double start = now_ns();
+    for (int i = 0; i < key_count; i++) {
+        bool inserted = hash_table_insert(table, keys[i], keys[i]);
+        assert(inserted);
+    }
+    double insert_ns = (now_ns() - start) / key_count;
+
+    // Поиск идёт в другом порядке, чем вставка
+    shuffle_keys(keys, key_count, 777);
+
+    size_t found = 0;
+    start = now_ns();
+    for (int round = 0; round < rounds; round++) {
+        for (int i = 0; i < key_count; i++) {
+            found += hash_table_get(table, keys[i]) != NULL;
+        }
+    }
+    double hit_ns = (now_ns() - start) / ((double)key_count * rounds);
+    assert(found == (size_t)key_count * rounds);
+
+    found = 0;
+    start = now_ns();
+    for (int round = 0; round < rounds; round++) {
+        for (int i = 0; i < key_count; i++) {
+            found += hash_table_contains(table, missing[i]);
+        }
+    }
+    double miss_ns = (now_ns() - start) / ((double)key_count * rounds);
+    assert(found == 0);
+
+    printf("benchmark_hash_table (%d keys): insert %.1f ns, hit %.1f ns, miss %.1f ns per operation.\n",
+           key_count, insert_ns, hit_ns, miss_ns);
+    hash_table_destroy(table, NULL);
+    free(keys);
+    free(missing);
+}
+
+/**
+ * Бенчмарк: таблица размера lc_commands и большая таблица, не помещающаяся в кеш.
+ */
+void benchmark_hash_table() {
+    benchmark_hash_table_size(64, 20000);
+    benchmark_hash_table_size(200000, 5);
+}
+
 int main() {
     test_hash_table_create();
     test_hash_table_insert_and_get();
     test_hash_table_update();
     test_hash_table_contains();
     test_hash_table_resize();
+    test_hash_table_long_keys();
+    benchmark_hash_table();
 
     printf("All tests passed.\n");
     return 0;
@@ -0,0 +1,139 @@
+#ifndef MACHO_ANALYZER_BATCH_SCANNER_H
+#define MACHO_ANALYZER_BATCH_SCANNER_H
+
+#include "macho_analyzer.h"
+#include "language_detector.h"
+#include "security_check.h"
+#include "security_analyzer.h"
+#include "result_cache.h"
+#include "scan_manifest.h"
+
+/**
+ * Вид записи результата.
+ */
+typedef enum {
+    BATCH_RECORD_FILE,  // Итог по файлу целиком
+    BATCH_RECORD_ARCH   // Одна архитектура файла
+} BatchRecordKind;
+
+/**
+ * Изменение файла относительно манифеста прошлого прохода.
+ */
+typedef enum {
+    BATCH_CHANGE_NONE,      // Без манифеста или файл не изменился
+    BATCH_CHANGE_ADDED,     // Новый Mach-O
+    BATCH_CHANGE_CHANGED,   // Изменилась хотя бы одна архитектура
+    BATCH_CHANGE_REMOVED    // Mach-O исчез или перестал быть Mach-O (только запись файла)
+} BatchChange;
+
+/**
+ * Запись результата пакетного анализа.
+ * Для каждого файла сначала сообщается запись BATCH_RECORD_FILE, затем подряд
+ * записи BATCH_RECORD_ARCH его архитектур; записи разных файлов не перемешиваются.
+ */
+typedef struct {
+    BatchRecordKind kind;
+    const char *path;           // Путь к файлу
+    int status;                 // 0 — успешно, -1 — ошибка
+    const char *error;          // Описание ошибки или NULL
+    BatchChange change;         // Изменение относительно прошлого прохода
+
+    // Поля записи файла (в записях архитектур повторяются)
+    uint64_t file_size;         // Размер файла
+    bool is_fat;                // FAT-файл
+    uint32_t arch_count;        // Количество архитектур
+
+    // Поля записи архитектуры
+    uint32_t arch_index;        // Номер архитектуры (с 0)
+    MachOArchitecture arch;     // Положение и тип процессора
+    const char *arch_name;      // Имя архитектуры
+    uint32_t file_type;         // Тип Mach-O (MH_EXECUTE, MH_DYLIB, ...)
+    uint32_t load_command_count;// Количество команд загрузки
+    bool is_64_bit;             // 64-битный Mach-O
+    LanguageInfo language;      // Язык и компилятор (пустые, если не определялись)
+    SecurityFeatures security;  // Защитные механизмы (нулевые, если не проверялись)
+    SecurityFindings findings;  // Находки analyze_* (пустые, если не искались)
+    const MachOFile *mach_o_file; // Разобранная архитектура, если включено keep_details, иначе NULL
+
+    // Результат из кеша: если cache_reader не NULL, архитектура не разбиралась, mach_o_file
+    // равен NULL, а полный результат лежит в cached. Поля выше заполнены из него.
+    const ResultReader *cache_reader;
+    ResultArchView cached;
+} BatchRecord;
+
+/**
+ * Обработчик записей. Вызывается из рабочих потоков, но никогда одновременно.
+ *
+ * @param record Запись; указатели в ней действительны только во время вызова.
+ * @param context Пользовательский контекст.
+ */
+typedef void (*BatchRecordCallback)(const BatchRecord *record, void *context);
+
+/**
+ * Параметры пакетного анализа.
+ */
+typedef struct {
+    size_t threads;             // Количество рабочих потоков (0 — по числу процессоров)
+    uint64_t max_file_size;     // Файлы больше этого размера пропускаются с ошибкой (0 — без ограничения)
+    bool detect_language;       // Определять язык и компилятор каждой архитектуры
+    bool check_security;        // Проверять защитные механизмы каждой архитектуры
+    bool collect_findings;      // Искать небезопасные функции и опасные секции
+    bool keep_details;          // Передавать обработчику разобранный MachOFile (для полного вывода)
+    const ResultCache *cache;   // Кеш результатов или NULL. При промахе выполняются все проверки,
+                                // чтобы запись кеша годилась для любого режима вывода
+    ScanManifest *previous;     // Манифест прошлого прохода или NULL. Если задан, обработчику
+                                // сообщаются только добавленные, изменённые и удалённые файлы
+    ScanManifest *next;         // Манифест, в который записывается текущий проход, или NULL
+} BatchOptions;
+
+/**
+ * Итоговая статистика пакетного анализа.
+ */
+typedef struct {
+    uint64_t files_seen;        // Обычных файлов просмотрено
+    uint64_t macho_files;       // Из них Mach-O или FAT
+    uint64_t arch_records;      // Записей архитектур сообщено
+    uint64_t cache_hits;        // Из них взято из кеша
+    uint64_t unchanged;         // Файлов, не изменившихся с прошлого прохода
+    uint64_t errors;            // Файлов и каталогов с ошибками
+} BatchStats;
+
+/**
+ * Возвращает параметры по умолчанию: потоки по числу процессоров, без предела
+ * размера, определение языка включено, проверка защиты, поиск находок
+ * и передача MachOFile выключены.
+ */
+BatchOptions batch_default_options(void);
+
+/**
+ * Возвращает имя изменения для вывода ("added", "changed", "removed") или NULL для BATCH_CHANGE_NONE.
+ */
+const char *batch_change_name(BatchChange change);
+
+/**
+ * Рекурсивно обходит пути и анализирует все найденные Mach-O и FAT файлы на пуле потоков.
+ *
+ * Каталоги обходятся рекурсивно, символические ссылки внутри каталогов не
+ * разыменовываются. Файлы отбираются по magic в первых байтах, поэтому остальное
+ * содержимое бандлов не отображается в память. Каждый рабочий поток разбирает
+ * свой MachOFile; общий только обработчик записей, вызовы которого сериализуются.
+ *
+ * С манифестом прошлого прохода файл, у которого совпали размер, mtime и inode,
+ * не открывается вовсе. Остальные файлы разбираются, а по хешам архитектур
+ * отделяются изменённые от тех, у которых поменялись только метаданные.
+ * Mach-O из прошлого манифеста, не встреченные в этом проходе, сообщаются
+ * записями BATCH_CHANGE_REMOVED после обхода, поэтому манифест должен
+ * относиться к тем же путям.
+ *
+ * @param paths Пути к файлам и каталогам.
+ * @param count Количество путей.
+ * @param options Параметры (NULL — параметры по умолчанию).
+ * @param callback Обработчик записей.
+ * @param context Контекст обработчика.
+ * @param stats Если не NULL, сюда записывается статистика.
+ * @return 0, если все пути обработаны без ошибок, -1 если были ошибки.
+ */
+int batch_scan(const char *const *paths, size_t count, const BatchOptions *options,
+               BatchRecordCallback callback, void *context, BatchStats *stats);
+
+#endif // MACHO_ANALYZER_BATCH_SCANNER_H
@@ -0,0 +1,116 @@
+#ifndef MACHO_ANALYZER_CODE_SIGNATURE_H
+#define MACHO_ANALYZER_CODE_SIGNATURE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "macho_analyzer.h"
+#include "command_visitor.h"
+
+// Magic-числа блобов подписи (хранятся в big-endian)
+#define CSMAGIC_CODEDIRECTORY       0xfade0c02
+#define CSMAGIC_EMBEDDED_SIGNATURE  0xfade0cc0
+#define CSMAGIC_BLOBWRAPPER         0xfade0b01
+
+// Слоты индекса SuperBlob
+#define CSSLOT_CODEDIRECTORY                 0
+#define CSSLOT_ALTERNATE_CODEDIRECTORIES     0x1000
+#define CSSLOT_ALTERNATE_CODEDIRECTORY_MAX   5
+
+// Типы хешей директории кода
+#define CS_HASHTYPE_SHA1             1
+#define CS_HASHTYPE_SHA256           2
+#define CS_HASHTYPE_SHA256_TRUNCATED 3
+#define CS_HASHTYPE_SHA384           4
+
+// Основная директория и до пяти альтернативных
+#define CODE_SIGNATURE_MAX_DIRECTORIES (1 + CSSLOT_ALTERNATE_CODEDIRECTORY_MAX)
+
+// Сколько несовпавших страниц запоминается для вывода (считаются все)
+#define CODE_SIGNATURE_MAX_REPORTED_PAGES 16
+
+/**
+ * Результат проверки подписи кода.
+ */
+typedef enum {
+    CODE_SIGNATURE_ABSENT,          // Команды LC_CODE_SIGNATURE нет
+    CODE_SIGNATURE_VALID,           // Хеши всех страниц совпали
+    CODE_SIGNATURE_OUT_OF_BOUNDS,   // Данные подписи или страницы выходят за границы файла
+    CODE_SIGNATURE_BAD_MAGIC,       // Magic-число не соответствует SuperBlob или директории кода
+    CODE_SIGNATURE_TOO_SMALL,       // Данных меньше, чем занимает директория кода
+    CODE_SIGNATURE_BAD_LENGTH,      // Длины и смещения директории кода не согласованы
+    CODE_SIGNATURE_BAD_IDENTIFIER,  // Неверное смещение идентификатора
+    CODE_SIGNATURE_UNSUPPORTED_HASH,// Ни одна директория не использует поддерживаемый хеш
+    CODE_SIGNATURE_PAGE_MISMATCH    // Хеш хотя бы одной страницы не совпал
+} CodeSignatureStatus;
+
+/**
+ * Результат проверки одной директории кода.
+ */
+typedef struct {
+    uint32_t slot;              // Слот в SuperBlob (CSSLOT_*)
+    uint8_t hash_type;          // CS_HASHTYPE_*
+    uint8_t hash_size;          // Размер хеша страницы
+    uint32_t page_size;         // Размер страницы (0 — одна страница до code_limit)
+    uint32_t page_count;        // Количество слотов кода
+    uint64_t code_limit;        // Подписанная часть файла
+    bool verified;              // Страницы проверены (тип хеша поддерживается)
+    uint32_t mismatch_count;    // Страниц с несовпавшим хешем
+    uint32_t mismatched_pages[CODE_SIGNATURE_MAX_REPORTED_PAGES]; // Первые несовпавшие страницы по порядку
+} CodeDirectoryInfo;
+
+/**
+ * Сведения о подписи кода.
+ */
+typedef struct {
+    CodeSignatureStatus status;
+    uint32_t version;           // Версия основной директории кода
+    bool outdated;              // Версия ниже 0x20100
+    const char *identifier;     // Идентификатор (указывает в образ) или NULL
+    uint8_t hash_prefix[16];    // Первые байты хеша первой страницы основной директории
+    size_t hash_prefix_length;
+    uint8_t sha256[32];         // SHA-256 основной директории кода
+    uint32_t directory_count;
+    CodeDirectoryInfo directories[CODE_SIGNATURE_MAX_DIRECTORIES];
+} CodeSignatureInfo;
+
+/**
+ * Анализирует и проверяет подпись кода в Mach-O файле.
+ *
+ * Разбирает SuperBlob (CSMAGIC_EMBEDDED_SIGNATURE) или одиночную директорию кода,
+ * берёт основную и альтернативные директории (обычно SHA-1 и SHA-256) и сверяет
+ * хеш каждой страницы до codeLimit. При большом числе страниц они хешируются
+ * на пуле потоков кусками по нескольку сотен.
+ * Функция ничего не выводит; результат выводится через print_code_signature.
+ *
+ * @param mach_o_file Указатель на структуру MachOFile.
+ * @param threads Количество потоков для хеширования страниц (0 — по числу процессоров).
+ * @param info Структура для результата; status заполняется и при ошибке.
+ * @return 0, если подписи нет или она прошла проверки, -1 в случае ошибки или несовпадения.
+ */
+int analyze_code_signature(const MachOFile *mach_o_file, size_t threads, CodeSignatureInfo *info);
+
+/**
+ * Состояние проверки подписи при общем обходе команд.
+ */
+typedef struct {
+    CodeSignatureInfo *info;
+    size_t threads;
+    const struct linkedit_data_command *command;  // Найденная LC_CODE_SIGNATURE или NULL
+    int result;                                   // Результат как у analyze_code_signature
+} CodeSignatureCheck;
+
+/**
+ * Подписывает проверку подписи на visitor: команда LC_CODE_SIGNATURE запоминается
+ * при обходе, страницы сверяются после него. Результат — в info и check->result.
+ *
+ * @param visitor Набор подписок.
+ * @param check Состояние проверки; должно жить до окончания обхода.
+ * @param threads Количество потоков для хеширования страниц (0 — по числу процессоров).
+ * @param info Структура для результата.
+ * @return 0 при успехе, -1 в случае ошибки.
+ */
+int code_signature_subscribe(MachOCommandVisitor *visitor, CodeSignatureCheck *check, size_t threads,
+                             CodeSignatureInfo *info);
+
+#endif // MACHO_ANALYZER_CODE_SIGNATURE_H
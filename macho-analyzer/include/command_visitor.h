@@ -0,0 +1,100 @@
+#ifndef MACHO_ANALYZER_COMMAND_VISITOR_H
+#define MACHO_ANALYZER_COMMAND_VISITOR_H
+
+#include "macho_analyzer.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Обход команд загрузки с подпиской.
+ *
+ * Каждая проверка подписывается на нужные ей типы команд (LC_*), после чего
+ * все проверки выполняются за один проход по буферу команд: для каждой команды
+ * вызываются только подписчики её типа. Проход заканчивается раньше, если все
+ * подписчики сообщили, что им больше ничего не нужно.
+ */
+
+// Наибольшее число подписок одного обхода
+#define MACHO_VISITOR_MAX_SUBSCRIPTIONS 32
+#define MACHO_VISITOR_MAX_FINISHERS 8
+
+// Типы команд без LC_REQ_DYLD, для которых подписчики ищутся по таблице
+#define MACHO_VISITOR_COMMAND_SLOTS 64
+
+// Коды возврата обработчика команды
+#define MACHO_VISIT_CONTINUE 0   // Продолжать вызывать обработчик
+#define MACHO_VISIT_DONE     1   // Подписка выполнена, обработчик больше не вызывается
+
+/**
+ * Обработчик команды.
+ *
+ * @param mach_o_file Разбираемый Mach-O.
+ * @param cmd Команда загрузки подписанного типа.
+ * @param context Контекст, переданный при подписке.
+ * @return MACHO_VISIT_CONTINUE, MACHO_VISIT_DONE или -1 при ошибке (обход прерывается).
+ */
+typedef int (*MachOCommandHandler)(const MachOFile *mach_o_file, const struct load_command *cmd, void *context);
+
+/**
+ * Завершение проверки после прохода, например проверка по найденной команде.
+ *
+ * @return 0 при успехе, -1 при ошибке.
+ */
+typedef int (*MachOVisitorFinish)(const MachOFile *mach_o_file, void *context);
+
+typedef struct {
+    uint32_t cmd;                // Тип команды (LC_*)
+    MachOCommandHandler handler;
+    void *context;
+    int next;                    // Следующая подписка того же слота или -1
+    bool done;                   // Обработчик вернул MACHO_VISIT_DONE
+} MachOCommandSubscription;
+
+typedef struct {
+    MachOVisitorFinish finish;
+    void *context;
+} MachOVisitorFinisher;
+
+/**
+ * Набор подписок одного обхода. Живёт на стеке вызывающего, памяти не выделяет.
+ */
+typedef struct {
+    MachOCommandSubscription subscriptions[MACHO_VISITOR_MAX_SUBSCRIPTIONS];
+    size_t subscription_count;
+    int slots[MACHO_VISITOR_COMMAND_SLOTS];  // Первая подписка по типу команды или -1
+    int overflow;                            // Подписки на типы вне таблицы слотов или -1
+    MachOVisitorFinisher finishers[MACHO_VISITOR_MAX_FINISHERS];
+    size_t finisher_count;
+} MachOCommandVisitor;
+
+/**
+ * Подготавливает пустой набор подписок.
+ */
+void macho_visitor_init(MachOCommandVisitor *visitor);
+
+/**
+ * Подписывает обработчик на команды типа cmd.
+ * Подписчики одного типа вызываются в порядке подписки.
+ *
+ * @return 0 при успехе, -1 если подписок слишком много.
+ */
+int macho_visitor_subscribe(MachOCommandVisitor *visitor, uint32_t cmd, MachOCommandHandler handler, void *context);
+
+/**
+ * Регистрирует завершение, вызываемое после прохода в порядке регистрации.
+ *
+ * @return 0 при успехе, -1 если завершений слишком много.
+ */
+int macho_visitor_on_finish(MachOCommandVisitor *visitor, MachOVisitorFinish finish, void *context);
+
+/**
+ * Выполняет один проход по командам загрузки, затем вызывает завершения.
+ * Состояние подписок сбрасывается, поэтому набор можно запускать повторно.
+ *
+ * @param visitor Набор подписок.
+ * @param mach_o_file Разобранный Mach-O (команды проверены analyze_load_commands).
+ * @return 0 при успехе, -1 если обработчик или завершение вернули ошибку.
+ */
+int macho_visitor_run(MachOCommandVisitor *visitor, const MachOFile *mach_o_file);
+
+#endif // MACHO_ANALYZER_COMMAND_VISITOR_H
@@ -0,0 +1,20 @@
+#ifndef MACHO_ANALYZER_CONTENT_HASH_H
+#define MACHO_ANALYZER_CONTENT_HASH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Вычисляет XXH64 — быструю некриптографическую хеш-функцию содержимого.
+ * Используется как ключ кеша результатов: на современных процессорах она
+ * обрабатывает несколько гигабайт в секунду, то есть ограничена скоростью
+ * чтения памяти, а не вычислениями. Для проверки целостности не подходит.
+ *
+ * @param data Данные.
+ * @param size Размер данных.
+ * @param seed Начальное значение.
+ * @return 64-битный хеш.
+ */
+uint64_t xxh64(const void *data, size_t size, uint64_t seed);
+
+#endif // MACHO_ANALYZER_CONTENT_HASH_H
@@ -0,0 +1,95 @@
+#ifndef MACHO_ANALYZER_EXPORT_TRIE_H
+#define MACHO_ANALYZER_EXPORT_TRIE_H
+
+#include "macho_analyzer.h"
+
+// Наибольшая длина имени экспорта вместе с завершающим нулём при обходе
+#define MACHO_EXPORT_NAME_MAX 4096
+
+// Наибольшая глубина дерева при обходе
+#define MACHO_EXPORT_TRIE_MAX_DEPTH 128
+
+/**
+ * Дерево экспорта: префиксное дерево имён экспортируемых символов.
+ * Указывает прямо в образ, ничего не копирует и не выделяет.
+ */
+typedef struct {
+    const uint8_t *data;  // Начало дерева или NULL, если экспорта нет
+    uint32_t size;        // Размер дерева
+} MachOExportTrie;
+
+/**
+ * Экспортируемый символ.
+ */
+typedef struct {
+    const char *name;        // Имя символа (при обходе указывает в буфер итератора)
+    uint64_t flags;          // EXPORT_SYMBOL_FLAGS_*
+    uint64_t address;        // Смещение от начала образа (для ABSOLUTE — значение); 0 для реэкспорта
+    uint64_t resolver;       // Смещение резолвера для STUB_AND_RESOLVER, иначе 0
+    uint64_t ordinal;        // Номер библиотеки для REEXPORT, иначе 0
+    const char *import_name; // Имя в исходной библиотеке для REEXPORT ("" — то же имя), иначе NULL
+} MachOExport;
+
+/**
+ * Состояние узла на пути обхода.
+ */
+typedef struct {
+    uint32_t cursor;         // Смещение следующего ребра узла
+    uint32_t children_left;  // Сколько рёбер узла ещё не пройдено
+    uint32_t name_length;    // Длина имени до этого узла
+} MachOExportFrame;
+
+/**
+ * Потоковый обход дерева экспорта в глубину. Экспорты не собираются в массив:
+ * каждый вызов macho_export_iterator_next возвращает следующий.
+ */
+typedef struct {
+    MachOExportTrie trie;
+    MachOExportFrame stack[MACHO_EXPORT_TRIE_MAX_DEPTH];
+    uint32_t depth;            // Количество узлов на пути
+    uint32_t pending_node;     // Узел, в который ведёт последнее ребро
+    uint32_t pending_length;   // Длина имени до pending_node
+    bool has_pending;          // pending_node ещё не разобран
+    uint32_t visited;          // Разобранных узлов — защита от циклов в повреждённом дереве
+    char name[MACHO_EXPORT_NAME_MAX];
+} MachOExportIterator;
+
+/**
+ * Находит дерево экспорта: LC_DYLD_EXPORTS_TRIE или export_off/export_size из LC_DYLD_INFO(_ONLY).
+ *
+ * @param mach_o_file Указатель на структуру MachOFile.
+ * @param trie Результат; data == NULL, если экспорта нет.
+ * @return 0 при успехе, -1 если дерево выходит за границы файла.
+ */
+int macho_get_export_trie(const MachOFile *mach_o_file, MachOExportTrie *trie);
+
+/**
+ * Ищет экспорт по имени, спускаясь по рёбрам дерева: читаются только узлы на
+ * пути к имени, время зависит от глубины дерева, а не от числа экспортов.
+ *
+ * @param trie Дерево экспорта.
+ * @param name Имя символа, например "_malloc".
+ * @param export Сведения об экспорте; name указывает на переданное имя.
+ * @return 1, если символ экспортируется, 0 — если нет, -1 — если дерево повреждено.
+ */
+int macho_export_trie_find(const MachOExportTrie *trie, const char *name, MachOExport *export);
+
+/**
+ * Начинает обход дерева экспорта.
+ *
+ * @param iterator Состояние обхода.
+ * @param trie Дерево экспорта; должно оставаться доступным до конца обхода.
+ */
+void macho_export_iterator_init(MachOExportIterator *iterator, const MachOExportTrie *trie);
+
+/**
+ * Возвращает следующий экспорт. Имя указывает в буфер итератора и действительно
+ * до следующего вызова.
+ *
+ * @param iterator Состояние обхода.
+ * @param export Сведения об экспорте.
+ * @return 1, если экспорт возвращён, 0 — если обход закончен, -1 — если дерево повреждено.
+ */
+int macho_export_iterator_next(MachOExportIterator *iterator, MachOExport *export);
+
+#endif // MACHO_ANALYZER_EXPORT_TRIE_H
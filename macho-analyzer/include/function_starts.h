@@ -0,0 +1,47 @@
+#ifndef MACHO_ANALYZER_FUNCTION_STARTS_H
+#define MACHO_ANALYZER_FUNCTION_STARTS_H
+
+#include "macho_analyzer.h"
+
+/**
+ * Адреса начала функций из LC_FUNCTION_STARTS.
+ */
+typedef struct MachOFunctionStarts {
+    uint64_t *addresses;  // Виртуальные адреса по возрастанию
+    uint32_t count;       // Количество функций
+    uint64_t text_end;    // Конец секции __TEXT,__text (0, если секции нет) — граница последней функции
+} MachOFunctionStarts;
+
+/**
+ * Возвращает адреса начала функций, декодируя LC_FUNCTION_STARTS при первом обращении.
+ *
+ * Данные команды — разности адресов в ULEB128, первая отсчитывается от начала
+ * сегмента __TEXT; они декодируются пакетно (см. macho_decode_uleb128_run) и
+ * суммируются, поэтому массив уже отсортирован.
+ * Результат кэшируется внутри mach_o_file и освобождается в free_mach_o_file.
+ * Функцию можно вызывать из нескольких потоков для одного MachOFile: кеш
+ * публикуется атомарно, а ошибка построения запоминается и повторно не выводится.
+ *
+ * @param mach_o_file Указатель на структуру MachOFile.
+ * @return Указатель на таблицу (пустую, если команды нет) или NULL в случае ошибки.
+ */
+const MachOFunctionStarts *macho_get_function_starts(const MachOFile *mach_o_file);
+
+/**
+ * Возвращает размер функции: расстояние до начала следующей, а для последней —
+ * до конца секции __TEXT,__text.
+ *
+ * @param starts Таблица, полученная от macho_get_function_starts.
+ * @param index Номер функции.
+ * @return Размер в байтах или 0, если он неизвестен.
+ */
+uint64_t macho_function_size(const MachOFunctionStarts *starts, uint32_t index);
+
+/**
+ * Освобождает таблицу адресов функций.
+ *
+ * @param starts Таблица, созданная macho_get_function_starts.
+ */
+void macho_function_starts_free(MachOFunctionStarts *starts);
+
+#endif // MACHO_ANALYZER_FUNCTION_STARTS_H
@@ -0,0 +1,89 @@
+#ifndef MACHO_ANALYZER_IMPORT_TABLE_H
+#define MACHO_ANALYZER_IMPORT_TABLE_H
+
+#include "macho_analyzer.h"
+#include "command_visitor.h"
+
+/**
+ * Откуда взят список импортов.
+ */
+typedef enum {
+    MACHO_IMPORTS_NONE,           // Нет ни LC_DYLD_INFO, ни LC_DYLD_CHAINED_FIXUPS
+    MACHO_IMPORTS_DYLD_INFO,      // Опкоды привязки (bind и lazy bind)
+    MACHO_IMPORTS_CHAINED_FIXUPS  // Таблица импортов цепочек фиксапов
+} MachOImportSource;
+
+/**
+ * Импортируемый символ.
+ */
+typedef struct {
+    const char *name;     // Имя символа (указывает в образ), например "_strcpy"
+    const char *library;  // Имя библиотеки по ordinal или NULL для особых ordinal
+    int32_t ordinal;      // Номер библиотеки (1..dylib_count) или BIND_SPECIAL_DYLIB_*
+    bool weak;            // Слабый импорт: отсутствие символа не мешает загрузке
+    bool lazy;            // Символ привязывается только лениво (lazy bind)
+} MachOImport;
+
+/**
+ * Таблица импортов Mach-O файла. Каждый символ встречается один раз,
+ * в порядке первого упоминания в опкодах или таблице импортов.
+ */
+typedef struct MachOImportTable {
+    MachOImport *imports;     // Массив импортов
+    uint32_t count;           // Количество импортов
+    MachOImportSource source; // Источник списка
+} MachOImportTable;
+
+/**
+ * Команды, из которых строится таблица импортов.
+ */
+typedef struct {
+    const struct dyld_info_command *dyld_info;          // LC_DYLD_INFO(_ONLY) или NULL
+    const struct linkedit_data_command *chained_fixups; // LC_DYLD_CHAINED_FIXUPS или NULL
+} MachOImportCommands;
+
+/**
+ * Возвращает таблицу импортов, строя её при первом обращении.
+ *
+ * Импорты берутся из опкодов привязки LC_DYLD_INFO(_ONLY) или из таблицы импортов
+ * LC_DYLD_CHAINED_FIXUPS: они в сотни раз короче полной таблицы символов и, в отличие
+ * от неё, содержат библиотеку каждого символа. Если ни одной из этих команд нет,
+ * возвращается пустая таблица с source == MACHO_IMPORTS_NONE, и вызывающий может
+ * обратиться к индексу символов.
+ * Таблица кэшируется внутри mach_o_file и освобождается в free_mach_o_file.
+ * Функцию можно вызывать из нескольких потоков для одного MachOFile: кеш
+ * публикуется атомарно, а ошибка построения запоминается и повторно не выводится.
+ *
+ * @param mach_o_file Указатель на структуру MachOFile.
+ * @return Указатель на таблицу или NULL в случае ошибки (данные повреждены или нет памяти).
+ */
+const MachOImportTable *macho_get_import_table(const MachOFile *mach_o_file);
+
+/**
+ * Подписывает поиск команд привязки на visitor, чтобы таблицу можно было
+ * построить после общего прохода без отдельного обхода команд.
+ *
+ * @param visitor Набор подписок.
+ * @param commands Найденные команды; должны жить до окончания обхода.
+ * @return 0 при успехе, -1 в случае ошибки.
+ */
+int macho_import_commands_subscribe(MachOCommandVisitor *visitor, MachOImportCommands *commands);
+
+/**
+ * То же, что macho_get_import_table, но по командам, уже найденным при обходе
+ * (см. macho_import_commands_subscribe). Кеш общий с macho_get_import_table.
+ *
+ * @param mach_o_file Указатель на структуру MachOFile.
+ * @param commands Найденные команды.
+ * @return Указатель на таблицу или NULL в случае ошибки.
+ */
+const MachOImportTable *macho_get_import_table_from(const MachOFile *mach_o_file, const MachOImportCommands *commands);
+
+/**
+ * Освобождает таблицу импортов.
+ *
+ * @param table Таблица, созданная macho_get_import_table.
+ */
+void macho_import_table_free(MachOImportTable *table);
+
+#endif // MACHO_ANALYZER_IMPORT_TABLE_H
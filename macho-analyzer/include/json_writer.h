@@ -0,0 +1,89 @@
+#ifndef MACHO_ANALYZER_JSON_WRITER_H
+#define MACHO_ANALYZER_JSON_WRITER_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Наибольшая глубина вложенности объектов и массивов
+#define JSON_WRITER_MAX_DEPTH 32
+
+/**
+ * Потоковый писатель JSON / NDJSON.
+ *
+ * Текст накапливается в буфере фиксированного размера и сбрасывается в поток
+ * целыми блоками через fwrite, поэтому документ никогда не строится в памяти
+ * целиком, а на каждое поле не приходится отдельный вызов stdio. Запятые между
+ * элементами расставляются автоматически; строки экранируются, байты, не
+ * образующие корректный UTF-8, записываются как \u00XX.
+ */
+typedef struct {
+    FILE *out;                                  // Поток вывода
+    char *buffer;                               // Буфер вывода
+    size_t length;                              // Заполнено байт
+    size_t capacity;                            // Размер буфера
+    uint32_t depth;                             // Текущая глубина вложенности
+    bool need_comma[JSON_WRITER_MAX_DEPTH + 1]; // Перед следующим элементом уровня нужна запятая
+    bool after_key;                             // Только что записан ключ, ждём значение
+    bool error;                                 // Произошла ошибка записи или переполнение глубины
+} JsonWriter;
+
+/**
+ * Создаёт писатель поверх потока.
+ *
+ * @param writer Писатель.
+ * @param out Поток вывода.
+ * @param buffer_size Размер буфера (0 — 64 КБ).
+ * @return 0 при успехе, -1 в случае ошибки.
+ */
+int json_writer_init(JsonWriter *writer, FILE *out, size_t buffer_size);
+
+/**
+ * Сбрасывает буфер и освобождает писатель. Поток не закрывается.
+ *
+ * @return 0 при успехе, -1 если при записи была ошибка.
+ */
+int json_writer_close(JsonWriter *writer);
+
+/**
+ * Сбрасывает накопленный текст в поток.
+ *
+ * @return 0 при успехе, -1 в случае ошибки записи.
+ */
+int json_writer_flush(JsonWriter *writer);
+
+/**
+ * Завершает запись NDJSON переводом строки. Между записями верхнего уровня
+ * запятая не ставится.
+ */
+void json_end_record(JsonWriter *writer);
+
+void json_begin_object(JsonWriter *writer);
+void json_end_object(JsonWriter *writer);
+void json_begin_array(JsonWriter *writer);
+void json_end_array(JsonWriter *writer);
+
+/**
+ * Записывает ключ объекта; следующим вызовом должно быть значение.
+ */
+void json_key(JsonWriter *writer, const char *key);
+
+/**
+ * Записывает строку (NULL записывается как null).
+ */
+void json_string(JsonWriter *writer, const char *value);
+
+/**
+ * Записывает не более length байт строки, останавливаясь на нулевом байте
+ * (для полей фиксированной длины, например имён сегментов).
+ */
+void json_string_n(JsonWriter *writer, const char *value, size_t length);
+
+void json_uint(JsonWriter *writer, uint64_t value);
+void json_int(JsonWriter *writer, int64_t value);
+void json_double(JsonWriter *writer, double value);
+void json_bool(JsonWriter *writer, bool value);
+void json_null(JsonWriter *writer);
+
+#endif // MACHO_ANALYZER_JSON_WRITER_H
@@ -2,25 +2,87 @@
 #define MACHO_ANALYZER_LANGUAGE_DETECTOR_H
 
 #include "macho_analyzer.h"
+#include "symbol_classifier.h"
+#include "signature_scanner.h"
 
 typedef struct {
     char language[64];
     char compiler[64];
 } LanguageInfo;
 
+// Максимальное число языков в векторе оценок
+#define LANGUAGE_SCORES_MAX SYMBOL_CLASSIFIER_MAX_LANGUAGES
+
+/**
+ * Оценка одного языка: суммарный вес всех найденных свидетельств.
+ */
+typedef struct {
+    const char *language;   // Имя языка
+    const char *compiler;   // Компилятор, набравший наибольший вес внутри языка
+    double score;           // Суммарный вес свидетельств
+    uint32_t symbol_hits;   // Количество символов, проголосовавших за язык
+    uint32_t section_hits;  // Количество секций, проголосовавших за язык
+    uint32_t string_hits;   // Количество строк с сигнатурами языка
+} LanguageScore;
+
+/**
+ * Вектор оценок по всем языкам, за которые нашлось хотя бы одно свидетельство.
+ */
+typedef struct {
+    LanguageScore entries[LANGUAGE_SCORES_MAX];
+    size_t count;           // Количество заполненных элементов entries
+    double total;           // Сумма оценок всех языков
+    int best;               // Индекс языка с наибольшей оценкой или -1, если свидетельств нет
+    bool early_stop;        // Анализ прекращён досрочно по порогу уверенности
+} LanguageScores;
+
+/**
+ * Веса свидетельств и порог досрочной остановки.
+ */
+typedef struct {
+    double symbol_weight;       // Вес символа, совпавшего с префиксом языка
+    double plain_c_weight;      // Вес определённого символа без декорирования (слабый признак C)
+    double section_weight;      // Вес секции, характерной для языка
+    double generic_factor;      // Множитель для секций, встречающихся почти в любом файле
+    double string_weight;       // Вес строки с сигнатурой языка
+    double confidence;          // Доля лидера в общей сумме (0..1), при которой анализ прекращается
+    double min_evidence;        // Минимальная сумма весов, до которой порог не проверяется
+} LanguageDetectionOptions;
+
+/**
+ * Заполняет параметры определения языка значениями по умолчанию.
+ *
+ * @param options Указатель на структуру параметров.
+ */
+void language_detection_default_options(LanguageDetectionOptions *options);
+
+/**
+ * Вычисляет вектор оценок языков для Mach-O файла.
+ *
+ * Секции, содержимое __TEXT,__cstring/__const и все символы просматриваются за один
+ * проход; каждое совпадение добавляет свой вес к оценке языка, а не завершает анализ.
+ * Проход прекращается раньше только тогда, когда сумма весов достигла min_evidence
+ * и доля лидера не ниже confidence.
+ *
+ * @param mach_o_file Указатель на проанализированную структуру MachOFile.
+ * @param options Параметры или NULL для значений по умолчанию.
+ * @param scores Структура для записи вектора оценок.
+ * @return 0 при успехе, -1 в случае ошибки.
+ */
+int detect_language_scores(const MachOFile *mach_o_file, const LanguageDetectionOptions *options,
+                           LanguageScores *scores);
+
 /**
  * @brief Определяет язык программирования и компилятор для Mach-O файла.
  *
  * Функция анализирует Mach-O файл для определения языка программирования и компилятора,
- * используемого для его создания. Для этого она использует информацию из символов и секций
- * Mach-O файла. Сначала анализируются символы, которые могут содержать специфичные сигнатуры,
- * указывающие на язык или компилятор. Затем анализируются секции, если символы не дали точного результата.
+ * используемого для его создания. Символы, секции и строки голосуют за языки
+ * (см. detect_language_scores), результатом становится язык с наибольшей оценкой.
  *
  * @param mach_o_file Указатель на структуру MachOFile, содержащую информацию о файле.
  *                    Эта структура должна быть предварительно проанализирована и содержать
- *                    команды загрузки и секции.
- * @param file Указатель на открытый файл Mach-O для чтения данных, таких как символы и секции.
- *             Файл должен быть открыт на чтение.
+ *                    команды загрузки и секции. Символы и строки читаются из образа файла,
+ *                    на который ссылается структура.
  * @param lang_info Указатель на структуру LanguageInfo, в которой будет сохранена информация
  *                  о языке программирования и компиляторе после анализа.
  *                  В случае успешного определения, в эту структуру будет записано имя языка
@@ -30,15 +92,14 @@ typedef struct {
  *             (например, если файл поврежден или структура MachOFile пуста).
  *
  * Примечания:
- * - Если не удается определить язык или компилятор, функция по умолчанию установит язык как
- *   "Assembly" и компилятор как "Assembler".
+ * - Если ни одного свидетельства не найдено, язык и компилятор будут "Неизвестно".
  * - Функция поддерживает множество языков и компиляторов, включая C, C++, Swift, Rust, Go,
  *   Java, Python, Ruby, Kotlin/Native, Haskell, Erlang/Elixir и другие.
  *
  * Пример использования:
  * @code
  * LanguageInfo lang_info;
- * if (detect_language_and_compiler(&mach_o_file, file, &lang_info) == 0) {
+ * if (detect_language_and_compiler(&mach_o_file, &lang_info) == 0) {
  *     printf("Language: %s\n", lang_info.language);
  *     printf("Compiler: %s\n", lang_info.compiler);
  * } else {
@@ -46,6 +107,25 @@ typedef struct {
  * }
  * @endcode
  */
-int detect_language_and_compiler(const MachOFile *mach_o_file, FILE *file, LanguageInfo *lang_info);
+int detect_language_and_compiler(const MachOFile *mach_o_file, LanguageInfo *lang_info);
+
+/**
+ * Возвращает классификатор символов, которым пользуется detect_language_and_compiler.
+ *
+ * Классификатор строится один раз на процесс из встроенной таблицы префиксов. Его можно
+ * расширить собственными префиксами через symbol_classifier_add до начала анализа.
+ *
+ * @return Указатель на классификатор или NULL, если его не удалось построить.
+ */
+SymbolClassifier *language_detector_symbol_classifier(void);
+
+/**
+ * Возвращает сканер строковых сигнатур, которым пользуется detect_language_scores.
+ *
+ * Сканер строится один раз на процесс из встроенной таблицы сигнатур.
+ *
+ * @return Указатель на сканер или NULL, если его не удалось построить.
+ */
+const SignatureScanner *language_detector_string_scanner(void);
 
 #endif // MACHO_ANALYZER_LANGUAGE_DETECTOR_H
@@ -1,10 +1,18 @@
 #ifndef MACHO_ANALYZER_LC_COMMANDS_H
 #define MACHO_ANALYZER_LC_COMMANDS_H
 
+#include "macho_analyzer.h"
 #include <stdio.h>
 #include <string.h>
 #include <ctype.h>
 
+/**
+ * Граница младших битов номера команды (без LC_REQ_DYLD) для прямой таблицы.
+ * Все известные команды укладываются в неё; при добавлении команды с большим
+ * номером сборка прервётся на инициализаторе таблицы.
+ */
+#define LC_COMMAND_ID_LIMIT 0x40u
+
 /**
  * Перечисление для поддерживаемых языков.
  */
@@ -12,23 +20,46 @@ typedef enum {
     LANG_EN, // Английский язык
     LANG_RU  // Русский язык
 } Language;
+/**
+ * Функция, выводящая содержимое команды загрузки определённого типа.
+ *
+ * @param cmd Указатель на команду загрузки.
+ * @param mach_o_file Указатель на структуру MachOFile, которой принадлежит команда.
+ */
+typedef void (*LCCommandDecoder)(const struct load_command *cmd, const MachOFile *mach_o_file);
+
 /**
  * Структура для хранения информации о команде LC.
  */
 typedef struct {
     const char *name;
+    uint32_t cmd;              // Числовое значение команды, включая бит LC_REQ_DYLD
+    LCCommandDecoder decode;   // Декодер содержимого или NULL
     const char *description_en;
     const char *description_ru;
 } LCCommandInfo;
 
 /**
  * Получает информацию о команде по её имени.
+ * Таблица и её совершенная хеш-функция строятся при сборке, поэтому поиск не
+ * требует инициализации и не выделяет память.
  *
  * @param name Имя команды (например, "LC_REEXPORT_DYLIB").
  * @return Указатель на структуру LCCommandInfo или NULL, если команда не найдена.
  */
 const LCCommandInfo *get_lc_command_info(const char *name);
 
+/**
+ * Получает информацию о команде по её числовому значению (cmd->cmd).
+ * Поиск — одно обращение к массиву по младшим битам номера; бит LC_REQ_DYLD
+ * выбирает одну из двух половин таблицы, поэтому, например, LC_DYLD_INFO и
+ * LC_DYLD_INFO_ONLY различаются.
+ *
+ * @param cmd Значение поля cmd команды загрузки.
+ * @return Указатель на структуру LCCommandInfo или NULL, если команда не найдена.
+ */
+const LCCommandInfo *get_lc_command_info_by_id(uint32_t cmd);
+
 /**
  * Выводит информацию о команде на указанном языке.
  *
@@ -44,14 +75,4 @@ void print_lc_command_info(const LCCommandInfo *info, Language lang);
  */
 void print_all_lc_commands(Language lang);
 
-/**
- * Инициализация хеш-таблицы с командами LC.
- */
-void initialize_lc_command_table();
-
-/**
- * Освобождение памяти, выделенной для хеш-таблицы LC команд.
- */
-void destroy_lc_command_table();
-
 #endif // MACHO_ANALYZER_LC_COMMANDS_H
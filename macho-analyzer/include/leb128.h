@@ -0,0 +1,77 @@
+#ifndef MACHO_ANALYZER_LEB128_H
+#define MACHO_ANALYZER_LEB128_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Чтение чисел LEB128 из потоков dyld (опкоды привязки, LC_FUNCTION_STARTS, экспорт).
+ *
+ * @param cursor Текущая позиция; сдвигается за прочитанное число.
+ * @param end Конец данных.
+ * @param value Прочитанное значение.
+ * @return 0 при успехе, -1 если число обрывается на конце данных или длиннее 64 бит.
+ */
+static inline int macho_read_uleb128(const uint8_t **cursor, const uint8_t *end, uint64_t *value) {
+    uint64_t result = 0;
+    unsigned shift = 0;
+    const uint8_t *p = *cursor;
+    while (p < end) {
+        uint8_t byte = *p++;
+        if (shift >= 64 || (shift == 63 && (byte & 0x7e))) {
+            return -1;
+        }
+        result |= (uint64_t)(byte & 0x7f) << shift;
+        shift += 7;
+        if (!(byte & 0x80)) {
+            *cursor = p;
+            *value = result;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static inline int macho_read_sleb128(const uint8_t **cursor, const uint8_t *end, int64_t *value) {
+    uint64_t result = 0;
+    unsigned shift = 0;
+    const uint8_t *p = *cursor;
+    while (p < end) {
+        uint8_t byte = *p++;
+        if (shift >= 64) {
+            return -1;
+        }
+        result |= (uint64_t)(byte & 0x7f) << shift;
+        shift += 7;
+        if (!(byte & 0x80)) {
+            // Расширение знака по старшему биту последнего байта
+            if (shift < 64 && (byte & 0x40)) {
+                result |= ~(uint64_t)0 << shift;
+            }
+            *cursor = p;
+            *value = (int64_t)result;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Декодирует подряд идущие числа ULEB128 до нулевого значения (терминатор
+ * LC_FUNCTION_STARTS, не сохраняется) или до конца данных.
+ *
+ * Байты читаются по восемь словом: завершающие байты чисел находятся одной маской
+ * старших битов, а 7-битные группы каждого числа сжимаются в значение тремя
+ * сдвигами (SWAR). Побайтовое чтение остаётся для хвоста короче слова и для
+ * чисел длиннее восьми байт.
+ *
+ * @param data Начало данных.
+ * @param size Размер данных.
+ * @param values Массив для результата.
+ * @param capacity Размер массива; size значений всегда достаточно.
+ * @param count Количество декодированных значений.
+ * @return 0 при успехе, -1 если число оборвано, длиннее 64 бит или не помещается в массив.
+ */
+int macho_decode_uleb128_run(const uint8_t *data, size_t size, uint64_t *values, size_t capacity, size_t *count);
+
+#endif // MACHO_ANALYZER_LEB128_H
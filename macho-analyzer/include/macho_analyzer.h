@@ -4,7 +4,27 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <stdbool.h>
-#include <mach-o/loader.h>
+#include <string.h>
+#include "macho_image.h"
+#include "macho_types.h"
+#include "macho_endian.h"
+
+// Длина имени сегмента или секции в команде загрузки
+#define MACHO_NAME_LENGTH 16
+
+// Секция из LC_SEGMENT или LC_SEGMENT_64, поля в порядке байтов хоста
+typedef struct {
+    // Имена дополнены нулями до 16 байт и могут не завершаться нулём (выводятся через %.16s).
+    // Вместе segname и sectname образуют 32-байтовый ключ индекса секций.
+    char segname[MACHO_NAME_LENGTH];
+    char sectname[MACHO_NAME_LENGTH];
+    uint64_t addr;           // Виртуальный адрес
+    uint64_t size;           // Размер
+    uint32_t offset;         // Смещение в файле
+    uint32_t align;          // Выравнивание (степень двойки)
+    uint32_t flags;          // Тип и атрибуты (SECTION_TYPE, S_ATTR_*)
+    uint32_t segment_index;  // Индекс сегмента в MachOFile.segments
+} MachOSection;
 
 // Структура для хранения информации о сегменте
 typedef struct {
@@ -17,8 +37,7 @@ typedef struct {
     uint32_t initprot; // Начальные права доступа
     uint32_t nsects;   // Количество секций
     uint32_t flags;    // Флаги сегмента
-    struct section_64 *sections; // Для 64-битных файлов
-    struct section *sections32;  // Для 32-битных файлов
+    MachOSection *sections; // Первая из nsects секций сегмента в MachOFile.sections (NULL, если секций нет)
 } Segment;
 
 // Структура для хранения информации о динамической библиотеке
@@ -29,8 +48,31 @@ typedef struct {
     uint32_t compatibility_version; // Версия совместимости
 } Dylib;
 
+struct MachOSymbolIndex;
+struct MachOImportTable;
+struct MachOFunctionStarts;
+
+// Архитектура внутри файла: запись fat_arch или fat_arch_64 для FAT или весь файл для обычного Mach-O
+typedef struct {
+    uint64_t offset;           // Смещение Mach-O от начала файла
+    uint64_t size;             // Размер Mach-O
+    cpu_type_t cpu_type;       // Тип процессора
+    cpu_subtype_t cpu_subtype; // Подтип процессора
+} MachOArchitecture;
+
+// Биты MachOFile.cache_failed: ленивые кеши, построить которые не удалось
+#define MACHO_CACHE_SYMBOL_INDEX    (1u << 0)
+#define MACHO_CACHE_IMPORT_TABLE    (1u << 1)
+#define MACHO_CACHE_FUNCTION_STARTS (1u << 2)
+
 // Основная структура для хранения данных Mach-O файла
 typedef struct {
+    // Срез образа, в котором лежит Mach-O (для FAT — одна архитектура).
+    // Все смещения из команд загрузки отсчитываются от data.
+    const uint8_t *data;      // Начало среза внутри отображения
+    uint64_t data_size;       // Размер среза
+    MachOImage *owned_image;  // Образ, созданный analyze_mach_o (NULL, если образ внешний)
+
     // Заголовок Mach-O
     uint32_t magic;           // Magic number (например, MH_MAGIC_64)
     cpu_type_t cpu_type;      // Тип процессора (например, CPU_TYPE_X86_64)
@@ -39,27 +81,51 @@ typedef struct {
     uint32_t flags;           // Флаги (например, MH_PIE)
     uint32_t header_size;     // Размер заголовка
     bool is_64_bit;           // Флаг 64-битности
+    bool swapped;             // Порядок байтов образа противоположен хосту (MH_CIGAM, MH_CIGAM_64)
     union {
         struct mach_header header32;
         struct mach_header_64 header64;
-    } header;
+    } header;                 // Заголовок как в файле, без перестановки байтов
 
     // Команды загрузки
     uint32_t load_command_count; // Количество команд загрузки
     uint32_t sizeofcmds;         // Общий размер команд загрузки
-    struct load_command *commands;// Массив команд загрузки
+    const struct load_command *commands; // Команды загрузки (указывает внутрь образа)
 
     // Сегменты
     uint32_t segment_count;      // Количество сегментов
     Segment *segments;           // Массив сегментов
 
+    // Секции всех сегментов подряд в порядке команд загрузки, разбираются один раз
+    // в analyze_load_commands. Поиск по имени — через macho_find_section.
+    uint32_t section_count;      // Количество секций
+    MachOSection *sections;      // Плоская таблица секций
+    uint32_t *section_slots;     // Индекс: открытая адресация, номер секции + 1 (0 — пустой слот)
+    uint32_t section_slot_count; // Количество слотов индекса (степень двойки)
+
     // Динамические библиотеки
     uint32_t dylib_count;        // Количество связанных библиотек
     Dylib *dylibs;               // Массив библиотек
+
+    // Индекс таблицы символов, строится при первом обращении (см. macho_get_symbol_index)
+    struct MachOSymbolIndex *symbol_index;
+
+    // Таблица импортов, строится при первом обращении (см. macho_get_import_table)
+    struct MachOImportTable *import_table;
+
+    // Адреса начала функций, декодируются при первом обращении (см. macho_get_function_starts)
+    struct MachOFunctionStarts *function_starts;
+
+    // Ленивые кеши публикуются атомарно: один разобранный MachOFile можно читать из
+    // нескольких потоков. Неудачное построение запоминается и не повторяется.
+    uint32_t cache_failed;       // Биты MACHO_CACHE_*
 } MachOFile;
 
 /**
  * Анализирует Mach-O файл и сохраняет результат в структуру MachOFile.
+ * Файл отображается в память целиком; разбор начинается с текущей позиции файла.
+ * Для FAT-файла разбирается первая архитектура.
+ * Отображение принадлежит mach_o_file и освобождается в free_mach_o_file.
  *
  * @param file Указатель на файл для анализа.
  * @param mach_o_file Структура для хранения данных о Mach-O.
@@ -67,14 +133,113 @@ typedef struct {
  */
 int analyze_mach_o(FILE *file, MachOFile *mach_o_file);
 
+/**
+ * Анализирует Mach-O, лежащий в образе по смещению offset.
+ * MachOFile не копирует данные, а ссылается на образ, поэтому образ должен
+ * оставаться открытым, пока используется mach_o_file.
+ *
+ * @param image Отображённый образ файла.
+ * @param offset Смещение начала Mach-O внутри образа (для FAT — смещение архитектуры).
+ * @param size Размер Mach-O (0 — до конца образа).
+ * @param mach_o_file Структура для хранения данных о Mach-O.
+ * @return 0 при успехе, -1 в случае ошибки.
+ */
+int analyze_mach_o_image(const MachOImage *image, uint64_t offset, uint64_t size, MachOFile *mach_o_file);
+
 /**
  * Анализирует команды загрузки Mach-O файла.
+ * Заголовок уже должен быть разобран, а data/data_size — указывать на срез образа.
  *
- * @param file Указатель на файл.
  * @param mach_o_file Структура с данными о Mach-O.
  * @return 0 при успехе, -1 в случае ошибки.
  */
-int analyze_load_commands(FILE *file, MachOFile *mach_o_file);
+int analyze_load_commands(MachOFile *mach_o_file);
+
+/**
+ * Ищет секцию по имени сегмента и секции за O(1) по индексу, построенному
+ * в analyze_load_commands. Имена длиннее 16 байт не совпадают ни с чем.
+ * Если в файле несколько секций с одинаковыми именами, возвращается первая.
+ *
+ * @param mach_o_file Структура с данными о Mach-O.
+ * @param segname Имя сегмента (например, "__TEXT").
+ * @param sectname Имя секции (например, "__cstring").
+ * @return Указатель на секцию или NULL, если её нет.
+ */
+const MachOSection *macho_find_section(const MachOFile *mach_o_file, const char *segname, const char *sectname);
+
+/**
+ * Возвращает указатель на диапазон [offset, offset + size) внутри среза Mach-O.
+ * Смещение задаётся так же, как в командах загрузки (от начала среза).
+ *
+ * @param mach_o_file Структура с данными о Mach-O.
+ * @param offset Смещение от начала среза.
+ * @param size Размер диапазона.
+ * @return Указатель на данные или NULL, если диапазон выходит за границы среза.
+ */
+const void *macho_file_slice(const MachOFile *mach_o_file, uint64_t offset, uint64_t size);
+
+/**
+ * Чтение полей образа с учётом порядка байтов.
+ *
+ * Команды загрузки, секции и nlist не копируются и не переставляются заранее:
+ * поле переставляется в момент чтения, если образ записан в порядке байтов,
+ * противоположном хосту (swapped). Поэтому любое числовое поле структуры из
+ * образа читается через эти функции, а не напрямую.
+ */
+static inline uint16_t macho_get16(const MachOFile *mach_o_file, uint16_t value) {
+    return macho_swap_if16(mach_o_file->swapped, value);
+}
+
+static inline uint32_t macho_get32(const MachOFile *mach_o_file, uint32_t value) {
+    return macho_swap_if32(mach_o_file->swapped, value);
+}
+
+static inline uint64_t macho_get64(const MachOFile *mach_o_file, uint64_t value) {
+    return macho_swap_if64(mach_o_file->swapped, value);
+}
+
+/**
+ * Возвращает тип команды загрузки (LC_*).
+ */
+static inline uint32_t macho_command_type(const MachOFile *mach_o_file, const struct load_command *cmd) {
+    return macho_get32(mach_o_file, cmd->cmd);
+}
+
+/**
+ * Возвращает размер команды загрузки.
+ */
+static inline uint32_t macho_command_size(const MachOFile *mach_o_file, const struct load_command *cmd) {
+    return macho_get32(mach_o_file, cmd->cmdsize);
+}
+
+/**
+ * Возвращает следующую команду загрузки. Размеры всех команд проверены в
+ * analyze_load_commands, поэтому обход по load_command_count не выходит за sizeofcmds.
+ */
+static inline const struct load_command *macho_next_command(const MachOFile *mach_o_file,
+                                                            const struct load_command *cmd) {
+    return (const struct load_command *)((const uint8_t *)cmd + macho_command_size(mach_o_file, cmd));
+}
+
+/**
+ * Возвращает строку, заданную смещением lc_str внутри команды загрузки.
+ *
+ * @param mach_o_file Структура с данными о Mach-O.
+ * @param cmd Команда загрузки.
+ * @param offset Смещение строки от начала команды (как в файле, без перестановки).
+ * @return Указатель на строку или NULL, если смещение выходит за команду
+ *         или строка не завершается нулём внутри неё.
+ */
+static inline const char *macho_command_string(const MachOFile *mach_o_file, const struct load_command *cmd,
+                                               uint32_t offset) {
+    uint32_t cmdsize = macho_command_size(mach_o_file, cmd);
+    offset = macho_get32(mach_o_file, offset);
+    if (offset < sizeof(struct load_command) || offset >= cmdsize) {
+        return NULL;
+    }
+    const char *string = (const char *)cmd + offset;
+    return memchr(string, '\0', cmdsize - offset) ? string : NULL;
+}
 
 /**
  * Освобождает ресурсы, выделенные для хранения данных MachOFile.
@@ -83,6 +248,60 @@ int analyze_load_commands(FILE *file, MachOFile *mach_o_file);
  */
 void free_mach_o_file(MachOFile *mach_o_file);
 
+/**
+ * Передаёт все ресурсы MachOFile (таблицы, кеши, собственный образ) из src в dst.
+ * src обнуляется, поэтому его можно повторно освобождать или заполнять;
+ * прежнее содержимое dst не освобождается.
+ *
+ * @param dst Структура-получатель.
+ * @param src Структура-источник.
+ */
+void macho_file_move(MachOFile *dst, MachOFile *src);
+
+/**
+ * Перечисляет архитектуры, содержащиеся в образе, не разбирая сами Mach-O.
+ * Для обычного Mach-O возвращается одна архитектура, занимающая весь образ.
+ *
+ * @param image Отображённый образ файла.
+ * @param archs Массив для архитектур (может быть NULL, если max_archs == 0).
+ * @param max_archs Ёмкость массива archs.
+ * @param is_fat Если не NULL, сюда записывается признак FAT-файла.
+ * @return Количество архитектур (может превышать max_archs; записываются первые
+ *         max_archs) или -1, если образ не является Mach-O или FAT (FAT_MAGIC или FAT_MAGIC_64).
+ */
+int64_t macho_list_architectures(const MachOImage *image, MachOArchitecture *archs, uint32_t max_archs, bool *is_fat);
+
+/**
+ * Анализ разобранной архитектуры, выполняемый в том же рабочем потоке, что и разбор.
+ *
+ * @param mach_o_file Разобранная архитектура.
+ * @param index Номер архитектуры в archs.
+ * @param context Контекст, переданный в analyze_mach_o_architectures.
+ */
+typedef void (*MachOArchitectureAnalysis)(const MachOFile *mach_o_file, uint32_t index, void *context);
+
+/**
+ * Разбирает архитектуры одного образа параллельно, по архитектуре на рабочий поток.
+ * Архитектуры FAT-файла независимы и читаются из общего отображения только на
+ * чтение, поэтому разбор не требует синхронизации; результаты лежат в files в
+ * порядке archs, так что вывод не зависит от порядка завершения потоков.
+ *
+ * @param image Отображённый образ файла.
+ * @param archs Архитектуры (например, из macho_list_architectures).
+ * @param count Количество архитектур.
+ * @param threads Наибольшее число потоков (0 — по числу процессоров); больше count не создаётся.
+ * @param files Массив из count структур для результатов. Неразобранные архитектуры уже освобождены.
+ * @param statuses Массив из count кодов: 0 — архитектура разобрана, -1 — ошибка.
+ * @param analysis Дальнейший анализ каждой разобранной архитектуры в её рабочем потоке
+ *                 (например, macho_report_analyze) или NULL. Результаты пишутся по index,
+ *                 поэтому выводить их можно по порядку после возврата.
+ * @param context Контекст для analysis.
+ * @return 0, если разобраны все архитектуры, -1 если хотя бы одна не разобрана.
+ */
+int analyze_mach_o_architectures(const MachOImage *image, const MachOArchitecture *archs, uint32_t count,
+                                 size_t threads, MachOFile *files, int *statuses,
+                                 MachOArchitectureAnalysis analysis, void *context);
+
 /**
  * Возвращает строковое представление архитектуры.
  *
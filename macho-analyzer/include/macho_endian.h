@@ -0,0 +1,101 @@
+#ifndef MACHO_ANALYZER_MACHO_ENDIAN_H
+#define MACHO_ANALYZER_MACHO_ENDIAN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Перестановка байтов без <libkern/OSByteOrder.h>.
+ *
+ * Заголовки FAT и блобы подписи кода всегда хранятся в big-endian, а сами
+ * Mach-O — в порядке байтов целевого процессора, который может не совпадать
+ * с порядком байтов машины, на которой идёт анализ (например, PPC-срезы на x86).
+ * Порядок байтов хоста определяется при компиляции, поэтому лишних
+ * перестановок на совпадающем порядке нет.
+ */
+
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define MACHO_HOST_BIG_ENDIAN 1
+#else
+#define MACHO_HOST_BIG_ENDIAN 0
+#endif
+
+static inline uint16_t macho_swap16(uint16_t value) {
+    return __builtin_bswap16(value);
+}
+
+static inline uint32_t macho_swap32(uint32_t value) {
+    return __builtin_bswap32(value);
+}
+
+static inline uint64_t macho_swap64(uint64_t value) {
+    return __builtin_bswap64(value);
+}
+
+/**
+ * Переставляет байты, только если swap истинно. При константном swap
+ * (см. специализированные проходы в macho_analyzer.c и symbol_index.c)
+ * условие исчезает при компиляции.
+ */
+static inline uint16_t macho_swap_if16(bool swap, uint16_t value) {
+    return swap ? macho_swap16(value) : value;
+}
+
+static inline uint32_t macho_swap_if32(bool swap, uint32_t value) {
+    return swap ? macho_swap32(value) : value;
+}
+
+static inline uint64_t macho_swap_if64(bool swap, uint64_t value) {
+    return swap ? macho_swap64(value) : value;
+}
+
+/**
+ * Преобразует значение из big-endian в порядок байтов хоста.
+ */
+static inline uint32_t macho_big_to_host32(uint32_t value) {
+#if MACHO_HOST_BIG_ENDIAN
+    return value;
+#else
+    return macho_swap32(value);
+#endif
+}
+
+static inline uint64_t macho_big_to_host64(uint64_t value) {
+#if MACHO_HOST_BIG_ENDIAN
+    return value;
+#else
+    return macho_swap64(value);
+#endif
+}
+
+/**
+ * Преобразует значение из порядка байтов хоста в big-endian.
+ */
+static inline uint32_t macho_host_to_big32(uint32_t value) {
+    return macho_big_to_host32(value);
+}
+
+static inline uint64_t macho_host_to_big64(uint64_t value) {
+    return macho_big_to_host64(value);
+}
+
+/**
+ * Преобразует значение из little-endian в порядок байтов хоста.
+ */
+static inline uint32_t macho_little_to_host32(uint32_t value) {
+#if MACHO_HOST_BIG_ENDIAN
+    return macho_swap32(value);
+#else
+    return value;
+#endif
+}
+
+static inline uint64_t macho_little_to_host64(uint64_t value) {
+#if MACHO_HOST_BIG_ENDIAN
+    return macho_swap64(value);
+#else
+    return value;
+#endif
+}
+
+#endif // MACHO_ANALYZER_MACHO_ENDIAN_H
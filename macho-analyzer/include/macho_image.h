@@ -0,0 +1,87 @@
+#ifndef MACHO_ANALYZER_MACHO_IMAGE_H
+#define MACHO_ANALYZER_MACHO_IMAGE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Способ, которым получены байты образа.
+ */
+typedef enum {
+    MACHO_IMAGE_NONE,     // Образ не открыт
+    MACHO_IMAGE_MAPPED,   // Файл отображён в память через mmap
+    MACHO_IMAGE_HEAP,     // Файл прочитан в буфер на куче (если mmap недоступен)
+    MACHO_IMAGE_BORROWED  // Внешний буфер, образ им не владеет
+} MachOImageKind;
+
+/**
+ * Отображённый в память образ файла, доступный только для чтения.
+ *
+ * Образ создаётся один раз на файл, после чего все проходы анализа читают
+ * таблицы символов, строки и содержимое секций прямо из него, без fseek/fread
+ * и без промежуточных копий. Любое обращение к данным должно идти через
+ * macho_image_slice(), который проверяет границы.
+ */
+typedef struct {
+    const uint8_t *base;  // Начало данных
+    uint64_t size;        // Размер данных в байтах
+    MachOImageKind kind;  // Кто владеет памятью
+} MachOImage;
+
+/**
+ * Открывает файл по пути и отображает его в память.
+ *
+ * @param path Путь к файлу.
+ * @param image Структура, в которую будет записан образ.
+ * @return 0 при успехе, -1 в случае ошибки.
+ */
+int macho_image_open(const char *path, MachOImage *image);
+
+/**
+ * Отображает в память уже открытый файл целиком.
+ * Если файл не поддерживает mmap (например, канал), он читается в буфер.
+ *
+ * @param file Открытый на чтение файл.
+ * @param image Структура, в которую будет записан образ.
+ * @return 0 при успехе, -1 в случае ошибки.
+ */
+int macho_image_from_file(FILE *file, MachOImage *image);
+
+/**
+ * Оборачивает внешний буфер в образ без копирования.
+ * Буфер должен жить дольше образа и всех MachOFile, построенных по нему.
+ *
+ * @param data Указатель на данные.
+ * @param size Размер данных.
+ * @param image Структура, в которую будет записан образ.
+ * @return 0 при успехе, -1 в случае ошибки.
+ */
+int macho_image_from_memory(const void *data, uint64_t size, MachOImage *image);
+
+/**
+ * Освобождает отображение (или буфер) образа.
+ *
+ * @param image Образ.
+ */
+void macho_image_close(MachOImage *image);
+
+/**
+ * Возвращает указатель на диапазон [offset, offset + size) внутри образа.
+ *
+ * @param image Образ.
+ * @param offset Смещение от начала образа.
+ * @param size Размер диапазона.
+ * @return Указатель на данные или NULL, если диапазон выходит за границы образа.
+ */
+const void *macho_image_slice(const MachOImage *image, uint64_t offset, uint64_t size);
+
+/**
+ * Проверяет, что диапазон [offset, offset + size) целиком лежит в буфере длины limit.
+ * Корректно обрабатывает переполнение при сложении.
+ */
+static inline bool macho_range_valid(uint64_t offset, uint64_t size, uint64_t limit) {
+    return offset <= limit && size <= limit - offset;
+}
+
+#endif // MACHO_ANALYZER_MACHO_IMAGE_H
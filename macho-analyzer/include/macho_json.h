@@ -0,0 +1,54 @@
+#ifndef MACHO_ANALYZER_MACHO_JSON_H
+#define MACHO_ANALYZER_MACHO_JSON_H
+
+#include "json_writer.h"
+#include "macho_analyzer.h"
+#include "security_check.h"
+#include "language_detector.h"
+#include "batch_scanner.h"
+#include "result_store.h"
+
+/**
+ * Данные для JSON-объекта одной архитектуры.
+ */
+typedef struct {
+    const char *path;                   // Путь к файлу
+    uint32_t arch_index;                // Номер архитектуры в файле (с 0)
+    const MachOArchitecture *arch;      // Положение архитектуры в файле или NULL
+    const MachOFile *mach_o_file;       // Разобранная архитектура
+    const SecurityFeatures *security;   // Результат check_security_features или NULL (поле не выводится)
+    const LanguageInfo *language;       // Язык и компилятор или NULL (поле не выводится)
+} MachOJsonRecord;
+
+/**
+ * Записывает объект одной архитектуры: заголовок, команды загрузки, сегменты,
+ * библиотеки и, если переданы, защитные механизмы и язык. Перевод строки после
+ * объекта не пишется — для NDJSON вызывающий завершает запись json_end_record.
+ *
+ * @param writer Писатель JSON.
+ * @param record Данные архитектуры.
+ */
+void write_mach_o_json(JsonWriter *writer, const MachOJsonRecord *record);
+
+/**
+ * Записывает запись пакетного анализа. Запись архитектуры с разобранным
+ * MachOFile выводится полностью, как в write_mach_o_json; запись файла и
+ * записи с ошибкой — кратко.
+ *
+ * @param writer Писатель JSON.
+ * @param record Запись пакетного анализа.
+ */
+void write_batch_record_json(JsonWriter *writer, const BatchRecord *record);
+
+/**
+ * Записывает архитектуру, прочитанную из двоичного файла результатов, в той же
+ * схеме, что и write_mach_o_json. Команды загрузки в файле результатов не
+ * хранятся; вместо них выводятся находки анализа безопасности.
+ *
+ * @param writer Писатель JSON.
+ * @param reader Читатель файла результатов (для строк).
+ * @param view Запись архитектуры.
+ */
+void write_result_arch_json(JsonWriter *writer, const ResultReader *reader, const ResultArchView *view);
+
+#endif // MACHO_ANALYZER_MACHO_JSON_H
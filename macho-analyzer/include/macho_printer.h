@@ -2,15 +2,28 @@
 #define MACHO_ANALYZER_MACHO_PRINTER_H
 
 #include "macho_analyzer.h"
-#include <mach-o/nlist.h>
+#include "code_signature.h"
+#include "security_check.h"
+#include "security_analyzer.h"
+#include "language_detector.h"
+#include "macho_report.h"
+#include "macho_types.h"
 
 /**
  * Выводит информацию о Mach-O файле.
  *
  * @param mach_o_file Структура, содержащая данные о Mach-O.
- * @param file Указатель на исходный файл Mach-O.
  */
-void print_mach_o_info(const MachOFile *mach_o_file, FILE *file);
+void print_mach_o_info(const MachOFile *mach_o_file);
+
+/**
+ * Выводит информацию о Mach-O файле по уже выполненным проверкам
+ * (см. macho_report_analyze): сам ничего не анализирует.
+ *
+ * @param mach_o_file Структура, содержащая данные о Mach-O.
+ * @param report Результаты проверок этой архитектуры.
+ */
+void print_mach_o_report(const MachOFile *mach_o_file, const MachOReport *report);
 
 /**
  * @brief Выводит список динамических библиотек, используемых Mach-O файлом.
@@ -30,4 +43,61 @@ void print_dynamic_libraries(const MachOFile *mach_o_file);
  */
 void print_header_info(const MachOFile *mach_o_file);
 
+/**
+ * Выводит результат check_security_features.
+ *
+ * @param features Результат проверки.
+ * @param out Поток вывода.
+ */
+void print_security_features(const SecurityFeatures *features, FILE *out);
+
+/**
+ * Выводит находки analyze_unsafe_functions, analyze_section_permissions и analyze_debug_symbols.
+ *
+ * @param findings Список находок.
+ * @param out Поток вывода.
+ */
+void print_security_findings(const SecurityFindings *findings, FILE *out);
+
+/**
+ * Выводит результат analyze_code_signature.
+ *
+ * @param info Сведения о подписи кода.
+ * @param out Поток вывода.
+ */
+void print_code_signature(const CodeSignatureInfo *info, FILE *out);
+
+/**
+ * Выводит оценки языков, полученные detect_language_scores, по убыванию оценки.
+ *
+ * @param scores Оценки языков.
+ * @param out Поток вывода.
+ */
+void print_language_scores(const LanguageScores *scores, FILE *out);
+
+/**
+ * Декодеры команд загрузки. Все имеют сигнатуру LCCommandDecoder и вызываются
+ * через поле decode таблицы LC команд (см. get_lc_command_info_by_id).
+ *
+ * @param cmd Указатель на команду загрузки.
+ * @param mach_o_file Указатель на структуру MachOFile, которой принадлежит команда.
+ */
+void print_segment_command(const struct load_command *cmd, const MachOFile *mach_o_file);
+void print_symtab_command(const struct load_command *cmd, const MachOFile *mach_o_file);
+void print_dysymtab_command(const struct load_command *cmd, const MachOFile *mach_o_file);
+void print_dylib_command(const struct load_command *cmd, const MachOFile *mach_o_file);
+void print_dylinker_command(const struct load_command *cmd, const MachOFile *mach_o_file);
+void print_uuid_command(const struct load_command *cmd, const MachOFile *mach_o_file);
+void print_version_min_command(const struct load_command *cmd, const MachOFile *mach_o_file);
+void print_source_version_command(const struct load_command *cmd, const MachOFile *mach_o_file);
+void print_entry_point_command(const struct load_command *cmd, const MachOFile *mach_o_file);
+void print_linkedit_data_command(const struct load_command *cmd, const MachOFile *mach_o_file);
+void print_function_starts_command(const struct load_command *cmd, const MachOFile *mach_o_file);
+void print_dyld_info_command(const struct load_command *cmd, const MachOFile *mach_o_file);
+void print_encryption_info_command(const struct load_command *cmd, const MachOFile *mach_o_file);
+void print_rpath_command(const struct load_command *cmd, const MachOFile *mach_o_file);
+void print_build_version_command(const struct load_command *cmd, const MachOFile *mach_o_file);
+void print_linker_option_command(const struct load_command *cmd, const MachOFile *mach_o_file);
+void print_note_command(const struct load_command *cmd, const MachOFile *mach_o_file);
+
 #endif //MACHO_ANALYZER_MACHO_PRINTER_H
@@ -0,0 +1,62 @@
+#ifndef MACHO_ANALYZER_MACHO_REPORT_H
+#define MACHO_ANALYZER_MACHO_REPORT_H
+
+#include "macho_analyzer.h"
+#include "security_check.h"
+#include "security_analyzer.h"
+#include "code_signature.h"
+#include "language_detector.h"
+
+/**
+ * Какие проверки выполняет macho_report_analyze.
+ */
+typedef struct {
+    size_t threads;          // Потоки хеширования страниц подписи (0 — по числу процессоров)
+    bool detect_language;    // Определять язык и компилятор
+    bool collect_findings;   // Искать небезопасные функции, секции W+X и отладочные символы
+} MachOReportOptions;
+
+/**
+ * Результаты проверок одной архитектуры.
+ *
+ * Анализ отделён от вывода: macho_report_analyze ничего не печатает и не
+ * использует общего состояния, поэтому архитектуры FAT-файла анализируются
+ * в рабочих потоках, а print_mach_o_report затем выводит их по порядку.
+ */
+typedef struct {
+    int status;                  // 0 — защитные механизмы и подпись проверены, -1 — ошибка обхода
+    SecurityFeatures security;
+    CodeSignatureInfo signature;
+    int language_status;         // 0 — язык определялся успешно, -1 — ошибка или не определялся
+    LanguageInfo language;
+    int findings_status;         // 0 — находки собраны, -1 — ошибка или не собирались
+    SecurityFindings findings;   // Находки analyze_* (память освобождает macho_report_free)
+} MachOReport;
+
+/**
+ * Возвращает настройки по умолчанию: подпись хешируется на всех процессорах,
+ * язык и находки не ищутся.
+ */
+MachOReportOptions macho_report_default_options(void);
+
+/**
+ * Выполняет проверки одной архитектуры: защитные механизмы и подпись за один
+ * проход по командам, при необходимости язык и находки. Заодно строит таблицу
+ * адресов функций, которую читает декодер LC_FUNCTION_STARTS, чтобы вывод
+ * только обращался к кешу.
+ *
+ * @param mach_o_file Разобранная архитектура.
+ * @param options Настройки или NULL для настроек по умолчанию.
+ * @param report Структура для результата; освобождается macho_report_free.
+ * @return 0, если защитные механизмы и подпись проверены, -1 в случае ошибки.
+ */
+int macho_report_analyze(const MachOFile *mach_o_file, const MachOReportOptions *options, MachOReport *report);
+
+/**
+ * Освобождает память результата (находки). Структуру можно использовать повторно.
+ *
+ * @param report Результат macho_report_analyze или обнулённая структура.
+ */
+void macho_report_free(MachOReport *report);
+
+#endif // MACHO_ANALYZER_MACHO_REPORT_H
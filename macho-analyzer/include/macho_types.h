@@ -0,0 +1,526 @@
+#ifndef MACHO_ANALYZER_MACHO_TYPES_H
+#define MACHO_ANALYZER_MACHO_TYPES_H
+
+#include <stdint.h>
+
+/**
+ * Собственные определения структур и констант формата Mach-O.
+ *
+ * Повторяют раскладку <mach-o/loader.h>, <mach-o/fat.h>, <mach-o/nlist.h>
+ * и <mach-o/fixup-chains.h>,
+ * поэтому анализатор собирается и на Linux, где системных заголовков Apple нет.
+ * Все структуры описывают данные файла как есть: поля хранятся в порядке байтов
+ * образа (для FAT — всегда big-endian) и переставляются функциями из macho_endian.h.
+ * Указательные члены (char *ptr в lc_str, n_name в nlist) опущены: на 64-битных
+ * платформах Apple их тоже нет, а раскладка в файле от них не зависит.
+ */
+
+// Сами системные заголовки при случайном включении после этого файла пропускаются
+#define _MACHO_LOADER_H_
+#define _MACH_O_FAT_H_
+#define _MACHO_NLIST_H_
+#define __MACH_O_FIXUP_CHAINS__
+
+#ifdef __APPLE__
+#include <mach/machine.h>
+#include <mach/vm_prot.h>
+#else
+typedef int32_t cpu_type_t;
+typedef int32_t cpu_subtype_t;
+typedef int32_t vm_prot_t;
+
+// Типы процессоров (mach/machine.h)
+#define CPU_ARCH_MASK       0xff000000
+#define CPU_ARCH_ABI64      0x01000000
+#define CPU_ARCH_ABI64_32   0x02000000
+
+#define CPU_TYPE_ANY        ((cpu_type_t)-1)
+#define CPU_TYPE_X86        ((cpu_type_t)7)
+#define CPU_TYPE_I386       CPU_TYPE_X86
+#define CPU_TYPE_X86_64     (CPU_TYPE_X86 | CPU_ARCH_ABI64)
+#define CPU_TYPE_ARM        ((cpu_type_t)12)
+#define CPU_TYPE_ARM64      (CPU_TYPE_ARM | CPU_ARCH_ABI64)
+#define CPU_TYPE_ARM64_32   (CPU_TYPE_ARM | CPU_ARCH_ABI64_32)
+#define CPU_TYPE_POWERPC    ((cpu_type_t)18)
+#define CPU_TYPE_POWERPC64  (CPU_TYPE_POWERPC | CPU_ARCH_ABI64)
+
+#define CPU_SUBTYPE_MASK    0xff000000
+#define CPU_SUBTYPE_LIB64   0x80000000
+
+// Права доступа к памяти (mach/vm_prot.h)
+#define VM_PROT_NONE        ((vm_prot_t)0x00)
+#define VM_PROT_READ        ((vm_prot_t)0x01)
+#define VM_PROT_WRITE       ((vm_prot_t)0x02)
+#define VM_PROT_EXECUTE     ((vm_prot_t)0x04)
+#endif
+
+// ---------------------------------------------------------------------------
+// Заголовок (mach-o/loader.h)
+// ---------------------------------------------------------------------------
+
+struct mach_header {
+    uint32_t magic;
+    cpu_type_t cputype;
+    cpu_subtype_t cpusubtype;
+    uint32_t filetype;
+    uint32_t ncmds;
+    uint32_t sizeofcmds;
+    uint32_t flags;
+};
+
+struct mach_header_64 {
+    uint32_t magic;
+    cpu_type_t cputype;
+    cpu_subtype_t cpusubtype;
+    uint32_t filetype;
+    uint32_t ncmds;
+    uint32_t sizeofcmds;
+    uint32_t flags;
+    uint32_t reserved;
+};
+
+#define MH_MAGIC    0xfeedface
+#define MH_CIGAM    0xcefaedfe
+#define MH_MAGIC_64 0xfeedfacf
+#define MH_CIGAM_64 0xcffaedfe
+
+// Типы файлов
+#define MH_OBJECT       0x1
+#define MH_EXECUTE      0x2
+#define MH_FVMLIB       0x3
+#define MH_CORE         0x4
+#define MH_PRELOAD      0x5
+#define MH_DYLIB        0x6
+#define MH_DYLINKER     0x7
+#define MH_BUNDLE       0x8
+#define MH_DYLIB_STUB   0x9
+#define MH_DSYM         0xa
+#define MH_KEXT_BUNDLE  0xb
+#define MH_FILESET      0xc
+
+// Флаги заголовка
+#define MH_NOUNDEFS                 0x1
+#define MH_DYLDLINK                 0x4
+#define MH_TWOLEVEL                 0x80
+#define MH_ALLOW_STACK_EXECUTION    0x20000
+#define MH_PIE                      0x200000
+#define MH_NO_HEAP_EXECUTION        0x1000000
+
+// ---------------------------------------------------------------------------
+// Команды загрузки
+// ---------------------------------------------------------------------------
+
+struct load_command {
+    uint32_t cmd;
+    uint32_t cmdsize;
+};
+
+#define LC_REQ_DYLD 0x80000000
+
+#define LC_SEGMENT                  0x1
+#define LC_SYMTAB                   0x2
+#define LC_SYMSEG                   0x3
+#define LC_THREAD                   0x4
+#define LC_UNIXTHREAD               0x5
+#define LC_LOADFVMLIB               0x6
+#define LC_IDFVMLIB                 0x7
+#define LC_IDENT                    0x8
+#define LC_FVMFILE                  0x9
+#define LC_PREPAGE                  0xa
+#define LC_DYSYMTAB                 0xb
+#define LC_LOAD_DYLIB               0xc
+#define LC_ID_DYLIB                 0xd
+#define LC_LOAD_DYLINKER            0xe
+#define LC_ID_DYLINKER              0xf
+#define LC_PREBOUND_DYLIB           0x10
+#define LC_ROUTINES                 0x11
+#define LC_SUB_FRAMEWORK            0x12
+#define LC_SUB_UMBRELLA             0x13
+#define LC_SUB_CLIENT               0x14
+#define LC_SUB_LIBRARY              0x15
+#define LC_TWOLEVEL_HINTS           0x16
+#define LC_PREBIND_CKSUM            0x17
+#define LC_LOAD_WEAK_DYLIB          (0x18 | LC_REQ_DYLD)
+#define LC_SEGMENT_64               0x19
+#define LC_ROUTINES_64              0x1a
+#define LC_UUID                     0x1b
+#define LC_RPATH                    (0x1c | LC_REQ_DYLD)
+#define LC_CODE_SIGNATURE           0x1d
+#define LC_SEGMENT_SPLIT_INFO       0x1e
+#define LC_REEXPORT_DYLIB           (0x1f | LC_REQ_DYLD)
+#define LC_LAZY_LOAD_DYLIB          0x20
+#define LC_ENCRYPTION_INFO          0x21
+#define LC_DYLD_INFO                0x22
+#define LC_DYLD_INFO_ONLY           (0x22 | LC_REQ_DYLD)
+#define LC_LOAD_UPWARD_DYLIB        (0x23 | LC_REQ_DYLD)
+#define LC_VERSION_MIN_MACOSX       0x24
+#define LC_VERSION_MIN_IPHONEOS     0x25
+#define LC_FUNCTION_STARTS          0x26
+#define LC_DYLD_ENVIRONMENT         0x27
+#define LC_MAIN                     (0x28 | LC_REQ_DYLD)
+#define LC_DATA_IN_CODE             0x29
+#define LC_SOURCE_VERSION           0x2A
+#define LC_DYLIB_CODE_SIGN_DRS      0x2B
+#define LC_ENCRYPTION_INFO_64       0x2C
+#define LC_LINKER_OPTION            0x2D
+#define LC_LINKER_OPTIMIZATION_HINT 0x2E
+#define LC_VERSION_MIN_TVOS         0x2F
+#define LC_VERSION_MIN_WATCHOS      0x30
+#define LC_NOTE                     0x31
+#define LC_BUILD_VERSION            0x32
+#define LC_DYLD_EXPORTS_TRIE        (0x33 | LC_REQ_DYLD)
+#define LC_DYLD_CHAINED_FIXUPS      (0x34 | LC_REQ_DYLD)
+#define LC_FILESET_ENTRY            (0x35 | LC_REQ_DYLD)
+
+// Строка внутри команды: смещение от начала команды
+union lc_str {
+    uint32_t offset;
+};
+
+struct segment_command {
+    uint32_t cmd;
+    uint32_t cmdsize;
+    char segname[16];
+    uint32_t vmaddr;
+    uint32_t vmsize;
+    uint32_t fileoff;
+    uint32_t filesize;
+    vm_prot_t maxprot;
+    vm_prot_t initprot;
+    uint32_t nsects;
+    uint32_t flags;
+};
+
+struct segment_command_64 {
+    uint32_t cmd;
+    uint32_t cmdsize;
+    char segname[16];
+    uint64_t vmaddr;
+    uint64_t vmsize;
+    uint64_t fileoff;
+    uint64_t filesize;
+    vm_prot_t maxprot;
+    vm_prot_t initprot;
+    uint32_t nsects;
+    uint32_t flags;
+};
+
+struct section {
+    char sectname[16];
+    char segname[16];
+    uint32_t addr;
+    uint32_t size;
+    uint32_t offset;
+    uint32_t align;
+    uint32_t reloff;
+    uint32_t nreloc;
+    uint32_t flags;
+    uint32_t reserved1;
+    uint32_t reserved2;
+};
+
+struct section_64 {
+    char sectname[16];
+    char segname[16];
+    uint64_t addr;
+    uint64_t size;
+    uint32_t offset;
+    uint32_t align;
+    uint32_t reloff;
+    uint32_t nreloc;
+    uint32_t flags;
+    uint32_t reserved1;
+    uint32_t reserved2;
+    uint32_t reserved3;
+};
+
+// Тип и атрибуты секции (поле flags)
+#define SECTION_TYPE                0x000000ff
+#define SECTION_ATTRIBUTES          0xffffff00
+#define S_REGULAR                   0x0
+#define S_ZEROFILL                  0x1
+#define S_CSTRING_LITERALS          0x2
+#define S_NON_LAZY_SYMBOL_POINTERS  0x6
+#define S_LAZY_SYMBOL_POINTERS      0x7
+#define S_SYMBOL_STUBS              0x8
+#define S_MOD_INIT_FUNC_POINTERS    0x9
+#define S_ATTR_PURE_INSTRUCTIONS    0x80000000
+#define S_ATTR_SOME_INSTRUCTIONS    0x00000400
+
+struct dylib {
+    union lc_str name;
+    uint32_t timestamp;
+    uint32_t current_version;
+    uint32_t compatibility_version;
+};
+
+struct dylib_command {
+    uint32_t cmd;
+    uint32_t cmdsize;
+    struct dylib dylib;
+};
+
+struct dylinker_command {
+    uint32_t cmd;
+    uint32_t cmdsize;
+    union lc_str name;
+};
+
+struct symtab_command {
+    uint32_t cmd;
+    uint32_t cmdsize;
+    uint32_t symoff;
+    uint32_t nsyms;
+    uint32_t stroff;
+    uint32_t strsize;
+};
+
+struct dysymtab_command {
+    uint32_t cmd;
+    uint32_t cmdsize;
+    uint32_t ilocalsym;
+    uint32_t nlocalsym;
+    uint32_t iextdefsym;
+    uint32_t nextdefsym;
+    uint32_t iundefsym;
+    uint32_t nundefsym;
+    uint32_t tocoff;
+    uint32_t ntoc;
+    uint32_t modtaboff;
+    uint32_t nmodtab;
+    uint32_t extrefsymoff;
+    uint32_t nextrefsyms;
+    uint32_t indirectsymoff;
+    uint32_t nindirectsyms;
+    uint32_t extreloff;
+    uint32_t nextrel;
+    uint32_t locreloff;
+    uint32_t nlocrel;
+};
+
+struct uuid_command {
+    uint32_t cmd;
+    uint32_t cmdsize;
+    uint8_t uuid[16];
+};
+
+struct rpath_command {
+    uint32_t cmd;
+    uint32_t cmdsize;
+    union lc_str path;
+};
+
+struct linkedit_data_command {
+    uint32_t cmd;
+    uint32_t cmdsize;
+    uint32_t dataoff;
+    uint32_t datasize;
+};
+
+struct encryption_info_command {
+    uint32_t cmd;
+    uint32_t cmdsize;
+    uint32_t cryptoff;
+    uint32_t cryptsize;
+    uint32_t cryptid;
+};
+
+struct encryption_info_command_64 {
+    uint32_t cmd;
+    uint32_t cmdsize;
+    uint32_t cryptoff;
+    uint32_t cryptsize;
+    uint32_t cryptid;
+    uint32_t pad;
+};
+
+struct version_min_command {
+    uint32_t cmd;
+    uint32_t cmdsize;
+    uint32_t version;
+    uint32_t sdk;
+};
+
+struct build_version_command {
+    uint32_t cmd;
+    uint32_t cmdsize;
+    uint32_t platform;
+    uint32_t minos;
+    uint32_t sdk;
+    uint32_t ntools;
+};
+
+struct dyld_info_command {
+    uint32_t cmd;
+    uint32_t cmdsize;
+    uint32_t rebase_off;
+    uint32_t rebase_size;
+    uint32_t bind_off;
+    uint32_t bind_size;
+    uint32_t weak_bind_off;
+    uint32_t weak_bind_size;
+    uint32_t lazy_bind_off;
+    uint32_t lazy_bind_size;
+    uint32_t export_off;
+    uint32_t export_size;
+};
+
+struct linker_option_command {
+    uint32_t cmd;
+    uint32_t cmdsize;
+    uint32_t count;
+};
+
+struct entry_point_command {
+    uint32_t cmd;
+    uint32_t cmdsize;
+    uint64_t entryoff;
+    uint64_t stacksize;
+};
+
+struct source_version_command {
+    uint32_t cmd;
+    uint32_t cmdsize;
+    uint64_t version;
+};
+
+struct note_command {
+    uint32_t cmd;
+    uint32_t cmdsize;
+    char data_owner[16];
+    uint64_t offset;
+    uint64_t size;
+};
+
+// Опкоды привязки LC_DYLD_INFO: старшие 4 бита — опкод, младшие — непосредственное значение
+#define BIND_OPCODE_MASK                             0xF0
+#define BIND_IMMEDIATE_MASK                          0x0F
+#define BIND_OPCODE_DONE                             0x00
+#define BIND_OPCODE_SET_DYLIB_ORDINAL_IMM            0x10
+#define BIND_OPCODE_SET_DYLIB_ORDINAL_ULEB           0x20
+#define BIND_OPCODE_SET_DYLIB_SPECIAL_IMM            0x30
+#define BIND_OPCODE_SET_SYMBOL_TRAILING_FLAGS_IMM    0x40
+#define BIND_OPCODE_SET_TYPE_IMM                     0x50
+#define BIND_OPCODE_SET_ADDEND_SLEB                  0x60
+#define BIND_OPCODE_SET_SEGMENT_AND_OFFSET_ULEB      0x70
+#define BIND_OPCODE_ADD_ADDR_ULEB                    0x80
+#define BIND_OPCODE_DO_BIND                          0x90
+#define BIND_OPCODE_DO_BIND_ADD_ADDR_ULEB            0xA0
+#define BIND_OPCODE_DO_BIND_ADD_ADDR_IMM_SCALED      0xB0
+#define BIND_OPCODE_DO_BIND_ULEB_TIMES_SKIPPING_ULEB 0xC0
+#define BIND_OPCODE_THREADED                         0xD0
+#define BIND_SUBOPCODE_THREADED_SET_BIND_ORDINAL_TABLE_SIZE_ULEB 0x00
+#define BIND_SUBOPCODE_THREADED_APPLY                0x01
+
+#define BIND_SYMBOL_FLAGS_WEAK_IMPORT                0x1
+#define BIND_SYMBOL_FLAGS_NON_WEAK_DEFINITION        0x8
+
+// Особые номера библиотек (ordinal <= 0)
+#define BIND_SPECIAL_DYLIB_SELF             0
+#define BIND_SPECIAL_DYLIB_MAIN_EXECUTABLE  -1
+#define BIND_SPECIAL_DYLIB_FLAT_LOOKUP      -2
+#define BIND_SPECIAL_DYLIB_WEAK_LOOKUP      -3
+
+// Флаги записи дерева экспорта (LC_DYLD_EXPORTS_TRIE и export_off в LC_DYLD_INFO)
+#define EXPORT_SYMBOL_FLAGS_KIND_MASK          0x03
+#define EXPORT_SYMBOL_FLAGS_KIND_REGULAR       0x00
+#define EXPORT_SYMBOL_FLAGS_KIND_THREAD_LOCAL  0x01
+#define EXPORT_SYMBOL_FLAGS_KIND_ABSOLUTE      0x02
+#define EXPORT_SYMBOL_FLAGS_WEAK_DEFINITION    0x04
+#define EXPORT_SYMBOL_FLAGS_REEXPORT           0x08
+#define EXPORT_SYMBOL_FLAGS_STUB_AND_RESOLVER  0x10
+#define EXPORT_SYMBOL_FLAGS_STATIC_RESOLVER    0x20
+
+// ---------------------------------------------------------------------------
+// Цепочки фиксапов LC_DYLD_CHAINED_FIXUPS (mach-o/fixup-chains.h)
+// ---------------------------------------------------------------------------
+
+struct dyld_chained_fixups_header {
+    uint32_t fixups_version;  // 0
+    uint32_t starts_offset;   // Смещение dyld_chained_starts_in_image
+    uint32_t imports_offset;  // Смещение таблицы импортов
+    uint32_t symbols_offset;  // Смещение таблицы имён
+    uint32_t imports_count;   // Количество импортов
+    uint32_t imports_format;  // DYLD_CHAINED_IMPORT*
+    uint32_t symbols_format;  // 0 — без сжатия, 1 — zlib
+};
+
+// Форматы таблицы импортов. Записи — битовые поля, поэтому читаются сдвигами:
+//   DYLD_CHAINED_IMPORT          uint32: lib_ordinal:8, weak_import:1, name_offset:23
+//   DYLD_CHAINED_IMPORT_ADDEND   то же + int32 addend
+//   DYLD_CHAINED_IMPORT_ADDEND64 uint64: lib_ordinal:16, weak_import:1, reserved:15, name_offset:32 + uint64 addend
+#define DYLD_CHAINED_IMPORT          1
+#define DYLD_CHAINED_IMPORT_ADDEND   2
+#define DYLD_CHAINED_IMPORT_ADDEND64 3
+
+// ---------------------------------------------------------------------------
+// Таблица символов (mach-o/nlist.h)
+// ---------------------------------------------------------------------------
+
+struct nlist {
+    union {
+        uint32_t n_strx;
+    } n_un;
+    uint8_t n_type;
+    uint8_t n_sect;
+    int16_t n_desc;
+    uint32_t n_value;
+};
+
+struct nlist_64 {
+    union {
+        uint32_t n_strx;
+    } n_un;
+    uint8_t n_type;
+    uint8_t n_sect;
+    uint16_t n_desc;
+    uint64_t n_value;
+};
+
+// Маски поля n_type
+#define N_STAB  0xe0
+#define N_PEXT  0x10
+#define N_TYPE  0x0e
+#define N_EXT   0x01
+
+// Значения N_TYPE
+#define N_UNDF  0x0
+#define N_ABS   0x2
+#define N_SECT  0xe
+#define N_PBUD  0xc
+#define N_INDR  0xa
+
+#define NO_SECT 0
+
+// ---------------------------------------------------------------------------
+// Универсальные (FAT) файлы (mach-o/fat.h), всегда big-endian
+// ---------------------------------------------------------------------------
+
+#define FAT_MAGIC    0xcafebabe
+#define FAT_CIGAM    0xbebafeca
+#define FAT_MAGIC_64 0xcafebabf
+#define FAT_CIGAM_64 0xbfbafeca
+
+struct fat_header {
+    uint32_t magic;
+    uint32_t nfat_arch;
+};
+
+struct fat_arch {
+    cpu_type_t cputype;
+    cpu_subtype_t cpusubtype;
+    uint32_t offset;
+    uint32_t size;
+    uint32_t align;
+};
+
+struct fat_arch_64 {
+    cpu_type_t cputype;
+    cpu_subtype_t cpusubtype;
+    uint64_t offset;
+    uint64_t size;
+    uint32_t align;
+    uint32_t reserved;
+};
+
+#endif // MACHO_ANALYZER_MACHO_TYPES_H
@@ -0,0 +1,48 @@
+#ifndef MACHO_ANALYZER_PERFECT_HASH_H
+#define MACHO_ANALYZER_PERFECT_HASH_H
+
+#include <stdint.h>
+
+/**
+ * Минимальная совершенная хеш-функция для статических таблиц (схема hash-and-displace).
+ *
+ * Таблицы генерируются при сборке утилитой perfect_hash_gen: для каждой корзины
+ * подбирается seed, при котором все её ключи попадают в разные слоты. Поиск
+ * ключа — один проход по строке, одно обращение к массиву seed и одно к массиву
+ * слотов, после чего остаётся сравнить ключ с найденным элементом.
+ * Эти функции используются и генератором, и кодом поиска, поэтому должны совпадать.
+ */
+
+/**
+ * Хеширует ключ (FNV-1a, 64 бита).
+ */
+static inline uint64_t perfect_hash_key(const char *key) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (const unsigned char *p = (const unsigned char *)key; *p; p++) {
+        hash ^= *p;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/**
+ * Корзина ключа среди count корзин.
+ */
+static inline uint32_t perfect_hash_bucket(uint64_t hash, uint32_t count) {
+    return (uint32_t)(hash >> 32) % count;
+}
+
+/**
+ * Слот ключа среди count слотов при заданном seed корзины.
+ */
+static inline uint32_t perfect_hash_slot(uint64_t hash, uint32_t seed, uint32_t count) {
+    uint32_t x = (uint32_t)hash ^ (seed * 0x9E3779B9u);
+    x ^= x >> 16;
+    x *= 0x85EBCA6Bu;
+    x ^= x >> 13;
+    x *= 0xC2B2AE35u;
+    x ^= x >> 16;
+    return x % count;
+}
+
+#endif // MACHO_ANALYZER_PERFECT_HASH_H
@@ -0,0 +1,79 @@
+#ifndef MACHO_ANALYZER_RESULT_CACHE_H
+#define MACHO_ANALYZER_RESULT_CACHE_H
+
+#include <stdint.h>
+#include "macho_image.h"
+#include "result_store.h"
+
+// Версия анализаторов. Увеличивается при любом изменении, влияющем на результат
+// analyze_mach_o, check_security_features, detect_language_and_compiler или
+// analyze_*, чтобы записи кеша от прежних версий перестали находиться.
+#define RESULT_CACHE_ANALYZER_VERSION 1
+
+/**
+ * Кеш результатов на диске, адресуемый содержимым.
+ *
+ * Ключ — XXH64 байтов архитектуры вместе с её размером; запись — файл
+ * результатов (result_store) ровно с одной архитектурой, без пути. Одинаковые
+ * архитектуры в разных файлах и на разных путях разделяют одну запись.
+ * Записи кладутся во временный файл и переименовываются, поэтому несколько
+ * потоков и процессов могут пользоваться одним каталогом без блокировок.
+ */
+typedef struct {
+    char *directory;        // Корневой каталог кеша
+} ResultCache;
+
+/**
+ * Ключ записи кеша.
+ */
+typedef struct {
+    uint64_t hash;          // XXH64 содержимого архитектуры
+    uint64_t size;          // Размер архитектуры
+} ResultCacheKey;
+
+/**
+ * Открывает кеш, создавая каталог при необходимости.
+ *
+ * @param cache Кеш.
+ * @param directory Каталог кеша.
+ * @return 0 при успехе, -1 в случае ошибки.
+ */
+int result_cache_open(ResultCache *cache, const char *directory);
+
+void result_cache_close(ResultCache *cache);
+
+/**
+ * Вычисляет ключ архитектуры по её байтам в образе.
+ *
+ * @param image Образ файла.
+ * @param arch Архитектура.
+ * @param key Структура для ключа.
+ * @return 0 при успехе, -1 если архитектура выходит за границы образа.
+ */
+int result_cache_key(const MachOImage *image, const MachOArchitecture *arch, ResultCacheKey *key);
+
+/**
+ * Ищет запись в кеше. При успехе reader остаётся открытым и должен быть
+ * закрыт через result_reader_close; view указывает в его отображение.
+ *
+ * @param cache Кеш.
+ * @param key Ключ.
+ * @param reader Читатель для записи.
+ * @param view Запись архитектуры.
+ * @return 1 при попадании, 0 при промахе (в том числе для повреждённой записи).
+ */
+int result_cache_lookup(const ResultCache *cache, const ResultCacheKey *key, ResultReader *reader,
+                        ResultArchView *view);
+
+/**
+ * Сохраняет результат архитектуры. Путь и положение архитектуры в файле не
+ * сохраняются: они берутся у того файла, в котором запись найдена.
+ *
+ * @param cache Кеш.
+ * @param key Ключ.
+ * @param input Результат анализа.
+ * @return 0 при успехе, -1 в случае ошибки.
+ */
+int result_cache_store(const ResultCache *cache, const ResultCacheKey *key, const ResultArchInput *input);
+
+#endif // MACHO_ANALYZER_RESULT_CACHE_H
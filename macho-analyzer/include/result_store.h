@@ -0,0 +1,256 @@
+#ifndef MACHO_ANALYZER_RESULT_STORE_H
+#define MACHO_ANALYZER_RESULT_STORE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "macho_analyzer.h"
+#include "macho_image.h"
+#include "security_check.h"
+#include "security_analyzer.h"
+#include "language_detector.h"
+
+/**
+ * Компактный двоичный формат результатов анализа.
+ *
+ * Файл начинается с заголовка ResultFileHeader, за которым подряд идут записи.
+ * Каждая запись начинается с ResultRecordHeader и выровнена на 8 байт, поэтому
+ * файл можно отобразить в память и читать структуры прямо из отображения.
+ * Строки (пути, имена библиотек и сегментов, язык) хранятся один раз в записях
+ * RESULT_RECORD_STRING и дальше упоминаются по номеру; строка всегда определена
+ * раньше первой ссылки на неё, поэтому файл пишется и читается потоково.
+ * Все числа записываются в порядке байтов хоста (little-endian для всех
+ * поддерживаемых платформ); файл с другим порядком читатель отвергает по magic.
+ */
+
+#define RESULT_FILE_MAGIC   0x52414252u  // "RBAR"
+#define RESULT_FILE_VERSION 2
+
+// Номер строки, означающий её отсутствие
+#define RESULT_NO_STRING 0
+
+// Биты поля ResultArchRecord.security
+#define RESULT_SECURITY_ASLR            (1u << 0)
+#define RESULT_SECURITY_DEP             (1u << 1)
+#define RESULT_SECURITY_STACK_CANARIES  (1u << 2)
+#define RESULT_SECURITY_ENTITLEMENTS    (1u << 3)
+#define RESULT_SECURITY_BITCODE         (1u << 4)
+#define RESULT_SECURITY_CHECKED         (1u << 15)  // Защитные механизмы проверялись
+
+typedef struct {
+    uint32_t magic;             // RESULT_FILE_MAGIC
+    uint16_t version;           // RESULT_FILE_VERSION
+    uint16_t header_size;       // sizeof(ResultFileHeader)
+    uint64_t reserved;
+} ResultFileHeader;
+
+typedef enum {
+    RESULT_RECORD_STRING = 1,   // Определение строки
+    RESULT_RECORD_ARCH = 2      // Результат анализа одной архитектуры
+} ResultRecordType;
+
+typedef struct {
+    uint32_t size;              // Размер записи вместе с заголовком и выравниванием
+    uint16_t type;              // ResultRecordType
+    uint16_t reserved;
+} ResultRecordHeader;
+
+/**
+ * Тело записи RESULT_RECORD_STRING; за ним следуют length байт строки и нулевой байт.
+ */
+typedef struct {
+    uint32_t id;                // Номер строки (с 1, по порядку определения)
+    uint32_t length;            // Длина без завершающего нуля
+} ResultStringRecord;
+
+/**
+ * Тело записи RESULT_RECORD_ARCH; за ним подряд следуют массивы
+ * ResultSegment[segment_count], ResultDylib[dylib_count], ResultFinding[finding_count]
+ * и номера строк библиотек песочницы uint32_t[min(sandbox_count, SECURITY_MAX_SANDBOX_DYLIBS)].
+ */
+typedef struct {
+    uint32_t path;              // Строка: путь к файлу
+    uint32_t arch_index;        // Номер архитектуры в файле
+    int32_t cpu_type;
+    int32_t cpu_subtype;
+    uint64_t offset;            // Положение архитектуры в файле
+    uint64_t size;
+    uint32_t file_type;
+    uint32_t flags;             // Флаги заголовка Mach-O
+    uint32_t language;          // Строка: язык или RESULT_NO_STRING
+    uint32_t compiler;          // Строка: компилятор или RESULT_NO_STRING
+    uint32_t sandbox_count;     // Найдено библиотек песочницы (SecurityFeatures.sandbox_dylib_count)
+    uint16_t security;          // Биты RESULT_SECURITY_*
+    uint8_t is_64_bit;
+    uint8_t reserved;
+    uint32_t segment_count;
+    uint32_t dylib_count;
+    uint32_t finding_count;
+    uint32_t load_command_count;
+} ResultArchRecord;
+
+typedef struct {
+    uint32_t name;              // Строка: имя сегмента
+    uint32_t maxprot;
+    uint32_t initprot;
+    uint32_t nsects;
+    uint64_t vmaddr;
+    uint64_t vmsize;
+    uint64_t fileoff;
+    uint64_t filesize;
+} ResultSegment;
+
+typedef struct {
+    uint32_t name;              // Строка: путь библиотеки
+    uint32_t timestamp;
+    uint32_t current_version;
+    uint32_t compatibility_version;
+} ResultDylib;
+
+typedef struct {
+    uint32_t kind;              // SecurityFindingKind
+    uint32_t name;              // Строка: имя функции или секции
+} ResultFinding;
+
+/**
+ * Данные одной архитектуры для записи. Поля security, language и findings
+ * необязательны (NULL — не проверялись).
+ */
+typedef struct {
+    const char *path;
+    uint32_t arch_index;
+    const MachOArchitecture *arch;      // Положение архитектуры или NULL (тонкий файл целиком)
+    const MachOFile *mach_o_file;
+    const SecurityFeatures *security;
+    const LanguageInfo *language;
+    const SecurityFindings *findings;
+} ResultArchInput;
+
+/**
+ * Писатель файла результатов. Повторяющиеся строки (например,
+ * /usr/lib/libSystem.B.dylib) записываются один раз на весь файл.
+ */
+typedef struct {
+    FILE *out;
+    struct HashTable *strings;  // Строка -> номер
+    uint32_t string_count;
+    uint8_t *scratch;           // Буфер сборки записи
+    size_t scratch_capacity;
+    uint64_t record_count;      // Записано записей архитектур
+    bool error;
+} ResultWriter;
+
+/**
+ * Начинает файл результатов: пишет заголовок в поток.
+ *
+ * @param writer Писатель.
+ * @param out Поток, открытый на запись в двоичном режиме.
+ * @return 0 при успехе, -1 в случае ошибки.
+ */
+int result_writer_open(ResultWriter *writer, FILE *out);
+
+/**
+ * Дописывает запись архитектуры и определения её новых строк.
+ *
+ * @param writer Писатель.
+ * @param input Данные архитектуры.
+ * @return 0 при успехе, -1 в случае ошибки.
+ */
+int result_writer_add(ResultWriter *writer, const ResultArchInput *input);
+
+/**
+ * Сбрасывает поток и освобождает писатель. Поток не закрывается.
+ *
+ * @return 0 при успехе, -1 если при записи была ошибка.
+ */
+int result_writer_close(ResultWriter *writer);
+
+/**
+ * Читатель файла результатов. Файл отображается в память; все указатели,
+ * которые возвращает читатель, ссылаются прямо в отображение и действительны
+ * до result_reader_close.
+ */
+typedef struct {
+    MachOImage image;
+    const char **strings;       // Номер строки -> указатель в отображение (индекс 0 не используется)
+    uint32_t string_count;
+    uint64_t arch_count;        // Записей архитектур в файле
+    uint64_t position;          // Смещение следующей записи для result_reader_next
+} ResultReader;
+
+/**
+ * Архитектура, прочитанная из файла результатов.
+ */
+typedef struct {
+    const ResultArchRecord *arch;
+    const ResultSegment *segments;
+    const ResultDylib *dylibs;
+    const ResultFinding *findings;
+    const uint32_t *sandbox_dylibs;  // Номера строк библиотек песочницы
+} ResultArchView;
+
+/**
+ * Копирует запись архитектуры из другого файла результатов (например, из кеша),
+ * заменяя путь и положение архитектуры; строки переводятся в номера этого файла.
+ *
+ * @param writer Писатель.
+ * @param reader Читатель, из которого взята запись.
+ * @param view Запись архитектуры.
+ * @param path Путь к файлу.
+ * @param arch_index Номер архитектуры в файле.
+ * @param arch Положение архитектуры или NULL (оставить как в записи).
+ * @return 0 при успехе, -1 в случае ошибки.
+ */
+int result_writer_add_view(ResultWriter *writer, const ResultReader *reader, const ResultArchView *view,
+                           const char *path, uint32_t arch_index, const MachOArchitecture *arch);
+
+/**
+ * Открывает файл результатов, проверяет его структуру и строит индекс строк.
+ *
+ * @param path Путь к файлу.
+ * @param reader Читатель.
+ * @return 0 при успехе, -1 в случае ошибки.
+ */
+int result_reader_open(const char *path, ResultReader *reader);
+
+/**
+ * Открывает результаты из буфера в памяти (буфер должен жить дольше читателя).
+ *
+ * @return 0 при успехе, -1 в случае ошибки.
+ */
+int result_reader_from_memory(const void *data, uint64_t size, ResultReader *reader);
+
+/**
+ * Возвращает следующую запись архитектуры.
+ *
+ * @param reader Читатель.
+ * @param view Структура для результата.
+ * @return 1, если запись прочитана, 0 в конце файла.
+ */
+int result_reader_next(ResultReader *reader, ResultArchView *view);
+
+/**
+ * Возвращает к началу файла для повторного прохода.
+ */
+void result_reader_rewind(ResultReader *reader);
+
+/**
+ * Возвращает строку по номеру.
+ *
+ * @return Строка или NULL для RESULT_NO_STRING и неизвестных номеров.
+ */
+const char *result_reader_string(const ResultReader *reader, uint32_t id);
+
+/**
+ * Восстанавливает SecurityFeatures из записи архитектуры.
+ *
+ * @param reader Читатель (для имён библиотек песочницы).
+ * @param view Запись архитектуры.
+ * @param features Структура для результата; имена указывают в отображение читателя.
+ * @return true, если защитные механизмы проверялись при записи.
+ */
+bool result_security_features(const ResultReader *reader, const ResultArchView *view, SecurityFeatures *features);
+
+void result_reader_close(ResultReader *reader);
+
+#endif // MACHO_ANALYZER_RESULT_STORE_H
@@ -0,0 +1,85 @@
+#ifndef MACHO_ANALYZER_SCAN_MANIFEST_H
+#define MACHO_ANALYZER_SCAN_MANIFEST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define SCAN_MANIFEST_MAGIC   0x464D4252u  // "RBMF"
+#define SCAN_MANIFEST_VERSION 1
+
+/**
+ * Сведения об одном файле из прошлого прохода.
+ */
+typedef struct {
+    char *path;
+    uint64_t size;
+    int64_t mtime_sec;          // Время изменения, секунды
+    uint32_t mtime_nsec;        // и наносекунды
+    uint64_t inode;
+    bool is_macho;              // Файл был Mach-O или FAT
+    uint32_t arch_count;        // Количество архитектур (0 для остальных файлов)
+    uint64_t *hashes;           // XXH64 каждой архитектуры
+    bool seen;                  // Файл встретился в текущем проходе
+} ScanManifestEntry;
+
+struct HashTable;
+
+/**
+ * Манифест пакетного прохода: путь -> размер, mtime, inode и хеши архитектур.
+ *
+ * Манифест прошлого прохода позволяет не открывать файлы, у которых совпали
+ * размер, mtime и inode, а для остальных по хешам архитектур отличить
+ * действительно изменённые бинарники от файлов, которых только коснулись.
+ * В манифест попадают все просмотренные обычные файлы, а не только Mach-O:
+ * иначе каждый повторный проход заново открывал бы всё остальное содержимое дерева.
+ */
+typedef struct {
+    ScanManifestEntry *entries;
+    size_t count;
+    size_t capacity;
+    struct HashTable *index;    // Путь -> номер записи + 1
+} ScanManifest;
+
+/**
+ * Создаёт пустой манифест.
+ *
+ * @return 0 при успехе, -1 в случае ошибки.
+ */
+int scan_manifest_init(ScanManifest *manifest);
+
+/**
+ * Загружает манифест из файла. Отсутствующий файл даёт пустой манифест
+ * (первый проход).
+ *
+ * @param manifest Неинициализированный манифест.
+ * @param path Путь к файлу манифеста.
+ * @return 0 при успехе, -1 если файл повреждён или не читается.
+ */
+int scan_manifest_load(ScanManifest *manifest, const char *path);
+
+/**
+ * Сохраняет манифест: запись идёт во временный файл, который затем
+ * переименовывается, поэтому прерванный проход не портит прежний манифест.
+ *
+ * @return 0 при успехе, -1 в случае ошибки.
+ */
+int scan_manifest_save(const ScanManifest *manifest, const char *path);
+
+/**
+ * Добавляет запись (путь и хеши копируются). Повторный путь заменяет прежнюю запись.
+ *
+ * @return 0 при успехе, -1 в случае ошибки.
+ */
+int scan_manifest_add(ScanManifest *manifest, const ScanManifestEntry *entry);
+
+/**
+ * Ищет запись по пути.
+ *
+ * @return Запись или NULL.
+ */
+ScanManifestEntry *scan_manifest_find(const ScanManifest *manifest, const char *path);
+
+void scan_manifest_free(ScanManifest *manifest);
+
+#endif // MACHO_ANALYZER_SCAN_MANIFEST_H
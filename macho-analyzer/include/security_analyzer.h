@@ -2,7 +2,6 @@
 #define SECURITY_ANALYZER_H
 
 #include "macho_analyzer.h"
-#include "../../libs/hash_table/hash_table.h"
 
 /**
  * Структура, содержащая информацию о небезопасной функции.
@@ -20,26 +19,71 @@ typedef struct {
 extern const UnsafeFunctionInfo unsafe_functions[];
 
 /**
- * Инициализирует таблицу небезопасных функций.
+ * Ищет небезопасную функцию по имени (без префикса '_').
  *
- * Функция создает и заполняет хеш-таблицу известными небезопасными функциями для использования в анализе.
+ * Поиск — одно обращение к таблице с совершенной хеш-функцией, построенной при сборке;
+ * инициализация и освобождение памяти не требуются.
  *
- * @return Указатель на созданную хеш-таблицу или NULL в случае ошибки.
+ * @param name Имя функции.
+ * @return Указатель на информацию о функции или NULL, если функция не из списка.
  */
-HashTable *initialize_unsafe_function_table();
+const UnsafeFunctionInfo *find_unsafe_function(const char *name);
+
+/**
+ * Вид находки анализа безопасности.
+ */
+typedef enum {
+    SECURITY_FINDING_UNSAFE_FUNCTION,   // Импорт или определение небезопасной функции
+    SECURITY_FINDING_WRITABLE_CODE,     // Секция с правами на запись и выполнение
+    SECURITY_FINDING_DEBUG_SYMBOLS      // Секция с отладочной информацией
+} SecurityFindingKind;
+
+/**
+ * Одна находка анализа безопасности.
+ */
+typedef struct {
+    SecurityFindingKind kind;
+    const UnsafeFunctionInfo *function; // Для SECURITY_FINDING_UNSAFE_FUNCTION, иначе NULL
+    char section[17];                   // Имя секции для находок в секциях, иначе пустая строка
+} SecurityFinding;
+
+/**
+ * Список находок. Функции analyze_* только дописывают в него, поэтому один список
+ * можно заполнить несколькими проверками подряд.
+ */
+typedef struct {
+    SecurityFinding *items;
+    size_t count;
+    size_t capacity;
+} SecurityFindings;
+
+/**
+ * Освобождает память списка находок и обнуляет его.
+ *
+ * @param findings Список находок.
+ */
+void security_findings_free(SecurityFindings *findings);
+
+/**
+ * Возвращает количество находок указанного вида.
+ */
+size_t security_findings_count(const SecurityFindings *findings, SecurityFindingKind kind);
 
 /**
  * Анализирует символы в Mach-O файле на использование небезопасных функций.
  *
- * Функция проверяет таблицу символов в Mach-O файле на наличие известных небезопасных функций,
- * которые могут представлять угрозу безопасности (например, strcpy, sprintf и другие).
+ * Функция проверяет импорты Mach-O файла (см. macho_get_import_table) на наличие известных
+ * небезопасных функций, которые могут представлять угрозу безопасности (например, strcpy,
+ * sprintf и другие). Если импорты не описаны опкодами привязки или цепочками фиксапов,
+ * проверяется таблица символов.
+ * Все функции analyze_* ничего не выводят и не используют общего состояния; результат
+ * выводится через print_security_findings.
  *
  * @param mach_o_file Указатель на структуру MachOFile, содержащую информацию о командах загрузки.
- * @param file Указатель на открытый файл Mach-O для чтения таблицы символов.
- * @param unsafe_function_table Указатель на хеш-таблицу небезопасных функций.
+ * @param findings Список, в который дописываются находки.
  * @return 0 при успехе, -1 в случае ошибки.
  */
-int analyze_unsafe_functions(const MachOFile *mach_o_file, FILE *file, HashTable *unsafe_function_table);
+int analyze_unsafe_functions(const MachOFile *mach_o_file, SecurityFindings *findings);
 
 /**
  * Анализирует секции в Mach-O файле на наличие прав на запись и исполнение одновременно.
@@ -48,10 +92,10 @@ int analyze_unsafe_functions(const MachOFile *mach_o_file, FILE *file, HashTable
  * что является потенциально небезопасной конфигурацией и может привести к уязвимостям.
  *
  * @param mach_o_file Указатель на структуру MachOFile, содержащую информацию о командах загрузки и секциях.
- * @param file Указатель на открытый файл Mach-O для чтения данных секций.
+ * @param findings Список, в который дописываются находки.
  * @return 0 при успехе, -1 в случае ошибки.
  */
-int analyze_section_permissions(const MachOFile *mach_o_file, FILE *file);
+int analyze_section_permissions(const MachOFile *mach_o_file, SecurityFindings *findings);
 
 /**
  * Анализирует секции Mach-O файла на наличие отладочных символов.
@@ -60,9 +104,9 @@ int analyze_section_permissions(const MachOFile *mach_o_file, FILE *file);
  * которые могут содержать информацию, используемую для отладки и потенциально раскрывающую внутреннюю структуру программы.
  *
  * @param mach_o_file Указатель на структуру MachOFile, содержащую информацию о командах загрузки и секциях.
- * @param file Указатель на открытый файл Mach-O для чтения данных секций.
+ * @param findings Список, в который дописываются находки.
  * @return 0 при успехе, -1 в случае ошибки.
  */
-int analyze_debug_symbols(const MachOFile *mach_o_file, FILE *file);
+int analyze_debug_symbols(const MachOFile *mach_o_file, SecurityFindings *findings);
 
 #endif // SECURITY_ANALYZER_H
\ No newline at end of file
@@ -2,13 +2,62 @@
 #define MACHO_ANALYZER_SECURITY_CHECK_H
 
 #include "macho_analyzer.h"
+#include "command_visitor.h"
+#include "import_table.h"
 #include <stdbool.h>
 
+// Сколько библиотек песочницы сохраняется в SecurityFeatures
+#define SECURITY_MAX_SANDBOX_DYLIBS 8
+
+/**
+ * Результат проверки защитных механизмов Mach-O файла.
+ */
+typedef struct {
+    bool aslr;                  // Установлен флаг MH_PIE
+    bool dep;                   // Установлен флаг MH_NO_HEAP_EXECUTION
+    bool stack_canaries;        // Есть __stack_chk_fail и __stack_chk_guard
+    const char *sandbox_dylibs[SECURITY_MAX_SANDBOX_DYLIBS];  // Библиотеки песочницы в порядке команд (указывают в образ)
+    uint32_t sandbox_dylib_count;  // Найдено библиотек песочницы; сохранены первые SECURITY_MAX_SANDBOX_DYLIBS
+    bool entitlements;          // Есть секция __TEXT,__entitlements
+    bool bitcode;               // Есть команда LC_DATA_IN_CODE
+} SecurityFeatures;
+
+/**
+ * Состояние проверки защитных механизмов на время обхода команд.
+ */
+typedef struct {
+    SecurityFeatures *features;
+    const struct symtab_command *symtab;  // Найденная LC_SYMTAB или NULL
+    MachOImportCommands imports;          // Найденные команды привязки
+} SecurityCheck;
+
 /**
  * Проверяет наличие защитных механизмов в Mach-O файле.
+ * Функция ничего не выводит и не использует общего состояния, поэтому её можно
+ * вызывать из нескольких потоков для разных файлов; для вывода результата
+ * используется print_security_features.
+ *
+ * @param mach_o_file Указатель на структуру MachOFile.
+ * @param features Структура для результата.
+ * @return 0 при успехе, -1 в случае ошибки.
+ */
+int check_security_features(const MachOFile *mach_o_file, SecurityFeatures *features);
+
+/**
+ * Заполняет проверки, не требующие команд (флаги заголовка, секции), и подписывает
+ * на visitor проверки песочницы (LC_LOAD_DYLIB), Bitcode (LC_DATA_IN_CODE) и поиск
+ * команд для Stack Canaries (LC_DYLD_INFO(_ONLY), LC_DYLD_CHAINED_FIXUPS, LC_SYMTAB).
+ * Импорты или символы декодируются в завершении по найденным командам, поэтому
+ * все проверки выполняются за один проход вместе с другими подписчиками.
+ * Результат готов после macho_visitor_run.
  *
+ * @param visitor Набор подписок.
+ * @param check Состояние проверки; должно жить до окончания обхода.
  * @param mach_o_file Указатель на структуру MachOFile.
+ * @param features Структура для результата; должна жить до окончания обхода.
+ * @return 0 при успехе, -1 в случае ошибки.
  */
-void check_security_features(const MachOFile *mach_o_file, FILE *file);
+int security_check_subscribe(MachOCommandVisitor *visitor, SecurityCheck *check, const MachOFile *mach_o_file,
+                             SecurityFeatures *features);
 
 #endif //MACHO_ANALYZER_SECURITY_CHECK_H
@@ -0,0 +1,73 @@
+#ifndef MACHO_ANALYZER_SHA_DIGEST_H
+#define MACHO_ANALYZER_SHA_DIGEST_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define SHA1_DIGEST_LENGTH   20
+#define SHA256_DIGEST_LENGTH 32
+#define SHA_BLOCK_SIZE       64
+
+/**
+ * SHA-1 и SHA-256 для хешей подписи кода, без зависимости от CommonCrypto.
+ *
+ * Сжатие блоков выбирается один раз при первом вызове по CPUID: на x86-64
+ * с расширением SHA (SHA-NI) используются инструкции sha1rnds4/sha256rnds2,
+ * иначе — переносимая скалярная реализация. Результат не зависит от выбора.
+ */
+
+/**
+ * Реализация сжатия блоков.
+ */
+typedef enum {
+    SHA_IMPLEMENTATION_SCALAR,  // Переносимая реализация на C
+    SHA_IMPLEMENTATION_SHA_NI   // Инструкции Intel SHA Extensions
+} ShaImplementation;
+
+typedef struct {
+    uint32_t state[5];
+    uint64_t length;            // Обработано байт
+    uint8_t buffer[SHA_BLOCK_SIZE];
+    size_t buffered;
+} Sha1Context;
+
+typedef struct {
+    uint32_t state[8];
+    uint64_t length;            // Обработано байт
+    uint8_t buffer[SHA_BLOCK_SIZE];
+    size_t buffered;
+} Sha256Context;
+
+void sha1_init(Sha1Context *context);
+void sha1_update(Sha1Context *context, const void *data, size_t size);
+void sha1_final(Sha1Context *context, uint8_t digest[SHA1_DIGEST_LENGTH]);
+
+void sha256_init(Sha256Context *context);
+void sha256_update(Sha256Context *context, const void *data, size_t size);
+void sha256_final(Sha256Context *context, uint8_t digest[SHA256_DIGEST_LENGTH]);
+
+/**
+ * Вычисляет SHA-1 буфера целиком.
+ */
+void sha1(const void *data, size_t size, uint8_t digest[SHA1_DIGEST_LENGTH]);
+
+/**
+ * Вычисляет SHA-256 буфера целиком.
+ */
+void sha256(const void *data, size_t size, uint8_t digest[SHA256_DIGEST_LENGTH]);
+
+/**
+ * Возвращает реализацию, выбранную для этого процессора.
+ */
+ShaImplementation sha_implementation(void);
+
+/**
+ * Принудительно выбирает реализацию (для тестов и сравнения скорости).
+ * Не потокобезопасна: вызывается до начала хеширования.
+ *
+ * @return true, если реализация поддерживается процессором.
+ */
+bool sha_select_implementation(ShaImplementation implementation);
+
+#endif // MACHO_ANALYZER_SHA_DIGEST_H
@@ -0,0 +1,87 @@
+#ifndef MACHO_ANALYZER_SIGNATURE_SCANNER_H
+#define MACHO_ANALYZER_SIGNATURE_SCANNER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Реализация поиска, выбранная для сканера.
+ */
+typedef enum {
+    SIGNATURE_SCAN_SCALAR,  // Переносимый побайтовый поиск
+    SIGNATURE_SCAN_SSE2,    // 16 байт за шаг
+    SIGNATURE_SCAN_AVX2     // 32 байта за шаг
+} SignatureScanImpl;
+
+/**
+ * Поиск нескольких сигнатур в произвольных байтах за один проход.
+ *
+ * Сигнатуры группируются по первым двум байтам. Векторная реализация сравнивает
+ * блок данных и тот же блок со сдвигом на байт со всеми различными парами сразу,
+ * и только позиции, где пара совпала, проверяются memcmp. Нулевые байты не
+ * прерывают поиск, поэтому просматриваются все строки секции, а не только первая.
+ * Лучшая доступная реализация (AVX2, SSE2 или скалярная) выбирается при создании
+ * сканера по возможностям процессора.
+ */
+typedef struct SignatureScanner SignatureScanner;
+
+/**
+ * Обработчик найденной сигнатуры.
+ *
+ * @param signature_id Индекс сигнатуры в массиве, переданном при создании.
+ * @param offset Смещение начала совпадения от начала данных.
+ * @param context Пользовательский контекст.
+ * @return 0 для продолжения поиска, любое другое значение останавливает его.
+ */
+typedef int (*SignatureHitCallback)(uint32_t signature_id, uint64_t offset, void *context);
+
+/**
+ * Создаёт сканер для набора сигнатур.
+ * Строки не копируются и должны жить не меньше сканера.
+ *
+ * @param needles Массив непустых сигнатур.
+ * @param count Количество сигнатур.
+ * @return Указатель на сканер или NULL в случае ошибки.
+ */
+SignatureScanner *signature_scanner_create(const char *const *needles, size_t count);
+
+/**
+ * Уничтожает сканер.
+ *
+ * @param scanner Сканер.
+ */
+void signature_scanner_destroy(SignatureScanner *scanner);
+
+/**
+ * Ищет все вхождения всех сигнатур.
+ * Совпадения сообщаются в порядке возрастания смещения, при равных смещениях —
+ * в порядке индексов сигнатур. Перекрывающиеся вхождения сообщаются все.
+ *
+ * @param scanner Сканер.
+ * @param data Данные.
+ * @param size Размер данных.
+ * @param callback Обработчик совпадений.
+ * @param context Контекст для обработчика.
+ * @return Количество сообщённых совпадений или -1 в случае ошибки.
+ */
+int64_t signature_scanner_scan(const SignatureScanner *scanner, const void *data, uint64_t size,
+                               SignatureHitCallback callback, void *context);
+
+/**
+ * Возвращает реализацию, которой пользуется сканер.
+ */
+SignatureScanImpl signature_scanner_impl(const SignatureScanner *scanner);
+
+/**
+ * Переключает сканер на указанную реализацию (например, для сравнения результатов).
+ *
+ * @return 0 при успехе, -1 если реализация не поддерживается процессором или набором сигнатур.
+ */
+int signature_scanner_set_impl(SignatureScanner *scanner, SignatureScanImpl impl);
+
+/**
+ * Возвращает имя реализации для вывода.
+ */
+const char *signature_scan_impl_name(SignatureScanImpl impl);
+
+#endif // MACHO_ANALYZER_SIGNATURE_SCANNER_H
@@ -0,0 +1,100 @@
+#ifndef MACHO_ANALYZER_SYMBOL_CLASSIFIER_H
+#define MACHO_ANALYZER_SYMBOL_CLASSIFIER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Максимальное число различных языков в одном классификаторе
+#define SYMBOL_CLASSIFIER_MAX_LANGUAGES 64
+
+/**
+ * Сопоставление префикса имени символа языку и компилятору.
+ */
+typedef struct {
+    const char *prefix;
+    const char *language;
+    const char *compiler;
+} SymbolMapping;
+
+/**
+ * Классификатор символов по префиксам.
+ *
+ * Все префиксы компилируются в один префиксный автомат (trie) с таблицей переходов
+ * по классам байтов. Классификация символа — один проход по его байтам, который
+ * обрывается на первом байте, не продолжающем ни один префикс, поэтому суммарная
+ * стоимость линейна по размеру таблицы строк и не зависит от числа префиксов.
+ */
+typedef struct SymbolClassifier SymbolClassifier;
+
+/**
+ * Создаёт классификатор и заполняет его сопоставлениями.
+ *
+ * @param mappings Массив сопоставлений (может быть NULL, если count == 0).
+ * @param count Количество сопоставлений.
+ * @return Указатель на классификатор или NULL в случае ошибки.
+ */
+SymbolClassifier *symbol_classifier_create(const SymbolMapping *mappings, size_t count);
+
+/**
+ * Уничтожает классификатор.
+ *
+ * @param classifier Классификатор.
+ */
+void symbol_classifier_destroy(SymbolClassifier *classifier);
+
+/**
+ * Добавляет префикс в классификатор во время выполнения.
+ * Строки не копируются и должны жить не меньше классификатора.
+ * Классификатор нельзя расширять, пока им пользуются другие потоки.
+ *
+ * @param classifier Классификатор.
+ * @param mapping Сопоставление (префикс не должен быть пустым).
+ * @return Идентификатор префикса (>= 0) или -1 в случае ошибки.
+ */
+int symbol_classifier_add(SymbolClassifier *classifier, const SymbolMapping *mapping);
+
+/**
+ * Находит все префиксы, с которых начинается имя символа.
+ * Идентификаторы выдаются в порядке возрастания длины префикса.
+ *
+ * @param classifier Классификатор.
+ * @param name Имя символа.
+ * @param ids Массив для идентификаторов найденных префиксов (может быть NULL).
+ * @param max_ids Размер массива ids.
+ * @return Общее количество совпавших префиксов (может превышать max_ids).
+ */
+size_t symbol_classifier_match(const SymbolClassifier *classifier, const char *name, uint32_t *ids, size_t max_ids);
+
+/**
+ * Учитывает символ в счётчиках языков: каждый язык, префикс которого совпал,
+ * получает +1 (не более одного раза на символ).
+ *
+ * @param classifier Классификатор.
+ * @param name Имя символа.
+ * @param counts Массив счётчиков размера symbol_classifier_language_count().
+ * @return Битовая маска совпавших языков (0, если совпадений нет).
+ */
+uint64_t symbol_classifier_tally(const SymbolClassifier *classifier, const char *name, uint32_t *counts);
+
+/**
+ * Возвращает сопоставление по идентификатору префикса.
+ */
+const SymbolMapping *symbol_classifier_mapping(const SymbolClassifier *classifier, uint32_t id);
+
+/**
+ * Возвращает количество различных языков в классификаторе.
+ */
+size_t symbol_classifier_language_count(const SymbolClassifier *classifier);
+
+/**
+ * Возвращает имя языка по его идентификатору.
+ */
+const char *symbol_classifier_language(const SymbolClassifier *classifier, uint32_t language_id);
+
+/**
+ * Возвращает идентификатор языка для префикса.
+ */
+uint32_t symbol_classifier_language_of(const SymbolClassifier *classifier, uint32_t id);
+
+#endif // MACHO_ANALYZER_SYMBOL_CLASSIFIER_H
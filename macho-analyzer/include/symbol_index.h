@@ -0,0 +1,71 @@
+#ifndef MACHO_ANALYZER_SYMBOL_INDEX_H
+#define MACHO_ANALYZER_SYMBOL_INDEX_H
+
+#include "macho_analyzer.h"
+#include "command_visitor.h"
+
+/**
+ * Декодированная запись таблицы символов (nlist / nlist_64).
+ */
+typedef struct {
+    const char *name;  // Имя символа (указывает в таблицу строк образа, "" для некорректных индексов)
+    uint64_t n_value;  // Значение символа (обычно адрес)
+    uint16_t n_desc;   // Дополнительная информация (ordinal библиотеки, weak и т.д.)
+    uint8_t n_type;    // Тип символа
+    uint8_t n_sect;    // Номер секции (1..255) или NO_SECT
+    bool is_undefined; // Символ импортируется из другого образа
+    bool is_external;  // Символ видим вне образа (N_EXT)
+} MachOSymbol;
+
+/**
+ * Индекс таблицы символов Mach-O файла.
+ * Записи идут в том же порядке, что и в LC_SYMTAB.
+ */
+typedef struct MachOSymbolIndex {
+    MachOSymbol *symbols; // Массив символов
+    uint32_t count;       // Количество символов
+} MachOSymbolIndex;
+
+/**
+ * Возвращает индекс таблицы символов, строя его при первом обращении.
+ *
+ * LC_SYMTAB разбирается один раз на MachOFile, после чего все проходы (стековые канарейки,
+ * небезопасные функции, определение языка) используют один и тот же индекс.
+ * Индекс кэшируется внутри mach_o_file и освобождается в free_mach_o_file.
+ * Функцию можно вызывать из нескольких потоков для одного MachOFile: кеш
+ * публикуется атомарно, а ошибка построения запоминается и повторно не выводится.
+ *
+ * @param mach_o_file Указатель на структуру MachOFile.
+ * @return Указатель на индекс (возможно, пустой, если таблицы символов нет) или NULL в случае ошибки.
+ */
+const MachOSymbolIndex *macho_get_symbol_index(const MachOFile *mach_o_file);
+
+/**
+ * Подписывает поиск LC_SYMTAB на visitor, чтобы индекс можно было построить
+ * после общего прохода без отдельного обхода команд.
+ *
+ * @param visitor Набор подписок.
+ * @param symtab Найденная команда или NULL; должна жить до окончания обхода.
+ * @return 0 при успехе, -1 в случае ошибки.
+ */
+int macho_symtab_subscribe(MachOCommandVisitor *visitor, const struct symtab_command **symtab);
+
+/**
+ * То же, что macho_get_symbol_index, но по команде, уже найденной при обходе
+ * (см. macho_symtab_subscribe). Кеш общий с macho_get_symbol_index.
+ *
+ * @param mach_o_file Указатель на структуру MachOFile.
+ * @param symtab Команда LC_SYMTAB или NULL, если её нет.
+ * @return Указатель на индекс или NULL в случае ошибки.
+ */
+const MachOSymbolIndex *macho_get_symbol_index_from(const MachOFile *mach_o_file,
+                                                     const struct symtab_command *symtab);
+
+/**
+ * Освобождает индекс таблицы символов.
+ *
+ * @param index Индекс, созданный macho_get_symbol_index.
+ */
+void macho_symbol_index_free(MachOSymbolIndex *index);
+
+#endif // MACHO_ANALYZER_SYMBOL_INDEX_H
@@ -0,0 +1,67 @@
+#ifndef MACHO_ANALYZER_THREAD_POOL_H
+#define MACHO_ANALYZER_THREAD_POOL_H
+
+#include <stddef.h>
+
+/**
+ * Пул из фиксированного числа рабочих потоков с ограниченной очередью задач.
+ *
+ * Очередь ограничена, поэтому thread_pool_submit блокируется, пока рабочие не
+ * разберут задачи: производитель (например, обход каталога) не накапливает в
+ * памяти десятки тысяч задач впереди анализа.
+ */
+typedef struct ThreadPool ThreadPool;
+
+/**
+ * Задача пула.
+ *
+ * @param arg Аргумент, переданный в thread_pool_submit.
+ * @param worker Номер рабочего потока (0 .. thread_pool_size - 1); позволяет
+ *               задачам пользоваться состоянием, закреплённым за потоком.
+ */
+typedef void (*ThreadPoolTask)(void *arg, size_t worker);
+
+/**
+ * Создаёт пул и запускает рабочие потоки.
+ *
+ * @param workers Количество потоков (0 — по числу доступных процессоров).
+ * @param queue_capacity Ёмкость очереди (0 — по четыре задачи на поток).
+ * @return Указатель на пул или NULL в случае ошибки.
+ */
+ThreadPool *thread_pool_create(size_t workers, size_t queue_capacity);
+
+/**
+ * Ставит задачу в очередь. Если очередь заполнена, ждёт освобождения места.
+ *
+ * @param pool Пул.
+ * @param task Функция задачи.
+ * @param arg Аргумент задачи.
+ * @return 0 при успехе, -1 если пул уже останавливается или аргументы неверны.
+ */
+int thread_pool_submit(ThreadPool *pool, ThreadPoolTask task, void *arg);
+
+/**
+ * Ждёт, пока очередь опустеет и все начатые задачи завершатся.
+ *
+ * @param pool Пул.
+ */
+void thread_pool_wait(ThreadPool *pool);
+
+/**
+ * Выполняет оставшиеся задачи, останавливает потоки и освобождает пул.
+ *
+ * @param pool Пул.
+ */
+void thread_pool_destroy(ThreadPool *pool);
+
+/**
+ * Возвращает количество рабочих потоков пула.
+ */
+size_t thread_pool_size(const ThreadPool *pool);
+
+/**
+ * Возвращает число доступных процессоров (не меньше 1).
+ */
+size_t thread_pool_cpu_count(void);
+
+#endif // MACHO_ANALYZER_THREAD_POOL_H
@@ -0,0 +1,710 @@
+#include "batch_scanner.h"
+#include "thread_pool.h"
+#include "macho_types.h"
+#include "macho_endian.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#ifdef __APPLE__
+#define STAT_MTIME(st) ((st)->st_mtimespec)
+#else
+#define STAT_MTIME(st) ((st)->st_mtim)
+#endif
+
+// Начальная ёмкость буферов архитектур рабочего потока
+#define BATCH_INITIAL_ARCHS 4
+
+/**
+ * Состояние, закреплённое за рабочим потоком: буферы архитектур и записей
+ * одного файла переиспользуются от файла к файлу и растут только под FAT-файл
+ * с большим числом архитектур, чем встречалось этому потоку раньше.
+ * Разобранные архитектуры живут до того, как их записи переданы обработчику.
+ */
+typedef struct {
+    uint32_t capacity;                  // Архитектур, под которые выделены буферы
+    MachOArchitecture *archs;
+    BatchRecord *records;               // capacity + 1 записей: файл и его архитектуры
+    MachOFile *files;
+    SecurityFindings *findings;
+    ResultReader *cached;
+    ResultCacheKey *keys;
+    uint64_t *hashes;                   // XXH64 архитектур для манифеста
+    bool *keyed;                        // Ключ архитектуры посчитан
+} BatchWorkerState;
+
+typedef struct {
+    BatchOptions options;
+    BatchRecordCallback callback;
+    void *context;
+
+    ThreadPool *pool;
+    BatchWorkerState *workers;  // По одному состоянию на рабочий поток
+
+    pthread_mutex_t lock;       // Сериализует обработчик записей и статистику
+    BatchStats stats;
+} BatchContext;
+
+/**
+ * Задача анализа одного файла; путь хранится в той же аллокации.
+ */
+typedef struct {
+    BatchContext *batch;
+    char path[];
+} BatchTask;
+
+/**
+ * Результат проверки первых байтов файла.
+ */
+typedef enum {
+    PROBE_ERROR = -1,   // Файл не удалось прочитать
+    PROBE_OTHER = 0,    // Не Mach-O
+    PROBE_MACHO = 1     // Mach-O или FAT
+} ProbeResult;
+
+BatchOptions batch_default_options(void) {
+    BatchOptions options = {0};
+    options.threads = 0;
+    options.max_file_size = 0;  // Файлы отображаются в память, поэтому размер не ограничивается
+    options.detect_language = true;
+    return options;
+}
+
+const char *batch_change_name(BatchChange change) {
+    switch (change) {
+        case BATCH_CHANGE_ADDED:
+            return "added";
+        case BATCH_CHANGE_CHANGED:
+            return "changed";
+        case BATCH_CHANGE_REMOVED:
+            return "removed";
+        default:
+            return NULL;
+    }
+}
+
+/**
+ * Увеличивает массив до count элементов. При ошибке массив остаётся прежним,
+ * а в failed записывается true.
+ */
+static void *grow_array(void *array, size_t count, size_t element_size, bool *failed) {
+    void *grown = realloc(array, count * element_size);
+    if (!grown) {
+        *failed = true;
+        return array;
+    }
+    return grown;
+}
+
+/**
+ * Увеличивает буферы рабочего потока до count архитектур. Содержимое
+ * сохраняется, поэтому записи, уже заполненные для файла, остаются на месте.
+ *
+ * @return 0 при успехе, -1 если не удалось выделить память.
+ */
+static int reserve_worker_state(BatchWorkerState *state, uint32_t count) {
+    if (count <= state->capacity) {
+        return 0;
+    }
+    uint32_t capacity = state->capacity ? state->capacity : BATCH_INITIAL_ARCHS;
+    while (capacity < count) {
+        capacity = capacity > UINT32_MAX / 2 ? count : capacity * 2;
+    }
+
+    bool failed = false;
+    state->archs = grow_array(state->archs, capacity, sizeof(MachOArchitecture), &failed);
+    state->records = grow_array(state->records, (size_t)capacity + 1, sizeof(BatchRecord), &failed);
+    state->files = grow_array(state->files, capacity, sizeof(MachOFile), &failed);
+    state->findings = grow_array(state->findings, capacity, sizeof(SecurityFindings), &failed);
+    state->cached = grow_array(state->cached, capacity, sizeof(ResultReader), &failed);
+    state->keys = grow_array(state->keys, capacity, sizeof(ResultCacheKey), &failed);
+    state->hashes = grow_array(state->hashes, capacity, sizeof(uint64_t), &failed);
+    state->keyed = grow_array(state->keyed, capacity, sizeof(bool), &failed);
+    if (failed) {
+        // Выросшие массивы остаются за потоком, ёмкость — прежней
+        fprintf(stderr, "Ошибка: Не удалось выделить память для архитектур\n");
+        return -1;
+    }
+
+    // Списки находок переиспользуются между файлами, поэтому новые начинаются пустыми
+    memset(&state->findings[state->capacity], 0, (size_t)(capacity - state->capacity) * sizeof(SecurityFindings));
+    state->capacity = capacity;
+    return 0;
+}
+
+static void free_worker_state(BatchWorkerState *state) {
+    for (uint32_t i = 0; i < state->capacity; i++) {
+        security_findings_free(&state->findings[i]);
+    }
+    free(state->archs);
+    free(state->records);
+    free(state->files);
+    free(state->findings);
+    free(state->cached);
+    free(state->keys);
+    free(state->hashes);
+    free(state->keyed);
+    memset(state, 0, sizeof(BatchWorkerState));
+}
+
+/**
+ * Проверяет magic в первых байтах файла.
+ * У FAT-файла число архитектур не ограничивается; class-файлы Java, начинающиеся
+ * с того же 0xCAFEBABE, отсекаются по типу процессора первой архитектуры: на его
+ * месте у них лежат счётчик пула констант и ненулевой тег первой константы.
+ */
+static bool has_macho_magic(const uint8_t *head, size_t size) {
+    if (size < sizeof(uint32_t)) {
+        return false;
+    }
+    uint32_t magic;
+    memcpy(&magic, head, sizeof(magic));
+
+    switch (magic) {
+        case MH_MAGIC:
+        case MH_CIGAM:
+        case MH_MAGIC_64:
+        case MH_CIGAM_64:
+            return true;
+        case FAT_MAGIC:
+        case FAT_CIGAM:
+        case FAT_MAGIC_64:
+        case FAT_CIGAM_64: {
+            if (size < 3 * sizeof(uint32_t)) {
+                return false;
+            }
+            uint32_t nfat_arch;
+            uint32_t cputype;  // fat_arch и fat_arch_64 начинаются с cputype
+            memcpy(&nfat_arch, head + sizeof(uint32_t), sizeof(nfat_arch));
+            memcpy(&cputype, head + 2 * sizeof(uint32_t), sizeof(cputype));
+            nfat_arch = macho_big_to_host32(nfat_arch);
+            cputype = macho_big_to_host32(cputype);
+            return nfat_arch > 0 && (cputype & ~CPU_ARCH_MASK) <= 0xff;
+        }
+        default:
+            return false;
+    }
+}
+
+/**
+ * Читает первые байты файла и определяет, стоит ли его анализировать.
+ *
+ * @param path Путь к файлу.
+ * @param st Сюда записываются сведения об открытом файле.
+ * @return Результат проверки.
+ */
+static ProbeResult probe_file(const char *path, struct stat *st) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return PROBE_ERROR;
+    }
+
+    uint8_t head[3 * sizeof(uint32_t)];
+    ssize_t n = -1;
+    if (fstat(fd, st) == 0) {
+        n = read(fd, head, sizeof(head));
+    }
+    close(fd);
+
+    if (n < 0) {
+        return PROBE_ERROR;
+    }
+    return has_macho_magic(head, (size_t)n) ? PROBE_MACHO : PROBE_OTHER;
+}
+
+/**
+ * Заполняет запись архитектуры из кеша.
+ *
+ * @return true при попадании.
+ */
+static bool load_cached(const BatchContext *batch, BatchWorkerState *state, uint32_t index,
+                        const ResultCacheKey *key, BatchRecord *record) {
+    ResultReader *reader = &state->cached[index];
+    if (result_cache_lookup(batch->options.cache, key, reader, &record->cached) != 1) {
+        return false;
+    }
+    const ResultArchRecord *cached = record->cached.arch;
+    record->cache_reader = reader;
+    record->file_type = cached->file_type;
+    record->load_command_count = cached->load_command_count;
+    record->is_64_bit = cached->is_64_bit;
+    const char *language = result_reader_string(reader, cached->language);
+    const char *compiler = result_reader_string(reader, cached->compiler);
+    snprintf(record->language.language, sizeof(record->language.language), "%s", language ? language : "");
+    snprintf(record->language.compiler, sizeof(record->language.compiler), "%s", compiler ? compiler : "");
+    result_security_features(reader, &record->cached, &record->security);
+    return true;
+}
+
+/**
+ * Разбирает одну архитектуру и выполняет включённые проверки.
+ * С кешем выполняются все проверки, а полный результат сохраняется в кеш.
+ */
+static void analyze_architecture(const BatchContext *batch, BatchWorkerState *state, const MachOImage *image,
+                                 uint32_t index, const ResultCacheKey *key, BatchRecord *record) {
+    const BatchOptions *options = &batch->options;
+    const MachOArchitecture *arch = &state->archs[index];
+    MachOFile *mach_o_file = &state->files[index];
+    if (analyze_mach_o_image(image, arch->offset, arch->size, mach_o_file) != 0) {
+        record->status = -1;
+        record->error = "не удалось разобрать архитектуру";
+        free_mach_o_file(mach_o_file);
+        return;
+    }
+
+    record->file_type = mach_o_file->file_type;
+    record->load_command_count = mach_o_file->load_command_count;
+    record->is_64_bit = mach_o_file->is_64_bit;
+    if (options->keep_details) {
+        record->mach_o_file = mach_o_file;
+    }
+    if ((options->detect_language || key) &&
+        detect_language_and_compiler(mach_o_file, &record->language) != 0) {
+        record->status = -1;
+        record->error = "не удалось определить язык";
+    }
+    if ((options->check_security || key) &&
+        check_security_features(mach_o_file, &record->security) != 0) {
+        record->status = -1;
+        record->error = "не удалось проверить защитные механизмы";
+    }
+    if (options->collect_findings || key) {
+        // Список находок переиспользуется: память остаётся за потоком, сбрасывается только счётчик
+        SecurityFindings *findings = &state->findings[index];
+        findings->count = 0;
+        if (analyze_unsafe_functions(mach_o_file, findings) != 0 ||
+            analyze_section_permissions(mach_o_file, findings) != 0 ||
+            analyze_debug_symbols(mach_o_file, findings) != 0) {
+            record->status = -1;
+            record->error = "не удалось проверить безопасность";
+        }
+        record->findings = *findings;
+    }
+    if (key && record->status == 0) {
+        ResultArchInput input = {NULL, 0, NULL, mach_o_file, &record->security, &record->language,
+                                 &record->findings};
+        result_cache_store(options->cache, key, &input);  // Ошибка записи кеша не мешает анализу
+    }
+    if (!options->keep_details) {
+        free_mach_o_file(mach_o_file);
+    }
+}
+
+/**
+ * Разбирает все архитектуры открытого образа в записи рабочего потока.
+ *
+ * @param previous Запись прошлого манифеста или NULL. Если хеши всех архитектур
+ *                 совпали с ней, файл не разбирается: изменились только метаданные.
+ * @return Количество заполненных записей, включая запись файла.
+ */
+static size_t analyze_architectures(const BatchContext *batch, BatchWorkerState *state, const MachOImage *image,
+                                    const ScanManifestEntry *previous) {
+    const BatchOptions *options = &batch->options;
+    bool is_fat = false;
+    int64_t arch_count = macho_list_architectures(image, state->archs, state->capacity, &is_fat);
+    if (arch_count > state->capacity) {
+        if (arch_count > UINT32_MAX - 1 || reserve_worker_state(state, (uint32_t)arch_count) != 0) {
+            state->records[0].status = -1;
+            state->records[0].error = "не удалось выделить память для архитектур";
+            return 1;
+        }
+        arch_count = macho_list_architectures(image, state->archs, state->capacity, &is_fat);
+    }
+    BatchRecord *file = &state->records[0];
+    if (arch_count < 0) {
+        file->status = -1;
+        file->error = "повреждённый заголовок Mach-O";
+        return 1;
+    }
+    file->is_fat = is_fat;
+    file->arch_count = (uint32_t)arch_count;
+
+    // Хеш архитектуры служит и ключом кеша, и отпечатком в манифесте
+    bool hashed = options->cache || options->previous || options->next;
+    bool *keyed = state->keyed;
+    memset(keyed, 0, (size_t)arch_count * sizeof(bool));
+    for (uint32_t i = 0; hashed && i < (uint32_t)arch_count; i++) {
+        keyed[i] = result_cache_key(image, &state->archs[i], &state->keys[i]) == 0;
+        state->hashes[i] = keyed[i] ? state->keys[i].hash : 0;
+    }
+    if (previous && previous->is_macho && previous->arch_count == (uint32_t)arch_count &&
+        memcmp(previous->hashes, state->hashes, (size_t)arch_count * sizeof(uint64_t)) == 0) {
+        return 1;
+    }
+
+    size_t record_count = 1;
+    for (uint32_t i = 0; i < (uint32_t)arch_count; i++) {
+        const MachOArchitecture *arch = &state->archs[i];
+        BatchRecord *record = &state->records[record_count++];
+        *record = *file;
+        record->kind = BATCH_RECORD_ARCH;
+        record->arch_index = i;
+        record->arch = *arch;
+        record->arch_name = get_arch_name(arch->cpu_type, arch->cpu_subtype);
+
+        const ResultCacheKey *key = options->cache && keyed[i] ? &state->keys[i] : NULL;
+        if (key && load_cached(batch, state, i, key, record)) {
+            continue;
+        }
+        analyze_architecture(batch, state, image, i, key, record);
+    }
+    return record_count;
+}
+
+/**
+ * Заполняет запись манифеста сведениями о файле (путь не копируется).
+ */
+static void describe_file(ScanManifestEntry *entry, const char *path, const struct stat *st) {
+    memset(entry, 0, sizeof(ScanManifestEntry));
+    entry->path = (char *)path;
+    entry->size = (uint64_t)st->st_size;
+    entry->mtime_sec = (int64_t)STAT_MTIME(st).tv_sec;
+    entry->mtime_nsec = (uint32_t)STAT_MTIME(st).tv_nsec;
+    entry->inode = (uint64_t)st->st_ino;
+}
+
+/**
+ * Определяет изменение файла по хешам архитектур.
+ */
+static BatchChange detect_change(const ScanManifestEntry *previous, const ScanManifestEntry *current) {
+    bool was_macho = previous && previous->is_macho;
+    if (!current->is_macho) {
+        return was_macho ? BATCH_CHANGE_REMOVED : BATCH_CHANGE_NONE;
+    }
+    if (!was_macho) {
+        return BATCH_CHANGE_ADDED;
+    }
+    bool same = previous->arch_count == current->arch_count &&
+                (current->arch_count == 0 ||
+                 memcmp(previous->hashes, current->hashes, current->arch_count * sizeof(uint64_t)) == 0);
+    return same ? BATCH_CHANGE_NONE : BATCH_CHANGE_CHANGED;
+}
+
+/**
+ * Добавляет запись в манифест текущего прохода. Вызывается под batch->lock.
+ */
+static void record_manifest(BatchContext *batch, const ScanManifestEntry *entry) {
+    if (batch->options.next && scan_manifest_add(batch->options.next, entry) != 0) {
+        batch->stats.errors++;
+    }
+}
+
+/**
+ * Быстрый путь повторного прохода: если размер, mtime и inode совпали
+ * с прошлым манифестом, файл не открывается, а запись переносится как есть.
+ *
+ * @return true, если файл пропущен.
+ */
+static bool skip_unchanged(BatchContext *batch, const char *path) {
+    ScanManifestEntry *previous = scan_manifest_find(batch->options.previous, path);
+    struct stat st;
+    if (!previous || stat(path, &st) != 0) {
+        return false;
+    }
+    ScanManifestEntry current;
+    describe_file(&current, path, &st);
+    if (current.size != previous->size || current.mtime_sec != previous->mtime_sec ||
+        current.mtime_nsec != previous->mtime_nsec || current.inode != previous->inode) {
+        return false;
+    }
+
+    pthread_mutex_lock(&batch->lock);
+    previous->seen = true;
+    batch->stats.macho_files += previous->is_macho;
+    batch->stats.unchanged += previous->is_macho;
+    record_manifest(batch, previous);
+    pthread_mutex_unlock(&batch->lock);
+    return true;
+}
+
+/**
+ * Задача пула: анализирует один файл и сообщает его записи.
+ */
+static void analyze_file(void *arg, size_t worker) {
+    BatchTask *task = arg;
+    BatchContext *batch = task->batch;
+    BatchWorkerState *state = &batch->workers[worker];
+    const BatchOptions *options = &batch->options;
+
+    if (options->previous && skip_unchanged(batch, task->path)) {
+        free(task);
+        return;
+    }
+
+    BatchRecord *file = &state->records[0];
+    memset(file, 0, sizeof(BatchRecord));
+    file->kind = BATCH_RECORD_FILE;
+    file->path = task->path;
+
+    size_t record_count = 1;
+    struct stat st = {0};
+    ProbeResult probe = probe_file(task->path, &st);
+    file->file_size = (uint64_t)st.st_size;
+    if (probe == PROBE_OTHER && !options->previous && !options->next) {
+        free(task);
+        return;
+    }
+
+    // Прошлый манифест во время прохода не меняется, кроме флагов seen, поэтому ищется без блокировки
+    ScanManifestEntry *previous = scan_manifest_find(options->previous, task->path);
+    MachOImage image = {0};
+    bool image_open = false;
+    if (probe == PROBE_ERROR) {
+        file->status = -1;
+        file->error = "не удалось прочитать файл";
+    } else if (probe == PROBE_OTHER) {
+        // Обычный файл попадает только в манифест
+    } else if (options->max_file_size && file->file_size > options->max_file_size) {
+        file->status = -1;
+        file->error = "файл слишком велик";
+    } else if (macho_image_open(task->path, &image) != 0) {
+        file->status = -1;
+        file->error = "не удалось отобразить файл в память";
+    } else {
+        image_open = true;
+        record_count = analyze_architectures(batch, state, &image, previous);
+        file = &state->records[0];  // Буфер записей мог вырасти
+    }
+
+    bool failed = false;
+    for (size_t i = 0; i < record_count; i++) {
+        failed |= state->records[i].status != 0;
+    }
+
+    ScanManifestEntry current;
+    describe_file(&current, task->path, &st);
+    current.is_macho = probe == PROBE_MACHO;
+    current.arch_count = file->arch_count;
+    current.hashes = state->hashes;
+
+    pthread_mutex_lock(&batch->lock);
+    bool report = probe != PROBE_OTHER;
+    if (options->previous) {
+        BatchChange change = failed ? BATCH_CHANGE_NONE : detect_change(previous, &current);
+        for (size_t i = 0; i < record_count; i++) {
+            state->records[i].change = change;
+        }
+        if (change == BATCH_CHANGE_REMOVED) {
+            file->arch_count = previous->arch_count;
+        }
+        report = failed || change != BATCH_CHANGE_NONE;
+        batch->stats.unchanged += current.is_macho && !report;
+        if (previous) {
+            previous->seen = true;
+        }
+    }
+    // Файлы с ошибками не попадают в манифест, чтобы следующий проход проверил их снова
+    if (!failed) {
+        record_manifest(batch, &current);
+    } else if (previous) {
+        record_manifest(batch, previous);
+    }
+
+    if (probe == PROBE_MACHO) {
+        batch->stats.macho_files++;
+    }
+    batch->stats.errors += failed;
+    if (report) {
+        batch->stats.arch_records += record_count - 1;
+        for (size_t i = 1; i < record_count; i++) {
+            batch->stats.cache_hits += state->records[i].cache_reader != NULL;
+        }
+        if (batch->callback) {
+            for (size_t i = 0; i < record_count; i++) {
+                batch->callback(&state->records[i], batch->context);
+            }
+        }
+    }
+    pthread_mutex_unlock(&batch->lock);
+
+    for (size_t i = 1; i < record_count; i++) {
+        if (state->records[i].mach_o_file) {
+            free_mach_o_file(&state->files[i - 1]);
+        }
+        if (state->records[i].cache_reader) {
+            result_reader_close(&state->cached[i - 1]);
+        }
+    }
+    if (image_open) {
+        macho_image_close(&image);
+    }
+    free(task);
+}
+
+static void count_error(BatchContext *batch) {
+    pthread_mutex_lock(&batch->lock);
+    batch->stats.errors++;
+    pthread_mutex_unlock(&batch->lock);
+}
+
+static void submit_file(BatchContext *batch, const char *path) {
+    size_t length = strlen(path);
+    BatchTask *task = malloc(sizeof(BatchTask) + length + 1);
+    if (!task) {
+        fprintf(stderr, "Ошибка: Не удалось выделить память для задачи %s\n", path);
+        count_error(batch);
+        return;
+    }
+    task->batch = batch;
+    memcpy(task->path, path, length + 1);
+
+    pthread_mutex_lock(&batch->lock);
+    batch->stats.files_seen++;
+    pthread_mutex_unlock(&batch->lock);
+
+    if (thread_pool_submit(batch->pool, analyze_file, task) != 0) {
+        fprintf(stderr, "Ошибка: Не удалось поставить в очередь %s\n", path);
+        free(task);
+        count_error(batch);
+    }
+}
+
+/**
+ * Собирает путь каталог/имя в новой строке.
+ */
+static char *join_path(const char *dir, const char *name) {
+    size_t dir_length = strlen(dir);
+    size_t name_length = strlen(name);
+    bool slash = dir_length > 0 && dir[dir_length - 1] != '/';
+    char *path = malloc(dir_length + slash + name_length + 1);
+    if (!path) {
+        return NULL;
+    }
+    memcpy(path, dir, dir_length);
+    if (slash) {
+        path[dir_length] = '/';
+    }
+    memcpy(path + dir_length + slash, name, name_length + 1);
+    return path;
+}
+
+static void walk_directory(BatchContext *batch, const char *path) {
+    DIR *dir = opendir(path);
+    if (!dir) {
+        fprintf(stderr, "Ошибка: Не удалось открыть каталог %s\n", path);
+        count_error(batch);
+        return;
+    }
+
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+            continue;
+        }
+        char *child = join_path(path, entry->d_name);
+        if (!child) {
+            fprintf(stderr, "Ошибка: Не удалось выделить память для пути в %s\n", path);
+            count_error(batch);
+            continue;
+        }
+
+        // Тип из записи каталога избавляет от lstat для каждого файла
+        unsigned char type = entry->d_type;
+        if (type == DT_UNKNOWN) {
+            struct stat st;
+            if (lstat(child, &st) == 0) {
+                type = S_ISDIR(st.st_mode) ? DT_DIR : S_ISREG(st.st_mode) ? DT_REG : DT_LNK;
+            }
+        }
+
+        if (type == DT_DIR) {
+            walk_directory(batch, child);
+        } else if (type == DT_REG) {
+            submit_file(batch, child);
+        }
+        free(child);
+    }
+    closedir(dir);
+}
+
+/**
+ * Сообщает об удалённых Mach-O: записи прошлого манифеста, не встреченные в этом проходе.
+ */
+static void report_removed(BatchContext *batch) {
+    const ScanManifest *previous = batch->options.previous;
+    for (size_t i = 0; i < previous->count; i++) {
+        const ScanManifestEntry *entry = &previous->entries[i];
+        if (entry->seen || !entry->is_macho) {
+            continue;
+        }
+        BatchRecord record = {0};
+        record.kind = BATCH_RECORD_FILE;
+        record.path = entry->path;
+        record.change = BATCH_CHANGE_REMOVED;
+        record.file_size = entry->size;
+        record.arch_count = entry->arch_count;
+        if (batch->callback) {
+            batch->callback(&record, batch->context);
+        }
+    }
+}
+
+int batch_scan(const char *const *paths, size_t count, const BatchOptions *options,
+               BatchRecordCallback callback, void *context, BatchStats *stats) {
+    if (!paths && count > 0) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в batch_scan\n");
+        return -1;
+    }
+
+    BatchContext batch = {0};
+    batch.options = options ? *options : batch_default_options();
+    batch.callback = callback;
+    batch.context = context;
+
+    batch.pool = thread_pool_create(batch.options.threads, 0);
+    if (!batch.pool) {
+        return -1;
+    }
+    size_t workers = thread_pool_size(batch.pool);
+    batch.workers = calloc(workers, sizeof(BatchWorkerState));
+    bool reserved = batch.workers != NULL;
+    for (size_t w = 0; reserved && w < workers; w++) {
+        reserved = reserve_worker_state(&batch.workers[w], BATCH_INITIAL_ARCHS) == 0;
+    }
+    if (!reserved) {
+        fprintf(stderr, "Ошибка: Не удалось выделить память для состояния потоков\n");
+        thread_pool_destroy(batch.pool);
+        for (size_t w = 0; batch.workers && w < workers; w++) {
+            free_worker_state(&batch.workers[w]);
+        }
+        free(batch.workers);
+        return -1;
+    }
+    pthread_mutex_init(&batch.lock, NULL);
+
+    for (size_t i = 0; i < count; i++) {
+        struct stat st;
+        if (stat(paths[i], &st) != 0) {
+            fprintf(stderr, "Ошибка: Не удалось получить сведения о %s\n", paths[i]);
+            count_error(&batch);
+        } else if (S_ISDIR(st.st_mode)) {
+            walk_directory(&batch, paths[i]);
+        } else if (S_ISREG(st.st_mode)) {
+            submit_file(&batch, paths[i]);
+        } else {
+            fprintf(stderr, "Ошибка: %s не является файлом или каталогом\n", paths[i]);
+            count_error(&batch);
+        }
+    }
+
+    thread_pool_wait(batch.pool);
+    if (batch.options.previous) {
+        report_removed(&batch);
+    }
+    thread_pool_destroy(batch.pool);
+    for (size_t w = 0; w < workers; w++) {
+        free_worker_state(&batch.workers[w]);
+    }
+    free(batch.workers);
+    pthread_mutex_destroy(&batch.lock);
+
+    if (stats) {
+        *stats = batch.stats;
+    }
+    return batch.stats.errors ? -1 : 0;
+}
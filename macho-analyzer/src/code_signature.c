@@ -0,0 +1,442 @@
+#include "code_signature.h"
+#include "sha_digest.h"
+#include "thread_pool.h"
+#include "macho_types.h"
+#include "macho_endian.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Страниц в одной задаче пула: 256 страниц по 4 КиБ — 1 МиБ хеширования на задачу
+#define CODE_SIGNATURE_PAGES_PER_TASK 256
+
+// Размеры заголовков блобов
+#define SUPERBLOB_HEADER_SIZE   12  // magic, length, count
+#define BLOB_INDEX_SIZE         8   // type, offset
+#define CODE_DIRECTORY_MIN_SIZE 44  // Поля до spare2 включительно
+#define CODE_DIRECTORY_V20300_SIZE 64  // С codeLimit64
+
+// Смещения полей CodeDirectory
+#define CD_LENGTH         4
+#define CD_VERSION        8
+#define CD_HASH_OFFSET    16
+#define CD_IDENT_OFFSET   20
+#define CD_SPECIAL_SLOTS  24
+#define CD_CODE_SLOTS     28
+#define CD_CODE_LIMIT     32
+#define CD_HASH_SIZE      36
+#define CD_HASH_TYPE      37
+#define CD_PAGE_SIZE      39
+#define CD_CODE_LIMIT_64  56
+
+/**
+ * Поля блобов подписи хранятся в big-endian и не обязательно выровнены.
+ */
+static uint32_t read_be32(const uint8_t *p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return macho_big_to_host32(value);
+}
+
+static uint64_t read_be64(const uint8_t *p) {
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+    return macho_big_to_host64(value);
+}
+
+/**
+ * Разобранная директория кода: указатели на подписанные байты и на хеши слотов кода.
+ */
+typedef struct {
+    const uint8_t *blob;        // Начало директории
+    uint32_t length;
+    const uint8_t *code;        // Начало среза Mach-O
+    const uint8_t *hashes;      // Хеш слота кода 0
+} CodeDirectoryData;
+
+/**
+ * Задача пула: проверяет страницы [first, end) одной директории.
+ */
+typedef struct {
+    const CodeDirectoryInfo *directory;
+    const CodeDirectoryData *data;
+    uint32_t first;
+    uint32_t end;
+    uint32_t mismatch_count;
+    uint32_t mismatched_pages[CODE_SIGNATURE_MAX_REPORTED_PAGES];
+} PageHashTask;
+
+static bool hash_type_supported(uint8_t hash_type, uint8_t hash_size) {
+    switch (hash_type) {
+        case CS_HASHTYPE_SHA1:
+        case CS_HASHTYPE_SHA256_TRUNCATED:
+            return hash_size == SHA1_DIGEST_LENGTH;
+        case CS_HASHTYPE_SHA256:
+            return hash_size == SHA256_DIGEST_LENGTH;
+        default:
+            return false;
+    }
+}
+
+/**
+ * Проверяет заголовок директории кода и заполняет сведения о ней.
+ *
+ * @param blob Начало директории.
+ * @param available Байт до конца SuperBlob.
+ * @return CODE_SIGNATURE_VALID, если директория согласована, иначе код ошибки.
+ */
+static CodeSignatureStatus parse_directory(const MachOFile *mach_o_file, const uint8_t *blob, uint32_t available,
+                                           uint32_t slot, CodeDirectoryInfo *directory, CodeDirectoryData *data) {
+    if (available < CODE_DIRECTORY_MIN_SIZE) {
+        return CODE_SIGNATURE_TOO_SMALL;
+    }
+    if (read_be32(blob) != CSMAGIC_CODEDIRECTORY) {
+        return CODE_SIGNATURE_BAD_MAGIC;
+    }
+    uint32_t length = read_be32(blob + CD_LENGTH);
+    if (length < CODE_DIRECTORY_MIN_SIZE || length > available) {
+        return CODE_SIGNATURE_BAD_LENGTH;
+    }
+
+    memset(directory, 0, sizeof(CodeDirectoryInfo));
+    directory->slot = slot;
+    directory->hash_type = blob[CD_HASH_TYPE];
+    directory->hash_size = blob[CD_HASH_SIZE];
+    directory->page_count = read_be32(blob + CD_CODE_SLOTS);
+    directory->code_limit = read_be32(blob + CD_CODE_LIMIT);
+    if (read_be32(blob + CD_VERSION) >= 0x20300 && length >= CODE_DIRECTORY_V20300_SIZE &&
+        read_be64(blob + CD_CODE_LIMIT_64) != 0) {
+        directory->code_limit = read_be64(blob + CD_CODE_LIMIT_64);
+    }
+    uint8_t page_shift = blob[CD_PAGE_SIZE];
+    if (page_shift >= 32) {
+        return CODE_SIGNATURE_BAD_LENGTH;
+    }
+    directory->page_size = page_shift ? 1u << page_shift : 0;
+
+    // Хеши специальных слотов лежат перед hashOffset, слотов кода — после
+    uint64_t hash_offset = read_be32(blob + CD_HASH_OFFSET);
+    uint64_t special_size = (uint64_t)read_be32(blob + CD_SPECIAL_SLOTS) * directory->hash_size;
+    uint64_t code_size = (uint64_t)directory->page_count * directory->hash_size;
+    if (hash_offset < special_size || hash_offset + code_size > length) {
+        return CODE_SIGNATURE_BAD_LENGTH;
+    }
+
+    // Слоты должны покрывать подписанную часть файла ровно
+    uint64_t expected_pages = directory->page_size
+                              ? (directory->code_limit + directory->page_size - 1) / directory->page_size
+                              : directory->code_limit > 0;
+    if (directory->page_count != expected_pages) {
+        return CODE_SIGNATURE_BAD_LENGTH;
+    }
+    const uint8_t *code = macho_file_slice(mach_o_file, 0, directory->code_limit);
+    if (!code) {
+        return CODE_SIGNATURE_OUT_OF_BOUNDS;
+    }
+
+    directory->verified = hash_type_supported(directory->hash_type, directory->hash_size);
+    data->blob = blob;
+    data->length = length;
+    data->code = code;
+    data->hashes = blob + hash_offset;
+    return CODE_SIGNATURE_VALID;
+}
+
+/**
+ * Находит директории кода: в SuperBlob — основную и альтернативные,
+ * иначе одиночную директорию, занимающую все данные подписи.
+ *
+ * @return CODE_SIGNATURE_VALID или код ошибки.
+ */
+static CodeSignatureStatus find_directories(const MachOFile *mach_o_file, const uint8_t *signature, uint32_t size,
+                                            CodeSignatureInfo *info, CodeDirectoryData *data) {
+    if (size < sizeof(uint32_t)) {
+        return CODE_SIGNATURE_TOO_SMALL;
+    }
+    uint32_t magic = read_be32(signature);
+    if (magic == CSMAGIC_CODEDIRECTORY) {
+        info->directory_count = 1;
+        return parse_directory(mach_o_file, signature, size, CSSLOT_CODEDIRECTORY, &info->directories[0], &data[0]);
+    }
+    if (magic != CSMAGIC_EMBEDDED_SIGNATURE) {
+        return CODE_SIGNATURE_BAD_MAGIC;
+    }
+    if (size < SUPERBLOB_HEADER_SIZE) {
+        return CODE_SIGNATURE_TOO_SMALL;
+    }
+
+    uint32_t length = read_be32(signature + 4);
+    uint32_t count = read_be32(signature + 8);
+    if (length > size || length < SUPERBLOB_HEADER_SIZE ||
+        (uint64_t)count * BLOB_INDEX_SIZE > length - SUPERBLOB_HEADER_SIZE) {
+        return CODE_SIGNATURE_BAD_LENGTH;
+    }
+
+    // Первый проход берёт основную директорию, второй — альтернативные, чтобы основная была первой
+    for (int pass = 0; pass < 2; pass++) {
+        for (uint32_t i = 0; i < count; i++) {
+            const uint8_t *entry = signature + SUPERBLOB_HEADER_SIZE + (size_t)i * BLOB_INDEX_SIZE;
+            uint32_t type = read_be32(entry);
+            uint32_t offset = read_be32(entry + 4);
+            bool wanted = pass == 0 ? type == CSSLOT_CODEDIRECTORY
+                                    : type >= CSSLOT_ALTERNATE_CODEDIRECTORIES &&
+                                      type < CSSLOT_ALTERNATE_CODEDIRECTORIES + CSSLOT_ALTERNATE_CODEDIRECTORY_MAX;
+            if (!wanted) {
+                continue;  // Требования, права, CMS-подпись
+            }
+            if (offset >= length || info->directory_count == CODE_SIGNATURE_MAX_DIRECTORIES ||
+                (pass == 0 && info->directory_count > 0)) {
+                return CODE_SIGNATURE_BAD_LENGTH;
+            }
+            uint32_t index = info->directory_count;
+            CodeSignatureStatus status = parse_directory(mach_o_file, signature + offset, length - offset, type,
+                                                         &info->directories[index], &data[index]);
+            if (status != CODE_SIGNATURE_VALID) {
+                return status;
+            }
+            info->directory_count++;
+        }
+        if (info->directory_count == 0) {
+            return CODE_SIGNATURE_BAD_MAGIC;  // Нет основной директории кода
+        }
+    }
+    return CODE_SIGNATURE_VALID;
+}
+
+/**
+ * Хеширует страницы задачи и запоминает несовпавшие.
+ */
+static void hash_pages_task(void *arg, size_t worker) {
+    (void)worker;
+    PageHashTask *task = arg;
+    const CodeDirectoryInfo *directory = task->directory;
+    const CodeDirectoryData *data = task->data;
+
+    for (uint32_t page = task->first; page < task->end; page++) {
+        uint64_t start = (uint64_t)page * directory->page_size;
+        uint64_t size = directory->code_limit - start;
+        if (directory->page_size && size > directory->page_size) {
+            size = directory->page_size;
+        }
+
+        uint8_t digest[SHA256_DIGEST_LENGTH];
+        if (directory->hash_type == CS_HASHTYPE_SHA1) {
+            sha1(data->code + start, (size_t)size, digest);
+        } else {
+            sha256(data->code + start, (size_t)size, digest);
+        }
+        if (memcmp(digest, data->hashes + (size_t)page * directory->hash_size, directory->hash_size) != 0) {
+            if (task->mismatch_count < CODE_SIGNATURE_MAX_REPORTED_PAGES) {
+                task->mismatched_pages[task->mismatch_count] = page;
+            }
+            task->mismatch_count++;
+        }
+    }
+}
+
+/**
+ * Переносит несовпадения задачи в сведения о директории (задачи сливаются по порядку страниц).
+ */
+static void merge_task(CodeDirectoryInfo *directory, const PageHashTask *task) {
+    for (uint32_t i = 0; i < task->mismatch_count && i < CODE_SIGNATURE_MAX_REPORTED_PAGES; i++) {
+        if (directory->mismatch_count + i < CODE_SIGNATURE_MAX_REPORTED_PAGES) {
+            directory->mismatched_pages[directory->mismatch_count + i] = task->mismatched_pages[i];
+        }
+    }
+    directory->mismatch_count += task->mismatch_count;
+}
+
+/**
+ * Проверяет страницы всех директорий с поддерживаемым хешем. Страницы режутся
+ * на задачи по CODE_SIGNATURE_PAGES_PER_TASK; если задач больше одной и
+ * доступно больше одного потока, задачи выполняются на пуле.
+ *
+ * @return 0 при успехе, -1 если не удалось выделить память.
+ */
+static int verify_pages(CodeSignatureInfo *info, const CodeDirectoryData *data, size_t threads) {
+    size_t task_count = 0;
+    for (uint32_t d = 0; d < info->directory_count; d++) {
+        if (info->directories[d].verified) {
+            task_count += (info->directories[d].page_count + CODE_SIGNATURE_PAGES_PER_TASK - 1) /
+                          CODE_SIGNATURE_PAGES_PER_TASK;
+        }
+    }
+    if (task_count == 0) {
+        return 0;
+    }
+
+    PageHashTask *tasks = calloc(task_count, sizeof(PageHashTask));
+    if (!tasks) {
+        fprintf(stderr, "Ошибка: Не удалось выделить память для проверки страниц подписи\n");
+        return -1;
+    }
+    size_t next = 0;
+    for (uint32_t d = 0; d < info->directory_count; d++) {
+        const CodeDirectoryInfo *directory = &info->directories[d];
+        for (uint32_t first = 0; directory->verified && first < directory->page_count;
+             first += CODE_SIGNATURE_PAGES_PER_TASK) {
+            PageHashTask *task = &tasks[next++];
+            task->directory = directory;
+            task->data = &data[d];
+            task->first = first;
+            task->end = directory->page_count - first > CODE_SIGNATURE_PAGES_PER_TASK
+                        ? first + CODE_SIGNATURE_PAGES_PER_TASK : directory->page_count;
+        }
+    }
+
+    if (threads == 0) {
+        threads = thread_pool_cpu_count();
+    }
+    if (threads > task_count) {
+        threads = task_count;
+    }
+
+    // Небольшую подпись дешевле проверить в текущем потоке
+    ThreadPool *pool = threads > 1 ? thread_pool_create(threads, task_count) : NULL;
+    if (pool) {
+        for (size_t i = 0; i < task_count; i++) {
+            if (thread_pool_submit(pool, hash_pages_task, &tasks[i]) != 0) {
+                hash_pages_task(&tasks[i], 0);
+            }
+        }
+        thread_pool_wait(pool);
+        thread_pool_destroy(pool);
+    } else {
+        for (size_t i = 0; i < task_count; i++) {
+            hash_pages_task(&tasks[i], 0);
+        }
+    }
+
+    for (size_t i = 0; i < task_count; i++) {
+        merge_task(&info->directories[tasks[i].directory - info->directories], &tasks[i]);
+    }
+    free(tasks);
+    return 0;
+}
+
+/**
+ * Проверяет подпись, на которую указывает команда LC_CODE_SIGNATURE.
+ *
+ * @param mach_o_file Указатель на структуру MachOFile.
+ * @param code_sig_cmd Команда подписи или NULL, если её нет.
+ * @param threads Количество потоков для хеширования страниц.
+ * @param info Структура для результата (обнулена вызывающим).
+ * @return 0, если подписи нет или она прошла проверки, -1 в случае ошибки или несовпадения.
+ */
+static int verify_signature(const MachOFile *mach_o_file, const struct linkedit_data_command *code_sig_cmd,
+                            size_t threads, CodeSignatureInfo *info) {
+    if (!code_sig_cmd) {
+        info->status = CODE_SIGNATURE_ABSENT;
+        return 0;
+    }
+
+    // Данные подписи читаются прямо из образа
+    uint32_t datasize = macho_get32(mach_o_file, code_sig_cmd->datasize);
+    const uint8_t *signature_data = macho_file_slice(mach_o_file, macho_get32(mach_o_file, code_sig_cmd->dataoff), datasize);
+    if (!signature_data) {
+        info->status = CODE_SIGNATURE_OUT_OF_BOUNDS;
+        return -1;
+    }
+
+    CodeDirectoryData data[CODE_SIGNATURE_MAX_DIRECTORIES];
+    info->status = find_directories(mach_o_file, signature_data, datasize, info, data);
+    if (info->status != CODE_SIGNATURE_VALID) {
+        return -1;
+    }
+
+    // Сведения основной директории
+    const CodeDirectoryData *primary = &data[0];
+    info->version = read_be32(primary->blob + CD_VERSION);
+    info->outdated = info->version < 0x20100;
+
+    uint32_t ident_offset = read_be32(primary->blob + CD_IDENT_OFFSET);
+    if (ident_offset < primary->length &&
+        memchr(primary->blob + ident_offset, '\0', primary->length - ident_offset)) {
+        info->identifier = (const char *)(primary->blob + ident_offset);
+    } else {
+        info->status = CODE_SIGNATURE_BAD_IDENTIFIER;
+        return -1;
+    }
+
+    // Первые байты хеша
+    if (info->directories[0].page_count > 0) {
+        info->hash_prefix_length = info->directories[0].hash_size < sizeof(info->hash_prefix)
+                                   ? info->directories[0].hash_size : sizeof(info->hash_prefix);
+        memcpy(info->hash_prefix, primary->hashes, info->hash_prefix_length);
+    }
+
+    // Вычисление SHA-256 хеша
+    sha256(primary->blob, primary->length, info->sha256);
+
+    if (verify_pages(info, data, threads) != 0) {
+        return -1;
+    }
+
+    bool verified = false;
+    for (uint32_t d = 0; d < info->directory_count; d++) {
+        verified |= info->directories[d].verified;
+        if (info->directories[d].mismatch_count > 0) {
+            info->status = CODE_SIGNATURE_PAGE_MISMATCH;
+        }
+    }
+    if (!verified) {
+        info->status = CODE_SIGNATURE_UNSUPPORTED_HASH;
+    }
+    return info->status == CODE_SIGNATURE_VALID ? 0 : -1;
+}
+
+/**
+ * Запоминает первую команду LC_CODE_SIGNATURE.
+ */
+static int visit_code_signature(const MachOFile *mach_o_file, const struct load_command *cmd, void *context) {
+    (void)mach_o_file;
+    ((CodeSignatureCheck *)context)->command = (const struct linkedit_data_command *)cmd;
+    return MACHO_VISIT_DONE;
+}
+
+/**
+ * Проверяет найденную подпись после обхода команд.
+ * Несовпадение подписи — результат проверки, а не ошибка обхода, поэтому
+ * он сохраняется в check->result.
+ */
+static int finish_code_signature(const MachOFile *mach_o_file, void *context) {
+    CodeSignatureCheck *check = context;
+    check->result = verify_signature(mach_o_file, check->command, check->threads, check->info);
+    return 0;
+}
+
+int code_signature_subscribe(MachOCommandVisitor *visitor, CodeSignatureCheck *check, size_t threads,
+                             CodeSignatureInfo *info) {
+    if (!visitor || !check || !info) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в code_signature_subscribe\n");
+        return -1;
+    }
+
+    memset(info, 0, sizeof(CodeSignatureInfo));
+    check->info = info;
+    check->threads = threads;
+    check->command = NULL;
+    check->result = 0;
+
+    if (macho_visitor_subscribe(visitor, LC_CODE_SIGNATURE, visit_code_signature, check) != 0 ||
+        macho_visitor_on_finish(visitor, finish_code_signature, check) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+int analyze_code_signature(const MachOFile *mach_o_file, size_t threads, CodeSignatureInfo *info) {
+    if (!mach_o_file || !mach_o_file->commands || !info) {
+        fprintf(stderr, "Ошибка: Неверный Mach-O файл или отсутствуют команды для обработки.\n");
+        return -1;
+    }
+
+    MachOCommandVisitor visitor;
+    CodeSignatureCheck check;
+    macho_visitor_init(&visitor);
+    if (code_signature_subscribe(&visitor, &check, threads, info) != 0 ||
+        macho_visitor_run(&visitor, mach_o_file) != 0) {
+        return -1;
+    }
+    return check.result;
+}
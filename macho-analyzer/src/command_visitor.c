@@ -0,0 +1,104 @@
+#include "command_visitor.h"
+#include <stdio.h>
+
+void macho_visitor_init(MachOCommandVisitor *visitor) {
+    visitor->subscription_count = 0;
+    visitor->finisher_count = 0;
+    visitor->overflow = -1;
+    for (size_t i = 0; i < MACHO_VISITOR_COMMAND_SLOTS; i++) {
+        visitor->slots[i] = -1;
+    }
+}
+
+/**
+ * Возвращает голову списка подписок для типа команды.
+ */
+static int *subscription_head(MachOCommandVisitor *visitor, uint32_t cmd) {
+    uint32_t slot = cmd & ~LC_REQ_DYLD;
+    return slot < MACHO_VISITOR_COMMAND_SLOTS ? &visitor->slots[slot] : &visitor->overflow;
+}
+
+int macho_visitor_subscribe(MachOCommandVisitor *visitor, uint32_t cmd, MachOCommandHandler handler, void *context) {
+    if (!visitor || !handler) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в macho_visitor_subscribe\n");
+        return -1;
+    }
+    if (visitor->subscription_count == MACHO_VISITOR_MAX_SUBSCRIPTIONS) {
+        fprintf(stderr, "Ошибка: Слишком много подписок на команды загрузки\n");
+        return -1;
+    }
+
+    int index = (int)visitor->subscription_count++;
+    MachOCommandSubscription *subscription = &visitor->subscriptions[index];
+    subscription->cmd = cmd;
+    subscription->handler = handler;
+    subscription->context = context;
+    subscription->next = -1;
+    subscription->done = false;
+
+    // Добавляем в конец списка, чтобы сохранить порядок подписки
+    int *link = subscription_head(visitor, cmd);
+    while (*link >= 0) {
+        link = &visitor->subscriptions[*link].next;
+    }
+    *link = index;
+    return 0;
+}
+
+int macho_visitor_on_finish(MachOCommandVisitor *visitor, MachOVisitorFinish finish, void *context) {
+    if (!visitor || !finish) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в macho_visitor_on_finish\n");
+        return -1;
+    }
+    if (visitor->finisher_count == MACHO_VISITOR_MAX_FINISHERS) {
+        fprintf(stderr, "Ошибка: Слишком много завершений обхода команд\n");
+        return -1;
+    }
+
+    visitor->finishers[visitor->finisher_count].finish = finish;
+    visitor->finishers[visitor->finisher_count].context = context;
+    visitor->finisher_count++;
+    return 0;
+}
+
+int macho_visitor_run(MachOCommandVisitor *visitor, const MachOFile *mach_o_file) {
+    if (!visitor || !mach_o_file || !mach_o_file->commands) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в macho_visitor_run\n");
+        return -1;
+    }
+
+    for (size_t i = 0; i < visitor->subscription_count; i++) {
+        visitor->subscriptions[i].done = false;
+    }
+
+    size_t active = visitor->subscription_count;
+    const struct load_command *cmd = mach_o_file->commands;
+    for (uint32_t i = 0; active > 0 && i < mach_o_file->load_command_count; i++) {
+        uint32_t type = macho_command_type(mach_o_file, cmd);
+        for (int index = *subscription_head(visitor, type); index >= 0;) {
+            MachOCommandSubscription *subscription = &visitor->subscriptions[index];
+            index = subscription->next;
+            if (subscription->done || subscription->cmd != type) {
+                continue;
+            }
+
+            int rc = subscription->handler(mach_o_file, cmd, subscription->context);
+            if (rc < 0) {
+                return -1;
+            }
+            if (rc == MACHO_VISIT_DONE) {
+                subscription->done = true;
+                active--;
+            }
+        }
+        cmd = macho_next_command(mach_o_file, cmd);
+    }
+
+    int rc = 0;
+    for (size_t i = 0; i < visitor->finisher_count; i++) {
+        if (visitor->finishers[i].finish(mach_o_file, visitor->finishers[i].context) != 0) {
+            rc = -1;
+        }
+    }
+    return rc;
+}
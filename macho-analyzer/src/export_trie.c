@@ -0,0 +1,292 @@
+#include "export_trie.h"
+#include "command_visitor.h"
+#include "leb128.h"
+#include "macho_types.h"
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * Команды, в которых может лежать дерево экспорта.
+ */
+typedef struct {
+    const struct linkedit_data_command *exports_trie;
+    const struct dyld_info_command *dyld_info;
+} ExportCommands;
+
+static int visit_exports_trie(const MachOFile *mach_o_file, const struct load_command *cmd, void *context) {
+    if (macho_command_size(mach_o_file, cmd) < sizeof(struct linkedit_data_command)) {
+        return MACHO_VISIT_CONTINUE;
+    }
+    ((ExportCommands *)context)->exports_trie = (const struct linkedit_data_command *)cmd;
+    return MACHO_VISIT_DONE;
+}
+
+static int visit_dyld_info(const MachOFile *mach_o_file, const struct load_command *cmd, void *context) {
+    if (macho_command_size(mach_o_file, cmd) < sizeof(struct dyld_info_command)) {
+        return MACHO_VISIT_CONTINUE;
+    }
+    ((ExportCommands *)context)->dyld_info = (const struct dyld_info_command *)cmd;
+    return MACHO_VISIT_DONE;
+}
+
+int macho_get_export_trie(const MachOFile *mach_o_file, MachOExportTrie *trie) {
+    if (!mach_o_file || !mach_o_file->commands || !trie) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в macho_get_export_trie\n");
+        return -1;
+    }
+    trie->data = NULL;
+    trie->size = 0;
+
+    ExportCommands commands = {NULL, NULL};
+    MachOCommandVisitor visitor;
+    macho_visitor_init(&visitor);
+    if (macho_visitor_subscribe(&visitor, LC_DYLD_EXPORTS_TRIE, visit_exports_trie, &commands) != 0 ||
+        macho_visitor_subscribe(&visitor, LC_DYLD_INFO, visit_dyld_info, &commands) != 0 ||
+        macho_visitor_subscribe(&visitor, LC_DYLD_INFO_ONLY, visit_dyld_info, &commands) != 0 ||
+        macho_visitor_run(&visitor, mach_o_file) != 0) {
+        return -1;
+    }
+
+    uint32_t offset;
+    uint32_t size;
+    if (commands.exports_trie) {
+        offset = macho_get32(mach_o_file, commands.exports_trie->dataoff);
+        size = macho_get32(mach_o_file, commands.exports_trie->datasize);
+    } else if (commands.dyld_info) {
+        offset = macho_get32(mach_o_file, commands.dyld_info->export_off);
+        size = macho_get32(mach_o_file, commands.dyld_info->export_size);
+    } else {
+        return 0; // Экспорта нет
+    }
+    if (size == 0) {
+        return 0;
+    }
+
+    trie->data = macho_file_slice(mach_o_file, offset, size);
+    if (!trie->data) {
+        fprintf(stderr, "Ошибка: Дерево экспорта выходит за границы файла\n");
+        return -1;
+    }
+    trie->size = size;
+    return 0;
+}
+
+/**
+ * Разбирает начало узла: размер сведений об экспорте и количество рёбер.
+ *
+ * @param trie Дерево экспорта.
+ * @param node Смещение узла.
+ * @param info Начало сведений об экспорте.
+ * @param info_size Размер сведений (0 — узел не описывает экспорт).
+ * @param children Смещение первого ребра.
+ * @param child_count Количество рёбер.
+ * @return 0 при успехе, -1 если узел выходит за дерево.
+ */
+static int read_node(const MachOExportTrie *trie, uint32_t node, const uint8_t **info, uint64_t *info_size,
+                     uint32_t *children, uint32_t *child_count) {
+    const uint8_t *end = trie->data + trie->size;
+    const uint8_t *p = trie->data + node;
+    if (node >= trie->size || macho_read_uleb128(&p, end, info_size) != 0 ||
+        *info_size >= (uint64_t)(end - p)) {
+        return -1;
+    }
+    *info = p;
+    p += *info_size;
+    *child_count = *p++;
+    *children = (uint32_t)(p - trie->data);
+    return 0;
+}
+
+/**
+ * Разбирает сведения об экспорте узла.
+ *
+ * @return 0 при успехе, -1 если сведения повреждены.
+ */
+static int read_export(const uint8_t *info, uint64_t info_size, const char *name, MachOExport *export) {
+    const uint8_t *p = info;
+    const uint8_t *end = info + info_size;
+    memset(export, 0, sizeof(MachOExport));
+    export->name = name;
+    if (macho_read_uleb128(&p, end, &export->flags) != 0) {
+        return -1;
+    }
+
+    if (export->flags & EXPORT_SYMBOL_FLAGS_REEXPORT) {
+        if (macho_read_uleb128(&p, end, &export->ordinal) != 0 || !memchr(p, '\0', (size_t)(end - p))) {
+            return -1;
+        }
+        export->import_name = (const char *)p;
+        return 0;
+    }
+
+    if (macho_read_uleb128(&p, end, &export->address) != 0) {
+        return -1;
+    }
+    if ((export->flags & EXPORT_SYMBOL_FLAGS_STUB_AND_RESOLVER) &&
+        macho_read_uleb128(&p, end, &export->resolver) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Читает ребро: подпись (непустая строка) и смещение дочернего узла.
+ *
+ * @param trie Дерево экспорта.
+ * @param cursor Смещение ребра; сдвигается на следующее ребро.
+ * @param label Подпись ребра.
+ * @param label_length Длина подписи.
+ * @param child Смещение дочернего узла.
+ * @return 0 при успехе, -1 если ребро повреждено.
+ */
+static int read_edge(const MachOExportTrie *trie, uint32_t *cursor, const char **label, size_t *label_length,
+                     uint32_t *child) {
+    const uint8_t *end = trie->data + trie->size;
+    const uint8_t *p = trie->data + *cursor;
+    const uint8_t *nul = *cursor < trie->size ? memchr(p, '\0', (size_t)(end - p)) : NULL;
+    if (!nul || nul == p) {
+        return -1;
+    }
+    *label = (const char *)p;
+    *label_length = (size_t)(nul - p);
+
+    p = nul + 1;
+    uint64_t offset;
+    if (macho_read_uleb128(&p, end, &offset) != 0 || offset >= trie->size) {
+        return -1;
+    }
+    *child = (uint32_t)offset;
+    *cursor = (uint32_t)(p - trie->data);
+    return 0;
+}
+
+int macho_export_trie_find(const MachOExportTrie *trie, const char *name, MachOExport *export) {
+    if (!trie || !name || !export) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в macho_export_trie_find\n");
+        return -1;
+    }
+    if (!trie->data) {
+        return 0;
+    }
+
+    // Каждое ребро непустое, поэтому спуск не длиннее имени
+    const char *rest = name;
+    uint32_t node = 0;
+    for (;;) {
+        const uint8_t *info;
+        uint64_t info_size;
+        uint32_t cursor;
+        uint32_t child_count;
+        if (read_node(trie, node, &info, &info_size, &cursor, &child_count) != 0) {
+            fprintf(stderr, "Ошибка: Повреждённый узел дерева экспорта по смещению %u\n", node);
+            return -1;
+        }
+        if (*rest == '\0') {
+            if (info_size == 0) {
+                return 0;
+            }
+            if (read_export(info, info_size, name, export) != 0) {
+                fprintf(stderr, "Ошибка: Повреждённые сведения об экспорте %s\n", name);
+                return -1;
+            }
+            return 1;
+        }
+
+        bool descended = false;
+        for (uint32_t i = 0; i < child_count && !descended; i++) {
+            const char *label;
+            size_t label_length;
+            uint32_t child;
+            if (read_edge(trie, &cursor, &label, &label_length, &child) != 0) {
+                fprintf(stderr, "Ошибка: Повреждённое ребро дерева экспорта по смещению %u\n", cursor);
+                return -1;
+            }
+            // Подписи рёбер одного узла начинаются с разных символов
+            if (strncmp(rest, label, label_length) == 0) {
+                rest += label_length;
+                node = child;
+                descended = true;
+            }
+        }
+        if (!descended) {
+            return 0;
+        }
+    }
+}
+
+void macho_export_iterator_init(MachOExportIterator *iterator, const MachOExportTrie *trie) {
+    iterator->trie = *trie;
+    iterator->depth = 0;
+    iterator->pending_node = 0;
+    iterator->pending_length = 0;
+    iterator->has_pending = trie->data != NULL && trie->size > 0;
+    iterator->visited = 0;
+    iterator->name[0] = '\0';
+}
+
+int macho_export_iterator_next(MachOExportIterator *iterator, MachOExport *export) {
+    if (!iterator || !export) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в macho_export_iterator_next\n");
+        return -1;
+    }
+    const MachOExportTrie *trie = &iterator->trie;
+
+    for (;;) {
+        if (iterator->has_pending) {
+            iterator->has_pending = false;
+            uint32_t node = iterator->pending_node;
+
+            // В дереве каждый узел достижим один раз; больше узлов, чем байт, бывает только в цикле
+            if (++iterator->visited > trie->size || iterator->depth == MACHO_EXPORT_TRIE_MAX_DEPTH) {
+                fprintf(stderr, "Ошибка: Цикл или слишком глубокое дерево экспорта\n");
+                return -1;
+            }
+            const uint8_t *info;
+            uint64_t info_size;
+            MachOExportFrame *frame = &iterator->stack[iterator->depth];
+            if (read_node(trie, node, &info, &info_size, &frame->cursor, &frame->children_left) != 0) {
+                fprintf(stderr, "Ошибка: Повреждённый узел дерева экспорта по смещению %u\n", node);
+                return -1;
+            }
+            frame->name_length = iterator->pending_length;
+            iterator->depth++;
+
+            if (info_size > 0) {
+                if (read_export(info, info_size, iterator->name, export) != 0) {
+                    fprintf(stderr, "Ошибка: Повреждённые сведения об экспорте %s\n", iterator->name);
+                    return -1;
+                }
+                return 1;
+            }
+            continue;
+        }
+
+        if (iterator->depth == 0) {
+            return 0;
+        }
+        MachOExportFrame *frame = &iterator->stack[iterator->depth - 1];
+        if (frame->children_left == 0) {
+            iterator->depth--;
+            continue;
+        }
+
+        const char *label;
+        size_t label_length;
+        uint32_t child;
+        if (read_edge(trie, &frame->cursor, &label, &label_length, &child) != 0) {
+            fprintf(stderr, "Ошибка: Повреждённое ребро дерева экспорта по смещению %u\n", frame->cursor);
+            return -1;
+        }
+        if (frame->name_length + label_length >= MACHO_EXPORT_NAME_MAX) {
+            fprintf(stderr, "Ошибка: Слишком длинное имя экспорта\n");
+            return -1;
+        }
+        memcpy(iterator->name + frame->name_length, label, label_length);
+        iterator->name[frame->name_length + label_length] = '\0';
+        frame->children_left--;
+
+        iterator->pending_node = child;
+        iterator->pending_length = frame->name_length + (uint32_t)label_length;
+        iterator->has_pending = true;
+    }
+}
@@ -0,0 +1,135 @@
+#include "function_starts.h"
+#include "command_visitor.h"
+#include "leb128.h"
+#include "macho_types.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int visit_function_starts(const MachOFile *mach_o_file, const struct load_command *cmd, void *context) {
+    if (macho_command_size(mach_o_file, cmd) < sizeof(struct linkedit_data_command)) {
+        return MACHO_VISIT_CONTINUE;
+    }
+    *(const struct linkedit_data_command **)context = (const struct linkedit_data_command *)cmd;
+    return MACHO_VISIT_DONE;
+}
+
+/**
+ * Возвращает адрес начала сегмента __TEXT, от которого отсчитывается первая разность.
+ */
+static uint64_t text_segment_address(const MachOFile *mach_o_file) {
+    for (uint32_t i = 0; i < mach_o_file->segment_count; i++) {
+        if (strcmp(mach_o_file->segments[i].segname, "__TEXT") == 0) {
+            return mach_o_file->segments[i].vmaddr;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Декодирует LC_FUNCTION_STARTS.
+ */
+static MachOFunctionStarts *build_function_starts(const MachOFile *mach_o_file) {
+    const struct linkedit_data_command *starts_cmd = NULL;
+    MachOCommandVisitor visitor;
+    macho_visitor_init(&visitor);
+    if (macho_visitor_subscribe(&visitor, LC_FUNCTION_STARTS, visit_function_starts, &starts_cmd) != 0 ||
+        macho_visitor_run(&visitor, mach_o_file) != 0) {
+        return NULL;
+    }
+
+    MachOFunctionStarts *starts = calloc(1, sizeof(MachOFunctionStarts));
+    if (!starts) {
+        fprintf(stderr, "Ошибка: Не удалось выделить память для адресов функций\n");
+        return NULL;
+    }
+    const MachOSection *text = macho_find_section(mach_o_file, "__TEXT", "__text");
+    starts->text_end = text ? text->addr + text->size : 0;
+
+    uint32_t datasize = starts_cmd ? macho_get32(mach_o_file, starts_cmd->datasize) : 0;
+    if (datasize == 0) {
+        return starts; // Пустая таблица: команды нет
+    }
+    const uint8_t *data = macho_file_slice(mach_o_file, macho_get32(mach_o_file, starts_cmd->dataoff), datasize);
+    if (!data) {
+        fprintf(stderr, "Ошибка: Данные LC_FUNCTION_STARTS выходят за границы файла\n");
+        free(starts);
+        return NULL;
+    }
+
+    // Каждое число занимает хотя бы байт, поэтому datasize адресов всегда достаточно
+    uint64_t *addresses = malloc((size_t)datasize * sizeof(uint64_t));
+    size_t count = 0;
+    if (!addresses) {
+        fprintf(stderr, "Ошибка: Не удалось выделить память для адресов функций\n");
+        free(starts);
+        return NULL;
+    }
+    if (macho_decode_uleb128_run(data, datasize, addresses, datasize, &count) != 0) {
+        fprintf(stderr, "Ошибка: Повреждённые данные LC_FUNCTION_STARTS\n");
+        free(addresses);
+        free(starts);
+        return NULL;
+    }
+
+    uint64_t address = text_segment_address(mach_o_file);
+    for (size_t i = 0; i < count; i++) {
+        address += addresses[i];
+        addresses[i] = address;
+    }
+
+    // Лишнее место возвращается только если его заметно больше нужного
+    if (count < datasize / 2) {
+        uint64_t *shrunk = realloc(addresses, (count ? count : 1) * sizeof(uint64_t));
+        if (shrunk) {
+            addresses = shrunk;
+        }
+    }
+    starts->addresses = addresses;
+    starts->count = (uint32_t)count;
+    return starts;
+}
+
+const MachOFunctionStarts *macho_get_function_starts(const MachOFile *mach_o_file) {
+    if (!mach_o_file || !mach_o_file->commands) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в macho_get_function_starts\n");
+        return NULL;
+    }
+
+    // Кеш не меняет наблюдаемого состояния MachOFile, поэтому const снимается
+    MachOFile *cache = (MachOFile *)mach_o_file;
+    MachOFunctionStarts *starts = __atomic_load_n(&cache->function_starts, __ATOMIC_ACQUIRE);
+    if (starts || (__atomic_load_n(&cache->cache_failed, __ATOMIC_ACQUIRE) & MACHO_CACHE_FUNCTION_STARTS)) {
+        return starts;
+    }
+
+    starts = build_function_starts(mach_o_file);
+    if (!starts) {
+        __atomic_fetch_or(&cache->cache_failed, MACHO_CACHE_FUNCTION_STARTS, __ATOMIC_RELEASE);
+        return NULL;
+    }
+    MachOFunctionStarts *published = NULL;
+    if (!__atomic_compare_exchange_n(&cache->function_starts, &published, starts, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        // Другой поток построил кеш раньше: используется его результат
+        macho_function_starts_free(starts);
+        starts = published;
+    }
+    return starts;
+}
+
+uint64_t macho_function_size(const MachOFunctionStarts *starts, uint32_t index) {
+    if (!starts || index >= starts->count) {
+        return 0;
+    }
+    uint64_t end = index + 1 < starts->count ? starts->addresses[index + 1] : starts->text_end;
+    return end > starts->addresses[index] ? end - starts->addresses[index] : 0;
+}
+
+void macho_function_starts_free(MachOFunctionStarts *starts) {
+    if (!starts) {
+        return;
+    }
+    free(starts->addresses);
+    free(starts);
+}
@@ -0,0 +1,420 @@
+#include "import_table.h"
+#include "command_visitor.h"
+#include "hash_table.h"
+#include "leb128.h"
+#include "macho_types.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Размер записи таблицы импортов цепочек фиксапов по формату
+#define CHAINED_IMPORT_SIZE          4
+#define CHAINED_IMPORT_ADDEND_SIZE   8
+#define CHAINED_IMPORT_ADDEND64_SIZE 16
+
+/**
+ * Состояние построения таблицы: имена импортов уже добавленных символов.
+ */
+typedef struct {
+    const MachOFile *mach_o_file;
+    MachOImportTable *table;
+    uint32_t capacity;
+    HashTable *names;  // Имя символа -> номер импорта + 1
+} ImportBuilder;
+
+static int visit_dyld_info(const MachOFile *mach_o_file, const struct load_command *cmd, void *context) {
+    if (macho_command_size(mach_o_file, cmd) < sizeof(struct dyld_info_command)) {
+        return MACHO_VISIT_CONTINUE;
+    }
+    ((MachOImportCommands *)context)->dyld_info = (const struct dyld_info_command *)cmd;
+    return MACHO_VISIT_DONE;
+}
+
+static int visit_chained_fixups(const MachOFile *mach_o_file, const struct load_command *cmd, void *context) {
+    if (macho_command_size(mach_o_file, cmd) < sizeof(struct linkedit_data_command)) {
+        return MACHO_VISIT_CONTINUE;
+    }
+    ((MachOImportCommands *)context)->chained_fixups = (const struct linkedit_data_command *)cmd;
+    return MACHO_VISIT_DONE;
+}
+
+/**
+ * Возвращает имя библиотеки по ordinal или NULL для особых и неверных номеров.
+ */
+static const char *library_name(const MachOFile *mach_o_file, int32_t ordinal) {
+    if (ordinal < 1 || (uint32_t)ordinal > mach_o_file->dylib_count) {
+        return NULL;
+    }
+    return mach_o_file->dylibs[ordinal - 1].name;
+}
+
+/**
+ * Добавляет импорт или объединяет его с уже добавленным символом того же имени:
+ * символ остаётся слабым и ленивым, только если слабы и ленивы все его привязки.
+ *
+ * @return 0 при успехе, -1 если не удалось выделить память.
+ */
+static int add_import(ImportBuilder *builder, const char *name, int32_t ordinal, bool weak, bool lazy) {
+    uintptr_t position = (uintptr_t)hash_table_get(builder->names, name);
+    if (position != 0) {
+        MachOImport *existing = &builder->table->imports[position - 1];
+        existing->weak &= weak;
+        existing->lazy &= lazy;
+        return 0;
+    }
+
+    MachOImportTable *table = builder->table;
+    if (table->count == builder->capacity) {
+        uint32_t capacity = builder->capacity ? builder->capacity * 2 : 64;
+        MachOImport *imports = realloc(table->imports, (size_t)capacity * sizeof(MachOImport));
+        if (!imports) {
+            fprintf(stderr, "Ошибка: Не удалось выделить память для таблицы импортов\n");
+            return -1;
+        }
+        table->imports = imports;
+        builder->capacity = capacity;
+    }
+
+    MachOImport *import = &table->imports[table->count];
+    import->name = name;
+    import->library = library_name(builder->mach_o_file, ordinal);
+    import->ordinal = ordinal;
+    import->weak = weak;
+    import->lazy = lazy;
+    if (!hash_table_insert(builder->names, name, (void *)(uintptr_t)(table->count + 1))) {
+        fprintf(stderr, "Ошибка: Не удалось добавить импорт в таблицу\n");
+        return -1;
+    }
+    table->count++;
+    return 0;
+}
+
+/**
+ * Выполняет поток опкодов привязки и добавляет каждый привязываемый символ.
+ * Адреса привязки не вычисляются: для списка импортов важны только символ,
+ * библиотека и флаги. BIND_OPCODE_DONE не завершает поток, потому что в
+ * lazy bind им разделяются записи отдельных символов.
+ *
+ * @param builder Состояние построения.
+ * @param data Начало потока.
+ * @param size Размер потока.
+ * @param lazy Поток lazy bind.
+ * @return 0 при успехе, -1 при повреждённом потоке или нехватке памяти.
+ */
+static int parse_bind_opcodes(ImportBuilder *builder, const uint8_t *data, uint32_t size, bool lazy) {
+    const uint8_t *p = data;
+    const uint8_t *end = data + size;
+    const char *name = NULL;
+    int32_t ordinal = 0;
+    bool weak = false;
+    uint64_t value;
+    int64_t addend;
+
+    while (p < end) {
+        uint8_t opcode = *p & BIND_OPCODE_MASK;
+        uint8_t immediate = *p & BIND_IMMEDIATE_MASK;
+        p++;
+
+        int rc = 0;
+        bool bind = false;
+        switch (opcode) {
+            case BIND_OPCODE_DONE:
+            case BIND_OPCODE_SET_TYPE_IMM:
+                break;
+            case BIND_OPCODE_SET_DYLIB_ORDINAL_IMM:
+                ordinal = immediate;
+                break;
+            case BIND_OPCODE_SET_DYLIB_ORDINAL_ULEB:
+                rc = macho_read_uleb128(&p, end, &value);
+                if (rc == 0 && value > INT32_MAX) {
+                    rc = -1;
+                }
+                ordinal = (int32_t)value;
+                break;
+            case BIND_OPCODE_SET_DYLIB_SPECIAL_IMM:
+                // Непосредственное значение — отрицательное число в 4 битах
+                ordinal = immediate ? (int8_t)(BIND_OPCODE_MASK | immediate) : BIND_SPECIAL_DYLIB_SELF;
+                break;
+            case BIND_OPCODE_SET_SYMBOL_TRAILING_FLAGS_IMM: {
+                const uint8_t *nul = memchr(p, '\0', (size_t)(end - p));
+                if (!nul) {
+                    rc = -1;
+                    break;
+                }
+                name = (const char *)p;
+                weak = (immediate & BIND_SYMBOL_FLAGS_WEAK_IMPORT) != 0;
+                p = nul + 1;
+                break;
+            }
+            case BIND_OPCODE_SET_ADDEND_SLEB:
+                rc = macho_read_sleb128(&p, end, &addend);
+                break;
+            case BIND_OPCODE_SET_SEGMENT_AND_OFFSET_ULEB:
+            case BIND_OPCODE_ADD_ADDR_ULEB:
+                rc = macho_read_uleb128(&p, end, &value);
+                break;
+            case BIND_OPCODE_DO_BIND:
+            case BIND_OPCODE_DO_BIND_ADD_ADDR_IMM_SCALED:
+                bind = true;
+                break;
+            case BIND_OPCODE_DO_BIND_ADD_ADDR_ULEB:
+                rc = macho_read_uleb128(&p, end, &value);
+                bind = true;
+                break;
+            case BIND_OPCODE_DO_BIND_ULEB_TIMES_SKIPPING_ULEB: {
+                uint64_t count;
+                rc = macho_read_uleb128(&p, end, &count);
+                if (rc == 0) {
+                    rc = macho_read_uleb128(&p, end, &value);
+                }
+                bind = count > 0;
+                break;
+            }
+            case BIND_OPCODE_THREADED:
+                if (immediate == BIND_SUBOPCODE_THREADED_SET_BIND_ORDINAL_TABLE_SIZE_ULEB) {
+                    rc = macho_read_uleb128(&p, end, &value);
+                } else if (immediate != BIND_SUBOPCODE_THREADED_APPLY) {
+                    rc = -1;
+                }
+                break;
+            default:
+                rc = -1;
+                break;
+        }
+
+        if (rc != 0) {
+            fprintf(stderr, "Ошибка: Повреждённый опкод привязки 0x%02x по смещению %ld\n",
+                    opcode | immediate, (long)(p - data));
+            return -1;
+        }
+        if (bind) {
+            if (!name) {
+                fprintf(stderr, "Ошибка: Привязка без имени символа\n");
+                return -1;
+            }
+            if (add_import(builder, name, ordinal, weak, lazy) != 0) {
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * Добавляет импорты из опкодов bind и lazy bind команды LC_DYLD_INFO(_ONLY).
+ * Поток weak bind не читается: в нём перечислены слабые определения для
+ * объединения между образами, а не импорты из конкретных библиотек.
+ */
+static int parse_dyld_info(ImportBuilder *builder, const struct dyld_info_command *dyld_info) {
+    const MachOFile *mach_o_file = builder->mach_o_file;
+    uint32_t bind_size = macho_get32(mach_o_file, dyld_info->bind_size);
+    uint32_t lazy_bind_size = macho_get32(mach_o_file, dyld_info->lazy_bind_size);
+    const uint8_t *bind = macho_file_slice(mach_o_file, macho_get32(mach_o_file, dyld_info->bind_off), bind_size);
+    const uint8_t *lazy_bind = macho_file_slice(mach_o_file, macho_get32(mach_o_file, dyld_info->lazy_bind_off),
+                                                lazy_bind_size);
+    if ((bind_size && !bind) || (lazy_bind_size && !lazy_bind)) {
+        fprintf(stderr, "Ошибка: Опкоды привязки выходят за границы файла\n");
+        return -1;
+    }
+
+    if (bind_size && parse_bind_opcodes(builder, bind, bind_size, false) != 0) {
+        return -1;
+    }
+    if (lazy_bind_size && parse_bind_opcodes(builder, lazy_bind, lazy_bind_size, true) != 0) {
+        return -1;
+    }
+    builder->table->source = MACHO_IMPORTS_DYLD_INFO;
+    return 0;
+}
+
+/**
+ * Добавляет импорты из таблицы импортов LC_DYLD_CHAINED_FIXUPS.
+ * Имена, сжатые zlib, не распаковываются: таблица остаётся с источником
+ * MACHO_IMPORTS_NONE, и проверки используют индекс символов.
+ */
+static int parse_chained_fixups(ImportBuilder *builder, const struct linkedit_data_command *fixups_cmd) {
+    const MachOFile *mach_o_file = builder->mach_o_file;
+    uint32_t size = macho_get32(mach_o_file, fixups_cmd->datasize);
+    const uint8_t *data = macho_file_slice(mach_o_file, macho_get32(mach_o_file, fixups_cmd->dataoff), size);
+    if (!data || size < sizeof(struct dyld_chained_fixups_header)) {
+        fprintf(stderr, "Ошибка: Данные цепочек фиксапов выходят за границы файла\n");
+        return -1;
+    }
+
+    struct dyld_chained_fixups_header header;
+    memcpy(&header, data, sizeof(header));
+    uint32_t imports_offset = macho_get32(mach_o_file, header.imports_offset);
+    uint32_t symbols_offset = macho_get32(mach_o_file, header.symbols_offset);
+    uint32_t imports_count = macho_get32(mach_o_file, header.imports_count);
+    uint32_t imports_format = macho_get32(mach_o_file, header.imports_format);
+    if (macho_get32(mach_o_file, header.symbols_format) != 0) {
+        return 0;
+    }
+
+    size_t entry_size;
+    switch (imports_format) {
+        case DYLD_CHAINED_IMPORT:
+            entry_size = CHAINED_IMPORT_SIZE;
+            break;
+        case DYLD_CHAINED_IMPORT_ADDEND:
+            entry_size = CHAINED_IMPORT_ADDEND_SIZE;
+            break;
+        case DYLD_CHAINED_IMPORT_ADDEND64:
+            entry_size = CHAINED_IMPORT_ADDEND64_SIZE;
+            break;
+        default:
+            fprintf(stderr, "Ошибка: Неизвестный формат импортов цепочек фиксапов %u\n", imports_format);
+            return -1;
+    }
+    if (imports_offset > size || (uint64_t)imports_count * entry_size > size - imports_offset ||
+        symbols_offset > size) {
+        fprintf(stderr, "Ошибка: Таблица импортов выходит за данные цепочек фиксапов\n");
+        return -1;
+    }
+
+    const uint8_t *entry = data + imports_offset;
+    for (uint32_t i = 0; i < imports_count; i++, entry += entry_size) {
+        int32_t ordinal;
+        bool weak;
+        uint32_t name_offset;
+        if (imports_format == DYLD_CHAINED_IMPORT_ADDEND64) {
+            uint64_t raw;
+            memcpy(&raw, entry, sizeof(raw));
+            raw = macho_get64(mach_o_file, raw);
+            uint32_t library = raw & 0xffff;
+            ordinal = library > 0xfff0 ? (int16_t)library : (int32_t)library;
+            weak = (raw >> 16) & 1;
+            name_offset = (uint32_t)(raw >> 32);
+        } else {
+            uint32_t raw;
+            memcpy(&raw, entry, sizeof(raw));
+            raw = macho_get32(mach_o_file, raw);
+            uint32_t library = raw & 0xff;
+            ordinal = library > 0xf0 ? (int8_t)library : (int32_t)library;
+            weak = (raw >> 8) & 1;
+            name_offset = raw >> 9;
+        }
+
+        uint32_t available = size - symbols_offset;
+        const char *name = (const char *)data + symbols_offset + name_offset;
+        if (name_offset >= available || !memchr(name, '\0', available - name_offset)) {
+            fprintf(stderr, "Ошибка: Неверное имя импорта %u в цепочках фиксапов\n", i);
+            return -1;
+        }
+        if (add_import(builder, name, ordinal, weak, false) != 0) {
+            return -1;
+        }
+    }
+    builder->table->source = MACHO_IMPORTS_CHAINED_FIXUPS;
+    return 0;
+}
+
+/**
+ * Строит таблицу импортов Mach-O файла.
+ */
+static MachOImportTable *build_import_table(const MachOFile *mach_o_file, const MachOImportCommands *found) {
+    MachOImportCommands commands = {NULL, NULL};
+    if (found) {
+        commands = *found;
+    } else {
+        MachOCommandVisitor visitor;
+        macho_visitor_init(&visitor);
+        if (macho_import_commands_subscribe(&visitor, &commands) != 0 ||
+            macho_visitor_run(&visitor, mach_o_file) != 0) {
+            return NULL;
+        }
+    }
+
+    MachOImportTable *table = calloc(1, sizeof(MachOImportTable));
+    if (!table) {
+        fprintf(stderr, "Ошибка: Не удалось выделить память для таблицы импортов\n");
+        return NULL;
+    }
+    if (!commands.dyld_info && !commands.chained_fixups) {
+        return table; // Пустая таблица: импорты нужно искать в таблице символов
+    }
+
+    ImportBuilder builder = {mach_o_file, table, 0, hash_table_create()};
+    if (!builder.names) {
+        fprintf(stderr, "Ошибка: Не удалось создать таблицу имён импортов\n");
+        free(table);
+        return NULL;
+    }
+
+    // Цепочки фиксапов заменяют опкоды привязки, поэтому имеют приоритет
+    int rc = commands.chained_fixups ? parse_chained_fixups(&builder, commands.chained_fixups)
+                                     : parse_dyld_info(&builder, commands.dyld_info);
+    hash_table_destroy(builder.names, NULL);
+    if (rc != 0) {
+        macho_import_table_free(table);
+        return NULL;
+    }
+    return table;
+}
+
+int macho_import_commands_subscribe(MachOCommandVisitor *visitor, MachOImportCommands *commands) {
+    if (!visitor || !commands) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в macho_import_commands_subscribe\n");
+        return -1;
+    }
+    commands->dyld_info = NULL;
+    commands->chained_fixups = NULL;
+    if (macho_visitor_subscribe(visitor, LC_DYLD_INFO, visit_dyld_info, commands) != 0 ||
+        macho_visitor_subscribe(visitor, LC_DYLD_INFO_ONLY, visit_dyld_info, commands) != 0 ||
+        macho_visitor_subscribe(visitor, LC_DYLD_CHAINED_FIXUPS, visit_chained_fixups, commands) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Возвращает таблицу из кеша или строит и публикует её.
+ *
+ * @param found Найденные команды или NULL, чтобы найти их самостоятельно.
+ */
+static const MachOImportTable *cached_import_table(const MachOFile *mach_o_file, const MachOImportCommands *found) {
+    // Кеш не меняет наблюдаемого состояния MachOFile, поэтому const снимается
+    MachOFile *cache = (MachOFile *)mach_o_file;
+    MachOImportTable *table = __atomic_load_n(&cache->import_table, __ATOMIC_ACQUIRE);
+    if (table || (__atomic_load_n(&cache->cache_failed, __ATOMIC_ACQUIRE) & MACHO_CACHE_IMPORT_TABLE)) {
+        return table;
+    }
+
+    table = build_import_table(mach_o_file, found);
+    if (!table) {
+        __atomic_fetch_or(&cache->cache_failed, MACHO_CACHE_IMPORT_TABLE, __ATOMIC_RELEASE);
+        return NULL;
+    }
+    MachOImportTable *published = NULL;
+    if (!__atomic_compare_exchange_n(&cache->import_table, &published, table, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        // Другой поток построил кеш раньше: используется его результат
+        macho_import_table_free(table);
+        table = published;
+    }
+    return table;
+}
+
+const MachOImportTable *macho_get_import_table(const MachOFile *mach_o_file) {
+    if (!mach_o_file || !mach_o_file->commands) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в macho_get_import_table\n");
+        return NULL;
+    }
+    return cached_import_table(mach_o_file, NULL);
+}
+
+const MachOImportTable *macho_get_import_table_from(const MachOFile *mach_o_file, const MachOImportCommands *commands) {
+    if (!mach_o_file || !mach_o_file->commands || !commands) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в macho_get_import_table_from\n");
+        return NULL;
+    }
+    return cached_import_table(mach_o_file, commands);
+}
+
+void macho_import_table_free(MachOImportTable *table) {
+    if (!table) {
+        return;
+    }
+    free(table->imports);
+    free(table);
+}
@@ -0,0 +1,316 @@
+#include "json_writer.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// Размер буфера по умолчанию
+#define JSON_WRITER_DEFAULT_BUFFER (64 * 1024)
+
+// Наибольшая длина числа в десятичной записи, включая знак
+#define JSON_NUMBER_MAX 32
+
+static const char hex_digits[] = "0123456789abcdef";
+
+int json_writer_init(JsonWriter *writer, FILE *out, size_t buffer_size) {
+    if (!writer || !out) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в json_writer_init\n");
+        return -1;
+    }
+    memset(writer, 0, sizeof(JsonWriter));
+    writer->capacity = buffer_size ? buffer_size : JSON_WRITER_DEFAULT_BUFFER;
+    if (writer->capacity < JSON_NUMBER_MAX) {
+        writer->capacity = JSON_NUMBER_MAX;
+    }
+    writer->buffer = malloc(writer->capacity);
+    if (!writer->buffer) {
+        fprintf(stderr, "Ошибка: Не удалось выделить память для буфера JSON\n");
+        return -1;
+    }
+    writer->out = out;
+    return 0;
+}
+
+int json_writer_flush(JsonWriter *writer) {
+    if (!writer || !writer->buffer) {
+        return -1;
+    }
+    if (writer->length > 0) {
+        if (fwrite(writer->buffer, 1, writer->length, writer->out) != writer->length) {
+            writer->error = true;
+        }
+        writer->length = 0;
+    }
+    if (fflush(writer->out) != 0) {
+        writer->error = true;
+    }
+    return writer->error ? -1 : 0;
+}
+
+int json_writer_close(JsonWriter *writer) {
+    if (!writer || !writer->buffer) {
+        return -1;
+    }
+    int rc = json_writer_flush(writer);
+    free(writer->buffer);
+    writer->buffer = NULL;
+    return rc;
+}
+
+/**
+ * Сбрасывает буфер в поток без fflush.
+ */
+static void drain(JsonWriter *writer) {
+    if (writer->length > 0 &&
+        fwrite(writer->buffer, 1, writer->length, writer->out) != writer->length) {
+        writer->error = true;
+    }
+    writer->length = 0;
+}
+
+static void put_bytes(JsonWriter *writer, const char *data, size_t size) {
+    if (writer->length + size > writer->capacity) {
+        drain(writer);
+        if (size > writer->capacity) {
+            // Большой фрагмент пишется напрямую, минуя буфер
+            if (fwrite(data, 1, size, writer->out) != size) {
+                writer->error = true;
+            }
+            return;
+        }
+    }
+    memcpy(writer->buffer + writer->length, data, size);
+    writer->length += size;
+}
+
+static inline void put_char(JsonWriter *writer, char c) {
+    if (writer->length == writer->capacity) {
+        drain(writer);
+    }
+    writer->buffer[writer->length++] = c;
+}
+
+/**
+ * Ставит запятую перед очередным элементом, если она нужна.
+ */
+static void begin_value(JsonWriter *writer) {
+    if (writer->after_key) {
+        writer->after_key = false;
+        return;
+    }
+    if (writer->depth > 0 && writer->need_comma[writer->depth]) {
+        put_char(writer, ',');
+    }
+    writer->need_comma[writer->depth] = true;
+}
+
+static void open_scope(JsonWriter *writer, char c) {
+    begin_value(writer);
+    if (writer->depth >= JSON_WRITER_MAX_DEPTH) {
+        writer->error = true;
+        return;
+    }
+    put_char(writer, c);
+    writer->depth++;
+    writer->need_comma[writer->depth] = false;
+}
+
+static void close_scope(JsonWriter *writer, char c) {
+    if (writer->depth == 0) {
+        writer->error = true;
+        return;
+    }
+    writer->depth--;
+    put_char(writer, c);
+}
+
+void json_begin_object(JsonWriter *writer) {
+    open_scope(writer, '{');
+}
+
+void json_end_object(JsonWriter *writer) {
+    close_scope(writer, '}');
+}
+
+void json_begin_array(JsonWriter *writer) {
+    open_scope(writer, '[');
+}
+
+void json_end_array(JsonWriter *writer) {
+    close_scope(writer, ']');
+}
+
+void json_end_record(JsonWriter *writer) {
+    put_char(writer, '\n');
+    writer->need_comma[0] = false;
+}
+
+/**
+ * Возвращает длину корректной последовательности UTF-8, начинающейся с s[0],
+ * или 0, если последовательность некорректна.
+ */
+static size_t utf8_sequence_length(const unsigned char *s, size_t available) {
+    unsigned char c = s[0];
+    size_t length;
+    unsigned char min = 0x80;
+    unsigned char max = 0xBF;
+
+    if (c >= 0xC2 && c <= 0xDF) {
+        length = 2;
+    } else if (c >= 0xE0 && c <= 0xEF) {
+        length = 3;
+        if (c == 0xE0) {
+            min = 0xA0;  // Избыточная запись
+        } else if (c == 0xED) {
+            max = 0x9F;  // Суррогаты
+        }
+    } else if (c >= 0xF0 && c <= 0xF4) {
+        length = 4;
+        if (c == 0xF0) {
+            min = 0x90;
+        } else if (c == 0xF4) {
+            max = 0x8F;
+        }
+    } else {
+        return 0;
+    }
+
+    if (length > available || s[1] < min || s[1] > max) {
+        return 0;
+    }
+    for (size_t i = 2; i < length; i++) {
+        if ((s[i] & 0xC0) != 0x80) {
+            return 0;
+        }
+    }
+    return length;
+}
+
+static void put_escaped(JsonWriter *writer, const char *value, size_t length) {
+    const unsigned char *s = (const unsigned char *)value;
+    size_t run = 0;  // Начало участка, не требующего экранирования
+
+    put_char(writer, '"');
+    for (size_t i = 0; i < length;) {
+        unsigned char c = s[i];
+        if (c >= 0x20 && c < 0x80 && c != '"' && c != '\\') {
+            i++;
+            continue;
+        }
+        if (c >= 0x80) {
+            size_t sequence = utf8_sequence_length(s + i, length - i);
+            if (sequence > 0) {
+                i += sequence;
+                continue;
+            }
+        }
+
+        put_bytes(writer, value + run, i - run);
+        char escape[6] = {'\\', 0, 0, 0, 0, 0};
+        size_t escape_length = 2;
+        switch (c) {
+            case '"': escape[1] = '"'; break;
+            case '\\': escape[1] = '\\'; break;
+            case '\n': escape[1] = 'n'; break;
+            case '\r': escape[1] = 'r'; break;
+            case '\t': escape[1] = 't'; break;
+            default:
+                escape[1] = 'u';
+                escape[2] = '0';
+                escape[3] = '0';
+                escape[4] = hex_digits[c >> 4];
+                escape[5] = hex_digits[c & 0xF];
+                escape_length = 6;
+                break;
+        }
+        put_bytes(writer, escape, escape_length);
+        i++;
+        run = i;
+    }
+    put_bytes(writer, value + run, length - run);
+    put_char(writer, '"');
+}
+
+void json_key(JsonWriter *writer, const char *key) {
+    begin_value(writer);
+    put_escaped(writer, key, strlen(key));
+    put_char(writer, ':');
+    writer->after_key = true;
+}
+
+void json_string(JsonWriter *writer, const char *value) {
+    if (!value) {
+        json_null(writer);
+        return;
+    }
+    begin_value(writer);
+    put_escaped(writer, value, strlen(value));
+}
+
+void json_string_n(JsonWriter *writer, const char *value, size_t length) {
+    if (!value) {
+        json_null(writer);
+        return;
+    }
+    const char *end = memchr(value, '\0', length);
+    begin_value(writer);
+    put_escaped(writer, value, end ? (size_t)(end - value) : length);
+}
+
+/**
+ * Записывает число без знака в десятичном виде справа налево.
+ *
+ * @return Указатель на первую цифру внутри buffer.
+ */
+static char *format_uint(char *end, uint64_t value) {
+    char *p = end;
+    do {
+        *--p = (char)('0' + value % 10);
+        value /= 10;
+    } while (value);
+    return p;
+}
+
+void json_uint(JsonWriter *writer, uint64_t value) {
+    char buffer[JSON_NUMBER_MAX];
+    char *end = buffer + sizeof(buffer);
+    char *start = format_uint(end, value);
+    begin_value(writer);
+    put_bytes(writer, start, (size_t)(end - start));
+}
+
+void json_int(JsonWriter *writer, int64_t value) {
+    char buffer[JSON_NUMBER_MAX];
+    char *end = buffer + sizeof(buffer);
+    uint64_t magnitude = value < 0 ? (uint64_t)0 - (uint64_t)value : (uint64_t)value;
+    char *start = format_uint(end, magnitude);
+    if (value < 0) {
+        *--start = '-';
+    }
+    begin_value(writer);
+    put_bytes(writer, start, (size_t)(end - start));
+}
+
+void json_double(JsonWriter *writer, double value) {
+    if (!isfinite(value)) {
+        json_null(writer);  // NaN и бесконечности в JSON не представимы
+        return;
+    }
+    char buffer[JSON_NUMBER_MAX];
+    int length = snprintf(buffer, sizeof(buffer), "%.17g", value);
+    begin_value(writer);
+    put_bytes(writer, buffer, (size_t)length);
+}
+
+void json_bool(JsonWriter *writer, bool value) {
+    begin_value(writer);
+    if (value) {
+        put_bytes(writer, "true", 4);
+    } else {
+        put_bytes(writer, "false", 5);
+    }
+}
+
+void json_null(JsonWriter *writer) {
+    begin_value(writer);
+    put_bytes(writer, "null", 4);
+}
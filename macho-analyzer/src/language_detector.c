@@ -1,8 +1,11 @@
 #include "language_detector.h"
+#include "symbol_index.h"
+#include "signature_scanner.h"
+#include "macho_types.h"
 #include <string.h>
 #include <stdlib.h>
-#include <mach-o/nlist.h>
 #include <stdio.h>
+#include <pthread.h>
 
 typedef struct {
     const char *segment_name;
@@ -135,22 +138,44 @@ static const SectionMapping section_mappings[] = {
         {"__DATA", "__scalanative_data",      "Scala",         "Scala Native"}
 };
 
+/**
+ * Сигнатура в строковых данных, указывающая на язык.
+ */
 typedef struct {
-    char detected_language_by_symbols[64];
-    char detected_compiler_by_symbols[64];
-    char detected_language_by_sections[64];
-    char detected_compiler_by_sections[64];
-    char detected_language_by_strings[64];
-    char detected_compiler_by_strings[64];
-    char final_language[64];
-    char final_compiler[64];
-} DetectionResults;
-
-typedef struct {
-    const char *prefix;
+    const char *needle;
     const char *language;
     const char *compiler;
-} SymbolMapping;
+} StringSignature;
+
+static const StringSignature string_signatures[] = {
+        {"go.buildid",             "Go",            "gc (Go compiler)"},
+        {"Go build ID",            "Go",            "gc (Go compiler)"},
+        {"Python",                 "Python",        "Cython or CPython"},
+        {"Py_InitModule",          "Python",        "Cython or CPython"},
+        {"Java",                   "Java",          "GraalVM Native Image"},
+        {"JNI",                    "Java",          "GraalVM Native Image"},
+        {"Kotlin",                 "Kotlin/Native", "Kotlin Native Compiler"},
+        {"kotlin.native.internal", "Kotlin/Native", "Kotlin Native Compiler"}
+};
+
+// Секции, которые есть почти в любом файле: их голос умножается на generic_factor
+static const char *const generic_sections[][2] = {
+        {"__TEXT", "__text"},
+        {"__TEXT", "__cstring"},
+        {"__TEXT", "__const"},
+        {"__TEXT", "__unwind_info"},
+        {"__DATA", "__data"},
+        {"__DATA", "__const"}
+};
+
+// Сколько совпавших префиксов одного символа учитывается при голосовании
+#define SYMBOL_MATCH_LIMIT 16
+
+// Максимальное число компиляторов, различаемых внутри одного языка
+#define LANGUAGE_COMPILERS_MAX 8
+
+// Через сколько символов проверяется порог досрочной остановки
+#define EARLY_STOP_INTERVAL 1024
 
 static const SymbolMapping symbol_mappings[] = {
         // C++
@@ -250,439 +275,427 @@ static const SymbolMapping symbol_mappings[] = {
 
         // Дополнительные ассемблеры
         {"nasm_",      "Assembly",      "NASM"},
-        {"fasm_",      "Assembly",      "FASM"}
+        {"nasm",       "Assembly",      "NASM"},
+        {"fasm_",      "Assembly",      "FASM"},
+        {"_fasm_",     "Assembly",      "FASM"}
 };
 
-/**
- * Анализирует символы в Mach-O файле для определения языка и компилятора.
- *
- * @param mach_o_file Указатель на структуру MachOFile.
- * @param file Указатель на открытый файл Mach-O.
- * @param lang_info Указатель на структуру LanguageInfo для записи результатов.
- * @return 0 при успехе, -1 при ошибке.
- */
-static int analyze_symbols(const MachOFile *mach_o_file, FILE *file, LanguageInfo *lang_info);
+// Классификатор по symbol_mappings, строится один раз на процесс
+static SymbolClassifier *default_classifier = NULL;
+static pthread_once_t default_classifier_once = PTHREAD_ONCE_INIT;
 
-/**
- * Анализирует секции в Mach-O файле для определения языка и компилятора.
- *
- * @param mach_o_file Указатель на структуру MachOFile.
- * @param lang_info Указатель на структуру LanguageInfo для записи результатов.
- * @return 0 при успехе, -1 при ошибке.
- */
-static int analyze_sections(const MachOFile *mach_o_file, LanguageInfo *lang_info);
+static void build_default_classifier(void) {
+    default_classifier = symbol_classifier_create(symbol_mappings, sizeof(symbol_mappings) / sizeof(SymbolMapping));
+}
 
-/**
- * Анализирует строки данных в Mach-O файле для определения языка и компилятора.
- *
- * @param mach_o_file Указатель на структуру MachOFile.
- * @param file Указатель на открытый файл Mach-O.
- * @param lang_info Указатель на структуру LanguageInfo для записи результатов.
- * @return 0 при успехе, -1 при ошибке.
- */
-static int analyze_strings(const MachOFile *mach_o_file, FILE *file, LanguageInfo *lang_info);
+SymbolClassifier *language_detector_symbol_classifier(void) {
+    pthread_once(&default_classifier_once, build_default_classifier);
+    return default_classifier;
+}
+
+// Сканер по string_signatures, строится один раз на процесс
+#define STRING_SIGNATURE_COUNT (sizeof(string_signatures) / sizeof(StringSignature))
+static const char *string_signature_needles[STRING_SIGNATURE_COUNT];
+static SignatureScanner *string_scanner = NULL;
+static pthread_once_t string_scanner_once = PTHREAD_ONCE_INIT;
+
+static void build_string_scanner(void) {
+    for (size_t i = 0; i < STRING_SIGNATURE_COUNT; i++) {
+        string_signature_needles[i] = string_signatures[i].needle;
+    }
+    string_scanner = signature_scanner_create(string_signature_needles, STRING_SIGNATURE_COUNT);
+}
+
+const SignatureScanner *language_detector_string_scanner(void) {
+    pthread_once(&string_scanner_once, build_string_scanner);
+    return string_scanner;
+}
+
+typedef enum {
+    EVIDENCE_SYMBOL,
+    EVIDENCE_SECTION,
+    EVIDENCE_STRING
+} EvidenceKind;
 
 /**
- * Проверяет секцию на соответствие языку и компилятору.
- *
- * @param segname Имя сегмента.
- * @param sectname Имя секции.
- * @param lang_info Указатель на структуру LanguageInfo для записи результатов.
- * @return 0 при совпадении, -1 если не найдено.
+ * Состояние голосования на время одного вызова detect_language_scores.
  */
-static int check_section(const char *segname, const char *sectname, LanguageInfo *lang_info);
+typedef struct {
+    LanguageScores *scores;
+    const LanguageDetectionOptions *options;
+    const char *compilers[LANGUAGE_SCORES_MAX][LANGUAGE_COMPILERS_MAX];
+    double compiler_weights[LANGUAGE_SCORES_MAX][LANGUAGE_COMPILERS_MAX];
+    int classifier_slots[SYMBOL_CLASSIFIER_MAX_LANGUAGES]; // Слот в scores для языка классификатора (-1 — ещё нет)
+} VoteState;
+
+void language_detection_default_options(LanguageDetectionOptions *options) {
+    if (!options) {
+        return;
+    }
+    options->symbol_weight = 1.0;
+    options->plain_c_weight = 0.05;
+    options->section_weight = 8.0;
+    options->generic_factor = 0.125;
+    options->string_weight = 4.0;
+    options->confidence = 0.95;
+    options->min_evidence = 256.0;
+}
 
 /**
- * Объединяет результаты анализа символов, секций и строк.
+ * Возвращает слот языка в векторе оценок, добавляя язык при необходимости.
  *
- * @param results Указатель на структуру DetectionResults.
+ * @return Индекс слота или -1, если вектор заполнен.
  */
-static void combine_results(DetectionResults *results);
-
-int detect_language_and_compiler(const MachOFile *mach_o_file, FILE *file, LanguageInfo *lang_info) {
-    if (!mach_o_file || !file || !lang_info) {
-        fprintf(stderr, "Ошибка: Неверные аргументы в detect_language_and_compiler\n");
+static int score_slot(VoteState *state, const char *language) {
+    LanguageScores *scores = state->scores;
+    for (size_t i = 0; i < scores->count; i++) {
+        if (strcmp(scores->entries[i].language, language) == 0) {
+            return (int)i;
+        }
+    }
+    if (scores->count >= LANGUAGE_SCORES_MAX) {
         return -1;
     }
+    LanguageScore *entry = &scores->entries[scores->count];
+    memset(entry, 0, sizeof(LanguageScore));
+    entry->language = language;
+    return (int)scores->count++;
+}
 
-    DetectionResults results = {0};
-    strcpy(results.detected_language_by_symbols, "Неизвестно");
-    strcpy(results.detected_compiler_by_symbols, "Неизвестно");
-    strcpy(results.detected_language_by_sections, "Неизвестно");
-    strcpy(results.detected_compiler_by_sections, "Неизвестно");
-    strcpy(results.detected_language_by_strings, "Неизвестно");
-    strcpy(results.detected_compiler_by_strings, "Неизвестно");
-    strcpy(results.final_language, "Неизвестно");
-    strcpy(results.final_compiler, "Неизвестно");
-
-    LanguageInfo temp_lang_info = {0};
-
-    if (analyze_symbols(mach_o_file, file, &temp_lang_info) == 0) {
-        strcpy(results.detected_language_by_symbols, temp_lang_info.language);
-        strcpy(results.detected_compiler_by_symbols, temp_lang_info.compiler);
+/**
+ * Добавляет вес свидетельства к языку и к его компилятору.
+ */
+static void vote_slot(VoteState *state, int slot, const char *compiler, double weight, EvidenceKind kind) {
+    if (slot < 0 || weight <= 0.0) {
+        return;
     }
 
-    if (analyze_sections(mach_o_file, &temp_lang_info) == 0) {
-        strcpy(results.detected_language_by_sections, temp_lang_info.language);
-        strcpy(results.detected_compiler_by_sections, temp_lang_info.compiler);
+    LanguageScore *entry = &state->scores->entries[slot];
+    entry->score += weight;
+    state->scores->total += weight;
+    switch (kind) {
+        case EVIDENCE_SYMBOL:
+            entry->symbol_hits++;
+            break;
+        case EVIDENCE_SECTION:
+            entry->section_hits++;
+            break;
+        case EVIDENCE_STRING:
+            entry->string_hits++;
+            break;
     }
 
-    if (analyze_strings(mach_o_file, file, &temp_lang_info) == 0) {
-        strcpy(results.detected_language_by_strings, temp_lang_info.language);
-        strcpy(results.detected_compiler_by_strings, temp_lang_info.compiler);
+    const char **compilers = state->compilers[slot];
+    double *weights = state->compiler_weights[slot];
+    for (size_t i = 0; i < LANGUAGE_COMPILERS_MAX; i++) {
+        if (!compilers[i]) {
+            compilers[i] = compiler;
+        }
+        if (compilers[i] == compiler || strcmp(compilers[i], compiler) == 0) {
+            weights[i] += weight;
+            return;
+        }
     }
+}
 
-    combine_results(&results);
-
-    strcpy(lang_info->language, results.final_language);
-    strcpy(lang_info->compiler, results.final_compiler);
-
-    return 0;
+static void vote(VoteState *state, const char *language, const char *compiler, double weight, EvidenceKind kind) {
+    vote_slot(state, score_slot(state, language), compiler, weight, kind);
 }
 
-static int analyze_symbols(const MachOFile *mach_o_file, FILE *file, LanguageInfo *lang_info) {
-    if (!mach_o_file || !file || !lang_info) {
-        fprintf(stderr, "Ошибка: Неверные аргументы в analyze_symbols\n");
-        return -1;
+/**
+ * Проверяет, достигнут ли порог уверенности для досрочной остановки.
+ */
+static bool confident_enough(const VoteState *state) {
+    const LanguageScores *scores = state->scores;
+    if (scores->total <= 0.0 || scores->total < state->options->min_evidence) {
+        return false;
     }
-
-    struct symtab_command *symtab_cmd = NULL;
-    struct load_command *cmd = mach_o_file->commands;
-    uint32_t ncmds = mach_o_file->load_command_count; // Исправлено: command_count -> load_command_count
-
-    // Поиск команды LC_SYMTAB
-    for (uint32_t i = 0; i < ncmds; i++) {
-        if (cmd->cmd == LC_SYMTAB) {
-            symtab_cmd = (struct symtab_command *)cmd;
-            break;
+    double best = 0.0;
+    for (size_t i = 0; i < scores->count; i++) {
+        if (scores->entries[i].score > best) {
+            best = scores->entries[i].score;
         }
-        cmd = (struct load_command *)((uint8_t *)cmd + cmd->cmdsize);
     }
+    return best >= scores->total * state->options->confidence;
+}
 
-    if (!symtab_cmd || symtab_cmd->nsyms == 0) {
-        return -1;
+static bool is_generic_section(const char *segname, const char *sectname) {
+    for (size_t i = 0; i < sizeof(generic_sections) / sizeof(generic_sections[0]); i++) {
+        if (strcmp(segname, generic_sections[i][0]) == 0 && strcmp(sectname, generic_sections[i][1]) == 0) {
+            return true;
+        }
     }
+    return false;
+}
 
-    long current_offset = ftell(file);
+/**
+ * Голосует по имени секции. Если одна секция сопоставлена нескольким языкам,
+ * её вес делится между ними поровну.
+ */
+static void vote_section(VoteState *state, const MachOFile *mach_o_file, const char *segname, const char *sectname) {
+    size_t shared = 0;
+    for (size_t i = 0; i < sizeof(section_mappings) / sizeof(SectionMapping); i++) {
+        if (strcmp(segname, section_mappings[i].segment_name) == 0 &&
+            strcmp(sectname, section_mappings[i].section_name) == 0) {
+            shared++;
+        }
+    }
 
-    size_t symbol_size = mach_o_file->is_64_bit ? sizeof(struct nlist_64) : sizeof(struct nlist);
-    size_t symbols_size = symtab_cmd->nsyms * symbol_size;
+    double weight = state->options->section_weight;
+    if (is_generic_section(segname, sectname)) {
+        weight *= state->options->generic_factor;
+    }
 
-    void *symbols = malloc(symbols_size);
-    if (!symbols) {
-        fprintf(stderr, "Ошибка: Не удалось выделить память для символов\n");
-        fseek(file, current_offset, SEEK_SET);
-        return -1;
+    if (shared > 0) {
+        for (size_t i = 0; i < sizeof(section_mappings) / sizeof(SectionMapping); i++) {
+            if (strcmp(segname, section_mappings[i].segment_name) == 0 &&
+                strcmp(sectname, section_mappings[i].section_name) == 0) {
+                vote(state, section_mappings[i].language, section_mappings[i].compiler,
+                     weight / (double)shared, EVIDENCE_SECTION);
+            }
+        }
     }
 
-    fseek(file, symtab_cmd->symoff, SEEK_SET);
-    if (fread(symbols, symbol_size, symtab_cmd->nsyms, file) != symtab_cmd->nsyms) {
-        fprintf(stderr, "Ошибка: Не удалось прочитать символы\n");
-        free(symbols);
-        fseek(file, current_offset, SEEK_SET);
-        return -1;
+    // Файл из одной секции кода и нескольких команд загрузки обычно написан на ассемблере
+    if (strcmp(segname, "__TEXT") == 0 && strcmp(sectname, "__text") == 0 &&
+        mach_o_file->load_command_count <= 5) {
+        vote(state, "Assembly", "Assembler", state->options->section_weight, EVIDENCE_SECTION);
     }
+}
 
-    char *string_table = malloc(symtab_cmd->strsize);
-    if (!string_table) {
-        fprintf(stderr, "Ошибка: Не удалось выделить память для таблицы строк\n");
-        free(symbols);
-        fseek(file, current_offset, SEEK_SET);
-        return -1;
+/**
+ * Обработчик совпадения строковой сигнатуры. Останавливает поиск, как только
+ * достигнут порог уверенности.
+ */
+static int string_hit(uint32_t signature_id, uint64_t offset, void *context) {
+    (void)offset;
+    VoteState *state = context;
+    const StringSignature *signature = &string_signatures[signature_id];
+    vote(state, signature->language, signature->compiler, state->options->string_weight, EVIDENCE_STRING);
+
+    if (confident_enough(state)) {
+        state->scores->early_stop = true;
+        return 1;
     }
+    return 0;
+}
 
-    fseek(file, symtab_cmd->stroff, SEEK_SET);
-    if (fread(string_table, 1, symtab_cmd->strsize, file) != symtab_cmd->strsize) {
-        fprintf(stderr, "Ошибка: Не удалось прочитать таблицу строк\n");
-        free(symbols);
-        free(string_table);
-        fseek(file, current_offset, SEEK_SET);
+/**
+ * Голосует по содержимому секции: каждое вхождение сигнатуры даёт голос её языку.
+ * Просматриваются все байты секции, а не только первая строка.
+ *
+ * @return 0 при успехе, -1 при ошибке.
+ */
+static int vote_strings(VoteState *state, const char *data, uint64_t size) {
+    const SignatureScanner *scanner = language_detector_string_scanner();
+    if (!scanner) {
+        fprintf(stderr, "Ошибка: Не удалось построить сканер строковых сигнатур\n");
         return -1;
     }
 
-    for (uint32_t i = 0; i < symtab_cmd->nsyms; i++) {
-        char *sym_name;
-        if (mach_o_file->is_64_bit) {
-            struct nlist_64 *sym = &((struct nlist_64 *)symbols)[i];
-            uint32_t strx = sym->n_un.n_strx;
-            if (strx >= symtab_cmd->strsize) continue;
-            sym_name = string_table + strx;
-        } else {
-            struct nlist *sym = &((struct nlist *)symbols)[i];
-            uint32_t strx = sym->n_un.n_strx;
-            if (strx >= symtab_cmd->strsize) continue;
-            sym_name = string_table + strx;
-        }
+    return signature_scanner_scan(scanner, data, size, string_hit, state) < 0 ? -1 : 0;
+}
 
-        // Проверка символа на принадлежность языку
-        for (size_t j = 0; j < sizeof(symbol_mappings) / sizeof(SymbolMapping); j++) {
-            if (strstr(sym_name, symbol_mappings[j].prefix) == sym_name) {
-                strcpy(lang_info->language, symbol_mappings[j].language);
-                strcpy(lang_info->compiler, symbol_mappings[j].compiler);
-                free(symbols);
-                free(string_table);
-                fseek(file, current_offset, SEEK_SET);
-                return 0;
-            }
-        }
+/**
+ * Голосование по секциям: сначала голосуют имена всех секций из плоской таблицы,
+ * затем строки из __TEXT,__cstring и __TEXT,__const, найденных по индексу секций.
+ *
+ * @return 0 при успехе, -1 при ошибке.
+ */
+static int vote_sections_and_strings(VoteState *state, const MachOFile *mach_o_file) {
+    for (uint32_t i = 0; i < mach_o_file->section_count; i++) {
+        const MachOSection *section = &mach_o_file->sections[i];
+        char segname[MACHO_NAME_LENGTH + 1] = {0};
+        char sectname[MACHO_NAME_LENGTH + 1] = {0};
+        memcpy(segname, section->segname, MACHO_NAME_LENGTH);
+        memcpy(sectname, section->sectname, MACHO_NAME_LENGTH);
+        vote_section(state, mach_o_file, segname, sectname);
+    }
 
-        // Специальная проверка на компиляторы C: Clang, GCC и т.д.
-        if (strcmp(sym_name, "_main") == 0 || strcmp(sym_name, "__start") == 0) {
-            // Если обнаружен символ main, то это C, но нужно определить компилятор
-            if (strstr(sym_name, "__gccmain")) {
-                strcpy(lang_info->language, "C");
-                strcpy(lang_info->compiler, "GCC");
-            } else {
-                strcpy(lang_info->language, "C");
-                strcpy(lang_info->compiler, "Clang");
-            }
-            free(symbols);
-            free(string_table);
-            fseek(file, current_offset, SEEK_SET);
-            return 0;
+    static const char *const string_sections[] = {"__cstring", "__const"};
+    for (size_t i = 0; i < sizeof(string_sections) / sizeof(string_sections[0]); i++) {
+        const MachOSection *section = macho_find_section(mach_o_file, "__TEXT", string_sections[i]);
+        if (!section || section->size == 0) {
+            continue;
         }
 
-        // NASM и FASM (зависит от символов и структуры файла)
-        if (strstr(sym_name, "_start") == sym_name || strstr(sym_name, "nasm") == sym_name) {
-            strcpy(lang_info->language, "Assembly");
-            strcpy(lang_info->compiler, "NASM");
-            free(symbols);
-            free(string_table);
-            fseek(file, current_offset, SEEK_SET);
-            return 0;
+        // Содержимое секции читается прямо из образа
+        const char *data = macho_file_slice(mach_o_file, section->offset, section->size);
+        if (data && vote_strings(state, data, section->size) != 0) {
+            return -1;
         }
-        if (strstr(sym_name, "_fasm_") == sym_name) {
-            strcpy(lang_info->language, "Assembly");
-            strcpy(lang_info->compiler, "FASM");
-            free(symbols);
-            free(string_table);
-            fseek(file, current_offset, SEEK_SET);
+        if (state->scores->early_stop) {
             return 0;
         }
     }
 
-    free(symbols);
-    free(string_table);
-    fseek(file, current_offset, SEEK_SET);
-
-    return -1;
+    return 0;
 }
 
-static int check_section(const char *segname, const char *sectname, LanguageInfo *lang_info) {
-    for (size_t i = 0; i < sizeof(section_mappings) / sizeof(SectionMapping); i++) {
-        if (strcmp(segname, section_mappings[i].segment_name) == 0 &&
-            strcmp(sectname, section_mappings[i].section_name) == 0) {
-            strcpy(lang_info->language, section_mappings[i].language);
-            strcpy(lang_info->compiler, section_mappings[i].compiler);
-            return 0;
-        }
+/**
+ * Голосует по символам. Каждый символ отдаёт по одному голосу каждому языку,
+ * чей префикс с ним совпал; компилятор берётся из первого по порядку таблицы
+ * совпавшего префикса этого языка.
+ *
+ * @return 0 при успехе, -1 при ошибке.
+ */
+static int vote_symbols(VoteState *state, const MachOFile *mach_o_file) {
+    const MachOSymbolIndex *index = macho_get_symbol_index(mach_o_file);
+    if (!index) {
+        return -1;
     }
-    return -1;
-}
 
-static int analyze_sections(const MachOFile *mach_o_file, LanguageInfo *lang_info) {
-    if (!mach_o_file || !lang_info) {
-        fprintf(stderr, "Ошибка: Неверные аргументы в analyze_sections\n");
+    const SymbolClassifier *classifier = language_detector_symbol_classifier();
+    if (!classifier) {
+        fprintf(stderr, "Ошибка: Не удалось построить классификатор символов\n");
         return -1;
     }
 
-    strcpy(lang_info->language, "Неизвестно");
-    strcpy(lang_info->compiler, "Неизвестно");
-
-    struct load_command *cmd = mach_o_file->commands;
-    uint32_t ncmds = mach_o_file->load_command_count; // Исправлено: command_count -> load_command_count
-
-    for (uint32_t i = 0; i < ncmds; i++) {
-        if (cmd->cmdsize == 0) {
-            fprintf(stderr, "Ошибка: Неверный размер команды загрузки\n");
-            return -1;
+    const LanguageDetectionOptions *options = state->options;
+    for (uint32_t i = 0; i < index->count; i++) {
+        if (i % EARLY_STOP_INTERVAL == 0 && i > 0 && confident_enough(state)) {
+            state->scores->early_stop = true;
+            return 0;
         }
 
-        if (cmd->cmd == LC_SEGMENT || cmd->cmd == LC_SEGMENT_64) {
-            uint32_t nsects = 0;
-            void *sections = NULL;
-
-            if (cmd->cmd == LC_SEGMENT) {
-                struct segment_command *seg_cmd = (struct segment_command *)cmd;
-                nsects = seg_cmd->nsects;
-                sections = (void *)(seg_cmd + 1);
-            } else { // LC_SEGMENT_64
-                struct segment_command_64 *seg_cmd = (struct segment_command_64 *)cmd;
-                nsects = seg_cmd->nsects;
-                sections = (void *)(seg_cmd + 1);
-            }
+        const MachOSymbol *symbol = &index->symbols[i];
+        const char *sym_name = symbol->name;
 
-            // Проверка корректности числа секций
-            if (nsects == 0 || sections == NULL) {
-                cmd = (struct load_command *)((uint8_t *)cmd + cmd->cmdsize);
-                continue;
-            }
+        // Один проход автомата по байтам имени даёт все совпавшие префиксы
+        uint32_t matches[SYMBOL_MATCH_LIMIT];
+        size_t found = symbol_classifier_match(classifier, sym_name, matches, SYMBOL_MATCH_LIMIT);
+        if (found > SYMBOL_MATCH_LIMIT) {
+            found = SYMBOL_MATCH_LIMIT;
+        }
 
-            for (uint32_t j = 0; j < nsects; j++) {
-                char segname[17] = {0};
-                char sectname[17] = {0};
-
-                if (cmd->cmd == LC_SEGMENT) {
-                    struct section *section = &((struct section *)sections)[j];
-                    memcpy(segname, section->segname, 16);
-                    segname[16] = '\0';
-                    memcpy(sectname, section->sectname, 16);
-                    sectname[16] = '\0';
-                } else { // LC_SEGMENT_64
-                    struct section_64 *section = &((struct section_64 *)sections)[j];
-                    memcpy(segname, section->segname, 16);
-                    segname[16] = '\0';
-                    memcpy(sectname, section->sectname, 16);
-                    sectname[16] = '\0';
+        if (found > 0) {
+            uint64_t voted = 0;
+            for (size_t j = 0; j < found; j++) {
+                uint32_t language = symbol_classifier_language_of(classifier, matches[j]);
+                if (voted & (UINT64_C(1) << language)) {
+                    continue;
                 }
+                voted |= UINT64_C(1) << language;
 
-                if (check_section(segname, sectname, lang_info) == 0) {
-                    return 0;
+                uint32_t best = matches[j];
+                for (size_t k = j + 1; k < found; k++) {
+                    if (matches[k] < best && symbol_classifier_language_of(classifier, matches[k]) == language) {
+                        best = matches[k];
+                    }
                 }
 
-                if (strcmp(segname, "__TEXT") == 0 && strcmp(sectname, "__text") == 0 &&
-                    mach_o_file->load_command_count <= 5) { // Исправлено: command_count -> load_command_count
-                    strcpy(lang_info->language, "Assembly");
-                    strcpy(lang_info->compiler, "Assembler");
-                    return 0;
+                if (state->classifier_slots[language] < 0) {
+                    state->classifier_slots[language] =
+                            score_slot(state, symbol_classifier_language(classifier, language));
                 }
+                vote_slot(state, state->classifier_slots[language],
+                          symbol_classifier_mapping(classifier, best)->compiler,
+                          options->symbol_weight, EVIDENCE_SYMBOL);
             }
+            continue;
         }
 
-        if (cmd->cmdsize == 0) {
-            fprintf(stderr, "Ошибка: Обнаружен неверный размер команды, предотвращение бесконечного цикла\n");
-            return -1;
+        // Точка входа C
+        if (strcmp(sym_name, "_main") == 0 || strcmp(sym_name, "__start") == 0) {
+            vote(state, "C", "Clang", options->symbol_weight, EVIDENCE_SYMBOL);
+            continue;
         }
-        cmd = (struct load_command *)((uint8_t *)cmd + cmd->cmdsize);
-    }
-
-    return -1;
-}
 
-static int analyze_strings(const MachOFile *mach_o_file, FILE *file, LanguageInfo *lang_info) {
-    if (!mach_o_file || !file || !lang_info) {
-        fprintf(stderr, "Ошибка: Неверные аргументы в analyze_strings\n");
-        return -1;
+        // Определённый символ без декорирования — слабый признак кода на C
+        if (!symbol->is_undefined && !(symbol->n_type & N_STAB) &&
+            sym_name[0] == '_' && ((sym_name[1] >= 'a' && sym_name[1] <= 'z') ||
+                                   (sym_name[1] >= 'A' && sym_name[1] <= 'Z'))) {
+            vote(state, "C", "Clang", options->plain_c_weight, EVIDENCE_SYMBOL);
+        }
     }
 
-    long current_offset = ftell(file);
-
-    struct load_command *cmd = mach_o_file->commands;
-    uint32_t ncmds = mach_o_file->load_command_count; // Исправлено: command_count -> load_command_count
-
-    for (uint32_t i = 0; i < ncmds; i++) {
-        if (cmd->cmd == LC_SEGMENT || cmd->cmd == LC_SEGMENT_64) {
-            uint32_t nsects;
-            struct section *sections = NULL;
+    return 0;
+}
 
-            if (cmd->cmd == LC_SEGMENT) {
-                struct segment_command *seg_cmd = (struct segment_command *)cmd;
-                nsects = seg_cmd->nsects;
-                sections = (struct section *)(seg_cmd + 1);
-            } else {
-                struct segment_command_64 *seg_cmd = (struct segment_command_64 *)cmd;
-                nsects = seg_cmd->nsects;
-                sections = (struct section *)(seg_cmd + 1);
+/**
+ * Выбирает для каждого языка компилятор с наибольшим весом и определяет лидера.
+ */
+static void finalize_scores(VoteState *state) {
+    LanguageScores *scores = state->scores;
+    scores->best = -1;
+
+    for (size_t i = 0; i < scores->count; i++) {
+        LanguageScore *entry = &scores->entries[i];
+        double best_weight = -1.0;
+        for (size_t j = 0; j < LANGUAGE_COMPILERS_MAX && state->compilers[i][j]; j++) {
+            if (state->compiler_weights[i][j] > best_weight) {
+                best_weight = state->compiler_weights[i][j];
+                entry->compiler = state->compilers[i][j];
             }
+        }
 
-            for (uint32_t j = 0; j < nsects; j++) {
-                char *sectname = sections[j].sectname;
-                char *segname = sections[j].segname;
-
-                if (strcmp(segname, "__TEXT") == 0 &&
-                    (strcmp(sectname, "__cstring") == 0 || strcmp(sectname, "__const") == 0)) {
-                    uint32_t offset = sections[j].offset;
-                    uint32_t size = sections[j].size;
-
-                    char *data = malloc(size);
-                    if (!data) continue;
-
-                    fseek(file, offset, SEEK_SET);
-                    if (fread(data, 1, size, file) != size) {
-                        free(data);
-                        continue;
-                    }
+        // При равенстве оценок побеждает язык, свидетельство о котором найдено раньше
+        if (scores->best < 0 || entry->score > scores->entries[scores->best].score) {
+            scores->best = (int)i;
+        }
+    }
+}
 
-                    if (strstr(data, "go.buildid") || strstr(data, "Go build ID")) {
-                        strcpy(lang_info->language, "Go");
-                        strcpy(lang_info->compiler, "gc (Go compiler)");
-                        free(data);
-                        fseek(file, current_offset, SEEK_SET);
-                        return 0;
-                    }
+int detect_language_scores(const MachOFile *mach_o_file, const LanguageDetectionOptions *options,
+                           LanguageScores *scores) {
+    if (!mach_o_file || !scores) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в detect_language_scores\n");
+        return -1;
+    }
 
-                    if (strstr(data, "Python") || strstr(data, "Py_InitModule")) {
-                        strcpy(lang_info->language, "Python");
-                        strcpy(lang_info->compiler, "Cython or CPython");
-                        free(data);
-                        fseek(file, current_offset, SEEK_SET);
-                        return 0;
-                    }
+    LanguageDetectionOptions defaults;
+    if (!options) {
+        language_detection_default_options(&defaults);
+        options = &defaults;
+    }
 
-                    if (strstr(data, "Java") || strstr(data, "JNI")) {
-                        strcpy(lang_info->language, "Java");
-                        strcpy(lang_info->compiler, "GraalVM Native Image");
-                        free(data);
-                        fseek(file, current_offset, SEEK_SET);
-                        return 0;
-                    }
+    memset(scores, 0, sizeof(LanguageScores));
+    scores->best = -1;
 
-                    if (strstr(data, "Kotlin") || strstr(data, "kotlin.native.internal")) {
-                        strcpy(lang_info->language, "Kotlin/Native");
-                        strcpy(lang_info->compiler, "Kotlin Native Compiler");
-                        free(data);
-                        fseek(file, current_offset, SEEK_SET);
-                        return 0;
-                    }
+    VoteState *state = calloc(1, sizeof(VoteState));
+    if (!state) {
+        fprintf(stderr, "Ошибка: Не удалось выделить память для определения языка\n");
+        return -1;
+    }
+    state->scores = scores;
+    state->options = options;
+    for (size_t i = 0; i < SYMBOL_CLASSIFIER_MAX_LANGUAGES; i++) {
+        state->classifier_slots[i] = -1;
+    }
 
-                    free(data);
-                }
-            }
+    int result = vote_sections_and_strings(state, mach_o_file);
+    if (result == 0) {
+        if (confident_enough(state)) {
+            scores->early_stop = true;
+        } else {
+            result = vote_symbols(state, mach_o_file);
         }
-        cmd = (struct load_command *)((uint8_t *)cmd + cmd->cmdsize);
     }
 
-    fseek(file, current_offset, SEEK_SET);
-    return -1;
+    finalize_scores(state);
+    free(state);
+    return result;
 }
 
-static void combine_results(DetectionResults *results) {
-    if (!results) {
-        fprintf(stderr, "Ошибка: Неверные аргументы в combine_results\n");
-        return;
+int detect_language_and_compiler(const MachOFile *mach_o_file, LanguageInfo *lang_info) {
+    if (!mach_o_file || !lang_info) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в detect_language_and_compiler\n");
+        return -1;
+    }
+
+    strcpy(lang_info->language, "Неизвестно");
+    strcpy(lang_info->compiler, "Неизвестно");
+
+    LanguageScores scores;
+    if (detect_language_scores(mach_o_file, NULL, &scores) != 0) {
+        return -1;
     }
 
-    if (strcmp(results->detected_language_by_symbols, results->detected_language_by_sections) == 0 &&
-        strcmp(results->detected_language_by_sections, results->detected_language_by_strings) == 0 &&
-        strcmp(results->detected_language_by_symbols, "Неизвестно") != 0) {
-        strcpy(results->final_language, results->detected_language_by_symbols);
-        strcpy(results->final_compiler, results->detected_compiler_by_symbols);
-    } else if (strcmp(results->detected_language_by_symbols, results->detected_language_by_sections) == 0 &&
-               strcmp(results->detected_language_by_symbols, "Неизвестно") != 0) {
-        strcpy(results->final_language, results->detected_language_by_symbols);
-        strcpy(results->final_compiler, results->detected_compiler_by_symbols);
-        fprintf(stderr, "Предупреждение: Анализ строк не совпадает с анализом символов и секций.\n");
-    } else if (strcmp(results->detected_language_by_symbols, results->detected_language_by_strings) == 0 &&
-               strcmp(results->detected_language_by_symbols, "Неизвестно") != 0) {
-        strcpy(results->final_language, results->detected_language_by_symbols);
-        strcpy(results->final_compiler, results->detected_compiler_by_symbols);
-        fprintf(stderr, "Предупреждение: Анализ секций не совпадает с анализом символов и строк.\n");
-    } else if (strcmp(results->detected_language_by_sections, results->detected_language_by_strings) == 0 &&
-               strcmp(results->detected_language_by_sections, "Неизвестно") != 0) {
-        strcpy(results->final_language, results->detected_language_by_sections);
-        strcpy(results->final_compiler, results->detected_compiler_by_sections);
-        fprintf(stderr, "Предупреждение: Анализ символов не совпадает с анализом секций и строк.\n");
-    } else if (strcmp(results->detected_language_by_symbols, "Неизвестно") != 0) {
-        strcpy(results->final_language, results->detected_language_by_symbols);
-        strcpy(results->final_compiler, results->detected_compiler_by_symbols);
-    } else if (strcmp(results->detected_language_by_sections, "Неизвестно") != 0) {
-        strcpy(results->final_language, results->detected_language_by_sections);
-        strcpy(results->final_compiler, results->detected_compiler_by_sections);
-    } else if (strcmp(results->detected_language_by_strings, "Неизвестно") != 0) {
-        strcpy(results->final_language, results->detected_language_by_strings);
-        strcpy(results->final_compiler, results->detected_compiler_by_strings);
-    } else {
-        strcpy(results->final_language, "Неизвестно");
-        strcpy(results->final_compiler, "Неизвестно");
+    if (scores.best >= 0) {
+        const LanguageScore *best = &scores.entries[scores.best];
+        snprintf(lang_info->language, sizeof(lang_info->language), "%s", best->language);
+        snprintf(lang_info->compiler, sizeof(lang_info->compiler), "%s", best->compiler);
     }
-}
\ No newline at end of file
+
+    return 0;
+}
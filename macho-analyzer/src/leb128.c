@@ -0,0 +1,91 @@
+#include "leb128.h"
+#include "macho_endian.h"
+#include <string.h>
+
+#define LEB128_STOP_BITS 0x8080808080808080ULL
+#define LEB128_DATA_BITS 0x7f7f7f7f7f7f7f7fULL
+
+/**
+ * Собирает значение из 7-битных групп байтов слова (младший байт — первая группа):
+ * соседние группы попарно сдвигаются вплотную друг к другу, сначала в 16-битных,
+ * затем в 32- и 64-битных полях.
+ */
+static inline uint64_t compress_groups(uint64_t word) {
+    word &= LEB128_DATA_BITS;
+    word = (word & 0x007f007f007f007fULL) | ((word & 0x7f007f007f007f00ULL) >> 1);
+    word = (word & 0x00003fff00003fffULL) | ((word & 0x3fff00003fff0000ULL) >> 2);
+    word = (word & 0x000000000fffffffULL) | ((word & 0x0fffffff00000000ULL) >> 4);
+    return word;
+}
+
+/**
+ * Сохраняет значение.
+ *
+ * @return 1, если встретился терминатор, 0 — если значение сохранено, -1 — если массив заполнен.
+ */
+static inline int store_value(uint64_t value, uint64_t *values, size_t capacity, size_t *count) {
+    if (value == 0) {
+        return 1;
+    }
+    if (*count == capacity) {
+        return -1;
+    }
+    values[(*count)++] = value;
+    return 0;
+}
+
+int macho_decode_uleb128_run(const uint8_t *data, size_t size, uint64_t *values, size_t capacity, size_t *count) {
+    const uint8_t *p = data;
+    const uint8_t *end = data + size;
+    *count = 0;
+
+    while (end - p >= 8) {
+        uint64_t word;
+        memcpy(&word, p, sizeof(word));
+        word = macho_little_to_host64(word);
+
+        uint64_t stops = ~word & LEB128_STOP_BITS;
+        if (!stops) {
+            // Число длиннее восьми байт
+            uint64_t value;
+            if (macho_read_uleb128(&p, end, &value) != 0) {
+                return -1;
+            }
+            int rc = store_value(value, values, capacity, count);
+            if (rc != 0) {
+                return rc < 0 ? -1 : 0;
+            }
+            continue;
+        }
+
+        // Все числа, которые целиком лежат в слове
+        unsigned consumed = 0;
+        while (stops) {
+            unsigned next = (unsigned)__builtin_ctzll(stops) / 8 + 1;
+            uint64_t group = word >> (consumed * 8);
+            if (next - consumed < 8) {
+                group &= (1ULL << ((next - consumed) * 8)) - 1;
+            }
+            consumed = next;
+            stops &= stops - 1;
+
+            int rc = store_value(compress_groups(group), values, capacity, count);
+            if (rc != 0) {
+                return rc < 0 ? -1 : 0;
+            }
+        }
+        p += consumed;
+    }
+
+    while (p < end) {
+        uint64_t value;
+        if (macho_read_uleb128(&p, end, &value) != 0) {
+            return -1;
+        }
+        int rc = store_value(value, values, capacity, count);
+        if (rc != 0) {
+            return rc < 0 ? -1 : 0;
+        }
+    }
+    return 0;
+}
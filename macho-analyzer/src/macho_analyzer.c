@@ -1,239 +1,131 @@
 #include "macho_analyzer.h"
+#include "symbol_index.h"
+#include "import_table.h"
+#include "function_starts.h"
+#include "thread_pool.h"
+#include "content_hash.h"
+#include "macho_types.h"
+#include "macho_endian.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
-#include <mach-o/loader.h>
-#include <mach-o/fat.h>
-#include <CommonCrypto/CommonDigest.h>
-#include <CommonCrypto/CommonCrypto.h>
-#include <macho_printer.h>
-#include <CommonCrypto/CommonDigest.h>
-
-#define CSMAGIC_CODEDIRECTORY 0xfade0c02
-#define CSMAGIC_BLOBWRAPPER 0xfade0b01
+#include <sys/types.h>
 
 /**
  * Функция для анализа заголовков Mach-O файла.
- * Читает заголовок Mach-O файла и сохраняет информацию в структуру MachOFile.
- *
- * @param file Указатель на открытый файл Mach-O.
- * @param mach_o_file Структура для хранения данных о файле Mach-O.
- * @return 0 при успешном выполнении, -1 в случае ошибки.
- */
-static int analyze_mach_header(FILE *file, MachOFile *mach_o_file);
-
-/**
- * Функция для анализа команд загрузки Mach-O файла.
- * Читает команды загрузки Mach-O и сохраняет их в структуру MachOFile.
+ * Читает заголовок из начала среза и сохраняет информацию в структуру MachOFile.
  *
- * @param file Указатель на открытый файл Mach-O.
- * @param mach_o_file Структура для хранения команд загрузки.
+ * @param mach_o_file Структура для хранения данных о файле Mach-O (data/data_size уже заданы).
  * @return 0 при успешном выполнении, -1 в случае ошибки.
  */
-int analyze_load_commands(FILE *file, MachOFile *mach_o_file);
+static int analyze_mach_header(MachOFile *mach_o_file);
 
-/**
- * Функция для анализа заголовков Fat Binary.
- * Обрабатывает Fat Binary, извлекает информацию о каждой архитектуре и анализирует соответствующие Mach-O файлы.
- *
- * @param file Указатель на открытый файл Fat Binary.
- * @return 0 при успешном выполнении, -1 в случае ошибки.
- */
-int analyze_fat_binary(FILE *file);
-
-/**
- * Функция для чтения данных и проверки ошибок.
- * Обёртка над fread, которая проверяет успешность чтения данных и выводит сообщение об ошибке в случае неудачи.
- *
- * @param file Указатель на открытый файл.
- * @param buffer Буфер для хранения прочитанных данных.
- * @param size Количество байт для чтения.
- * @param err_msg Сообщение об ошибке для вывода в случае неудачи.
- * @return 0 при успешном выполнении, -1 в случае ошибки.
- */
-static int read_and_validate(FILE *file, void *buffer, size_t size, const char *err_msg);
-
-/**
- * Функция для более глубокого анализа секции LC_CODE_SIGNATURE в Mach-O файле.
- * Проверяет наличие LC_CODE_SIGNATURE и проверяет целостность подписи, а также её валидность.
- *
- * @param mach_o_file Структура MachOFile для хранения информации о файле.
- * @param file Указатель на открытый файл Mach-O для доступа к данным подписи.
- * @return 0 при успешной проверке, -1 в случае ошибки.
- */
-
-
-/**
- * Анализирует подпись кода в Mach-O файле.
- *
- * @param mach_o_file Указатель на структуру MachOFile.
- * @param file Указатель на файл для чтения данных подписи.
- * @return 0 при успехе, -1 в случае ошибки.
- */
-int analyze_code_signature(const MachOFile *mach_o_file, FILE *file) {
-    if (!mach_o_file || !mach_o_file->commands || !file) {
-        fprintf(stderr, "Ошибка: Неверный Mach-O файл или отсутствуют команды для обработки.\n");
+int analyze_mach_o(FILE *file, MachOFile *mach_o_file) {
+    if (!file || !mach_o_file) {
+        fprintf(stderr, "Ошибка: NULL указатель для файла или структуры MachOFile\n");
         return -1;
     }
 
-    struct load_command *cmd = mach_o_file->commands;
-    uint32_t ncmds = mach_o_file->load_command_count; // Исправлено: load_command_count
-    struct linkedit_data_command *code_sig_cmd = NULL;
-
-    // Поиск команды подписи кода
-    for (uint32_t i = 0; i < ncmds; i++) {
-        if (cmd->cmd == LC_CODE_SIGNATURE) {
-            code_sig_cmd = (struct linkedit_data_command *)cmd;
-            break;
-        }
-        cmd = (struct load_command *)((uint8_t *)cmd + cmd->cmdsize);
-    }
+    memset(mach_o_file, 0, sizeof(MachOFile));
 
-    if (!code_sig_cmd) {
-        printf("Подпись кода не обнаружена в данном Mach-O файле.\n");
-        return 0;
+    off_t start = ftello(file);
+    if (start < 0) {
+        start = 0;
     }
 
-    printf("Подпись кода обнаружена. Проверка подписи...\n");
-
-    // Перемещение к данным подписи
-    if (fseek(file, code_sig_cmd->dataoff, SEEK_SET) != 0) {
-        perror("Ошибка: Не удалось переместиться к данным подписи кода");
+    MachOImage *image = malloc(sizeof(MachOImage));
+    if (!image) {
+        fprintf(stderr, "Ошибка: Не удалось выделить память для образа файла\n");
         return -1;
     }
-
-    // Выделение памяти для данных подписи
-    uint8_t *signature_data = malloc(code_sig_cmd->datasize);
-    if (!signature_data) {
-        fprintf(stderr, "Ошибка: Не удалось выделить память для данных подписи кода.\n");
+    if (macho_image_from_file(file, image) != 0) {
+        free(image);
         return -1;
     }
 
-    // Чтение данных подписи
-    if (fread(signature_data, 1, code_sig_cmd->datasize, file) != code_sig_cmd->datasize) {
-        fprintf(stderr, "Ошибка: Не удалось прочитать данные подписи кода.\n");
-        free(signature_data);
+    const uint32_t *magic = macho_image_slice(image, (uint64_t)start, sizeof(uint32_t));
+    if (!magic) {
+        fprintf(stderr, "Ошибка: Файл слишком мал для Mach-O\n");
+        macho_image_close(image);
+        free(image);
         return -1;
     }
 
-    // Проверка magic-числа подписи
-    uint32_t magic = *(uint32_t *)signature_data;
-    if (magic != CSMAGIC_CODEDIRECTORY) {
-        printf("Предупреждение: Magic-число подписи кода не соответствует ожидаемому значению.\n");
-        free(signature_data);
-        return -1;
+    switch (*magic) {
+        case MH_MAGIC:
+        case MH_CIGAM:
+        case MH_MAGIC_64:
+        case MH_CIGAM_64:
+            if (analyze_mach_o_image(image, (uint64_t)start, 0, mach_o_file) != 0) {
+                macho_image_close(image);
+                free(image);
+                return -1;
+            }
+            mach_o_file->owned_image = image;
+            return 0;
+        case FAT_MAGIC:
+        case FAT_CIGAM:
+        case FAT_MAGIC_64:
+        case FAT_CIGAM_64: {
+            // Из FAT разбирается первая архитектура; остальные доступны через macho_list_architectures.
+            // Смещения fat_arch отсчитываются от заголовка FAT, а он лежит по смещению start
+            MachOImage fat_view;
+            MachOArchitecture arch;
+            if (macho_image_from_memory(image->base + start, image->size - (uint64_t)start, &fat_view) != 0 ||
+                macho_list_architectures(&fat_view, &arch, 1, NULL) < 1 || arch.offset > fat_view.size ||
+                analyze_mach_o_image(image, (uint64_t)start + arch.offset, arch.size, mach_o_file) != 0) {
+                fprintf(stderr, "Ошибка: Не удалось проанализировать первую архитектуру FAT\n");
+                free_mach_o_file(mach_o_file);
+                macho_image_close(image);
+                free(image);
+                return -1;
+            }
+            mach_o_file->owned_image = image;
+            return 0;
+        }
+        default:
+            fprintf(stderr, "Неподдерживаемый magic: 0x%x\n", *magic);
+            macho_image_close(image);
+            free(image);
+            return -1;
     }
+}
 
-    // Структура директории кода
-    struct code_directory {
-        uint32_t magic;
-        uint32_t length;
-        uint32_t version;
-        uint32_t flags;
-        uint32_t hashOffset;
-        uint32_t identOffset;
-        uint32_t nSpecialSlots;
-        uint32_t nCodeSlots;
-        uint32_t codeLimit;
-        uint8_t hashSize;
-        uint8_t hashType;
-        uint8_t platform;
-        uint8_t pageSize;
-        uint32_t spare2;
-        uint32_t scatterOffset;
-    };
-
-    struct code_directory *cd = (struct code_directory *)signature_data;
-
-    // Проверка длины директории кода
-    if (cd->length != code_sig_cmd->datasize) {
-        printf("Предупреждение: Длина директории кода не соответствует ожидаемому значению.\n");
-        free(signature_data);
+int analyze_mach_o_image(const MachOImage *image, uint64_t offset, uint64_t size, MachOFile *mach_o_file) {
+    if (!image || !mach_o_file) {
+        fprintf(stderr, "Ошибка: NULL указатель для образа или структуры MachOFile\n");
         return -1;
     }
 
-    printf("Версия директории кода: 0x%x\n", cd->version);
-    if (cd->version < 0x20100) {
-        printf("Предупреждение: Версия директории кода устарела. Рекомендуется обновление для повышения безопасности.\n");
-    }
+    memset(mach_o_file, 0, sizeof(MachOFile));
 
-    // Вывод идентификатора
-    if (cd->identOffset < code_sig_cmd->datasize) {
-        char *identifier = (char *)(signature_data + cd->identOffset);
-        printf("Идентификатор директории кода: %s\n", identifier);
-    } else {
-        printf("Предупреждение: Неверное смещение идентификатора в директории кода.\n");
-        free(signature_data);
+    if (offset > image->size) {
+        fprintf(stderr, "Ошибка: Смещение Mach-O за пределами файла\n");
         return -1;
     }
-
-    // Вывод первых 16 байт хеша
-    uint8_t *hash_data = signature_data + cd->hashOffset;
-    printf("Хеш директории кода (первые 16 байт): ");
-    for (size_t i = 0; i < 16 && i < cd->length - cd->hashOffset; i++) {
-        printf("%02x ", hash_data[i]);
+    if (size == 0) {
+        size = image->size - offset;
     }
-    printf("\n");
 
-    // Вычисление SHA-256 хеша
-    uint8_t calculated_hash[CC_SHA256_DIGEST_LENGTH];
-    CC_SHA256_CTX sha_ctx;
-    CC_SHA256_Init(&sha_ctx);
-    CC_SHA256_Update(&sha_ctx, signature_data, cd->length);
-    CC_SHA256_Final(calculated_hash, &sha_ctx);
-
-    printf("Вычисленный SHA-256 хеш: ");
-    for (size_t i = 0; i < CC_SHA256_DIGEST_LENGTH; i++) {
-        printf("%02x", calculated_hash[i]);
+    mach_o_file->data = macho_image_slice(image, offset, size);
+    if (!mach_o_file->data) {
+        fprintf(stderr, "Ошибка: Mach-O выходит за границы файла\n");
+        return -1;
     }
-    printf("\n");
+    mach_o_file->data_size = size;
 
-    printf("Подпись кода выглядит действительной (на основе предварительных проверок).\n");
-
-    free(signature_data);
+    if (analyze_mach_header(mach_o_file) != 0) return -1;
+    if (analyze_load_commands(mach_o_file) != 0) return -1;
     return 0;
 }
 
-int analyze_mach_o(FILE *file, MachOFile *mach_o_file) {
-    if (!file || !mach_o_file) {
-        fprintf(stderr, "Ошибка: NULL указатель для файла или структуры MachOFile\n");
-        return -1;
-    }
-
-    fseek(file, 0, SEEK_END);
-    long file_size = ftell(file);
-    if (file_size < sizeof(uint32_t)) {
-        fprintf(stderr, "Ошибка: Файл слишком мал для Mach-O\n");
-        return -1;
-    }
-    rewind(file);
-
-    memset(mach_o_file, 0, sizeof(MachOFile));
-
-    uint32_t magic;
-    if (fread(&magic, sizeof(uint32_t), 1, file) != 1) {
-        fprintf(stderr, "Ошибка чтения magic number\n");
-        return -1;
-    }
-    fseek(file, 0, SEEK_SET);
-
-    switch (magic) {
-        case MH_MAGIC:
-        case MH_CIGAM:
-        case MH_MAGIC_64:
-        case MH_CIGAM_64:
-            if (analyze_mach_header(file, mach_o_file) != 0) return -1;
-            if (analyze_load_commands(file, mach_o_file) != 0) return -1;
-            analyze_code_signature(mach_o_file, file);
-            return 0;
-        case FAT_MAGIC:
-        case FAT_CIGAM:
-            return analyze_fat_binary(file);
-        default:
-            fprintf(stderr, "Неподдерживаемый magic: 0x%x\n", magic);
-            return -1;
+const void *macho_file_slice(const MachOFile *mach_o_file, uint64_t offset, uint64_t size) {
+    if (!mach_o_file || !mach_o_file->data ||
+        !macho_range_valid(offset, size, mach_o_file->data_size)) {
+        return NULL;
     }
+    return mach_o_file->data + offset;
 }
 
 const char *get_arch_name(cpu_type_t cpu, cpu_subtype_t sub) {
@@ -251,280 +143,504 @@ const char *get_arch_name(cpu_type_t cpu, cpu_subtype_t sub) {
     }
 }
 
-int analyze_fat_binary(FILE *file) {
-    struct fat_header fatHeader;
-
-    if (fread(&fatHeader, sizeof(struct fat_header), 1, file) != 1) {
-        fprintf(stderr, "Failed to read fat header\n");
+int64_t macho_list_architectures(const MachOImage *image, MachOArchitecture *archs, uint32_t max_archs, bool *is_fat) {
+    const uint32_t *magic = image ? macho_image_slice(image, 0, sizeof(uint32_t)) : NULL;
+    if (!magic) {
         return -1;
     }
 
-    uint32_t nfat_arch = OSSwapBigToHostInt32(fatHeader.nfat_arch);
-
-    struct fat_arch *fatArchs = calloc(nfat_arch, sizeof(struct fat_arch));
-    if (!fatArchs) {
-        fprintf(stderr, "Memory allocation failed for fat_arch.\n");
-        return -1;
-    }
-
-    for (uint32_t i = 0; i < nfat_arch; i++) {
-        if (fread(&fatArchs[i], sizeof(struct fat_arch), 1, file) != 1) {
-            fprintf(stderr, "Failed to read fat_arch %u\n", i);
-            free(fatArchs);
-            return -1;
+    switch (*magic) {
+        case MH_MAGIC:
+        case MH_CIGAM:
+        case MH_MAGIC_64:
+        case MH_CIGAM_64: {
+            const struct mach_header *header = macho_image_slice(image, 0, sizeof(struct mach_header));
+            if (!header) {
+                return -1;
+            }
+            bool swap = *magic == MH_CIGAM || *magic == MH_CIGAM_64;
+            if (is_fat) {
+                *is_fat = false;
+            }
+            if (max_archs > 0) {
+                archs[0].offset = 0;
+                archs[0].size = image->size;
+                uint32_t cputype = (uint32_t)header->cputype;
+                uint32_t cpusubtype = (uint32_t)header->cpusubtype;
+                archs[0].cpu_type = (cpu_type_t)(swap ? macho_swap32(cputype) : cputype);
+                archs[0].cpu_subtype = (cpu_subtype_t)(swap ? macho_swap32(cpusubtype) : cpusubtype);
+            }
+            return 1;
         }
+        case FAT_MAGIC:
+        case FAT_CIGAM: {
+            const struct fat_header *header = macho_image_slice(image, 0, sizeof(struct fat_header));
+            if (!header) {
+                return -1;
+            }
+            uint32_t nfat_arch = macho_big_to_host32(header->nfat_arch);
+            const struct fat_arch *fat_archs = macho_image_slice(image, sizeof(struct fat_header),
+                                                                 (uint64_t)nfat_arch * sizeof(struct fat_arch));
+            if (!fat_archs) {
+                return -1;
+            }
+            if (is_fat) {
+                *is_fat = true;
+            }
+            for (uint32_t i = 0; i < nfat_arch && i < max_archs; i++) {
+                archs[i].offset = macho_big_to_host32(fat_archs[i].offset);
+                archs[i].size = macho_big_to_host32(fat_archs[i].size);
+                archs[i].cpu_type = (cpu_type_t)macho_big_to_host32(fat_archs[i].cputype);
+                archs[i].cpu_subtype = (cpu_subtype_t)macho_big_to_host32(fat_archs[i].cpusubtype);
+            }
+            return nfat_arch;
+        }
+        case FAT_MAGIC_64:
+        case FAT_CIGAM_64: {
+            // fat_arch_64 хранит смещения и размеры в 64 битах: архитектуры могут лежать дальше 4 ГБ
+            const struct fat_header *header = macho_image_slice(image, 0, sizeof(struct fat_header));
+            if (!header) {
+                return -1;
+            }
+            uint32_t nfat_arch = macho_big_to_host32(header->nfat_arch);
+            const struct fat_arch_64 *fat_archs = macho_image_slice(image, sizeof(struct fat_header),
+                                                                    (uint64_t)nfat_arch * sizeof(struct fat_arch_64));
+            if (!fat_archs) {
+                return -1;
+            }
+            if (is_fat) {
+                *is_fat = true;
+            }
+            for (uint32_t i = 0; i < nfat_arch && i < max_archs; i++) {
+                archs[i].offset = macho_big_to_host64(fat_archs[i].offset);
+                archs[i].size = macho_big_to_host64(fat_archs[i].size);
+                archs[i].cpu_type = (cpu_type_t)macho_big_to_host32(fat_archs[i].cputype);
+                archs[i].cpu_subtype = (cpu_subtype_t)macho_big_to_host32(fat_archs[i].cpusubtype);
+            }
+            return nfat_arch;
+        }
+        default:
+            return -1;
     }
+}
 
-    printf("Fat Binary with %u architectures:\n\n", nfat_arch);
-
-    for (uint32_t i = 0; i < nfat_arch; i++) {
-        cpu_type_t cpuType = OSSwapBigToHostInt32(fatArchs[i].cputype);
-        cpu_subtype_t cpuSubtype = OSSwapBigToHostInt32(fatArchs[i].cpusubtype);
-        uint32_t offset = OSSwapBigToHostInt32(fatArchs[i].offset);
-        uint32_t size = OSSwapBigToHostInt32(fatArchs[i].size);
+/**
+ * Задача разбора одной архитектуры.
+ */
+typedef struct {
+    const MachOImage *image;
+    const MachOArchitecture *arch;
+    MachOFile *file;
+    int *status;
+    uint32_t index;
+    MachOArchitectureAnalysis analysis;
+    void *context;
+} ArchitectureTask;
+
+static void analyze_architecture_task(void *arg, size_t worker) {
+    (void)worker;
+    ArchitectureTask *task = arg;
+    *task->status = analyze_mach_o_image(task->image, task->arch->offset, task->arch->size, task->file);
+    if (*task->status != 0) {
+        free_mach_o_file(task->file);
+    } else if (task->analysis) {
+        task->analysis(task->file, task->index, task->context);
+    }
+}
 
-        printf("---- Начинаем анализ архитектуры %u (%s) ----\n", i + 1, get_arch_name(cpuType, cpuSubtype));
-        printf("Offset = %u, Size = %u\n", offset, size);
+int analyze_mach_o_architectures(const MachOImage *image, const MachOArchitecture *archs, uint32_t count,
+                                 size_t threads, MachOFile *files, int *statuses,
+                                 MachOArchitectureAnalysis analysis, void *context) {
+    if (!image || (count > 0 && (!archs || !files || !statuses))) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в analyze_mach_o_architectures\n");
+        return -1;
+    }
+    if (count == 0) {
+        return 0;
+    }
 
-        if (fseek(file, offset, SEEK_SET) != 0) {
-            fprintf(stderr, "Failed to seek to architecture %u (offset %u).\n", i + 1, offset);
-            continue;
-        }
+    ArchitectureTask *tasks = calloc(count, sizeof(ArchitectureTask));
+    if (!tasks) {
+        fprintf(stderr, "Ошибка: Не удалось выделить память для задач разбора\n");
+        return -1;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        memset(&files[i], 0, sizeof(MachOFile));
+        tasks[i] = (ArchitectureTask){image, &archs[i], &files[i], &statuses[i], i, analysis, context};
+    }
 
-        MachOFile arch_mach_o_file;
-        memset(&arch_mach_o_file, 0, sizeof(MachOFile)); // обнуляем, чтобы избежать мусора
+    if (threads == 0) {
+        threads = thread_pool_cpu_count();
+    }
+    if (threads > count) {
+        threads = count;
+    }
 
-        if (analyze_mach_header(file, &arch_mach_o_file) != 0) {
-            fprintf(stderr, "Failed to analyze Mach-O header for architecture %u.\n", i + 1);
-            continue;
+    // Одну архитектуру (или при одном процессоре) дешевле разобрать в текущем потоке
+    ThreadPool *pool = threads > 1 ? thread_pool_create(threads, count) : NULL;
+    if (pool) {
+        for (uint32_t i = 0; i < count; i++) {
+            if (thread_pool_submit(pool, analyze_architecture_task, &tasks[i]) != 0) {
+                analyze_architecture_task(&tasks[i], 0);
+            }
         }
-
-        if (analyze_load_commands(file, &arch_mach_o_file) != 0) {
-            fprintf(stderr, "Failed to analyze load commands for architecture %u.\n", i + 1);
-            free_mach_o_file(&arch_mach_o_file);
-            continue;
+        thread_pool_wait(pool);
+        thread_pool_destroy(pool);
+    } else {
+        for (uint32_t i = 0; i < count; i++) {
+            analyze_architecture_task(&tasks[i], 0);
         }
+    }
+    free(tasks);
 
-        if (analyze_code_signature(&arch_mach_o_file, file) != 0) {
-            fprintf(stderr, "Code signature verification failed for architecture %u.\n", i + 1);
+    int rc = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (statuses[i] != 0) {
+            rc = -1;
         }
-
-        const char *archName = get_arch_name(cpuType, cpuSubtype);
-        printf("Архитектура %u (%s):\n", i + 1, archName);
-
-        print_mach_o_info(&arch_mach_o_file, file);
-        printf("\n");
-
-        free_mach_o_file(&arch_mach_o_file);
     }
-
-    free(fatArchs);
-    return 0;
+    return rc;
 }
 
-static int analyze_mach_header(FILE *file, MachOFile *mach_o_file) {
-    uint32_t magic;
-    if (read_and_validate(file, &magic, sizeof(uint32_t), "Failed to read magic number") != 0) {
+static int analyze_mach_header(MachOFile *mach_o_file) {
+    const uint32_t *magic_ptr = macho_file_slice(mach_o_file, 0, sizeof(uint32_t));
+    if (!magic_ptr) {
+        fprintf(stderr, "Failed to read magic number\n");
         return -1;
     }
+    uint32_t magic = *magic_ptr;
 
-    bool is_big_endian = false;
+    bool swapped = false;
     bool is_64_bit = false;
 
     switch (magic) {
         case MH_MAGIC:
             is_64_bit = false;
-            is_big_endian = false;
+            swapped = false;
             break;
         case MH_CIGAM:
             is_64_bit = false;
-            is_big_endian = true;
+            swapped = true;
             break;
         case MH_MAGIC_64:
             is_64_bit = true;
-            is_big_endian = false;
+            swapped = false;
             break;
         case MH_CIGAM_64:
             is_64_bit = true;
-            is_big_endian = true;
+            swapped = true;
             break;
         default:
             fprintf(stderr, "Unsupported file format or invalid magic number: 0x%x\n", magic);
             return -1;
     }
 
-    fseek(file, -(long) sizeof(uint32_t), SEEK_CUR); // Вернуть указатель назад для чтения заголовка полностью
-
-    if (is_64_bit) {
-        struct mach_header_64 header;
-        if (read_and_validate(file, &header, sizeof(struct mach_header_64), "Failed to read 64-bit Mach-O header") != 0) {
-            return -1;
-        }
-        mach_o_file->magic = header.magic;
-        mach_o_file->is_64_bit = true;
-        mach_o_file->cpu_type = is_big_endian ? OSSwapBigToHostInt32(header.cputype) : header.cputype;
-        mach_o_file->cpu_subtype = is_big_endian ? OSSwapBigToHostInt32(header.cpusubtype) : header.cpusubtype;
-        mach_o_file->file_type = is_big_endian ? OSSwapBigToHostInt32(header.filetype) : header.filetype;
-        mach_o_file->flags = is_big_endian ? OSSwapBigToHostInt32(header.flags) : header.flags;
-        mach_o_file->load_command_count = is_big_endian ? OSSwapBigToHostInt32(header.ncmds) : header.ncmds;
-        mach_o_file->sizeofcmds = is_big_endian ? OSSwapBigToHostInt32(header.sizeofcmds) : header.sizeofcmds;
-        mach_o_file->header_size = sizeof(struct mach_header_64);
-        mach_o_file->header.header64 = header;
-    } else {
-        struct mach_header header;
-        if (read_and_validate(file, &header, sizeof(struct mach_header), "Failed to read 32-bit Mach-O header") != 0) {
-            return -1;
-        }
-        mach_o_file->magic = header.magic;
-        mach_o_file->is_64_bit = false;
-        mach_o_file->cpu_type = is_big_endian ? OSSwapBigToHostInt32(header.cputype) : header.cputype;
-        mach_o_file->cpu_subtype = is_big_endian ? OSSwapBigToHostInt32(header.cpusubtype) : header.cpusubtype;
-        mach_o_file->file_type = is_big_endian ? OSSwapBigToHostInt32(header.filetype) : header.filetype;
-        mach_o_file->flags = is_big_endian ? OSSwapBigToHostInt32(header.flags) : header.flags;
-        mach_o_file->load_command_count = is_big_endian ? OSSwapBigToHostInt32(header.ncmds) : header.ncmds;
-        mach_o_file->sizeofcmds = is_big_endian ? OSSwapBigToHostInt32(header.sizeofcmds) : header.sizeofcmds;
-        mach_o_file->header_size = sizeof(struct mach_header);
-        mach_o_file->header.header32 = header;
+    // Первые семь полей у 32- и 64-битного заголовка совпадают
+    size_t header_size = is_64_bit ? sizeof(struct mach_header_64) : sizeof(struct mach_header);
+    const void *raw = macho_file_slice(mach_o_file, 0, header_size);
+    if (!raw) {
+        fprintf(stderr, "Failed to read %s Mach-O header\n", is_64_bit ? "64-bit" : "32-bit");
+        return -1;
     }
+    memcpy(&mach_o_file->header, raw, header_size);
+    const struct mach_header *header = &mach_o_file->header.header32;
+    mach_o_file->magic = header->magic;
+    mach_o_file->is_64_bit = is_64_bit;
+    mach_o_file->swapped = swapped;
+    mach_o_file->cpu_type = (cpu_type_t)macho_swap_if32(swapped, (uint32_t)header->cputype);
+    mach_o_file->cpu_subtype = (cpu_subtype_t)macho_swap_if32(swapped, (uint32_t)header->cpusubtype);
+    mach_o_file->file_type = macho_swap_if32(swapped, header->filetype);
+    mach_o_file->flags = macho_swap_if32(swapped, header->flags);
+    mach_o_file->load_command_count = macho_swap_if32(swapped, header->ncmds);
+    mach_o_file->sizeofcmds = macho_swap_if32(swapped, header->sizeofcmds);
+    mach_o_file->header_size = (uint32_t)header_size;
 
     return 0;
 }
 
 /**
- * Анализирует команды загрузки Mach-O файла и заполняет соответствующие поля структуры MachOFile.
+ * Копирует 16-байтовое имя из команды загрузки, заполняя нулями всё после
+ * завершающего нуля, чтобы имена сравнивались как ключи фиксированной длины.
+ */
+static void copy_name(char *out, const char *name) {
+    size_t length = strnlen(name, MACHO_NAME_LENGTH);
+    memcpy(out, name, length);
+    memset(out + length, 0, MACHO_NAME_LENGTH - length);
+}
+
+/**
+ * Хеш ключа секции: 32 байта segname и sectname, лежащие подряд.
+ */
+static uint32_t section_key_hash(const char *key) {
+    return (uint32_t)xxh64(key, 2 * MACHO_NAME_LENGTH, 0);
+}
+
+/**
+ * Строит индекс секций по ключу (segname, sectname) с открытой адресацией.
+ * Индекс заполнен не больше чем наполовину, поэтому пробы короткие.
  *
- * @param file Указатель на файл.
- * @param mach_o_file Структура с данными о Mach-O.
- * @return 0 при успехе, -1 в случае ошибки.
+ * @return 0 при успехе, -1 при ошибке выделения памяти.
  */
-int analyze_load_commands(FILE *file, MachOFile *mach_o_file) {
-    if (!file || !mach_o_file) {
-        fprintf(stderr, "Ошибка: NULL указатель на файл или MachOFile\n");
+static int build_section_index(MachOFile *mach_o_file) {
+    uint32_t slot_count = 8;
+    while (slot_count < mach_o_file->section_count * 2) {
+        slot_count <<= 1;
+    }
+    uint32_t *slots = calloc(slot_count, sizeof(uint32_t));
+    if (!slots) {
+        fprintf(stderr, "Ошибка: Не удалось выделить память для индекса секций\n");
         return -1;
     }
 
-    // Проверяем, что заголовок валиден
-    if (mach_o_file->load_command_count == 0 || mach_o_file->sizeofcmds == 0) {
-        fprintf(stderr, "Ошибка: Нет команд загрузки\n");
-        return -1;
+    for (uint32_t i = 0; i < mach_o_file->section_count; i++) {
+        const char *key = mach_o_file->sections[i].segname;
+        uint32_t slot = section_key_hash(key) & (slot_count - 1);
+        while (slots[slot] != 0 &&
+               memcmp(mach_o_file->sections[slots[slot] - 1].segname, key, 2 * MACHO_NAME_LENGTH) != 0) {
+            slot = (slot + 1) & (slot_count - 1);
+        }
+        if (slots[slot] == 0) {
+            slots[slot] = i + 1; // Для повторяющихся имён остаётся первая секция
+        }
     }
 
-    // Выделяем память для команд
-    mach_o_file->commands = malloc(mach_o_file->sizeofcmds);
-    if (!mach_o_file->commands) {
-        fprintf(stderr, "Ошибка: Не удалось выделить память для команд загрузки\n");
-        return -1;
+    mach_o_file->section_slots = slots;
+    mach_o_file->section_slot_count = slot_count;
+    return 0;
+}
+
+const MachOSection *macho_find_section(const MachOFile *mach_o_file, const char *segname, const char *sectname) {
+    if (!mach_o_file || !segname || !sectname || !mach_o_file->section_slots) {
+        return NULL;
     }
 
-    // Читаем команды
-    if (fread(mach_o_file->commands, mach_o_file->sizeofcmds, 1, file) != 1) {
-        fprintf(stderr, "Ошибка: Не удалось прочитать команды загрузки\n");
-        free(mach_o_file->commands);
-        mach_o_file->commands = NULL;
-        return -1;
+    size_t segname_length = strlen(segname);
+    size_t sectname_length = strlen(sectname);
+    if (segname_length > MACHO_NAME_LENGTH || sectname_length > MACHO_NAME_LENGTH) {
+        return NULL;
     }
+    char key[2 * MACHO_NAME_LENGTH] = {0};
+    memcpy(key, segname, segname_length);
+    memcpy(key + MACHO_NAME_LENGTH, sectname, sectname_length);
 
-    // Подсчитываем сегменты и библиотеки
-    struct load_command *cmd = mach_o_file->commands;
+    uint32_t mask = mach_o_file->section_slot_count - 1;
+    for (uint32_t slot = section_key_hash(key) & mask; mach_o_file->section_slots[slot] != 0; slot = (slot + 1) & mask) {
+        const MachOSection *section = &mach_o_file->sections[mach_o_file->section_slots[slot] - 1];
+        if (memcmp(section->segname, key, sizeof(key)) == 0) {
+            return section;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Освобождает сегменты, секции и библиотеки, заполненные parse_load_commands.
+ */
+static void free_parsed_commands(MachOFile *mach_o_file) {
+    for (uint32_t i = 0; mach_o_file->dylibs && i < mach_o_file->dylib_count; i++) {
+        free(mach_o_file->dylibs[i].name);
+    }
+    free(mach_o_file->dylibs);
+    free(mach_o_file->segments);
+    free(mach_o_file->sections);
+    free(mach_o_file->section_slots);
+    mach_o_file->dylibs = NULL;
+    mach_o_file->segments = NULL;
+    mach_o_file->sections = NULL;
+    mach_o_file->section_slots = NULL;
+    mach_o_file->dylib_count = 0;
+    mach_o_file->segment_count = 0;
+    mach_o_file->section_count = 0;
+    mach_o_file->section_slot_count = 0;
+}
+
+/**
+ * Проверяет команды загрузки и заполняет сегменты и библиотеки.
+ * Вызывается с константным swap, поэтому компилятор строит две версии прохода:
+ * для образов в порядке байтов хоста перестановок в ней нет вовсе.
+ *
+ * @param mach_o_file Структура с данными о Mach-O (commands уже указывает в образ).
+ * @param swap Порядок байтов образа противоположен хосту.
+ * @return 0 при успехе, -1 в случае ошибки.
+ */
+static inline __attribute__((always_inline)) int parse_load_commands(MachOFile *mach_o_file, const bool swap) {
+    // Проверяем, что каждая команда целиком лежит в области команд, а секции сегментов —
+    // внутри своей команды. После этой проверки остальные проходы могут обходить команды
+    // по cmdsize и секции по nsects без дополнительных проверок.
+    const uint8_t *cursor = (const uint8_t *)mach_o_file->commands;
+    uint32_t remaining = mach_o_file->sizeofcmds;
     uint32_t segment_count = 0;
+    uint32_t section_count = 0;
     uint32_t dylib_count = 0;
     for (uint32_t i = 0; i < mach_o_file->load_command_count; i++) {
-        if (cmd->cmd == LC_SEGMENT || cmd->cmd == LC_SEGMENT_64) {
+        const struct load_command *lc = (const struct load_command *)cursor;
+        uint32_t cmdsize = remaining >= sizeof(struct load_command) ? macho_swap_if32(swap, lc->cmdsize) : 0;
+        if (cmdsize < sizeof(struct load_command) || cmdsize > remaining) {
+            fprintf(stderr, "Ошибка: Некорректный размер команды загрузки %u\n", i + 1);
+            return -1;
+        }
+
+        uint32_t type = macho_swap_if32(swap, lc->cmd);
+        if (type == LC_SEGMENT || type == LC_SEGMENT_64) {
+            size_t header_size = type == LC_SEGMENT ? sizeof(struct segment_command) : sizeof(struct segment_command_64);
+            size_t section_size = type == LC_SEGMENT ? sizeof(struct section) : sizeof(struct section_64);
+            uint32_t nsects = type == LC_SEGMENT
+                              ? macho_swap_if32(swap, ((const struct segment_command *)lc)->nsects)
+                              : macho_swap_if32(swap, ((const struct segment_command_64 *)lc)->nsects);
+            if (cmdsize < header_size || nsects > (cmdsize - header_size) / section_size) {
+                fprintf(stderr, "Ошибка: Секции сегмента выходят за команду загрузки %u\n", i + 1);
+                return -1;
+            }
             segment_count++;
-        } else if (cmd->cmd == LC_LOAD_DYLIB || cmd->cmd == LC_LOAD_WEAK_DYLIB ||
-                   cmd->cmd == LC_REEXPORT_DYLIB || cmd->cmd == LC_LOAD_UPWARD_DYLIB ||
-                   cmd->cmd == LC_LAZY_LOAD_DYLIB) {
+            section_count += nsects; // Не переполняется: каждая секция занимает не меньше 68 байт команд
+        } else if (type == LC_LOAD_DYLIB || type == LC_LOAD_WEAK_DYLIB ||
+                   type == LC_REEXPORT_DYLIB || type == LC_LOAD_UPWARD_DYLIB ||
+                   type == LC_LAZY_LOAD_DYLIB) {
+            if (cmdsize < sizeof(struct dylib_command)) {
+                fprintf(stderr, "Ошибка: Некорректный размер команды загрузки %u\n", i + 1);
+                return -1;
+            }
             dylib_count++;
         }
-        cmd = (struct load_command *)((uint8_t *)cmd + cmd->cmdsize);
+        cursor += cmdsize;
+        remaining -= cmdsize;
     }
 
-    // Выделяем память для сегментов и библиотек
+    // Выделяем память для сегментов, секций и библиотек
     mach_o_file->segments = calloc(segment_count, sizeof(Segment));
     mach_o_file->dylibs = calloc(dylib_count, sizeof(Dylib));
-    if (!mach_o_file->segments || !mach_o_file->dylibs) {
+    mach_o_file->sections = section_count > 0 ? calloc(section_count, sizeof(MachOSection)) : NULL;
+    if (!mach_o_file->segments || !mach_o_file->dylibs || (section_count > 0 && !mach_o_file->sections)) {
         fprintf(stderr, "Ошибка: Не удалось выделить память для сегментов или библиотек\n");
-        free(mach_o_file->commands);
-        free(mach_o_file->segments);
-        free(mach_o_file->dylibs);
-        mach_o_file->commands = NULL;
-        mach_o_file->segments = NULL;
-        mach_o_file->dylibs = NULL;
+        free_parsed_commands(mach_o_file);
         return -1;
     }
     mach_o_file->segment_count = segment_count;
+    mach_o_file->section_count = section_count;
     mach_o_file->dylib_count = dylib_count;
 
     // Заполняем сегменты и библиотеки
-    cmd = mach_o_file->commands;
+    const struct load_command *cmd = mach_o_file->commands;
     uint32_t seg_index = 0;
+    uint32_t section_index = 0;
     uint32_t dylib_index = 0;
     for (uint32_t i = 0; i < mach_o_file->load_command_count; i++) {
-        if (cmd->cmd == LC_SEGMENT_64) {
-            struct segment_command_64 *seg_cmd = (struct segment_command_64 *)cmd;
+        uint32_t type = macho_swap_if32(swap, cmd->cmd);
+        uint32_t cmdsize = macho_swap_if32(swap, cmd->cmdsize);
+        if (type == LC_SEGMENT_64) {
+            const struct segment_command_64 *seg_cmd = (const struct segment_command_64 *)cmd;
             Segment *seg = &mach_o_file->segments[seg_index++];
             strncpy(seg->segname, seg_cmd->segname, 16);
             seg->segname[16] = '\0';
-            seg->vmaddr = seg_cmd->vmaddr;
-            seg->vmsize = seg_cmd->vmsize;
-            seg->fileoff = seg_cmd->fileoff;
-            seg->filesize = seg_cmd->filesize;
-            seg->maxprot = seg_cmd->maxprot;
-            seg->initprot = seg_cmd->initprot;
-            seg->nsects = seg_cmd->nsects;
-            seg->flags = seg_cmd->flags;
-            // Заполнение секций (при необходимости)
-        } else if (cmd->cmd == LC_SEGMENT) {
-            struct segment_command *seg_cmd = (struct segment_command *)cmd;
+            seg->vmaddr = macho_swap_if64(swap, seg_cmd->vmaddr);
+            seg->vmsize = macho_swap_if64(swap, seg_cmd->vmsize);
+            seg->fileoff = macho_swap_if64(swap, seg_cmd->fileoff);
+            seg->filesize = macho_swap_if64(swap, seg_cmd->filesize);
+            seg->maxprot = macho_swap_if32(swap, (uint32_t)seg_cmd->maxprot);
+            seg->initprot = macho_swap_if32(swap, (uint32_t)seg_cmd->initprot);
+            seg->nsects = macho_swap_if32(swap, seg_cmd->nsects);
+            seg->flags = macho_swap_if32(swap, seg_cmd->flags);
+            seg->sections = seg->nsects > 0 ? &mach_o_file->sections[section_index] : NULL;
+
+            const struct section_64 *sections = (const struct section_64 *)(seg_cmd + 1);
+            for (uint32_t j = 0; j < seg->nsects; j++) {
+                MachOSection *section = &mach_o_file->sections[section_index++];
+                copy_name(section->segname, sections[j].segname);
+                copy_name(section->sectname, sections[j].sectname);
+                section->addr = macho_swap_if64(swap, sections[j].addr);
+                section->size = macho_swap_if64(swap, sections[j].size);
+                section->offset = macho_swap_if32(swap, sections[j].offset);
+                section->align = macho_swap_if32(swap, sections[j].align);
+                section->flags = macho_swap_if32(swap, sections[j].flags);
+                section->segment_index = seg_index - 1;
+            }
+        } else if (type == LC_SEGMENT) {
+            const struct segment_command *seg_cmd = (const struct segment_command *)cmd;
             Segment *seg = &mach_o_file->segments[seg_index++];
             strncpy(seg->segname, seg_cmd->segname, 16);
             seg->segname[16] = '\0';
-            seg->vmaddr = seg_cmd->vmaddr;
-            seg->vmsize = seg_cmd->vmsize;
-            seg->fileoff = seg_cmd->fileoff;
-            seg->filesize = seg_cmd->filesize;
-            seg->maxprot = seg_cmd->maxprot;
-            seg->initprot = seg_cmd->initprot;
-            seg->nsects = seg_cmd->nsects;
-            seg->flags = seg_cmd->flags;
-            // Заполнение секций (при необходимости)
-        } else if (cmd->cmd == LC_LOAD_DYLIB || cmd->cmd == LC_LOAD_WEAK_DYLIB ||
-                   cmd->cmd == LC_REEXPORT_DYLIB || cmd->cmd == LC_LOAD_UPWARD_DYLIB ||
-                   cmd->cmd == LC_LAZY_LOAD_DYLIB) {
-            struct dylib_command *dylib_cmd = (struct dylib_command *)cmd;
+            seg->vmaddr = macho_swap_if32(swap, seg_cmd->vmaddr);
+            seg->vmsize = macho_swap_if32(swap, seg_cmd->vmsize);
+            seg->fileoff = macho_swap_if32(swap, seg_cmd->fileoff);
+            seg->filesize = macho_swap_if32(swap, seg_cmd->filesize);
+            seg->maxprot = macho_swap_if32(swap, (uint32_t)seg_cmd->maxprot);
+            seg->initprot = macho_swap_if32(swap, (uint32_t)seg_cmd->initprot);
+            seg->nsects = macho_swap_if32(swap, seg_cmd->nsects);
+            seg->flags = macho_swap_if32(swap, seg_cmd->flags);
+            seg->sections = seg->nsects > 0 ? &mach_o_file->sections[section_index] : NULL;
+
+            const struct section *sections = (const struct section *)(seg_cmd + 1);
+            for (uint32_t j = 0; j < seg->nsects; j++) {
+                MachOSection *section = &mach_o_file->sections[section_index++];
+                copy_name(section->segname, sections[j].segname);
+                copy_name(section->sectname, sections[j].sectname);
+                section->addr = macho_swap_if32(swap, sections[j].addr);
+                section->size = macho_swap_if32(swap, sections[j].size);
+                section->offset = macho_swap_if32(swap, sections[j].offset);
+                section->align = macho_swap_if32(swap, sections[j].align);
+                section->flags = macho_swap_if32(swap, sections[j].flags);
+                section->segment_index = seg_index - 1;
+            }
+        } else if (type == LC_LOAD_DYLIB || type == LC_LOAD_WEAK_DYLIB ||
+                   type == LC_REEXPORT_DYLIB || type == LC_LOAD_UPWARD_DYLIB ||
+                   type == LC_LAZY_LOAD_DYLIB) {
+            const struct dylib_command *dylib_cmd = (const struct dylib_command *)cmd;
             Dylib *dylib = &mach_o_file->dylibs[dylib_index++];
-            char *name = (char *)cmd + dylib_cmd->dylib.name.offset;
-            dylib->name = strdup(name);
+            uint32_t name_offset = macho_swap_if32(swap, dylib_cmd->dylib.name.offset);
+            if (name_offset >= cmdsize) {
+                name_offset = cmdsize;
+            }
+            dylib->name = strndup((const char *)cmd + name_offset, cmdsize - name_offset);
             if (!dylib->name) {
                 fprintf(stderr, "Ошибка: Не удалось выделить память для имени библиотеки\n");
-                // Освобождаем уже выделенные ресурсы
-                for (uint32_t j = 0; j < dylib_index; j++) {
-                    free(mach_o_file->dylibs[j].name);
-                }
-                free(mach_o_file->dylibs);
-                free(mach_o_file->segments);
-                free(mach_o_file->commands);
-                mach_o_file->dylibs = NULL;
-                mach_o_file->segments = NULL;
-                mach_o_file->commands = NULL;
+                free_parsed_commands(mach_o_file);
                 return -1;
             }
-            dylib->timestamp = dylib_cmd->dylib.timestamp;
-            dylib->current_version = dylib_cmd->dylib.current_version;
-            dylib->compatibility_version = dylib_cmd->dylib.compatibility_version;
+            dylib->timestamp = macho_swap_if32(swap, dylib_cmd->dylib.timestamp);
+            dylib->current_version = macho_swap_if32(swap, dylib_cmd->dylib.current_version);
+            dylib->compatibility_version = macho_swap_if32(swap, dylib_cmd->dylib.compatibility_version);
         }
-        cmd = (struct load_command *)((uint8_t *)cmd + cmd->cmdsize);
+        cmd = (const struct load_command *)((const uint8_t *)cmd + cmdsize);
     }
 
+    if (build_section_index(mach_o_file) != 0) {
+        free_parsed_commands(mach_o_file);
+        return -1;
+    }
     return 0;
 }
 
-static int read_and_validate(FILE *file, void *buffer, size_t size, const char *err_msg) {
-    if (fread(buffer, 1, size, file) != size) {
-        fprintf(stderr, "%s\n", err_msg);
+/**
+ * Анализирует команды загрузки Mach-O файла и заполняет соответствующие поля структуры MachOFile.
+ * Команды не копируются: mach_o_file->commands указывает прямо в образ.
+ *
+ * @param mach_o_file Структура с данными о Mach-O.
+ * @return 0 при успехе, -1 в случае ошибки.
+ */
+int analyze_load_commands(MachOFile *mach_o_file) {
+    if (!mach_o_file || !mach_o_file->data) {
+        fprintf(stderr, "Ошибка: NULL указатель на MachOFile или его данные\n");
         return -1;
     }
-    return 0;
+
+    // Проверяем, что заголовок валиден
+    if (mach_o_file->load_command_count == 0 || mach_o_file->sizeofcmds == 0) {
+        fprintf(stderr, "Ошибка: Нет команд загрузки\n");
+        return -1;
+    }
+
+    mach_o_file->commands = macho_file_slice(mach_o_file, mach_o_file->header_size, mach_o_file->sizeofcmds);
+    if (!mach_o_file->commands) {
+        fprintf(stderr, "Ошибка: Команды загрузки выходят за границы файла\n");
+        return -1;
+    }
+
+    int rc = mach_o_file->swapped ? parse_load_commands(mach_o_file, true)
+                                  : parse_load_commands(mach_o_file, false);
+    if (rc != 0) {
+        mach_o_file->commands = NULL;
+    }
+    return rc;
 }
 
 void free_mach_o_file(MachOFile *mf) {
@@ -533,11 +649,8 @@ void free_mach_o_file(MachOFile *mf) {
         return;
     }
 
-    // Освобождаем команды загрузки
-    if (mf->commands) {
-        free(mf->commands);
-        mf->commands = NULL;
-    }
+    // Команды загрузки лежат в образе и отдельно не освобождаются
+    mf->commands = NULL;
 
     // Освобождаем динамические библиотеки
     if (mf->dylibs) {
@@ -551,24 +664,47 @@ void free_mach_o_file(MachOFile *mf) {
         mf->dylibs = NULL;
     }
 
-    // Освобождаем сегменты
-    if (mf->segments) {
-        for (uint32_t i = 0; i < mf->segment_count; ++i) {
-            if (mf->segments[i].sections) {
-                free(mf->segments[i].sections);
-                mf->segments[i].sections = NULL;
-            }
-            if (mf->segments[i].sections32) {
-                free(mf->segments[i].sections32);
-                mf->segments[i].sections32 = NULL;
-            }
-        }
-        free(mf->segments);
-        mf->segments = NULL;
+    // Освобождаем сегменты и плоскую таблицу секций, на которую они ссылаются
+    free(mf->segments);
+    mf->segments = NULL;
+    free(mf->sections);
+    mf->sections = NULL;
+    free(mf->section_slots);
+    mf->section_slots = NULL;
+
+    // Освобождаем индекс символов
+    macho_symbol_index_free(mf->symbol_index);
+    mf->symbol_index = NULL;
+
+    // Освобождаем таблицу импортов
+    macho_import_table_free(mf->import_table);
+    mf->import_table = NULL;
+
+    // Освобождаем адреса функций
+    macho_function_starts_free(mf->function_starts);
+    mf->function_starts = NULL;
+    mf->cache_failed = 0;
+
+    // Освобождаем образ, если он был создан в analyze_mach_o
+    if (mf->owned_image) {
+        macho_image_close(mf->owned_image);
+        free(mf->owned_image);
+        mf->owned_image = NULL;
     }
+    mf->data = NULL;
+    mf->data_size = 0;
 
     // Сбрасываем счётчики
     mf->dylib_count = 0;
     mf->segment_count = 0;
     mf->load_command_count = 0;
-}
\ No newline at end of file
+}
+void macho_file_move(MachOFile *dst, MachOFile *src) {
+    if (!dst || !src) {
+        fprintf(stderr, "Ошибка: NULL указатель на MachOFile\n");
+        return;
+    }
+    // Переносится вся структура целиком, поэтому новые кеши не нужно перечислять здесь
+    *dst = *src;
+    memset(src, 0, sizeof(MachOFile));
+}
@@ -0,0 +1,161 @@
+#include "macho_image.h"
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * Отображает в память открытый дескриптор.
+ *
+ * @param fd Дескриптор открытого файла.
+ * @param image Структура для записи образа.
+ * @return 0 при успехе, 1 если файл не поддерживает mmap, -1 в случае ошибки.
+ */
+static int map_descriptor(int fd, MachOImage *image) {
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        return -1;
+    }
+    if (!S_ISREG(st.st_mode)) {
+        return 1;
+    }
+    if (st.st_size == 0) {
+        fprintf(stderr, "Ошибка: Файл пуст\n");
+        return -1;
+    }
+    if ((uint64_t)st.st_size > (uint64_t)SIZE_MAX) {
+        fprintf(stderr, "Ошибка: Файл не помещается в адресное пространство\n");
+        return -1;
+    }
+
+    void *base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (base == MAP_FAILED) {
+        return 1;
+    }
+
+    image->base = base;
+    image->size = (uint64_t)st.st_size;
+    image->kind = MACHO_IMAGE_MAPPED;
+    return 0;
+}
+
+/**
+ * Читает поток целиком в буфер на куче. Используется, когда mmap невозможен.
+ */
+static int read_stream(FILE *file, MachOImage *image) {
+    size_t capacity = 1 << 16;
+    size_t size = 0;
+    uint8_t *buffer = malloc(capacity);
+    if (!buffer) {
+        fprintf(stderr, "Ошибка: Не удалось выделить память для чтения файла\n");
+        return -1;
+    }
+
+    size_t n;
+    while ((n = fread(buffer + size, 1, capacity - size, file)) > 0) {
+        size += n;
+        if (size == capacity) {
+            uint8_t *grown = realloc(buffer, capacity * 2);
+            if (!grown) {
+                fprintf(stderr, "Ошибка: Не удалось выделить память для чтения файла\n");
+                free(buffer);
+                return -1;
+            }
+            buffer = grown;
+            capacity *= 2;
+        }
+    }
+
+    if (ferror(file) || size == 0) {
+        fprintf(stderr, "Ошибка: Не удалось прочитать файл\n");
+        free(buffer);
+        return -1;
+    }
+
+    image->base = buffer;
+    image->size = size;
+    image->kind = MACHO_IMAGE_HEAP;
+    return 0;
+}
+
+int macho_image_open(const char *path, MachOImage *image) {
+    if (!path || !image) {
+        fprintf(stderr, "Ошибка: NULL указатель в macho_image_open\n");
+        return -1;
+    }
+    memset(image, 0, sizeof(MachOImage));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Ошибка: Не удалось открыть файл %s\n", path);
+        return -1;
+    }
+
+    int rc = map_descriptor(fd, image);
+    close(fd);
+    if (rc == 1) {
+        FILE *file = fopen(path, "rb");
+        if (!file) {
+            fprintf(stderr, "Ошибка: Не удалось открыть файл %s\n", path);
+            return -1;
+        }
+        rc = read_stream(file, image);
+        fclose(file);
+    }
+    return rc;
+}
+
+int macho_image_from_file(FILE *file, MachOImage *image) {
+    if (!file || !image) {
+        fprintf(stderr, "Ошибка: NULL указатель в macho_image_from_file\n");
+        return -1;
+    }
+    memset(image, 0, sizeof(MachOImage));
+
+    fflush(file);
+    int rc = map_descriptor(fileno(file), image);
+    if (rc == 1) {
+        rewind(file);
+        rc = read_stream(file, image);
+    }
+    return rc;
+}
+
+int macho_image_from_memory(const void *data, uint64_t size, MachOImage *image) {
+    if (!data || !image || size == 0) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в macho_image_from_memory\n");
+        return -1;
+    }
+    image->base = data;
+    image->size = size;
+    image->kind = MACHO_IMAGE_BORROWED;
+    return 0;
+}
+
+void macho_image_close(MachOImage *image) {
+    if (!image) {
+        return;
+    }
+    switch (image->kind) {
+        case MACHO_IMAGE_MAPPED:
+            munmap((void *)image->base, (size_t)image->size);
+            break;
+        case MACHO_IMAGE_HEAP:
+            free((void *)image->base);
+            break;
+        default:
+            break;
+    }
+    image->base = NULL;
+    image->size = 0;
+    image->kind = MACHO_IMAGE_NONE;
+}
+
+const void *macho_image_slice(const MachOImage *image, uint64_t offset, uint64_t size) {
+    if (!image || !image->base || !macho_range_valid(offset, size, image->size)) {
+        return NULL;
+    }
+    return image->base + offset;
+}
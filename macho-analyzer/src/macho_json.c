@@ -0,0 +1,322 @@
+#include "macho_json.h"
+#include "lc_commands.h"
+#include <string.h>
+
+/**
+ * Записывает версию в формате X.Y.Z, как она хранится в dylib_command.
+ */
+static void write_version(JsonWriter *writer, uint32_t version) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%u.%u.%u", version >> 16, (version >> 8) & 0xff, version & 0xff);
+    json_string(writer, buffer);
+}
+
+static void write_load_commands(JsonWriter *writer, const MachOFile *mach_o_file) {
+    json_key(writer, "load_commands");
+    json_begin_array(writer);
+    const struct load_command *cmd = mach_o_file->commands;
+    for (uint32_t i = 0; cmd && i < mach_o_file->load_command_count; i++) {
+        uint32_t type = macho_command_type(mach_o_file, cmd);
+        const LCCommandInfo *info = get_lc_command_info_by_id(type);
+        json_begin_object(writer);
+        json_key(writer, "cmd");
+        json_uint(writer, type);
+        json_key(writer, "name");
+        json_string(writer, info ? info->name : NULL);
+        json_key(writer, "size");
+        json_uint(writer, macho_command_size(mach_o_file, cmd));
+        json_end_object(writer);
+        cmd = macho_next_command(mach_o_file, cmd);
+    }
+    json_end_array(writer);
+}
+
+static void write_segments(JsonWriter *writer, const MachOFile *mach_o_file) {
+    json_key(writer, "segments");
+    json_begin_array(writer);
+    for (uint32_t i = 0; mach_o_file->segments && i < mach_o_file->segment_count; i++) {
+        const Segment *segment = &mach_o_file->segments[i];
+        json_begin_object(writer);
+        json_key(writer, "name");
+        json_string_n(writer, segment->segname, sizeof(segment->segname));
+        json_key(writer, "vmaddr");
+        json_uint(writer, segment->vmaddr);
+        json_key(writer, "vmsize");
+        json_uint(writer, segment->vmsize);
+        json_key(writer, "fileoff");
+        json_uint(writer, segment->fileoff);
+        json_key(writer, "filesize");
+        json_uint(writer, segment->filesize);
+        json_key(writer, "maxprot");
+        json_uint(writer, segment->maxprot);
+        json_key(writer, "initprot");
+        json_uint(writer, segment->initprot);
+        json_key(writer, "nsects");
+        json_uint(writer, segment->nsects);
+        json_key(writer, "flags");
+        json_uint(writer, segment->flags);
+        json_end_object(writer);
+    }
+    json_end_array(writer);
+}
+
+static void write_dylibs(JsonWriter *writer, const MachOFile *mach_o_file) {
+    json_key(writer, "dylibs");
+    json_begin_array(writer);
+    for (uint32_t i = 0; mach_o_file->dylibs && i < mach_o_file->dylib_count; i++) {
+        const Dylib *dylib = &mach_o_file->dylibs[i];
+        json_begin_object(writer);
+        json_key(writer, "name");
+        json_string(writer, dylib->name);
+        json_key(writer, "timestamp");
+        json_uint(writer, dylib->timestamp);
+        json_key(writer, "current_version");
+        write_version(writer, dylib->current_version);
+        json_key(writer, "compatibility_version");
+        write_version(writer, dylib->compatibility_version);
+        json_end_object(writer);
+    }
+    json_end_array(writer);
+}
+
+static void write_security(JsonWriter *writer, const SecurityFeatures *security) {
+    json_key(writer, "security");
+    json_begin_object(writer);
+    json_key(writer, "aslr");
+    json_bool(writer, security->aslr);
+    json_key(writer, "dep");
+    json_bool(writer, security->dep);
+    json_key(writer, "stack_canaries");
+    json_bool(writer, security->stack_canaries);
+    json_key(writer, "sandbox_dylibs");
+    json_begin_array(writer);
+    for (uint32_t i = 0; i < security->sandbox_dylib_count && i < SECURITY_MAX_SANDBOX_DYLIBS; i++) {
+        json_string(writer, security->sandbox_dylibs[i]);
+    }
+    json_end_array(writer);
+    json_key(writer, "sandbox_dylib_count");
+    json_uint(writer, security->sandbox_dylib_count);
+    json_key(writer, "entitlements");
+    json_bool(writer, security->entitlements);
+    json_key(writer, "bitcode");
+    json_bool(writer, security->bitcode);
+    json_end_object(writer);
+}
+
+/**
+ * Записывает поля архитектуры внутри уже открытого объекта.
+ */
+static void write_mach_o_fields(JsonWriter *writer, const MachOJsonRecord *record) {
+    const MachOFile *mach_o_file = record->mach_o_file;
+
+    json_key(writer, "path");
+    json_string(writer, record->path);
+    json_key(writer, "arch_index");
+    json_uint(writer, record->arch_index);
+    json_key(writer, "arch");
+    json_string(writer, get_arch_name(mach_o_file->cpu_type, mach_o_file->cpu_subtype));
+    if (record->arch) {
+        json_key(writer, "offset");
+        json_uint(writer, record->arch->offset);
+        json_key(writer, "size");
+        json_uint(writer, record->arch->size);
+    }
+    json_key(writer, "cpu_type");
+    json_int(writer, mach_o_file->cpu_type);
+    json_key(writer, "cpu_subtype");
+    json_int(writer, mach_o_file->cpu_subtype);
+    json_key(writer, "magic");
+    json_uint(writer, mach_o_file->magic);
+    json_key(writer, "file_type");
+    json_uint(writer, mach_o_file->file_type);
+    json_key(writer, "flags");
+    json_uint(writer, mach_o_file->flags);
+    json_key(writer, "is_64_bit");
+    json_bool(writer, mach_o_file->is_64_bit);
+
+    write_load_commands(writer, mach_o_file);
+    write_segments(writer, mach_o_file);
+    write_dylibs(writer, mach_o_file);
+
+    if (record->security) {
+        write_security(writer, record->security);
+    }
+    if (record->language) {
+        json_key(writer, "language");
+        json_string(writer, record->language->language[0] ? record->language->language : NULL);
+        json_key(writer, "compiler");
+        json_string(writer, record->language->compiler[0] ? record->language->compiler : NULL);
+    }
+}
+
+void write_mach_o_json(JsonWriter *writer, const MachOJsonRecord *record) {
+    if (!writer || !record || !record->mach_o_file) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в write_mach_o_json\n");
+        return;
+    }
+    json_begin_object(writer);
+    write_mach_o_fields(writer, record);
+    json_end_object(writer);
+}
+
+static const char *finding_kind_name(uint32_t kind) {
+    switch (kind) {
+        case SECURITY_FINDING_UNSAFE_FUNCTION: return "unsafe_function";
+        case SECURITY_FINDING_WRITABLE_CODE: return "writable_code";
+        case SECURITY_FINDING_DEBUG_SYMBOLS: return "debug_symbols";
+        default: return NULL;
+    }
+}
+
+/**
+ * Записывает поля архитектуры из файла результатов внутри уже открытого объекта.
+ * Путь и положение архитектуры передаются отдельно: у записей кеша они свои
+ * для каждого файла, в котором найдена архитектура.
+ */
+static void write_result_fields(JsonWriter *writer, const ResultReader *reader, const ResultArchView *view,
+                                const char *path, uint32_t arch_index, uint64_t offset, uint64_t size) {
+    const ResultArchRecord *arch = view->arch;
+
+    json_key(writer, "path");
+    json_string(writer, path);
+    json_key(writer, "arch_index");
+    json_uint(writer, arch_index);
+    json_key(writer, "arch");
+    json_string(writer, get_arch_name(arch->cpu_type, arch->cpu_subtype));
+    json_key(writer, "offset");
+    json_uint(writer, offset);
+    json_key(writer, "size");
+    json_uint(writer, size);
+    json_key(writer, "cpu_type");
+    json_int(writer, arch->cpu_type);
+    json_key(writer, "cpu_subtype");
+    json_int(writer, arch->cpu_subtype);
+    json_key(writer, "file_type");
+    json_uint(writer, arch->file_type);
+    json_key(writer, "flags");
+    json_uint(writer, arch->flags);
+    json_key(writer, "is_64_bit");
+    json_bool(writer, arch->is_64_bit);
+    json_key(writer, "load_command_count");
+    json_uint(writer, arch->load_command_count);
+
+    json_key(writer, "segments");
+    json_begin_array(writer);
+    for (uint32_t i = 0; i < arch->segment_count; i++) {
+        const ResultSegment *segment = &view->segments[i];
+        json_begin_object(writer);
+        json_key(writer, "name");
+        json_string(writer, result_reader_string(reader, segment->name));
+        json_key(writer, "vmaddr");
+        json_uint(writer, segment->vmaddr);
+        json_key(writer, "vmsize");
+        json_uint(writer, segment->vmsize);
+        json_key(writer, "fileoff");
+        json_uint(writer, segment->fileoff);
+        json_key(writer, "filesize");
+        json_uint(writer, segment->filesize);
+        json_key(writer, "maxprot");
+        json_uint(writer, segment->maxprot);
+        json_key(writer, "initprot");
+        json_uint(writer, segment->initprot);
+        json_key(writer, "nsects");
+        json_uint(writer, segment->nsects);
+        json_end_object(writer);
+    }
+    json_end_array(writer);
+
+    json_key(writer, "dylibs");
+    json_begin_array(writer);
+    for (uint32_t i = 0; i < arch->dylib_count; i++) {
+        const ResultDylib *dylib = &view->dylibs[i];
+        json_begin_object(writer);
+        json_key(writer, "name");
+        json_string(writer, result_reader_string(reader, dylib->name));
+        json_key(writer, "timestamp");
+        json_uint(writer, dylib->timestamp);
+        json_key(writer, "current_version");
+        write_version(writer, dylib->current_version);
+        json_key(writer, "compatibility_version");
+        write_version(writer, dylib->compatibility_version);
+        json_end_object(writer);
+    }
+    json_end_array(writer);
+
+    json_key(writer, "findings");
+    json_begin_array(writer);
+    for (uint32_t i = 0; i < arch->finding_count; i++) {
+        const ResultFinding *finding = &view->findings[i];
+        json_begin_object(writer);
+        json_key(writer, "kind");
+        json_string(writer, finding_kind_name(finding->kind));
+        json_key(writer, "name");
+        json_string(writer, result_reader_string(reader, finding->name));
+        json_end_object(writer);
+    }
+    json_end_array(writer);
+
+    SecurityFeatures security;
+    if (result_security_features(reader, view, &security)) {
+        write_security(writer, &security);
+    }
+    json_key(writer, "language");
+    json_string(writer, result_reader_string(reader, arch->language));
+    json_key(writer, "compiler");
+    json_string(writer, result_reader_string(reader, arch->compiler));
+}
+
+void write_result_arch_json(JsonWriter *writer, const ResultReader *reader, const ResultArchView *view) {
+    if (!writer || !reader || !view || !view->arch) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в write_result_arch_json\n");
+        return;
+    }
+    const ResultArchRecord *arch = view->arch;
+    json_begin_object(writer);
+    write_result_fields(writer, reader, view, result_reader_string(reader, arch->path), arch->arch_index,
+                        arch->offset, arch->size);
+    json_end_object(writer);
+}
+
+void write_batch_record_json(JsonWriter *writer, const BatchRecord *record) {
+    if (!writer || !record) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в write_batch_record_json\n");
+        return;
+    }
+
+    json_begin_object(writer);
+    json_key(writer, "type");
+    json_string(writer, record->kind == BATCH_RECORD_FILE ? "file" : "arch");
+    if (record->change != BATCH_CHANGE_NONE) {
+        json_key(writer, "change");
+        json_string(writer, batch_change_name(record->change));
+    }
+
+    if (record->kind == BATCH_RECORD_ARCH && record->mach_o_file) {
+        MachOJsonRecord arch = {record->path, record->arch_index, &record->arch, record->mach_o_file,
+                                &record->security, &record->language};
+        write_mach_o_fields(writer, &arch);
+    } else if (record->kind == BATCH_RECORD_ARCH && record->cache_reader) {
+        write_result_fields(writer, record->cache_reader, &record->cached, record->path, record->arch_index,
+                            record->arch.offset, record->arch.size);
+    } else {
+        json_key(writer, "path");
+        json_string(writer, record->path);
+        if (record->kind == BATCH_RECORD_FILE) {
+            json_key(writer, "file_size");
+            json_uint(writer, record->file_size);
+            json_key(writer, "fat");
+            json_bool(writer, record->is_fat);
+            json_key(writer, "arch_count");
+            json_uint(writer, record->arch_count);
+        } else {
+            json_key(writer, "arch_index");
+            json_uint(writer, record->arch_index);
+            json_key(writer, "arch");
+            json_string(writer, record->arch_name);
+        }
+    }
+
+    json_key(writer, "error");
+    json_string(writer, record->status == 0 ? NULL : record->error);
+    json_end_object(writer);
+}
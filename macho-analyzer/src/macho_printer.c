@@ -1,143 +1,12 @@
 #include "macho_printer.h"
 #include "macho_analyzer.h"
-#include "security_check.h"
+#include "lc_commands.h"
+#include "macho_types.h"
+#include "function_starts.h"
 #include <stdlib.h>
 #include <string.h>
-#include <mach-o/nlist.h>
-#include <mach-o/loader.h>
 #include <stdbool.h>
 
-/**
- * Выводит информацию о заголовке Mach-O файла.
- *
- * @param mach_o_file Указатель на структуру MachOFile.
- */
-void print_header_info(const MachOFile *mach_o_file);
-
-/**
- * Выводит информацию о команде сегмента.
- *
- * @param cmd Указатель на команду сегмента.
- * @param is_64_bit Флаг, указывающий, является ли файл 64-битным.
- */
-static void print_segment_command(const struct load_command *cmd, bool is_64_bit);
-
-/**
- * Выводит информацию о команде таблицы символов.
- *
- * @param cmd Указатель на команду таблицы символов.
- * @param mach_o_file Указатель на структуру MachOFile.
- * @param file Указатель на файл для чтения данных.
- */
-static void print_symtab_command(const struct load_command *cmd, const MachOFile *mach_o_file, FILE *file);
-
-/**
- * Выводит информацию о команде динамической таблицы символов.
- *
- * @param cmd Указатель на команду динамической таблицы символов.
- * @param file Указатель на файл для чтения данных.
- */
-static void print_dysymtab_command(const struct load_command *cmd, FILE *file);
-
-/**
- * Выводит информацию о команде динамической библиотеки.
- *
- * @param cmd Указатель на команду динамической библиотеки.
- */
-static void print_dylib_command(const struct load_command *cmd);
-
-/**
- * Выводит информацию о команде загрузчика динамических библиотек.
- *
- * @param cmd Указатель на команду загрузчика.
- */
-void print_dylinker_command(const struct load_command *cmd);
-
-/**
- * Выводит информацию о команде UUID.
- *
- * @param cmd Указатель на команду UUID.
- */
-static void print_uuid_command(const struct load_command *cmd);
-
-/**
- * Выводит информацию о команде минимальной версии.
- *
- * @param cmd Указатель на команду минимальной версии.
- */
-static void print_version_min_command(const struct load_command *cmd);
-
-/**
- * Выводит информацию о команде версии исходного кода.
- *
- * @param cmd Указатель на команду версии исходного кода.
- */
-static void print_source_version_command(const struct load_command *cmd);
-
-/**
- * Выводит информацию о команде точки входа.
- *
- * @param cmd Указатель на команду точки входа.
- */
-static void print_entry_point_command(const struct load_command *cmd);
-
-/**
- * Выводит информацию о команде начала функций.
- *
- * @param cmd Указатель на команду начала функций.
- * @param file Указатель на файл для чтения данных.
- */
-static void print_function_starts_command(const struct load_command *cmd, FILE *file);
-
-/**
- * Выводит информацию о команде данных в коде.
- *
- * @param cmd Указатель на команду данных в коде.
- */
-static void print_data_in_code_command(const struct load_command *cmd);
-
-/**
- * Выводит информацию о команде подписи кода.
- *
- * @param cmd Указатель на команду подписи кода.
- */
-static void print_code_signature_command(const struct load_command *cmd);
-
-/**
- * Выводит информацию о команде информации о шифровании.
- *
- * @param cmd Указатель на команду информации о шифровании.
- */
-static void print_encryption_info_command(const struct load_command *cmd);
-
-/**
- * Выводит информацию о команде пути загрузки.
- *
- * @param cmd Указатель на команду пути загрузки.
- */
-static void print_rpath_command(const struct load_command *cmd);
-
-/**
- * Выводит информацию о команде версии сборки.
- *
- * @param cmd Указатель на команду версии сборки.
- */
-static void print_build_version_command(const struct load_command *cmd);
-
-/**
- * Выводит информацию о команде опций компоновщика.
- *
- * @param cmd Указатель на команду опций компоновщика.
- */
-static void print_linker_option_command(const struct load_command *cmd);
-
-/**
- * Выводит информацию о команде заметок.
- *
- * @param cmd Указатель на команду заметок.
- */
-static void print_note_command(const struct load_command *cmd);
-
 /**
  * Выводит информацию о заголовке Mach-O файла.
  */
@@ -158,125 +27,128 @@ void print_header_info(const MachOFile *mach_o_file) {
     printf("  Флаги: 0x%x\n", mach_o_file->flags);
 }
 
+/**
+ * Возвращает имя команды загрузки из таблицы LC команд.
+ */
+static const char *command_name(const struct load_command *cmd, const MachOFile *mach_o_file) {
+    const LCCommandInfo *info = get_lc_command_info_by_id(macho_command_type(mach_o_file, cmd));
+    return info ? info->name : "LC_???";
+}
+
 /**
  * Выводит информацию о команде сегмента.
  */
-static void print_segment_command(const struct load_command *cmd, bool is_64_bit) {
-    if (!cmd) {
+void print_segment_command(const struct load_command *cmd, const MachOFile *mach_o_file) {
+    if (!cmd || !mach_o_file) {
         fprintf(stderr, "Ошибка: NULL указатель на команду сегмента\n");
         return;
     }
 
-    if (is_64_bit) {
+    if (macho_command_type(mach_o_file, cmd) == LC_SEGMENT_64) {
         struct segment_command_64 *seg_cmd = (struct segment_command_64 *)cmd;
         printf("  LC_SEGMENT_64\n");
         printf("  Имя сегмента: %s\n", seg_cmd->segname);
-        printf("  Виртуальный адрес: 0x%llx\n", seg_cmd->vmaddr);
-        printf("  Размер в памяти: 0x%llx\n", seg_cmd->vmsize);
-        printf("  Смещение в файле: 0x%llx\n", seg_cmd->fileoff);
-        printf("  Размер в файле: 0x%llx\n", seg_cmd->filesize);
-        printf("  Максимальные права: 0x%x\n", seg_cmd->maxprot);
-        printf("  Начальные права: 0x%x\n", seg_cmd->initprot);
-        printf("  Количество секций: %u\n", seg_cmd->nsects);
-        printf("  Флаги: 0x%x\n", seg_cmd->flags);
+        printf("  Виртуальный адрес: 0x%llx\n", (unsigned long long)macho_get64(mach_o_file, seg_cmd->vmaddr));
+        printf("  Размер в памяти: 0x%llx\n", (unsigned long long)macho_get64(mach_o_file, seg_cmd->vmsize));
+        printf("  Смещение в файле: 0x%llx\n", (unsigned long long)macho_get64(mach_o_file, seg_cmd->fileoff));
+        printf("  Размер в файле: 0x%llx\n", (unsigned long long)macho_get64(mach_o_file, seg_cmd->filesize));
+        printf("  Максимальные права: 0x%x\n", macho_get32(mach_o_file, (uint32_t)seg_cmd->maxprot));
+        printf("  Начальные права: 0x%x\n", macho_get32(mach_o_file, (uint32_t)seg_cmd->initprot));
+        printf("  Количество секций: %u\n", macho_get32(mach_o_file, seg_cmd->nsects));
+        printf("  Флаги: 0x%x\n", macho_get32(mach_o_file, seg_cmd->flags));
     } else {
         struct segment_command *seg_cmd = (struct segment_command *)cmd;
         printf("  LC_SEGMENT\n");
         printf("  Имя сегмента: %s\n", seg_cmd->segname);
-        printf("  Виртуальный адрес: 0x%x\n", seg_cmd->vmaddr);
-        printf("  Размер в памяти: 0x%x\n", seg_cmd->vmsize);
-        printf("  Смещение в файле: 0x%x\n", seg_cmd->fileoff);
-        printf("  Размер в файле: 0x%x\n", seg_cmd->filesize);
-        printf("  Максимальные права: 0x%x\n", seg_cmd->maxprot);
-        printf("  Начальные права: 0x%x\n", seg_cmd->initprot);
-        printf("  Количество секций: %u\n", seg_cmd->nsects);
-        printf("  Флаги: 0x%x\n", seg_cmd->flags);
+        printf("  Виртуальный адрес: 0x%x\n", macho_get32(mach_o_file, seg_cmd->vmaddr));
+        printf("  Размер в памяти: 0x%x\n", macho_get32(mach_o_file, seg_cmd->vmsize));
+        printf("  Смещение в файле: 0x%x\n", macho_get32(mach_o_file, seg_cmd->fileoff));
+        printf("  Размер в файле: 0x%x\n", macho_get32(mach_o_file, seg_cmd->filesize));
+        printf("  Максимальные права: 0x%x\n", macho_get32(mach_o_file, (uint32_t)seg_cmd->maxprot));
+        printf("  Начальные права: 0x%x\n", macho_get32(mach_o_file, (uint32_t)seg_cmd->initprot));
+        printf("  Количество секций: %u\n", macho_get32(mach_o_file, seg_cmd->nsects));
+        printf("  Флаги: 0x%x\n", macho_get32(mach_o_file, seg_cmd->flags));
     }
 }
 
 /**
  * Выводит информацию о команде таблицы символов.
  */
-static void print_symtab_command(const struct load_command *cmd, const MachOFile *mach_o_file, FILE *file) {
-    if (!cmd || !mach_o_file || !file) {
+void print_symtab_command(const struct load_command *cmd, const MachOFile *mach_o_file) {
+    if (!cmd || !mach_o_file) {
         fprintf(stderr, "Ошибка: Неверные аргументы в print_symtab_command\n");
         return;
     }
 
     struct symtab_command *symtab_cmd = (struct symtab_command *)cmd;
     printf("  LC_SYMTAB\n");
-    printf("  Смещение таблицы символов: 0x%x\n", symtab_cmd->symoff);
-    printf("  Количество символов: %u\n", symtab_cmd->nsyms);
-    printf("  Смещение таблицы строк: 0x%x\n", symtab_cmd->stroff);
-    printf("  Размер таблицы строк: %u\n", symtab_cmd->strsize);
+    printf("  Смещение таблицы символов: 0x%x\n", macho_get32(mach_o_file, symtab_cmd->symoff));
+    printf("  Количество символов: %u\n", macho_get32(mach_o_file, symtab_cmd->nsyms));
+    printf("  Смещение таблицы строк: 0x%x\n", macho_get32(mach_o_file, symtab_cmd->stroff));
+    printf("  Размер таблицы строк: %u\n", macho_get32(mach_o_file, symtab_cmd->strsize));
 }
 
 /**
  * Выводит информацию о команде динамической таблицы символов.
  */
-static void print_dysymtab_command(const struct load_command *cmd, FILE *file) {
-    if (!cmd || !file) {
+void print_dysymtab_command(const struct load_command *cmd, const MachOFile *mach_o_file) {
+    if (!cmd || !mach_o_file) {
         fprintf(stderr, "Ошибка: Неверные аргументы в print_dysymtab_command\n");
         return;
     }
 
     struct dysymtab_command *dysymtab_cmd = (struct dysymtab_command *)cmd;
     printf("  LC_DYSYMTAB\n");
-    printf("  Индекс локальных символов: %u\n", dysymtab_cmd->ilocalsym);
-    printf("  Количество локальных символов: %u\n", dysymtab_cmd->nlocalsym);
-    printf("  Индекс определённых внешних символов: %u\n", dysymtab_cmd->iextdefsym);
-    printf("  Количество определённых внешних символов: %u\n", dysymtab_cmd->nextdefsym);
-    printf("  Индекс неопределённых внешних символов: %u\n", dysymtab_cmd->iundefsym);
-    printf("  Количество неопределённых внешних символов: %u\n", dysymtab_cmd->nundefsym);
+    printf("  Индекс локальных символов: %u\n", macho_get32(mach_o_file, dysymtab_cmd->ilocalsym));
+    printf("  Количество локальных символов: %u\n", macho_get32(mach_o_file, dysymtab_cmd->nlocalsym));
+    printf("  Индекс определённых внешних символов: %u\n", macho_get32(mach_o_file, dysymtab_cmd->iextdefsym));
+    printf("  Количество определённых внешних символов: %u\n", macho_get32(mach_o_file, dysymtab_cmd->nextdefsym));
+    printf("  Индекс неопределённых внешних символов: %u\n", macho_get32(mach_o_file, dysymtab_cmd->iundefsym));
+    printf("  Количество неопределённых внешних символов: %u\n", macho_get32(mach_o_file, dysymtab_cmd->nundefsym));
 }
 
 /**
  * Выводит информацию о команде динамической библиотеки.
  */
-static void print_dylib_command(const struct load_command *cmd) {
-    if (!cmd) {
+void print_dylib_command(const struct load_command *cmd, const MachOFile *mach_o_file) {
+    if (!cmd || !mach_o_file) {
         fprintf(stderr, "Ошибка: NULL указатель на команду библиотеки\n");
         return;
     }
 
     struct dylib_command *dylib_cmd = (struct dylib_command *)cmd;
-    char *name = (char *)cmd + dylib_cmd->dylib.name.offset;
-    printf("  LC_%s\n", cmd->cmd == LC_LOAD_DYLIB ? "LOAD_DYLIB" :
-                        cmd->cmd == LC_LOAD_WEAK_DYLIB ? "LOAD_WEAK_DYLIB" :
-                        cmd->cmd == LC_REEXPORT_DYLIB ? "REEXPORT_DYLIB" :
-                        "LOAD_UPWARD_DYLIB");
-    printf("  Имя библиотеки: %s\n", name);
-    printf("  Временная метка: %u\n", dylib_cmd->dylib.timestamp);
+    const char *name = macho_command_string(mach_o_file, cmd, dylib_cmd->dylib.name.offset);
+    uint32_t current_version = macho_get32(mach_o_file, dylib_cmd->dylib.current_version);
+    uint32_t compatibility_version = macho_get32(mach_o_file, dylib_cmd->dylib.compatibility_version);
+    printf("  %s\n", command_name(cmd, mach_o_file));
+    printf("  Имя библиотеки: %s\n", name ? name : "(некорректное смещение)");
+    printf("  Временная метка: %u\n", macho_get32(mach_o_file, dylib_cmd->dylib.timestamp));
     printf("  Текущая версия: %u.%u.%u\n",
-           dylib_cmd->dylib.current_version >> 16,
-           (dylib_cmd->dylib.current_version >> 8) & 0xff,
-           dylib_cmd->dylib.current_version & 0xff);
+           current_version >> 16, (current_version >> 8) & 0xff, current_version & 0xff);
     printf("  Версия совместимости: %u.%u.%u\n",
-           dylib_cmd->dylib.compatibility_version >> 16,
-           (dylib_cmd->dylib.compatibility_version >> 8) & 0xff,
-           dylib_cmd->dylib.compatibility_version & 0xff);
+           compatibility_version >> 16, (compatibility_version >> 8) & 0xff, compatibility_version & 0xff);
 }
 
 /**
  * Выводит информацию о команде загрузчика динамических библиотек.
  */
-void print_dylinker_command(const struct load_command *cmd) {
-    if (!cmd) {
+void print_dylinker_command(const struct load_command *cmd, const MachOFile *mach_o_file) {
+    if (!cmd || !mach_o_file) {
         fprintf(stderr, "Ошибка: NULL указатель на команду загрузчика\n");
         return;
     }
 
     struct dylinker_command *dylinker_cmd = (struct dylinker_command *)cmd;
-    char *name = (char *)cmd + dylinker_cmd->name.offset;
-    printf("  LC_LOAD_DYLINKER\n");
-    printf("  Имя загрузчика: %s\n", name);
+    const char *name = macho_command_string(mach_o_file, cmd, dylinker_cmd->name.offset);
+    printf("  %s\n", command_name(cmd, mach_o_file));
+    printf("  Имя загрузчика: %s\n", name ? name : "(некорректное смещение)");
 }
 
 /**
  * Выводит информацию о команде UUID.
  */
-static void print_uuid_command(const struct load_command *cmd) {
-    if (!cmd) {
+void print_uuid_command(const struct load_command *cmd, const MachOFile *mach_o_file) {
+    if (!cmd || !mach_o_file) {
         fprintf(stderr, "Ошибка: NULL указатель на команду UUID\n");
         return;
     }
@@ -293,30 +165,31 @@ static void print_uuid_command(const struct load_command *cmd) {
 /**
  * Выводит информацию о команде минимальной версии.
  */
-static void print_version_min_command(const struct load_command *cmd) {
-    if (!cmd) {
+void print_version_min_command(const struct load_command *cmd, const MachOFile *mach_o_file) {
+    if (!cmd || !mach_o_file) {
         fprintf(stderr, "Ошибка: NULL указатель на команду минимальной версии\n");
         return;
     }
 
     struct version_min_command *version_cmd = (struct version_min_command *)cmd;
-    printf("  LC_VERSION_MIN_%s\n",
-           cmd->cmd == LC_VERSION_MIN_MACOSX ? "MACOSX" : "IPHONEOS");
-    printf("  Версия: %u.%u\n", version_cmd->version >> 16, (version_cmd->version >> 8) & 0xff);
-    printf("  SDK: %u.%u\n", version_cmd->sdk >> 16, (version_cmd->sdk >> 8) & 0xff);
+    printf("  %s\n", command_name(cmd, mach_o_file));
+    uint32_t version = macho_get32(mach_o_file, version_cmd->version);
+    uint32_t sdk = macho_get32(mach_o_file, version_cmd->sdk);
+    printf("  Версия: %u.%u\n", version >> 16, (version >> 8) & 0xff);
+    printf("  SDK: %u.%u\n", sdk >> 16, (sdk >> 8) & 0xff);
 }
 
 /**
  * Выводит информацию о команде версии исходного кода.
  */
-static void print_source_version_command(const struct load_command *cmd) {
-    if (!cmd) {
+void print_source_version_command(const struct load_command *cmd, const MachOFile *mach_o_file) {
+    if (!cmd || !mach_o_file) {
         fprintf(stderr, "Ошибка: NULL указатель на команду версии исходного кода\n");
         return;
     }
 
     struct source_version_command *src_cmd = (struct source_version_command *)cmd;
-    uint64_t version = src_cmd->version;
+    uint64_t version = macho_get64(mach_o_file, src_cmd->version);
     printf("  LC_SOURCE_VERSION\n");
     printf("  Версия: %u.%u.%u.%u.%u\n",
            (uint32_t)((version >> 40) & 0xffffff),
@@ -329,132 +202,140 @@ static void print_source_version_command(const struct load_command *cmd) {
 /**
  * Выводит информацию о команде точки входа.
  */
-static void print_entry_point_command(const struct load_command *cmd) {
-    if (!cmd) {
+void print_entry_point_command(const struct load_command *cmd, const MachOFile *mach_o_file) {
+    if (!cmd || !mach_o_file) {
         fprintf(stderr, "Ошибка: NULL указатель на команду точки входа\n");
         return;
     }
 
     struct entry_point_command *entry_cmd = (struct entry_point_command *)cmd;
     printf("  LC_MAIN\n");
-    printf("  Смещение точки входа: 0x%llx\n", entry_cmd->entryoff);
-    printf("  Начальный размер стека: 0x%llx\n", entry_cmd->stacksize);
+    printf("  Смещение точки входа: 0x%llx\n", (unsigned long long)macho_get64(mach_o_file, entry_cmd->entryoff));
+    printf("  Начальный размер стека: 0x%llx\n", (unsigned long long)macho_get64(mach_o_file, entry_cmd->stacksize));
 }
 
 /**
- * Выводит информацию о команде начала функций.
+ * Выводит информацию о команде со ссылкой на данные в __LINKEDIT.
  */
-static void print_function_starts_command(const struct load_command *cmd, FILE *file) {
-    if (!cmd || !file) {
-        fprintf(stderr, "Ошибка: Неверные аргументы в print_function_starts_command\n");
+void print_linkedit_data_command(const struct load_command *cmd, const MachOFile *mach_o_file) {
+    if (!cmd || !mach_o_file) {
+        fprintf(stderr, "Ошибка: NULL указатель на команду данных __LINKEDIT\n");
         return;
     }
 
-    struct linkedit_data_command *func_cmd = (struct linkedit_data_command *)cmd;
-    printf("  LC_FUNCTION_STARTS\n");
-    printf("  Смещение данных: 0x%x\n", func_cmd->dataoff);
-    printf("  Размер данных: 0x%x\n", func_cmd->datasize);
+    struct linkedit_data_command *data_cmd = (struct linkedit_data_command *)cmd;
+    printf("  %s\n", command_name(cmd, mach_o_file));
+    printf("  Смещение данных: 0x%x\n", macho_get32(mach_o_file, data_cmd->dataoff));
+    printf("  Размер данных: 0x%x\n", macho_get32(mach_o_file, data_cmd->datasize));
 }
 
 /**
- * Выводит информацию о команде данных в коде.
+ * Выводит информацию о команде LC_FUNCTION_STARTS и число декодированных функций.
  */
-static void print_data_in_code_command(const struct load_command *cmd) {
-    if (!cmd) {
-        fprintf(stderr, "Ошибка: NULL указатель на команду данных в коде\n");
+void print_function_starts_command(const struct load_command *cmd, const MachOFile *mach_o_file) {
+    print_linkedit_data_command(cmd, mach_o_file);
+    if (!cmd || !mach_o_file) {
         return;
     }
 
-    struct linkedit_data_command *data_cmd = (struct linkedit_data_command *)cmd;
-    printf("  LC_DATA_IN_CODE\n");
-    printf("  Смещение данных: 0x%x\n", data_cmd->dataoff);
-    printf("  Размер данных: 0x%x\n", data_cmd->datasize);
+    const MachOFunctionStarts *starts = macho_get_function_starts(mach_o_file);
+    if (!starts) {
+        return;
+    }
+    printf("  Количество функций: %u\n", starts->count);
+    if (starts->count > 0) {
+        printf("  Адреса функций: 0x%llx - 0x%llx\n", (unsigned long long)starts->addresses[0],
+               (unsigned long long)starts->addresses[starts->count - 1]);
+    }
 }
 
 /**
- * Выводит информацию о команде подписи кода.
+ * Выводит информацию о команде сжатой информации для dyld.
  */
-static void print_code_signature_command(const struct load_command *cmd) {
-    if (!cmd) {
-        fprintf(stderr, "Ошибка: NULL указатель на команду подписи кода\n");
+void print_dyld_info_command(const struct load_command *cmd, const MachOFile *mach_o_file) {
+    if (!cmd || !mach_o_file) {
+        fprintf(stderr, "Ошибка: NULL указатель на команду информации для dyld\n");
         return;
     }
 
-    struct linkedit_data_command *sig_cmd = (struct linkedit_data_command *)cmd;
-    printf("  LC_CODE_SIGNATURE\n");
-    printf("  Смещение данных: 0x%x\n", sig_cmd->dataoff);
-    printf("  Размер данных: 0x%x\n", sig_cmd->datasize);
+    struct dyld_info_command *info_cmd = (struct dyld_info_command *)cmd;
+    printf("  %s\n", command_name(cmd, mach_o_file));
+    printf("  Перемещения: смещение 0x%x, размер 0x%x\n", macho_get32(mach_o_file, info_cmd->rebase_off), macho_get32(mach_o_file, info_cmd->rebase_size));
+    printf("  Привязки: смещение 0x%x, размер 0x%x\n", macho_get32(mach_o_file, info_cmd->bind_off), macho_get32(mach_o_file, info_cmd->bind_size));
+    printf("  Слабые привязки: смещение 0x%x, размер 0x%x\n", macho_get32(mach_o_file, info_cmd->weak_bind_off), macho_get32(mach_o_file, info_cmd->weak_bind_size));
+    printf("  Ленивые привязки: смещение 0x%x, размер 0x%x\n", macho_get32(mach_o_file, info_cmd->lazy_bind_off), macho_get32(mach_o_file, info_cmd->lazy_bind_size));
+    printf("  Экспорт: смещение 0x%x, размер 0x%x\n", macho_get32(mach_o_file, info_cmd->export_off), macho_get32(mach_o_file, info_cmd->export_size));
 }
 
 /**
  * Выводит информацию о команде информации о шифровании.
  */
-static void print_encryption_info_command(const struct load_command *cmd) {
-    if (!cmd) {
+void print_encryption_info_command(const struct load_command *cmd, const MachOFile *mach_o_file) {
+    if (!cmd || !mach_o_file) {
         fprintf(stderr, "Ошибка: NULL указатель на команду информации о шифровании\n");
         return;
     }
 
     struct encryption_info_command *enc_cmd = (struct encryption_info_command *)cmd;
-    printf("  LC_ENCRYPTION_INFO%s\n", cmd->cmd == LC_ENCRYPTION_INFO_64 ? "_64" : "");
-    printf("  Смещение шифрования: 0x%x\n", enc_cmd->cryptoff);
-    printf("  Размер шифрования: 0x%x\n", enc_cmd->cryptsize);
-    printf("  ID шифрования: %u\n", enc_cmd->cryptid);
+    printf("  LC_ENCRYPTION_INFO%s\n", macho_command_type(mach_o_file, cmd) == LC_ENCRYPTION_INFO_64 ? "_64" : "");
+    printf("  Смещение шифрования: 0x%x\n", macho_get32(mach_o_file, enc_cmd->cryptoff));
+    printf("  Размер шифрования: 0x%x\n", macho_get32(mach_o_file, enc_cmd->cryptsize));
+    printf("  ID шифрования: %u\n", macho_get32(mach_o_file, enc_cmd->cryptid));
 }
 
 /**
  * Выводит информацию о команде пути загрузки.
  */
-static void print_rpath_command(const struct load_command *cmd) {
-    if (!cmd) {
+void print_rpath_command(const struct load_command *cmd, const MachOFile *mach_o_file) {
+    if (!cmd || !mach_o_file) {
         fprintf(stderr, "Ошибка: NULL указатель на команду пути загрузки\n");
         return;
     }
 
     struct rpath_command *rpath_cmd = (struct rpath_command *)cmd;
-    char *path = (char *)cmd + rpath_cmd->path.offset;
+    const char *path = macho_command_string(mach_o_file, cmd, rpath_cmd->path.offset);
     printf("  LC_RPATH\n");
-    printf("  Путь: %s\n", path);
+    printf("  Путь: %s\n", path ? path : "(некорректное смещение)");
 }
 
 /**
  * Выводит информацию о команде версии сборки.
  */
-static void print_build_version_command(const struct load_command *cmd) {
-    if (!cmd) {
+void print_build_version_command(const struct load_command *cmd, const MachOFile *mach_o_file) {
+    if (!cmd || !mach_o_file) {
         fprintf(stderr, "Ошибка: NULL указатель на команду версии сборки\n");
         return;
     }
 
     struct build_version_command *build_cmd = (struct build_version_command *)cmd;
+    uint32_t minos = macho_get32(mach_o_file, build_cmd->minos);
+    uint32_t sdk = macho_get32(mach_o_file, build_cmd->sdk);
     printf("  LC_BUILD_VERSION\n");
-    printf("  Платформа: %u\n", build_cmd->platform);
-    printf("  Минимальная версия ОС: %u.%u.%u\n",
-           build_cmd->minos >> 16, (build_cmd->minos >> 8) & 0xff, build_cmd->minos & 0xff);
-    printf("  Версия SDK: %u.%u.%u\n",
-           build_cmd->sdk >> 16, (build_cmd->sdk >> 8) & 0xff, build_cmd->sdk & 0xff);
-    printf("  Количество инструментов: %u\n", build_cmd->ntools);
+    printf("  Платформа: %u\n", macho_get32(mach_o_file, build_cmd->platform));
+    printf("  Минимальная версия ОС: %u.%u.%u\n", minos >> 16, (minos >> 8) & 0xff, minos & 0xff);
+    printf("  Версия SDK: %u.%u.%u\n", sdk >> 16, (sdk >> 8) & 0xff, sdk & 0xff);
+    printf("  Количество инструментов: %u\n", macho_get32(mach_o_file, build_cmd->ntools));
 }
 
 /**
  * Выводит информацию о команде опций компоновщика.
  */
-static void print_linker_option_command(const struct load_command *cmd) {
-    if (!cmd) {
+void print_linker_option_command(const struct load_command *cmd, const MachOFile *mach_o_file) {
+    if (!cmd || !mach_o_file) {
         fprintf(stderr, "Ошибка: NULL указатель на команду опций компоновщика\n");
         return;
     }
 
     struct linker_option_command *opt_cmd = (struct linker_option_command *)cmd;
     printf("  LC_LINKER_OPTION\n");
-    printf("  Количество строк: %u\n", opt_cmd->count);
+    printf("  Количество строк: %u\n", macho_get32(mach_o_file, opt_cmd->count));
 }
 
 /**
  * Выводит информацию о команде заметок.
  */
-static void print_note_command(const struct load_command *cmd) {
-    if (!cmd) {
+void print_note_command(const struct load_command *cmd, const MachOFile *mach_o_file) {
+    if (!cmd || !mach_o_file) {
         fprintf(stderr, "Ошибка: NULL указатель на команду заметок\n");
         return;
     }
@@ -462,99 +343,253 @@ static void print_note_command(const struct load_command *cmd) {
     struct note_command *note_cmd = (struct note_command *)cmd;
     printf("  LC_NOTE\n");
     printf("  Имя данных: %s\n", note_cmd->data_owner);
-    printf("  Смещение данных: 0x%llx\n", note_cmd->offset);
-    printf("  Размер данных: 0x%llx\n", note_cmd->size);
+    printf("  Смещение данных: 0x%llx\n", (unsigned long long)macho_get64(mach_o_file, note_cmd->offset));
+    printf("  Размер данных: 0x%llx\n", (unsigned long long)macho_get64(mach_o_file, note_cmd->size));
 }
 
 /**
  * Выводит информацию о Mach-O файле, включая заголовок, проверки безопасности и команды загрузки.
  *
  * @param mach_o_file Указатель на структуру MachOFile.
- * @param file Указатель на файл для чтения дополнительных данных.
  */
-void print_mach_o_info(const MachOFile *mach_o_file, FILE *file) {
+void print_mach_o_info(const MachOFile *mach_o_file) {
     if (!mach_o_file) {
         fprintf(stderr, "Ошибка: NULL указатель на MachOFile\n");
         return;
     }
 
+    MachOReport report;
+    macho_report_analyze(mach_o_file, NULL, &report);
+    print_mach_o_report(mach_o_file, &report);
+    macho_report_free(&report);
+}
+
+void print_mach_o_report(const MachOFile *mach_o_file, const MachOReport *report) {
+    if (!mach_o_file || !report) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в print_mach_o_report\n");
+        return;
+    }
+
     print_header_info(mach_o_file);
     printf("===========================>ПРОВЕРКА БЕЗОПАСНОСТИ>=================================:\n");
-    check_security_features(mach_o_file, file);
+    if (report->status == 0) {
+        print_security_features(&report->security, stdout);
+        if (report->signature.status != CODE_SIGNATURE_ABSENT) {
+            print_code_signature(&report->signature, stdout);
+        }
+    }
     printf("===========================<ПРОВЕРКА БЕЗОПАСНОСТИ<=================================:\n");
-    struct load_command *cmd = mach_o_file->commands;
+    const struct load_command *cmd = mach_o_file->commands;
     uint32_t ncmds = mach_o_file->load_command_count;
 
     for (uint32_t i = 0; i < ncmds; i++) {
         printf("Команда загрузки %d:\n", i + 1);
-        printf("  Тип команды: %d\n", cmd->cmd);
-        printf("  Размер команды: %d\n", cmd->cmdsize);
+        uint32_t type = macho_command_type(mach_o_file, cmd);
+        printf("  Тип команды: %d\n", type);
+        printf("  Размер команды: %d\n", macho_command_size(mach_o_file, cmd));
+
+        const LCCommandInfo *info = get_lc_command_info_by_id(type);
+        if (info && info->decode) {
+            info->decode(cmd, mach_o_file);
+        } else {
+            if (info) {
+                printf("  %s\n", info->name);
+            }
+            printf("  Неизвестная или необработанная команда\n");
+        }
 
-        switch (cmd->cmd) {
-            case LC_SEGMENT:
-            case LC_SEGMENT_64:
-                print_segment_command(cmd, mach_o_file->is_64_bit);
-                break;
-            case LC_SYMTAB:
-                print_symtab_command(cmd, mach_o_file, file);
-                break;
-            case LC_DYSYMTAB:
-                print_dysymtab_command(cmd, file);
-                break;
-            case LC_LOAD_DYLIB:
-            case LC_LOAD_WEAK_DYLIB:
-            case LC_REEXPORT_DYLIB:
-            case LC_LOAD_UPWARD_DYLIB:
-                print_dylib_command(cmd);
-                break;
-            case LC_LOAD_DYLINKER:
-                print_dylinker_command(cmd);
-                break;
-            case LC_UUID:
-                print_uuid_command(cmd);
-                break;
-            case LC_VERSION_MIN_MACOSX:
-            case LC_VERSION_MIN_IPHONEOS:
-                print_version_min_command(cmd);
-                break;
-            case LC_SOURCE_VERSION:
-                print_source_version_command(cmd);
-                break;
-            case LC_MAIN:
-                print_entry_point_command(cmd);
-                break;
-            case LC_FUNCTION_STARTS:
-                print_function_starts_command(cmd, file);
-                break;
-            case LC_DATA_IN_CODE:
-                print_data_in_code_command(cmd);
-                break;
-            case LC_CODE_SIGNATURE:
-                print_code_signature_command(cmd);
-                break;
-            case LC_ENCRYPTION_INFO:
-            case LC_ENCRYPTION_INFO_64:
-                print_encryption_info_command(cmd);
-                break;
-            case LC_RPATH:
-                print_rpath_command(cmd);
-                break;
-            case LC_BUILD_VERSION:
-                print_build_version_command(cmd);
-                break;
-            case LC_LINKER_OPTION:
-                print_linker_option_command(cmd);
+        cmd = macho_next_command(mach_o_file, cmd);
+        printf("\n");
+    }
+}
+
+void print_security_features(const SecurityFeatures *features, FILE *out) {
+    if (!features || !out) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в print_security_features\n");
+        return;
+    }
+
+    fprintf(out, "Проверка функций безопасности:\n");
+    fprintf(out, features->aslr ? "  ASLR: Поддерживается (установлен флаг PIE)\n"
+                                : "  ASLR: Не поддерживается (флаг PIE отсутствует)\n");
+    fprintf(out, features->dep ? "  DEP: Поддерживается (отключено выполнение на куче)\n"
+                               : "  DEP: Не поддерживается\n");
+    fprintf(out, features->stack_canaries ? "  Stack Canaries: Поддерживаются\n"
+                                          : "  Stack Canaries: Не поддерживаются\n");
+
+    if (features->sandbox_dylib_count) {
+        uint32_t shown = features->sandbox_dylib_count < SECURITY_MAX_SANDBOX_DYLIBS ? features->sandbox_dylib_count
+                                                                                      : SECURITY_MAX_SANDBOX_DYLIBS;
+        for (uint32_t i = 0; i < shown; i++) {
+            fprintf(out, "Обнаружена песочница: %s\n", features->sandbox_dylibs[i]);
+        }
+        if (features->sandbox_dylib_count > shown) {
+            fprintf(out, "  ... и ещё %u библиотек песочницы\n", features->sandbox_dylib_count - shown);
+        }
+    } else {
+        fprintf(out, "Песочница не обнаружена в этом Mach-O файле.\n");
+    }
+    if (features->entitlements) {
+        fprintf(out, "Обнаружены полномочия в секции: __entitlements\n");
+    } else {
+        fprintf(out, "Полномочия не обнаружены в этом Mach-O файле.\n");
+    }
+
+    fprintf(out, features->bitcode ? "Обнаружен Bitcode в этом Mach-O файле.\n"
+                                   : "Bitcode не обнаружен в этом Mach-O файле.\n");
+}
+
+void print_security_findings(const SecurityFindings *findings, FILE *out) {
+    if (!findings || !out) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в print_security_findings\n");
+        return;
+    }
+
+    for (size_t i = 0; i < findings->count; i++) {
+        const SecurityFinding *finding = &findings->items[i];
+        switch (finding->kind) {
+            case SECURITY_FINDING_UNSAFE_FUNCTION:
+                fprintf(out, "Предупреждение: Обнаружена небезопасная функция: %s\n", finding->function->function_name);
+                fprintf(out, "  Категория: %s\n", finding->function->category);
+                fprintf(out, "  Уровень опасности: %s\n", finding->function->severity);
                 break;
-            case LC_NOTE:
-                print_note_command(cmd);
+            case SECURITY_FINDING_WRITABLE_CODE:
+                fprintf(out, "Предупреждение: Секция %s имеет одновременно права на запись и выполнение\n",
+                        finding->section);
                 break;
-            default:
-                printf("  Неизвестная или необработанная команда\n");
+            case SECURITY_FINDING_DEBUG_SYMBOLS:
+                fprintf(out, "Обнаружены отладочные символы в секции %s\n", finding->section);
                 break;
         }
+    }
 
-        cmd = (struct load_command *)((uint8_t *)cmd + cmd->cmdsize);
-        printf("\n");
+    size_t unsafe_count = security_findings_count(findings, SECURITY_FINDING_UNSAFE_FUNCTION);
+    if (unsafe_count > 0) {
+        fprintf(out, "Всего обнаружено небезопасных функций: %zu\n", unsafe_count);
+    } else {
+        fprintf(out, "Небезопасные функции не обнаружены.\n");
+    }
+}
+
+static const char *hash_type_name(uint8_t hash_type) {
+    switch (hash_type) {
+        case CS_HASHTYPE_SHA1:
+            return "SHA-1";
+        case CS_HASHTYPE_SHA256:
+            return "SHA-256";
+        case CS_HASHTYPE_SHA256_TRUNCATED:
+            return "SHA-256 (усечённый)";
+        case CS_HASHTYPE_SHA384:
+            return "SHA-384";
+        default:
+            return "неизвестный хеш";
+    }
+}
+
+void print_code_signature(const CodeSignatureInfo *info, FILE *out) {
+    if (!info || !out) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в print_code_signature\n");
+        return;
+    }
+
+    switch (info->status) {
+        case CODE_SIGNATURE_ABSENT:
+            fprintf(out, "Подпись кода не обнаружена в данном Mach-O файле.\n");
+            return;
+        case CODE_SIGNATURE_OUT_OF_BOUNDS:
+            fprintf(out, "Ошибка: Данные подписи кода или подписанные страницы выходят за границы файла.\n");
+            return;
+        case CODE_SIGNATURE_BAD_MAGIC:
+            fprintf(out, "Предупреждение: Magic-число подписи кода не соответствует ожидаемому значению.\n");
+            return;
+        case CODE_SIGNATURE_TOO_SMALL:
+            fprintf(out, "Предупреждение: Данные подписи кода слишком малы для директории кода.\n");
+            return;
+        case CODE_SIGNATURE_BAD_LENGTH:
+            fprintf(out, "Предупреждение: Длины и смещения директории кода не согласованы.\n");
+            return;
+        case CODE_SIGNATURE_BAD_IDENTIFIER:
+            fprintf(out, "Версия директории кода: 0x%x\n", info->version);
+            fprintf(out, "Предупреждение: Неверное смещение идентификатора в директории кода.\n");
+            return;
+        case CODE_SIGNATURE_VALID:
+        case CODE_SIGNATURE_UNSUPPORTED_HASH:
+        case CODE_SIGNATURE_PAGE_MISMATCH:
+            break;
+    }
+
+    fprintf(out, "Версия директории кода: 0x%x\n", info->version);
+    if (info->outdated) {
+        fprintf(out, "Предупреждение: Версия директории кода устарела. Рекомендуется обновление для повышения безопасности.\n");
+    }
+    fprintf(out, "Идентификатор директории кода: %s\n", info->identifier);
+
+    fprintf(out, "Хеш директории кода (первые 16 байт): ");
+    for (size_t i = 0; i < info->hash_prefix_length; i++) {
+        fprintf(out, "%02x ", info->hash_prefix[i]);
+    }
+    fprintf(out, "\n");
+
+    fprintf(out, "Вычисленный SHA-256 хеш: ");
+    for (size_t i = 0; i < sizeof(info->sha256); i++) {
+        fprintf(out, "%02x", info->sha256[i]);
+    }
+    fprintf(out, "\n");
+
+    for (uint32_t d = 0; d < info->directory_count; d++) {
+        const CodeDirectoryInfo *directory = &info->directories[d];
+        fprintf(out, "Директория кода %s: %s, страниц: %u по %u байт, подписано байт: %llu\n",
+                directory->slot == CSSLOT_CODEDIRECTORY ? "основная" : "альтернативная",
+                hash_type_name(directory->hash_type), directory->page_count, directory->page_size,
+                (unsigned long long)directory->code_limit);
+        if (!directory->verified) {
+            fprintf(out, "  Тип хеша не поддерживается, страницы не проверялись.\n");
+        } else if (directory->mismatch_count > 0) {
+            fprintf(out, "  Не совпали хеши страниц: %u (", directory->mismatch_count);
+            for (uint32_t i = 0; i < directory->mismatch_count && i < CODE_SIGNATURE_MAX_REPORTED_PAGES; i++) {
+                fprintf(out, "%s%u", i ? ", " : "", directory->mismatched_pages[i]);
+            }
+            fprintf(out, "%s)\n", directory->mismatch_count > CODE_SIGNATURE_MAX_REPORTED_PAGES ? ", ..." : "");
+        } else {
+            fprintf(out, "  Хеши всех страниц совпали.\n");
+        }
+    }
+
+    if (info->status == CODE_SIGNATURE_VALID) {
+        fprintf(out, "Подпись кода действительна: хеши всех страниц совпали.\n");
+    } else if (info->status == CODE_SIGNATURE_PAGE_MISMATCH) {
+        fprintf(out, "Предупреждение: Содержимое файла не соответствует подписи кода.\n");
+    } else {
+        fprintf(out, "Предупреждение: Ни одна директория кода не использует поддерживаемый тип хеша.\n");
+    }
+}
+
+void print_language_scores(const LanguageScores *scores, FILE *out) {
+    if (!scores || !out) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в print_language_scores\n");
+        return;
+    }
+
+    bool printed[LANGUAGE_SCORES_MAX] = {false};
+    fprintf(out, "Оценки языков%s:\n", scores->early_stop ? " (анализ остановлен досрочно)" : "");
+    for (size_t n = 0; n < scores->count; n++) {
+        // Выбор следующей по величине оценки; языков немного, сортировка не нужна
+        int best = -1;
+        for (size_t i = 0; i < scores->count; i++) {
+            if (!printed[i] && (best < 0 || scores->entries[i].score > scores->entries[best].score)) {
+                best = (int)i;
+            }
+        }
+        const LanguageScore *entry = &scores->entries[best];
+        printed[best] = true;
+        if (entry->score <= 0.0) {
+            break;
+        }
+        const char *compiler = entry->compiler && entry->compiler[0] ? entry->compiler : "Неизвестно";
+        fprintf(out, "  %s (%s): %.2f (%.0f%%) [символы: %u, секции: %u, строки: %u]\n",
+                entry->language, compiler, entry->score,
+                scores->total > 0.0 ? 100.0 * entry->score / scores->total : 0.0,
+                entry->symbol_hits, entry->section_hits, entry->string_hits);
     }
 }
 
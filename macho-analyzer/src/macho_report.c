@@ -0,0 +1,57 @@
+#include "macho_report.h"
+#include "command_visitor.h"
+#include "function_starts.h"
+#include <stdio.h>
+#include <string.h>
+
+MachOReportOptions macho_report_default_options(void) {
+    MachOReportOptions options = {0};
+    options.threads = 0;
+    options.detect_language = false;
+    options.collect_findings = false;
+    return options;
+}
+
+int macho_report_analyze(const MachOFile *mach_o_file, const MachOReportOptions *options, MachOReport *report) {
+    if (!mach_o_file || !mach_o_file->commands || !report) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в macho_report_analyze\n");
+        return -1;
+    }
+    MachOReportOptions defaults = macho_report_default_options();
+    if (!options) {
+        options = &defaults;
+    }
+    memset(report, 0, sizeof(MachOReport));
+
+    // Защитные механизмы и подпись проверяются за один проход по командам
+    MachOCommandVisitor visitor;
+    SecurityCheck security_check;
+    CodeSignatureCheck signature_check;
+    macho_visitor_init(&visitor);
+    report->status = security_check_subscribe(&visitor, &security_check, mach_o_file, &report->security) == 0 &&
+                     code_signature_subscribe(&visitor, &signature_check, options->threads, &report->signature) == 0 &&
+                     macho_visitor_run(&visitor, mach_o_file) == 0 ? 0 : -1;
+
+    // Ошибка декодирования уже запомнена в кеше и выводится здесь, а не при выводе команд
+    macho_get_function_starts(mach_o_file);
+
+    report->language_status = -1;
+    if (options->detect_language) {
+        report->language_status = detect_language_and_compiler(mach_o_file, &report->language);
+    }
+
+    report->findings_status = -1;
+    if (options->collect_findings) {
+        report->findings_status = analyze_unsafe_functions(mach_o_file, &report->findings) == 0 &&
+                                  analyze_section_permissions(mach_o_file, &report->findings) == 0 &&
+                                  analyze_debug_symbols(mach_o_file, &report->findings) == 0 ? 0 : -1;
+    }
+    return report->status;
+}
+
+void macho_report_free(MachOReport *report) {
+    if (!report) {
+        return;
+    }
+    security_findings_free(&report->findings);
+}
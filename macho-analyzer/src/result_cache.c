@@ -0,0 +1,179 @@
+#include "result_cache.h"
+#include "content_hash.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+// Длина пути записи относительно корня: "xx/" + 14 + "-" + 16 + ".vNNNNN" + '\0'
+#define RESULT_CACHE_NAME_MAX 64
+
+static int make_directory(const char *path) {
+    if (mkdir(path, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Ошибка: Не удалось создать каталог кеша %s\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+int result_cache_open(ResultCache *cache, const char *directory) {
+    if (!cache || !directory || !directory[0]) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в result_cache_open\n");
+        return -1;
+    }
+    cache->directory = strdup(directory);
+    if (!cache->directory) {
+        fprintf(stderr, "Ошибка: Не удалось выделить память для пути кеша\n");
+        return -1;
+    }
+    if (make_directory(cache->directory) != 0) {
+        result_cache_close(cache);
+        return -1;
+    }
+    return 0;
+}
+
+void result_cache_close(ResultCache *cache) {
+    if (cache) {
+        free(cache->directory);
+        cache->directory = NULL;
+    }
+}
+
+int result_cache_key(const MachOImage *image, const MachOArchitecture *arch, ResultCacheKey *key) {
+    if (!image || !arch || !key) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в result_cache_key\n");
+        return -1;
+    }
+    if (!arch->size && arch->offset > image->size) {
+        return -1;
+    }
+    uint64_t size = arch->size ? arch->size : image->size - arch->offset;
+    const void *data = macho_image_slice(image, arch->offset, size);
+    if (!data) {
+        return -1;
+    }
+    key->hash = xxh64(data, (size_t)size, 0);
+    key->size = size;
+    return 0;
+}
+
+/**
+ * Собирает путь записи: <каталог>/<первые два символа хеша>/<остаток>-<размер>.v<версия>.
+ * Подкаталоги не дают одному каталогу разрастись до сотен тысяч файлов.
+ *
+ * @param subdirectory Если true, возвращается только путь подкаталога.
+ * @return Новая строка или NULL.
+ */
+static char *entry_path(const ResultCache *cache, const ResultCacheKey *key, bool subdirectory) {
+    char name[RESULT_CACHE_NAME_MAX];
+    char hash[17];
+    snprintf(hash, sizeof(hash), "%016llx", (unsigned long long)key->hash);
+    if (subdirectory) {
+        snprintf(name, sizeof(name), "%.2s", hash);
+    } else {
+        snprintf(name, sizeof(name), "%.2s/%s-%016llx.v%u", hash, hash + 2, (unsigned long long)key->size,
+                 (unsigned)RESULT_CACHE_ANALYZER_VERSION);
+    }
+
+    size_t length = strlen(cache->directory) + 1 + strlen(name) + 1;
+    char *path = malloc(length);
+    if (!path) {
+        fprintf(stderr, "Ошибка: Не удалось выделить память для пути кеша\n");
+        return NULL;
+    }
+    snprintf(path, length, "%s/%s", cache->directory, name);
+    return path;
+}
+
+int result_cache_lookup(const ResultCache *cache, const ResultCacheKey *key, ResultReader *reader,
+                        ResultArchView *view) {
+    if (!cache || !cache->directory || !key || !reader || !view) {
+        return 0;
+    }
+    char *path = entry_path(cache, key, false);
+    if (!path) {
+        return 0;
+    }
+
+    // Промах — обычный случай, поэтому отсутствие файла проверяется без сообщений об ошибке
+    struct stat st;
+    int found = 0;
+    if (stat(path, &st) == 0 && S_ISREG(st.st_mode) && result_reader_open(path, reader) == 0) {
+        if (reader->arch_count == 1 && result_reader_next(reader, view) == 1 && view->arch->size == key->size) {
+            found = 1;
+        } else {
+            result_reader_close(reader);
+        }
+    }
+    free(path);
+    return found;
+}
+
+/**
+ * Записывает запись во временный файл рядом с path и переименовывает его в path.
+ * Уникальное временное имя в том же каталоге делает rename атомарным: читатель
+ * видит либо старую запись, либо новую целиком.
+ */
+static int write_entry(const char *path, const ResultArchInput *entry) {
+    size_t length = strlen(path) + sizeof(".XXXXXX");
+    char *temporary = malloc(length);
+    if (!temporary) {
+        fprintf(stderr, "Ошибка: Не удалось выделить память для пути кеша\n");
+        return -1;
+    }
+    snprintf(temporary, length, "%s.XXXXXX", path);
+
+    int fd = mkstemp(temporary);
+    FILE *out = fd >= 0 ? fdopen(fd, "wb") : NULL;
+    if (!out) {
+        fprintf(stderr, "Ошибка: Не удалось создать запись кеша %s\n", temporary);
+        if (fd >= 0) {
+            close(fd);
+            unlink(temporary);
+        }
+        free(temporary);
+        return -1;
+    }
+
+    ResultWriter writer;
+    bool written = result_writer_open(&writer, out) == 0;
+    if (written) {
+        written = result_writer_add(&writer, entry) == 0;
+        written = result_writer_close(&writer) == 0 && written;
+    }
+    written = fclose(out) == 0 && written;
+
+    int rc = 0;
+    if (!written || rename(temporary, path) != 0) {
+        fprintf(stderr, "Ошибка: Не удалось сохранить запись кеша %s\n", path);
+        unlink(temporary);
+        rc = -1;
+    }
+    free(temporary);
+    return rc;
+}
+
+int result_cache_store(const ResultCache *cache, const ResultCacheKey *key, const ResultArchInput *input) {
+    if (!cache || !cache->directory || !key || !input || !input->mach_o_file) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в result_cache_store\n");
+        return -1;
+    }
+
+    ResultArchInput entry = *input;
+    entry.path = NULL;
+    entry.arch_index = 0;
+    entry.arch = NULL;
+
+    char *directory = entry_path(cache, key, true);
+    char *path = entry_path(cache, key, false);
+    int rc = -1;
+    if (directory && path && make_directory(directory) == 0) {
+        rc = write_entry(path, &entry);
+    }
+    free(directory);
+    free(path);
+    return rc;
+}
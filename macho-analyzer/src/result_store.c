@@ -0,0 +1,504 @@
+#include "result_store.h"
+#include "hash_table.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+
+// Выравнивание записей в файле
+#define RESULT_ALIGNMENT 8
+
+// Начальный размер таблицы строк читателя
+#define RESULT_INITIAL_STRINGS 256
+
+static size_t align_record(size_t size) {
+    return (size + RESULT_ALIGNMENT - 1) & ~(size_t)(RESULT_ALIGNMENT - 1);
+}
+
+// Сколько имён библиотек песочницы хранится в записи при sandbox_count найденных
+static uint32_t stored_sandbox_count(uint32_t sandbox_count) {
+    return sandbox_count < SECURITY_MAX_SANDBOX_DYLIBS ? sandbox_count : SECURITY_MAX_SANDBOX_DYLIBS;
+}
+
+/**
+ * Обеспечивает буфер сборки записи размером не меньше size.
+ */
+static int reserve_scratch(ResultWriter *writer, size_t size) {
+    if (size <= writer->scratch_capacity) {
+        return 0;
+    }
+    size_t capacity = writer->scratch_capacity ? writer->scratch_capacity : 1024;
+    while (capacity < size) {
+        capacity *= 2;
+    }
+    uint8_t *scratch = realloc(writer->scratch, capacity);
+    if (!scratch) {
+        fprintf(stderr, "Ошибка: Не удалось выделить память для записи результатов\n");
+        return -1;
+    }
+    writer->scratch = scratch;
+    writer->scratch_capacity = capacity;
+    return 0;
+}
+
+static int write_bytes(ResultWriter *writer, const void *data, size_t size) {
+    if (fwrite(data, 1, size, writer->out) != size) {
+        fprintf(stderr, "Ошибка: Не удалось записать файл результатов\n");
+        writer->error = true;
+        return -1;
+    }
+    return 0;
+}
+
+int result_writer_open(ResultWriter *writer, FILE *out) {
+    if (!writer || !out) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в result_writer_open\n");
+        return -1;
+    }
+    memset(writer, 0, sizeof(ResultWriter));
+    writer->out = out;
+    writer->strings = hash_table_create();
+    if (!writer->strings) {
+        fprintf(stderr, "Ошибка: Не удалось создать таблицу строк\n");
+        return -1;
+    }
+
+    ResultFileHeader header = {0};
+    header.magic = RESULT_FILE_MAGIC;
+    header.version = RESULT_FILE_VERSION;
+    header.header_size = sizeof(ResultFileHeader);
+    if (write_bytes(writer, &header, sizeof(header)) != 0) {
+        hash_table_destroy(writer->strings, NULL);
+        writer->strings = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Возвращает номер строки, при первом появлении записывая её определение.
+ *
+ * @return Номер строки; RESULT_NO_STRING для NULL, пустой строки и при ошибке.
+ */
+static uint32_t intern_string(ResultWriter *writer, const char *value) {
+    if (!value || !value[0] || writer->error) {
+        return RESULT_NO_STRING;
+    }
+    uintptr_t id = (uintptr_t)hash_table_get(writer->strings, value);
+    if (id != 0) {
+        return (uint32_t)id;
+    }
+
+    size_t length = strlen(value);
+    if (length > UINT32_MAX - sizeof(ResultRecordHeader) - sizeof(ResultStringRecord) - RESULT_ALIGNMENT) {
+        writer->error = true;
+        return RESULT_NO_STRING;
+    }
+    size_t unpadded = sizeof(ResultRecordHeader) + sizeof(ResultStringRecord) + length;
+    size_t size = align_record(unpadded + 1);
+    static const uint8_t padding[RESULT_ALIGNMENT] = {0};  // Завершающий ноль и выравнивание
+
+    uint32_t new_id = writer->string_count + 1;
+    ResultRecordHeader header = {(uint32_t)size, RESULT_RECORD_STRING, 0};
+    ResultStringRecord string = {new_id, (uint32_t)length};
+    if (write_bytes(writer, &header, sizeof(header)) != 0 ||
+        write_bytes(writer, &string, sizeof(string)) != 0 ||
+        write_bytes(writer, value, length) != 0 ||
+        write_bytes(writer, padding, size - unpadded) != 0) {
+        return RESULT_NO_STRING;
+    }
+    if (!hash_table_insert(writer->strings, value, (void *)(uintptr_t)new_id)) {
+        // Строка уже в файле; без записи в таблице она лишь повторится при следующей встрече
+        fprintf(stderr, "Ошибка: Не удалось добавить строку в таблицу\n");
+    }
+    writer->string_count = new_id;
+    return new_id;
+}
+
+int result_writer_add(ResultWriter *writer, const ResultArchInput *input) {
+    if (!writer || !writer->strings || !input || !input->mach_o_file) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в result_writer_add\n");
+        return -1;
+    }
+    const MachOFile *mf = input->mach_o_file;
+    uint32_t segment_count = mf->segments ? mf->segment_count : 0;
+    uint32_t dylib_count = mf->dylibs ? mf->dylib_count : 0;
+    uint32_t finding_count = input->findings ? (uint32_t)input->findings->count : 0;
+    uint32_t sandbox_count = input->security ? input->security->sandbox_dylib_count : 0;
+
+    size_t size = sizeof(ResultRecordHeader) + sizeof(ResultArchRecord) +
+                  (size_t)segment_count * sizeof(ResultSegment) +
+                  (size_t)dylib_count * sizeof(ResultDylib) +
+                  (size_t)finding_count * sizeof(ResultFinding) +
+                  (size_t)stored_sandbox_count(sandbox_count) * sizeof(uint32_t);
+    size = align_record(size);
+    if (size > UINT32_MAX) {
+        fprintf(stderr, "Ошибка: Запись архитектуры слишком велика\n");
+        return -1;
+    }
+
+    ResultArchRecord arch = {0};
+    arch.path = intern_string(writer, input->path);
+    arch.arch_index = input->arch_index;
+    arch.cpu_type = mf->cpu_type;
+    arch.cpu_subtype = mf->cpu_subtype;
+    arch.offset = input->arch ? input->arch->offset : 0;
+    arch.size = input->arch ? input->arch->size : mf->data_size;
+    arch.file_type = mf->file_type;
+    arch.flags = mf->flags;
+    arch.is_64_bit = mf->is_64_bit;
+    arch.segment_count = segment_count;
+    arch.dylib_count = dylib_count;
+    arch.finding_count = finding_count;
+    arch.load_command_count = mf->load_command_count;
+    if (input->language) {
+        arch.language = intern_string(writer, input->language->language);
+        arch.compiler = intern_string(writer, input->language->compiler);
+    }
+    if (input->security) {
+        const SecurityFeatures *security = input->security;
+        arch.security = RESULT_SECURITY_CHECKED;
+        arch.security |= security->aslr ? RESULT_SECURITY_ASLR : 0;
+        arch.security |= security->dep ? RESULT_SECURITY_DEP : 0;
+        arch.security |= security->stack_canaries ? RESULT_SECURITY_STACK_CANARIES : 0;
+        arch.security |= security->entitlements ? RESULT_SECURITY_ENTITLEMENTS : 0;
+        arch.security |= security->bitcode ? RESULT_SECURITY_BITCODE : 0;
+        arch.sandbox_count = sandbox_count;
+    }
+
+    // Определения строк уходят в поток сразу, а запись собирается в буфере и пишется после них
+    if (reserve_scratch(writer, size) != 0) {
+        return -1;
+    }
+    memset(writer->scratch, 0, size);
+    uint8_t *body = writer->scratch + sizeof(ResultRecordHeader) + sizeof(ResultArchRecord);
+
+    ResultSegment *segments = (ResultSegment *)body;
+    for (uint32_t i = 0; i < segment_count; i++) {
+        const Segment *segment = &mf->segments[i];
+        segments[i].name = intern_string(writer, segment->segname);
+        segments[i].maxprot = segment->maxprot;
+        segments[i].initprot = segment->initprot;
+        segments[i].nsects = segment->nsects;
+        segments[i].vmaddr = segment->vmaddr;
+        segments[i].vmsize = segment->vmsize;
+        segments[i].fileoff = segment->fileoff;
+        segments[i].filesize = segment->filesize;
+    }
+
+    ResultDylib *dylibs = (ResultDylib *)(body + (size_t)segment_count * sizeof(ResultSegment));
+    for (uint32_t i = 0; i < dylib_count; i++) {
+        const Dylib *dylib = &mf->dylibs[i];
+        dylibs[i].name = intern_string(writer, dylib->name);
+        dylibs[i].timestamp = dylib->timestamp;
+        dylibs[i].current_version = dylib->current_version;
+        dylibs[i].compatibility_version = dylib->compatibility_version;
+    }
+
+    ResultFinding *findings = (ResultFinding *)((uint8_t *)dylibs + (size_t)dylib_count * sizeof(ResultDylib));
+    for (uint32_t i = 0; i < finding_count; i++) {
+        const SecurityFinding *finding = &input->findings->items[i];
+        findings[i].kind = finding->kind;
+        findings[i].name = intern_string(writer, finding->function ? finding->function->function_name
+                                                                   : finding->section);
+    }
+
+    uint32_t *sandbox_dylibs = (uint32_t *)(findings + finding_count);
+    for (uint32_t i = 0; i < stored_sandbox_count(sandbox_count); i++) {
+        sandbox_dylibs[i] = intern_string(writer, input->security->sandbox_dylibs[i]);
+    }
+
+    if (writer->error) {
+        return -1;
+    }
+    ResultRecordHeader header = {(uint32_t)size, RESULT_RECORD_ARCH, 0};
+    memcpy(writer->scratch, &header, sizeof(header));
+    memcpy(writer->scratch + sizeof(header), &arch, sizeof(arch));
+    if (write_bytes(writer, writer->scratch, size) != 0) {
+        return -1;
+    }
+    writer->record_count++;
+    return 0;
+}
+
+int result_writer_add_view(ResultWriter *writer, const ResultReader *reader, const ResultArchView *view,
+                           const char *path, uint32_t arch_index, const MachOArchitecture *arch) {
+    if (!writer || !writer->strings || !reader || !view || !view->arch) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в result_writer_add_view\n");
+        return -1;
+    }
+    const ResultArchRecord *source = view->arch;
+    size_t size = align_record(sizeof(ResultRecordHeader) + sizeof(ResultArchRecord) +
+                               (size_t)source->segment_count * sizeof(ResultSegment) +
+                               (size_t)source->dylib_count * sizeof(ResultDylib) +
+                               (size_t)source->finding_count * sizeof(ResultFinding) +
+                               (size_t)stored_sandbox_count(source->sandbox_count) * sizeof(uint32_t));
+
+    ResultArchRecord record = *source;
+    record.path = intern_string(writer, path);
+    record.arch_index = arch_index;
+    if (arch) {
+        record.offset = arch->offset;
+        record.size = arch->size;
+    }
+    record.language = intern_string(writer, result_reader_string(reader, source->language));
+    record.compiler = intern_string(writer, result_reader_string(reader, source->compiler));
+
+    if (reserve_scratch(writer, size) != 0) {
+        return -1;
+    }
+    memset(writer->scratch, 0, size);
+    uint8_t *body = writer->scratch + sizeof(ResultRecordHeader) + sizeof(ResultArchRecord);
+
+    // Массивы копируются целиком, затем в них заменяются номера строк
+    ResultSegment *segments = (ResultSegment *)body;
+    memcpy(segments, view->segments, (size_t)source->segment_count * sizeof(ResultSegment));
+    for (uint32_t i = 0; i < source->segment_count; i++) {
+        segments[i].name = intern_string(writer, result_reader_string(reader, segments[i].name));
+    }
+    ResultDylib *dylibs = (ResultDylib *)(segments + source->segment_count);
+    memcpy(dylibs, view->dylibs, (size_t)source->dylib_count * sizeof(ResultDylib));
+    for (uint32_t i = 0; i < source->dylib_count; i++) {
+        dylibs[i].name = intern_string(writer, result_reader_string(reader, dylibs[i].name));
+    }
+    ResultFinding *findings = (ResultFinding *)(dylibs + source->dylib_count);
+    memcpy(findings, view->findings, (size_t)source->finding_count * sizeof(ResultFinding));
+    for (uint32_t i = 0; i < source->finding_count; i++) {
+        findings[i].name = intern_string(writer, result_reader_string(reader, findings[i].name));
+    }
+    uint32_t *sandbox_dylibs = (uint32_t *)(findings + source->finding_count);
+    for (uint32_t i = 0; i < stored_sandbox_count(source->sandbox_count); i++) {
+        sandbox_dylibs[i] = intern_string(writer, result_reader_string(reader, view->sandbox_dylibs[i]));
+    }
+
+    if (writer->error) {
+        return -1;
+    }
+    ResultRecordHeader header = {(uint32_t)size, RESULT_RECORD_ARCH, 0};
+    memcpy(writer->scratch, &header, sizeof(header));
+    memcpy(writer->scratch + sizeof(header), &record, sizeof(record));
+    if (write_bytes(writer, writer->scratch, size) != 0) {
+        return -1;
+    }
+    writer->record_count++;
+    return 0;
+}
+
+int result_writer_close(ResultWriter *writer) {
+    if (!writer || !writer->strings) {
+        return -1;
+    }
+    if (fflush(writer->out) != 0) {
+        writer->error = true;
+    }
+    hash_table_destroy(writer->strings, NULL);
+    writer->strings = NULL;
+    free(writer->scratch);
+    writer->scratch = NULL;
+    writer->scratch_capacity = 0;
+    return writer->error ? -1 : 0;
+}
+
+/**
+ * Проверяет запись архитектуры: массивы должны помещаться в запись,
+ * а все номера строк — быть уже определены.
+ */
+static bool valid_arch_record(const ResultReader *reader, const uint8_t *body, size_t body_size) {
+    if (body_size < sizeof(ResultArchRecord)) {
+        return false;
+    }
+    const ResultArchRecord *arch = (const ResultArchRecord *)body;
+    uint64_t arrays = (uint64_t)arch->segment_count * sizeof(ResultSegment) +
+                      (uint64_t)arch->dylib_count * sizeof(ResultDylib) +
+                      (uint64_t)arch->finding_count * sizeof(ResultFinding) +
+                      (uint64_t)stored_sandbox_count(arch->sandbox_count) * sizeof(uint32_t);
+    if (arrays > body_size - sizeof(ResultArchRecord)) {
+        return false;
+    }
+
+    uint32_t limit = reader->string_count;
+    if (arch->path > limit || arch->language > limit || arch->compiler > limit) {
+        return false;
+    }
+    const ResultSegment *segments = (const ResultSegment *)(arch + 1);
+    for (uint32_t i = 0; i < arch->segment_count; i++) {
+        if (segments[i].name > limit) {
+            return false;
+        }
+    }
+    const ResultDylib *dylibs = (const ResultDylib *)(segments + arch->segment_count);
+    for (uint32_t i = 0; i < arch->dylib_count; i++) {
+        if (dylibs[i].name > limit) {
+            return false;
+        }
+    }
+    const ResultFinding *findings = (const ResultFinding *)(dylibs + arch->dylib_count);
+    for (uint32_t i = 0; i < arch->finding_count; i++) {
+        if (findings[i].name > limit) {
+            return false;
+        }
+    }
+    const uint32_t *sandbox_dylibs = (const uint32_t *)(findings + arch->finding_count);
+    for (uint32_t i = 0; i < stored_sandbox_count(arch->sandbox_count); i++) {
+        if (sandbox_dylibs[i] > limit) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Один проход по файлу: проверяет границы всех записей и собирает индекс строк.
+ */
+static int index_records(ResultReader *reader) {
+    const ResultFileHeader *header = macho_image_slice(&reader->image, 0, sizeof(ResultFileHeader));
+    if (!header || header->magic != RESULT_FILE_MAGIC) {
+        fprintf(stderr, "Ошибка: Файл не является файлом результатов\n");
+        return -1;
+    }
+    if (header->version != RESULT_FILE_VERSION || header->header_size < sizeof(ResultFileHeader) ||
+        header->header_size % RESULT_ALIGNMENT != 0) {
+        fprintf(stderr, "Ошибка: Неподдерживаемая версия файла результатов: %u\n", header->version);
+        return -1;
+    }
+
+    uint32_t capacity = 0;
+    uint64_t offset = header->header_size;
+    while (offset < reader->image.size) {
+        const ResultRecordHeader *record = macho_image_slice(&reader->image, offset, sizeof(ResultRecordHeader));
+        if (!record || record->size < sizeof(ResultRecordHeader) || record->size % RESULT_ALIGNMENT != 0 ||
+            !macho_image_slice(&reader->image, offset, record->size)) {
+            fprintf(stderr, "Ошибка: Повреждённая запись по смещению %llu\n", (unsigned long long)offset);
+            return -1;
+        }
+        const uint8_t *body = (const uint8_t *)(record + 1);
+        size_t body_size = record->size - sizeof(ResultRecordHeader);
+
+        if (record->type == RESULT_RECORD_STRING) {
+            const ResultStringRecord *string = (const ResultStringRecord *)body;
+            if (body_size < sizeof(ResultStringRecord) ||
+                string->length >= body_size - sizeof(ResultStringRecord) ||
+                string->id != reader->string_count + 1 ||
+                body[sizeof(ResultStringRecord) + string->length] != '\0') {
+                fprintf(stderr, "Ошибка: Повреждённая строка по смещению %llu\n", (unsigned long long)offset);
+                return -1;
+            }
+            if (string->id > capacity || capacity == 0) {
+                uint32_t new_capacity = capacity ? capacity * 2 : RESULT_INITIAL_STRINGS;
+                const char **strings = realloc(reader->strings, (size_t)(new_capacity + 1) * sizeof(char *));
+                if (!strings) {
+                    fprintf(stderr, "Ошибка: Не удалось выделить память для таблицы строк\n");
+                    return -1;
+                }
+                reader->strings = strings;
+                capacity = new_capacity;
+            }
+            reader->strings[string->id] = (const char *)(string + 1);
+            reader->string_count = string->id;
+        } else if (record->type == RESULT_RECORD_ARCH) {
+            if (!valid_arch_record(reader, body, body_size)) {
+                fprintf(stderr, "Ошибка: Повреждённая запись архитектуры по смещению %llu\n",
+                        (unsigned long long)offset);
+                return -1;
+            }
+            reader->arch_count++;
+        }
+        // Записи неизвестных типов пропускаются: их могут добавить следующие версии
+        offset += record->size;
+    }
+    reader->position = header->header_size;
+    return 0;
+}
+
+static int open_image(ResultReader *reader) {
+    if (index_records(reader) != 0) {
+        result_reader_close(reader);
+        return -1;
+    }
+    return 0;
+}
+
+int result_reader_open(const char *path, ResultReader *reader) {
+    if (!path || !reader) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в result_reader_open\n");
+        return -1;
+    }
+    memset(reader, 0, sizeof(ResultReader));
+    if (macho_image_open(path, &reader->image) != 0) {
+        return -1;
+    }
+    return open_image(reader);
+}
+
+int result_reader_from_memory(const void *data, uint64_t size, ResultReader *reader) {
+    if (!reader) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в result_reader_from_memory\n");
+        return -1;
+    }
+    memset(reader, 0, sizeof(ResultReader));
+    if (macho_image_from_memory(data, size, &reader->image) != 0) {
+        return -1;
+    }
+    return open_image(reader);
+}
+
+int result_reader_next(ResultReader *reader, ResultArchView *view) {
+    if (!reader || !view) {
+        return 0;
+    }
+    // Структура файла проверена при открытии, здесь границы уже не проверяются
+    while (reader->position < reader->image.size) {
+        const ResultRecordHeader *record = (const ResultRecordHeader *)(reader->image.base + reader->position);
+        reader->position += record->size;
+        if (record->type != RESULT_RECORD_ARCH) {
+            continue;
+        }
+        view->arch = (const ResultArchRecord *)(record + 1);
+        view->segments = (const ResultSegment *)(view->arch + 1);
+        view->dylibs = (const ResultDylib *)(view->segments + view->arch->segment_count);
+        view->findings = (const ResultFinding *)(view->dylibs + view->arch->dylib_count);
+        view->sandbox_dylibs = (const uint32_t *)(view->findings + view->arch->finding_count);
+        return 1;
+    }
+    return 0;
+}
+
+void result_reader_rewind(ResultReader *reader) {
+    if (reader && reader->image.base) {
+        reader->position = ((const ResultFileHeader *)reader->image.base)->header_size;
+    }
+}
+
+const char *result_reader_string(const ResultReader *reader, uint32_t id) {
+    if (!reader || id == RESULT_NO_STRING || id > reader->string_count) {
+        return NULL;
+    }
+    return reader->strings[id];
+}
+
+bool result_security_features(const ResultReader *reader, const ResultArchView *view, SecurityFeatures *features) {
+    const ResultArchRecord *arch = view->arch;
+    memset(features, 0, sizeof(SecurityFeatures));
+    if (!(arch->security & RESULT_SECURITY_CHECKED)) {
+        return false;
+    }
+    features->aslr = (arch->security & RESULT_SECURITY_ASLR) != 0;
+    features->dep = (arch->security & RESULT_SECURITY_DEP) != 0;
+    features->stack_canaries = (arch->security & RESULT_SECURITY_STACK_CANARIES) != 0;
+    features->entitlements = (arch->security & RESULT_SECURITY_ENTITLEMENTS) != 0;
+    features->bitcode = (arch->security & RESULT_SECURITY_BITCODE) != 0;
+    features->sandbox_dylib_count = arch->sandbox_count;
+    for (uint32_t i = 0; i < stored_sandbox_count(arch->sandbox_count); i++) {
+        features->sandbox_dylibs[i] = result_reader_string(reader, view->sandbox_dylibs[i]);
+    }
+    return true;
+}
+
+void result_reader_close(ResultReader *reader) {
+    if (!reader) {
+        return;
+    }
+    free(reader->strings);
+    reader->strings = NULL;
+    reader->string_count = 0;
+    macho_image_close(&reader->image);
+}
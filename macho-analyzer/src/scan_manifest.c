@@ -0,0 +1,283 @@
+#include "scan_manifest.h"
+#include "macho_image.h"
+#include "hash_table.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+// Выравнивание записей в файле манифеста
+#define SCAN_MANIFEST_ALIGNMENT 8
+
+#define SCAN_MANIFEST_FLAG_MACHO 1u
+
+typedef struct {
+    uint32_t magic;             // SCAN_MANIFEST_MAGIC
+    uint32_t version;           // SCAN_MANIFEST_VERSION
+    uint64_t count;             // Количество записей
+} ScanManifestHeader;
+
+/**
+ * Запись в файле; за ней следуют uint64_t hashes[arch_count], путь без
+ * завершающего нуля и выравнивание до 8 байт.
+ */
+typedef struct {
+    uint32_t path_length;
+    uint32_t arch_count;
+    uint64_t size;
+    int64_t mtime_sec;
+    uint64_t inode;
+    uint32_t mtime_nsec;
+    uint32_t flags;             // SCAN_MANIFEST_FLAG_*
+} ScanManifestRecord;
+
+static size_t align_manifest(size_t size) {
+    return (size + SCAN_MANIFEST_ALIGNMENT - 1) & ~(size_t)(SCAN_MANIFEST_ALIGNMENT - 1);
+}
+
+int scan_manifest_init(ScanManifest *manifest) {
+    if (!manifest) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в scan_manifest_init\n");
+        return -1;
+    }
+    memset(manifest, 0, sizeof(ScanManifest));
+    manifest->index = hash_table_create();
+    if (!manifest->index) {
+        fprintf(stderr, "Ошибка: Не удалось создать индекс манифеста\n");
+        return -1;
+    }
+    return 0;
+}
+
+static void free_entry(ScanManifestEntry *entry) {
+    free(entry->path);
+    free(entry->hashes);
+    entry->path = NULL;
+    entry->hashes = NULL;
+}
+
+void scan_manifest_free(ScanManifest *manifest) {
+    if (!manifest) {
+        return;
+    }
+    for (size_t i = 0; i < manifest->count; i++) {
+        free_entry(&manifest->entries[i]);
+    }
+    free(manifest->entries);
+    if (manifest->index) {
+        hash_table_destroy(manifest->index, NULL);
+    }
+    memset(manifest, 0, sizeof(ScanManifest));
+}
+
+ScanManifestEntry *scan_manifest_find(const ScanManifest *manifest, const char *path) {
+    if (!manifest || !manifest->index || !path) {
+        return NULL;
+    }
+    uintptr_t position = (uintptr_t)hash_table_get(manifest->index, path);
+    return position ? &manifest->entries[position - 1] : NULL;
+}
+
+int scan_manifest_add(ScanManifest *manifest, const ScanManifestEntry *entry) {
+    if (!manifest || !manifest->index || !entry || !entry->path) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в scan_manifest_add\n");
+        return -1;
+    }
+
+    ScanManifestEntry copy = *entry;
+    copy.seen = false;
+    copy.path = strdup(entry->path);
+    copy.hashes = NULL;
+    if (entry->arch_count > 0) {
+        copy.hashes = malloc((size_t)entry->arch_count * sizeof(uint64_t));
+        if (copy.hashes) {
+            memcpy(copy.hashes, entry->hashes, (size_t)entry->arch_count * sizeof(uint64_t));
+        }
+    }
+    if (!copy.path || (entry->arch_count > 0 && !copy.hashes)) {
+        fprintf(stderr, "Ошибка: Не удалось выделить память для записи манифеста\n");
+        free_entry(&copy);
+        return -1;
+    }
+
+    ScanManifestEntry *existing = scan_manifest_find(manifest, entry->path);
+    if (existing) {
+        free_entry(existing);
+        *existing = copy;
+        return 0;
+    }
+
+    if (manifest->count == manifest->capacity) {
+        size_t capacity = manifest->capacity ? manifest->capacity * 2 : 256;
+        ScanManifestEntry *entries = realloc(manifest->entries, capacity * sizeof(ScanManifestEntry));
+        if (!entries) {
+            fprintf(stderr, "Ошибка: Не удалось выделить память для манифеста\n");
+            free_entry(&copy);
+            return -1;
+        }
+        manifest->entries = entries;
+        manifest->capacity = capacity;
+    }
+    if (!hash_table_insert(manifest->index, copy.path, (void *)(uintptr_t)(manifest->count + 1))) {
+        fprintf(stderr, "Ошибка: Не удалось добавить путь в индекс манифеста\n");
+        free_entry(&copy);
+        return -1;
+    }
+    manifest->entries[manifest->count++] = copy;
+    return 0;
+}
+
+/**
+ * Разбирает отображённый файл манифеста.
+ */
+static int parse_manifest(ScanManifest *manifest, const MachOImage *image) {
+    const ScanManifestHeader *header = macho_image_slice(image, 0, sizeof(ScanManifestHeader));
+    if (!header || header->magic != SCAN_MANIFEST_MAGIC || header->version != SCAN_MANIFEST_VERSION) {
+        fprintf(stderr, "Ошибка: Неподдерживаемый формат манифеста\n");
+        return -1;
+    }
+
+    uint64_t offset = sizeof(ScanManifestHeader);
+    char *path = NULL;
+    size_t path_capacity = 0;
+    for (uint64_t i = 0; i < header->count; i++) {
+        const ScanManifestRecord *record = macho_image_slice(image, offset, sizeof(ScanManifestRecord));
+        uint64_t hashes_size = record ? (uint64_t)record->arch_count * sizeof(uint64_t) : 0;
+        const uint64_t *hashes = record ? macho_image_slice(image, offset + sizeof(ScanManifestRecord), hashes_size)
+                                        : NULL;
+        const char *name = hashes ? macho_image_slice(image, offset + sizeof(ScanManifestRecord) + hashes_size,
+                                                      record->path_length)
+                                  : NULL;
+        if (!name || record->path_length == 0) {
+            fprintf(stderr, "Ошибка: Повреждённая запись манифеста %llu\n", (unsigned long long)i);
+            free(path);
+            return -1;
+        }
+
+        if (record->path_length + 1 > path_capacity) {
+            path_capacity = record->path_length + 1;
+            char *buffer = realloc(path, path_capacity);
+            if (!buffer) {
+                fprintf(stderr, "Ошибка: Не удалось выделить память для пути\n");
+                free(path);
+                return -1;
+            }
+            path = buffer;
+        }
+        memcpy(path, name, record->path_length);
+        path[record->path_length] = '\0';
+
+        ScanManifestEntry entry = {0};
+        entry.path = path;
+        entry.size = record->size;
+        entry.mtime_sec = record->mtime_sec;
+        entry.mtime_nsec = record->mtime_nsec;
+        entry.inode = record->inode;
+        entry.is_macho = (record->flags & SCAN_MANIFEST_FLAG_MACHO) != 0;
+        entry.arch_count = record->arch_count;
+        entry.hashes = (uint64_t *)hashes;
+        if (scan_manifest_add(manifest, &entry) != 0) {
+            free(path);
+            return -1;
+        }
+        offset += align_manifest(sizeof(ScanManifestRecord) + hashes_size + record->path_length);
+    }
+    free(path);
+    return 0;
+}
+
+int scan_manifest_load(ScanManifest *manifest, const char *path) {
+    if (!manifest || !path) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в scan_manifest_load\n");
+        return -1;
+    }
+    if (scan_manifest_init(manifest) != 0) {
+        return -1;
+    }
+
+    struct stat st;
+    if (stat(path, &st) != 0 && errno == ENOENT) {
+        return 0;  // Первый проход
+    }
+
+    MachOImage image;
+    if (macho_image_open(path, &image) != 0) {
+        scan_manifest_free(manifest);
+        return -1;
+    }
+    int rc = parse_manifest(manifest, &image);
+    macho_image_close(&image);
+    if (rc != 0) {
+        scan_manifest_free(manifest);
+    }
+    return rc;
+}
+
+static int write_manifest(const ScanManifest *manifest, FILE *out) {
+    static const uint8_t padding[SCAN_MANIFEST_ALIGNMENT] = {0};
+    ScanManifestHeader header = {SCAN_MANIFEST_MAGIC, SCAN_MANIFEST_VERSION, manifest->count};
+    if (fwrite(&header, sizeof(header), 1, out) != 1) {
+        return -1;
+    }
+    for (size_t i = 0; i < manifest->count; i++) {
+        const ScanManifestEntry *entry = &manifest->entries[i];
+        size_t path_length = strlen(entry->path);
+        ScanManifestRecord record = {0};
+        record.path_length = (uint32_t)path_length;
+        record.arch_count = entry->arch_count;
+        record.size = entry->size;
+        record.mtime_sec = entry->mtime_sec;
+        record.mtime_nsec = entry->mtime_nsec;
+        record.inode = entry->inode;
+        record.flags = entry->is_macho ? SCAN_MANIFEST_FLAG_MACHO : 0;
+
+        size_t unpadded = sizeof(record) + (size_t)entry->arch_count * sizeof(uint64_t) + path_length;
+        if (fwrite(&record, sizeof(record), 1, out) != 1 ||
+            fwrite(entry->hashes, sizeof(uint64_t), entry->arch_count, out) != entry->arch_count ||
+            fwrite(entry->path, 1, path_length, out) != path_length ||
+            fwrite(padding, 1, align_manifest(unpadded) - unpadded, out) != align_manifest(unpadded) - unpadded) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int scan_manifest_save(const ScanManifest *manifest, const char *path) {
+    if (!manifest || !path) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в scan_manifest_save\n");
+        return -1;
+    }
+    size_t length = strlen(path) + sizeof(".XXXXXX");
+    char *temporary = malloc(length);
+    if (!temporary) {
+        fprintf(stderr, "Ошибка: Не удалось выделить память для пути манифеста\n");
+        return -1;
+    }
+    snprintf(temporary, length, "%s.XXXXXX", path);
+
+    int fd = mkstemp(temporary);
+    FILE *out = fd >= 0 ? fdopen(fd, "wb") : NULL;
+    if (!out) {
+        fprintf(stderr, "Ошибка: Не удалось создать файл манифеста %s\n", temporary);
+        if (fd >= 0) {
+            close(fd);
+            unlink(temporary);
+        }
+        free(temporary);
+        return -1;
+    }
+
+    int rc = write_manifest(manifest, out);
+    if (fclose(out) != 0) {
+        rc = -1;
+    }
+    if (rc != 0 || rename(temporary, path) != 0) {
+        fprintf(stderr, "Ошибка: Не удалось сохранить манифест %s\n", path);
+        unlink(temporary);
+        rc = -1;
+    }
+    free(temporary);
+    return rc;
+}
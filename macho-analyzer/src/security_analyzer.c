@@ -1,310 +1,171 @@
 #include "security_analyzer.h"
+#include "symbol_index.h"
+#include "import_table.h"
+#include "perfect_hash.h"
+#include "unsafe_functions_hash.h"
 #include "macho_analyzer.h"
-#include <mach-o/loader.h>
-#include <mach-o/nlist.h>
+#include "macho_types.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 
 const UnsafeFunctionInfo unsafe_functions[] = {
-        // Стандартные небезопасные функции C
-        {"strcpy", "операция со строками", "высокая"},
-        {"strncpy", "операция со строками", "средняя"},
-        {"sprintf", "операция со строками", "высокая"},
-        {"snprintf", "операция со строками", "средняя"},
-        {"vsprintf", "операция со строками", "высокая"},
-        {"vsnprintf", "операция со строками", "средняя"},
-        {"gets", "операция ввода", "высокая"},
-        {"fgets", "операция ввода", "средняя"},
-        {"scanf", "операция ввода", "средняя"},
-        {"sscanf", "операция ввода", "средняя"},
-        {"strcat", "операция со строками", "средняя"},
-        {"strncat", "операция со строками", "средняя"},
-
-        // Работа с памятью
-        {"memcpy", "операция с памятью", "средняя"},
-        {"memmove", "операция с памятью", "средняя"},
-        {"memset", "операция с памятью", "средняя"},
-        {"bcopy", "операция с памятью", "высокая"},
-        {"bzero", "операция с памятью", "высокая"},
-
-        // Динамическое выделение памяти
-        {"malloc", "выделение памяти", "низкая"},
-        {"realloc", "выделение памяти", "низкая"},
-        {"free", "освобождение памяти", "низкая"},
-        {"calloc", "выделение памяти", "низкая"},
-
-        // Функции работы со строками
-        {"strdup", "выделение памяти", "средняя"},
-        {"stpcpy", "операция со строками", "средняя"},
-        {"strtok", "операция со строками", "низкая"},
-        {"strncpy_s", "операция со строками", "низкая"},
-
-        // Форматирование строк
-        {"asprintf", "операция со строками", "средняя"},
-        {"vasprintf", "операция со строками", "средняя"},
-
-        // Работа с файлами
-        {"fopen", "операция с файлами", "низкая"},
-        {"fclose", "операция с файлами", "низкая"},
-        {"fread", "операция с файлами", "средняя"},
-        {"fwrite", "операция с файлами", "средняя"},
-
-        // Динамическое выделение памяти
-        {"alloca", "выделение памяти", "высокая"},
-        {"valloc", "выделение памяти", "средняя"},
-        {"posix_memalign", "выделение памяти", "низкая"},
-
-        // Потокобезопасность
-        {"rand", "генерация случайных чисел", "средняя"},
-        {"srand", "генерация случайных чисел", "средняя"},
-        {"drand48", "генерация случайных чисел", "средняя"},
-        {"lrand48", "генерация случайных чисел", "средняя"},
-        {"random", "генерация случайных чисел", "средняя"},
-
-        // Опасные сетевые функции
-        {"gethostbyname", "сетевая операция", "высокая"},
-        {"gethostbyaddr", "сетевая операция", "высокая"},
-        {"inet_ntoa", "сетевая операция", "средняя"},
-        {"inet_aton", "сетевая операция", "средняя"},
-        {"getaddrinfo", "сетевая операция", "средняя"},
-        {"getnameinfo", "сетевая операция", "средняя"},
-
-        // Управление процессами
-        {"system", "выполнение процесса", "высокая"},
-        {"popen", "выполнение процесса", "высокая"},
-        {"exec", "выполнение процесса", "высокая"},
-        {"execl", "выполнение процесса", "высокая"},
-        {"execle", "выполнение процесса", "высокая"},
-        {"execlp", "выполнение процесса", "высокая"},
-        {"execv", "выполнение процесса", "высокая"},
-        {"execvp", "выполнение процесса", "высокая"},
-        {"execve", "выполнение процесса", "высокая"},
-
-        // Потоки
-        {"pthread_create", "управление потоками", "средняя"},
-        {"pthread_exit", "управление потоками", "средняя"},
-        {"pthread_cancel", "управление потоками", "средняя"},
-
+#define UNSAFE_FUNCTION(name, category, severity) {name, category, severity},
+#include "unsafe_functions.def"
+#undef UNSAFE_FUNCTION
         {NULL, NULL, NULL}  // Завершающий элемент массива
 };
 
-HashTable *initialize_unsafe_function_table(void) {
-    HashTable *table = hash_table_create();
-    if (!table) {
-        fprintf(stderr, "Ошибка: Не удалось создать хеш-таблицу для небезопасных функций\n");
+_Static_assert(sizeof(unsafe_functions) / sizeof(UnsafeFunctionInfo) == UNSAFE_FUNCTIONS_HASH_SIZE + 1,
+               "unsafe_functions_hash.h не соответствует unsafe_functions.def");
+
+const UnsafeFunctionInfo *find_unsafe_function(const char *name) {
+    if (!name) {
         return NULL;
     }
-    for (int i = 0; unsafe_functions[i].function_name != NULL; i++) {
-        hash_table_insert(table, unsafe_functions[i].function_name, (void *)&unsafe_functions[i]);
-    }
-    return table;
+    uint64_t hash = perfect_hash_key(name);
+    uint32_t seed = unsafe_functions_hash_seeds[perfect_hash_bucket(hash, UNSAFE_FUNCTIONS_HASH_SIZE)];
+    const UnsafeFunctionInfo *info =
+            &unsafe_functions[unsafe_functions_hash_slots[perfect_hash_slot(hash, seed, UNSAFE_FUNCTIONS_HASH_SIZE)]];
+    return strcmp(info->function_name, name) == 0 ? info : NULL;
 }
 
-int analyze_unsafe_functions(const MachOFile *mach_o_file, FILE *file, HashTable *unsafe_function_table) {
-    if (!mach_o_file || !file || !unsafe_function_table) {
-        fprintf(stderr, "Ошибка: Неверные аргументы в analyze_unsafe_functions\n");
-        return -1;
-    }
-
-    struct symtab_command *symtab_cmd = NULL;
-    struct load_command *cmd = mach_o_file->commands;
-    uint32_t ncmds = mach_o_file->load_command_count; // Исправлено: command_count -> load_command_count
-
-    // Поиск команды LC_SYMTAB
-    for (uint32_t i = 0; i < ncmds; i++) {
-        if (cmd->cmd == LC_SYMTAB) {
-            symtab_cmd = (struct symtab_command *)cmd;
-            break;
+/**
+ * Дописывает находку в список.
+ *
+ * @return 0 при успехе, -1 если не удалось выделить память.
+ */
+static int add_finding(SecurityFindings *findings, SecurityFindingKind kind, const UnsafeFunctionInfo *function,
+                       const char *section) {
+    if (findings->count == findings->capacity) {
+        size_t capacity = findings->capacity ? findings->capacity * 2 : 16;
+        SecurityFinding *items = realloc(findings->items, capacity * sizeof(SecurityFinding));
+        if (!items) {
+            fprintf(stderr, "Ошибка: Не удалось выделить память для списка находок\n");
+            return -1;
         }
-        cmd = (struct load_command *)((uint8_t *)cmd + cmd->cmdsize);
+        findings->items = items;
+        findings->capacity = capacity;
     }
 
-    if (!symtab_cmd || symtab_cmd->nsyms == 0) {
-        printf("Информация: Таблица символов отсутствует или пуста\n");
-        return -1;
+    SecurityFinding *finding = &findings->items[findings->count++];
+    memset(finding, 0, sizeof(SecurityFinding));
+    finding->kind = kind;
+    finding->function = function;
+    if (section) {
+        strncpy(finding->section, section, sizeof(finding->section) - 1);
     }
+    return 0;
+}
 
-    long current_offset = ftell(file);
-    if (current_offset == -1) {
-        fprintf(stderr, "Ошибка: Не удалось получить текущее смещение файла\n");
-        return -1;
+void security_findings_free(SecurityFindings *findings) {
+    if (!findings) {
+        return;
     }
+    free(findings->items);
+    memset(findings, 0, sizeof(SecurityFindings));
+}
 
-    size_t symbol_size = mach_o_file->is_64_bit ? sizeof(struct nlist_64) : sizeof(struct nlist);
-    void *symbols = malloc(symbol_size * symtab_cmd->nsyms);
-    if (!symbols) {
-        fprintf(stderr, "Ошибка: Не удалось выделить память для символов\n");
-        return -1;
+size_t security_findings_count(const SecurityFindings *findings, SecurityFindingKind kind) {
+    size_t count = 0;
+    for (size_t i = 0; findings && i < findings->count; i++) {
+        count += findings->items[i].kind == kind;
     }
+    return count;
+}
 
-    if (fseek(file, symtab_cmd->symoff, SEEK_SET) != 0) {
-        fprintf(stderr, "Ошибка: Не удалось переместиться к таблице символов\n");
-        free(symbols);
-        return -1;
-    }
-    if (fread(symbols, symbol_size, symtab_cmd->nsyms, file) != symtab_cmd->nsyms) {
-        fprintf(stderr, "Ошибка: Не удалось прочитать таблицу символов\n");
-        free(symbols);
-        fseek(file, current_offset, SEEK_SET);
-        return -1;
+/**
+ * Добавляет находку, если символ есть в таблице небезопасных функций.
+ *
+ * @return 0 при успехе, -1 если не удалось выделить память.
+ */
+static int check_unsafe_symbol(SecurityFindings *findings, const char *sym_name) {
+    // Удаление префикса '_', если он присутствует
+    if (sym_name[0] == '_') {
+        sym_name++;
     }
 
-    char *string_table = malloc(symtab_cmd->strsize);
-    if (!string_table) {
-        fprintf(stderr, "Ошибка: Не удалось выделить память для таблицы строк\n");
-        free(symbols);
-        fseek(file, current_offset, SEEK_SET);
+    // Проверка наличия символа в таблице небезопасных функций
+    const UnsafeFunctionInfo *info = find_unsafe_function(sym_name);
+    if (info && add_finding(findings, SECURITY_FINDING_UNSAFE_FUNCTION, info, NULL) != 0) {
         return -1;
     }
+    return 0;
+}
 
-    if (fseek(file, symtab_cmd->stroff, SEEK_SET) != 0) {
-        fprintf(stderr, "Ошибка: Не удалось переместиться к таблице строк\n");
-        free(symbols);
-        free(string_table);
-        fseek(file, current_offset, SEEK_SET);
+int analyze_unsafe_functions(const MachOFile *mach_o_file, SecurityFindings *findings) {
+    if (!mach_o_file || !findings) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в analyze_unsafe_functions\n");
         return -1;
     }
-    if (fread(string_table, 1, symtab_cmd->strsize, file) != symtab_cmd->strsize) {
-        fprintf(stderr, "Ошибка: Не удалось прочитать таблицу строк\n");
-        free(symbols);
-        free(string_table);
-        fseek(file, current_offset, SEEK_SET);
+
+    // Вызываемые функции — это импорты; таблица символов нужна только без них
+    const MachOImportTable *imports = macho_get_import_table(mach_o_file);
+    if (!imports) {
         return -1;
     }
-
-    int unsafe_function_count = 0;
-
-    for (uint32_t i = 0; i < symtab_cmd->nsyms; i++) {
-        char *sym_name;
-        uint32_t strx;
-        if (mach_o_file->is_64_bit) {
-            struct nlist_64 *sym = &((struct nlist_64 *)symbols)[i];
-            strx = sym->n_un.n_strx;
-        } else {
-            struct nlist *sym = &((struct nlist *)symbols)[i];
-            strx = sym->n_un.n_strx;
-        }
-
-        if (strx >= symtab_cmd->strsize) {
-            continue; // Пропускаем некорректные индексы
-        }
-        sym_name = string_table + strx;
-
-        // Удаление префикса '_', если он присутствует
-        if (sym_name[0] == '_') {
-            sym_name++;
-        }
-
-        // Проверка наличия символа в хеш-таблице
-        if (hash_table_contains(unsafe_function_table, sym_name)) {
-            UnsafeFunctionInfo *info = (UnsafeFunctionInfo *)hash_table_get(unsafe_function_table, sym_name);
-            printf("Предупреждение: Обнаружена небезопасная функция: %s\n", info->function_name);
-            printf("  Категория: %s\n", info->category);
-            printf("  Уровень опасности: %s\n", info->severity);
-            unsafe_function_count++;
+    if (imports->source != MACHO_IMPORTS_NONE) {
+        for (uint32_t i = 0; i < imports->count; i++) {
+            if (check_unsafe_symbol(findings, imports->imports[i].name) != 0) {
+                return -1;
+            }
         }
+        return 0;
     }
 
-    free(symbols);
-    free(string_table);
-    fseek(file, current_offset, SEEK_SET);
+    const MachOSymbolIndex *index = macho_get_symbol_index(mach_o_file);
+    if (!index) {
+        return -1;
+    }
 
-    if (unsafe_function_count > 0) {
-        printf("Всего обнаружено небезопасных функций: %d\n", unsafe_function_count);
-    } else {
-        printf("Небезопасные функции не обнаружены.\n");
+    for (uint32_t i = 0; i < index->count; i++) {
+        if (check_unsafe_symbol(findings, index->symbols[i].name) != 0) {
+            return -1;
+        }
     }
 
     return 0;
 }
 
-int analyze_section_permissions(const MachOFile *mach_o_file, FILE *file) {
-    if (!mach_o_file || !file) {
+int analyze_section_permissions(const MachOFile *mach_o_file, SecurityFindings *findings) {
+    if (!mach_o_file || !findings) {
         fprintf(stderr, "Ошибка: Неверные аргументы в analyze_section_permissions\n");
         return -1;
     }
 
-    struct load_command *cmd = mach_o_file->commands;
-    for (uint32_t i = 0; i < mach_o_file->load_command_count; i++) { // Исправлено: command_count -> load_command_count
-        if (cmd->cmd == LC_SEGMENT || cmd->cmd == LC_SEGMENT_64) {
-            uint32_t nsects;
-            void *sections;
+    for (uint32_t i = 0; i < mach_o_file->section_count; i++) {
+        const MachOSection *section = &mach_o_file->sections[i];
+        uint32_t flags = section->flags;
 
-            if (cmd->cmd == LC_SEGMENT) {
-                struct segment_command *seg_cmd = (struct segment_command *)cmd;
-                nsects = seg_cmd->nsects;
-                sections = (struct section *)(seg_cmd + 1);
-            } else {
-                struct segment_command_64 *seg_cmd = (struct segment_command_64 *)cmd;
-                nsects = seg_cmd->nsects;
-                sections = (struct section_64 *)(seg_cmd + 1);
-            }
-
-            for (uint32_t j = 0; j < nsects; j++) {
-                uint32_t flags;
-                char sectname[17] = {0};
-                if (cmd->cmd == LC_SEGMENT) {
-                    struct section *section = &((struct section *)sections)[j];
-                    flags = section->flags;
-                    strncpy(sectname, section->sectname, 16);
-                } else {
-                    struct section_64 *section = &((struct section_64 *)sections)[j];
-                    flags = section->flags;
-                    strncpy(sectname, section->sectname, 16);
-                }
-
-                // Проверка на одновременную возможность записи и выполнения
-                if ((flags & S_ATTR_PURE_INSTRUCTIONS) && (flags & S_ATTR_SOME_INSTRUCTIONS)) {
-                    printf("Предупреждение: Секция %s имеет одновременно права на запись и выполнение\n", sectname);
-                }
+        // Проверка на одновременную возможность записи и выполнения
+        if ((flags & S_ATTR_PURE_INSTRUCTIONS) && (flags & S_ATTR_SOME_INSTRUCTIONS)) {
+            char sectname[MACHO_NAME_LENGTH + 1] = {0};
+            memcpy(sectname, section->sectname, MACHO_NAME_LENGTH);
+            if (add_finding(findings, SECURITY_FINDING_WRITABLE_CODE, NULL, sectname) != 0) {
+                return -1;
             }
         }
-        cmd = (struct load_command *)((uint8_t *)cmd + cmd->cmdsize);
     }
 
     return 0;
 }
 
-int analyze_debug_symbols(const MachOFile *mach_o_file, FILE *file) {
-    if (!mach_o_file || !file) {
+int analyze_debug_symbols(const MachOFile *mach_o_file, SecurityFindings *findings) {
+    if (!mach_o_file || !findings) {
         fprintf(stderr, "Ошибка: Неверные аргументы в analyze_debug_symbols\n");
         return -1;
     }
 
-    struct load_command *cmd = mach_o_file->commands;
-    for (uint32_t i = 0; i < mach_o_file->load_command_count; i++) { // Исправлено: command_count -> load_command_count
-        if (cmd->cmd == LC_SEGMENT || cmd->cmd == LC_SEGMENT_64) {
-            uint32_t nsects;
-            void *sections;
-
-            if (cmd->cmd == LC_SEGMENT) {
-                struct segment_command *seg_cmd = (struct segment_command *)cmd;
-                nsects = seg_cmd->nsects;
-                sections = (struct section *)(seg_cmd + 1);
-            } else {
-                struct segment_command_64 *seg_cmd = (struct segment_command_64 *)cmd;
-                nsects = seg_cmd->nsects;
-                sections = (struct section_64 *)(seg_cmd + 1);
-            }
-
-            for (uint32_t j = 0; j < nsects; j++) {
-                char sectname[17] = {0};
-                if (cmd->cmd == LC_SEGMENT) {
-                    struct section *section = &((struct section *)sections)[j];
-                    strncpy(sectname, section->sectname, 16);
-                } else {
-                    struct section_64 *section = &((struct section_64 *)sections)[j];
-                    strncpy(sectname, section->sectname, 16);
-                }
+    // Секции DWARF ищутся в любом сегменте, поэтому таблица просматривается целиком
+    for (uint32_t i = 0; i < mach_o_file->section_count; i++) {
+        char sectname[MACHO_NAME_LENGTH + 1] = {0};
+        memcpy(sectname, mach_o_file->sections[i].sectname, MACHO_NAME_LENGTH);
 
-                if (strcmp(sectname, "__debug_info") == 0 || strcmp(sectname, "__debug_line") == 0) {
-                    printf("Обнаружены отладочные символы в секции %s\n", sectname);
-                }
-            }
+        if ((strcmp(sectname, "__debug_info") == 0 || strcmp(sectname, "__debug_line") == 0) &&
+            add_finding(findings, SECURITY_FINDING_DEBUG_SYMBOLS, NULL, sectname) != 0) {
+            return -1;
         }
-        cmd = (struct load_command *)((uint8_t *)cmd + cmd->cmdsize);
     }
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,409 @@
+#include "sha_digest.h"
+#include <string.h>
+#include <pthread.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define SHA_DIGEST_HAVE_SHA_NI 1
+#include <cpuid.h>
+#include <immintrin.h>
+#else
+#define SHA_DIGEST_HAVE_SHA_NI 0
+#endif
+
+/**
+ * Сжатие count подряд идущих 64-байтных блоков в состояние.
+ */
+typedef void (*ShaBlockFunction)(uint32_t *state, const uint8_t *data, size_t count);
+
+static const uint32_t SHA256_K[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static inline uint32_t rotr32(uint32_t value, int bits) {
+    return (value >> bits) | (value << (32 - bits));
+}
+
+static inline uint32_t rotl32(uint32_t value, int bits) {
+    return (value << bits) | (value >> (32 - bits));
+}
+
+static inline uint32_t load_be32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline void store_be32(uint8_t *p, uint32_t value) {
+    p[0] = (uint8_t)(value >> 24);
+    p[1] = (uint8_t)(value >> 16);
+    p[2] = (uint8_t)(value >> 8);
+    p[3] = (uint8_t)value;
+}
+
+static void sha1_blocks_scalar(uint32_t *state, const uint8_t *data, size_t count) {
+    for (; count > 0; count--, data += SHA_BLOCK_SIZE) {
+        uint32_t w[80];
+        for (int i = 0; i < 16; i++) {
+            w[i] = load_be32(data + 4 * i);
+        }
+        for (int i = 16; i < 80; i++) {
+            w[i] = rotl32(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        }
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+        for (int i = 0; i < 80; i++) {
+            uint32_t f, k;
+            if (i < 20) {
+                f = (b & c) | (~b & d);
+                k = 0x5a827999;
+            } else if (i < 40) {
+                f = b ^ c ^ d;
+                k = 0x6ed9eba1;
+            } else if (i < 60) {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8f1bbcdc;
+            } else {
+                f = b ^ c ^ d;
+                k = 0xca62c1d6;
+            }
+            uint32_t t = rotl32(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = rotl32(b, 30);
+            b = a;
+            a = t;
+        }
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+    }
+}
+
+static void sha256_blocks_scalar(uint32_t *state, const uint8_t *data, size_t count) {
+    for (; count > 0; count--, data += SHA_BLOCK_SIZE) {
+        uint32_t w[64];
+        for (int i = 0; i < 16; i++) {
+            w[i] = load_be32(data + 4 * i);
+        }
+        for (int i = 16; i < 64; i++) {
+            uint32_t s0 = rotr32(w[i - 15], 7) ^ rotr32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = rotr32(w[i - 2], 17) ^ rotr32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int i = 0; i < 64; i++) {
+            uint32_t s1 = rotr32(e, 6) ^ rotr32(e, 11) ^ rotr32(e, 25);
+            uint32_t ch = (e & f) ^ (~e & g);
+            uint32_t t1 = h + s1 + ch + SHA256_K[i] + w[i];
+            uint32_t s0 = rotr32(a, 2) ^ rotr32(a, 13) ^ rotr32(a, 22);
+            uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+            uint32_t t2 = s0 + maj;
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+}
+
+#if SHA_DIGEST_HAVE_SHA_NI
+
+#define SHA_NI_TARGET __attribute__((target("sha,sse4.1,ssse3")))
+
+/**
+ * Четыре раунда SHA-1 (группа g из 20) вместе с расчётом расписания сообщений:
+ * sha1msg1/xor/sha1msg2 готовят слова группы g + 1..g + 3, пока идут раунды группы g.
+ * Макрос, а не функция: номер функции раунда в sha1rnds4 должен быть константой.
+ */
+#define SHA1_NI_GROUP(g)                                                       \
+    do {                                                                       \
+        if ((g) == 0) {                                                        \
+            e[0] = _mm_add_epi32(e[0], w[0]);                                  \
+        } else {                                                               \
+            e[(g) & 1] = _mm_sha1nexte_epu32(e[(g) & 1], w[(g) & 3]);          \
+        }                                                                      \
+        e[((g) + 1) & 1] = abcd;                                               \
+        if ((g) >= 3 && (g) <= 18) {                                           \
+            w[((g) + 1) & 3] = _mm_sha1msg2_epu32(w[((g) + 1) & 3], w[(g) & 3]); \
+        }                                                                      \
+        abcd = _mm_sha1rnds4_epu32(abcd, e[(g) & 1], (g) / 5);                 \
+        if ((g) >= 1 && (g) <= 16) {                                           \
+            w[((g) - 1) & 3] = _mm_sha1msg1_epu32(w[((g) - 1) & 3], w[(g) & 3]); \
+        }                                                                      \
+        if ((g) >= 2 && (g) <= 17) {                                           \
+            w[((g) - 2) & 3] = _mm_xor_si128(w[((g) - 2) & 3], w[(g) & 3]);    \
+        }                                                                      \
+    } while (0)
+
+SHA_NI_TARGET
+static void sha1_blocks_sha_ni(uint32_t *state, const uint8_t *data, size_t count) {
+    const __m128i mask = _mm_set_epi64x(0x0001020304050607LL, 0x08090a0b0c0d0e0fLL);
+    __m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)state), 0x1B);
+    __m128i e0 = _mm_set_epi32((int)state[4], 0, 0, 0);
+
+    for (; count > 0; count--, data += SHA_BLOCK_SIZE) {
+        __m128i abcd_save = abcd;
+        __m128i e0_save = e0;
+        __m128i e[2] = {e0, e0};
+        __m128i w[4];
+        for (int i = 0; i < 4; i++) {
+            w[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 16 * i)), mask);
+        }
+
+        SHA1_NI_GROUP(0);
+        SHA1_NI_GROUP(1);
+        SHA1_NI_GROUP(2);
+        SHA1_NI_GROUP(3);
+        SHA1_NI_GROUP(4);
+        SHA1_NI_GROUP(5);
+        SHA1_NI_GROUP(6);
+        SHA1_NI_GROUP(7);
+        SHA1_NI_GROUP(8);
+        SHA1_NI_GROUP(9);
+        SHA1_NI_GROUP(10);
+        SHA1_NI_GROUP(11);
+        SHA1_NI_GROUP(12);
+        SHA1_NI_GROUP(13);
+        SHA1_NI_GROUP(14);
+        SHA1_NI_GROUP(15);
+        SHA1_NI_GROUP(16);
+        SHA1_NI_GROUP(17);
+        SHA1_NI_GROUP(18);
+        SHA1_NI_GROUP(19);
+
+        e0 = _mm_sha1nexte_epu32(e[0], e0_save);
+        abcd = _mm_add_epi32(abcd, abcd_save);
+    }
+
+    _mm_storeu_si128((__m128i *)state, _mm_shuffle_epi32(abcd, 0x1B));
+    state[4] = (uint32_t)_mm_extract_epi32(e0, 3);
+}
+
+SHA_NI_TARGET
+static void sha256_blocks_sha_ni(uint32_t *state, const uint8_t *data, size_t count) {
+    const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bLL, 0x0405060700010203LL);
+
+    // Инструкции работают с состоянием в порядке ABEF/CDGH
+    __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&state[0]), 0xB1);
+    __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&state[4]), 0x1B);
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+
+    for (; count > 0; count--, data += SHA_BLOCK_SIZE) {
+        __m128i abef_save = state0;
+        __m128i cdgh_save = state1;
+        __m128i w[4];
+        for (int i = 0; i < 16; i++) {
+            if (i < 4) {
+                w[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 16 * i)), mask);
+            } else {
+                // W[i] из W[i-4], W[i-3], W[i-2], W[i-1] (по четыре слова)
+                __m128i next = _mm_sha256msg1_epu32(w[i & 3], w[(i + 1) & 3]);
+                next = _mm_add_epi32(next, _mm_alignr_epi8(w[(i + 3) & 3], w[(i + 2) & 3], 4));
+                w[i & 3] = _mm_sha256msg2_epu32(next, w[(i + 3) & 3]);
+            }
+            __m128i message = _mm_add_epi32(w[i & 3], _mm_loadu_si128((const __m128i *)&SHA256_K[4 * i]));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, message);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(message, 0x0E));
+        }
+
+        state0 = _mm_add_epi32(state0, abef_save);
+        state1 = _mm_add_epi32(state1, cdgh_save);
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1B);
+    state1 = _mm_shuffle_epi32(state1, 0xB1);
+    _mm_storeu_si128((__m128i *)&state[0], _mm_blend_epi16(tmp, state1, 0xF0));
+    _mm_storeu_si128((__m128i *)&state[4], _mm_alignr_epi8(state1, tmp, 8));
+}
+
+/**
+ * Проверяет по CPUID наличие SHA Extensions и нужных им SSSE3/SSE4.1.
+ */
+static bool cpu_has_sha_ni(void) {
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !(ecx & bit_SSSE3) || !(ecx & bit_SSE4_1)) {
+        return false;
+    }
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+    return (ebx & (1u << 29)) != 0;  // CPUID.(EAX=7,ECX=0):EBX.SHA
+}
+
+#endif // SHA_DIGEST_HAVE_SHA_NI
+
+static ShaImplementation active_implementation = SHA_IMPLEMENTATION_SCALAR;
+static ShaBlockFunction sha1_blocks = sha1_blocks_scalar;
+static ShaBlockFunction sha256_blocks = sha256_blocks_scalar;
+static pthread_once_t detect_once = PTHREAD_ONCE_INIT;
+
+static bool is_supported(ShaImplementation implementation) {
+#if SHA_DIGEST_HAVE_SHA_NI
+    if (implementation == SHA_IMPLEMENTATION_SHA_NI) {
+        return cpu_has_sha_ni();
+    }
+#endif
+    return implementation == SHA_IMPLEMENTATION_SCALAR;
+}
+
+static void use_implementation(ShaImplementation implementation) {
+    active_implementation = implementation;
+#if SHA_DIGEST_HAVE_SHA_NI
+    if (implementation == SHA_IMPLEMENTATION_SHA_NI) {
+        sha1_blocks = sha1_blocks_sha_ni;
+        sha256_blocks = sha256_blocks_sha_ni;
+        return;
+    }
+#endif
+    sha1_blocks = sha1_blocks_scalar;
+    sha256_blocks = sha256_blocks_scalar;
+}
+
+static void detect_implementation(void) {
+    use_implementation(is_supported(SHA_IMPLEMENTATION_SHA_NI) ? SHA_IMPLEMENTATION_SHA_NI
+                                                                : SHA_IMPLEMENTATION_SCALAR);
+}
+
+ShaImplementation sha_implementation(void) {
+    pthread_once(&detect_once, detect_implementation);
+    return active_implementation;
+}
+
+bool sha_select_implementation(ShaImplementation implementation) {
+    pthread_once(&detect_once, detect_implementation);
+    if (!is_supported(implementation)) {
+        return false;
+    }
+    use_implementation(implementation);
+    return true;
+}
+
+/**
+ * Общая часть update для SHA-1 и SHA-256: добирает неполный блок в буфере,
+ * а целые блоки из входа сжимает одним вызовом без копирования.
+ */
+static void update_blocks(uint32_t *state, uint8_t *buffer, size_t *buffered, uint64_t *length,
+                          const void *data, size_t size, ShaBlockFunction compress) {
+    const uint8_t *p = data;
+    *length += size;
+    if (size == 0) {
+        return;
+    }
+    if (*buffered > 0) {
+        size_t take = SHA_BLOCK_SIZE - *buffered;
+        if (take > size) {
+            take = size;
+        }
+        memcpy(buffer + *buffered, p, take);
+        *buffered += take;
+        p += take;
+        size -= take;
+        if (*buffered < SHA_BLOCK_SIZE) {
+            return;
+        }
+        compress(state, buffer, 1);
+        *buffered = 0;
+    }
+    if (size >= SHA_BLOCK_SIZE) {
+        compress(state, p, size / SHA_BLOCK_SIZE);
+        p += size - size % SHA_BLOCK_SIZE;
+        size %= SHA_BLOCK_SIZE;
+    }
+    memcpy(buffer, p, size);
+    *buffered = size;
+}
+
+/**
+ * Дополнение сообщения: 0x80, нули и длина в битах (big-endian) в конце последнего блока.
+ */
+static void finish_blocks(uint32_t *state, uint8_t *buffer, size_t buffered, uint64_t length,
+                          ShaBlockFunction compress) {
+    buffer[buffered++] = 0x80;
+    if (buffered > SHA_BLOCK_SIZE - 8) {
+        memset(buffer + buffered, 0, SHA_BLOCK_SIZE - buffered);
+        compress(state, buffer, 1);
+        buffered = 0;
+    }
+    memset(buffer + buffered, 0, SHA_BLOCK_SIZE - 8 - buffered);
+    uint64_t bits = length * 8;
+    store_be32(buffer + SHA_BLOCK_SIZE - 8, (uint32_t)(bits >> 32));
+    store_be32(buffer + SHA_BLOCK_SIZE - 4, (uint32_t)bits);
+    compress(state, buffer, 1);
+}
+
+void sha1_init(Sha1Context *context) {
+    pthread_once(&detect_once, detect_implementation);
+    static const uint32_t initial[5] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
+    memcpy(context->state, initial, sizeof(initial));
+    context->length = 0;
+    context->buffered = 0;
+}
+
+void sha1_update(Sha1Context *context, const void *data, size_t size) {
+    update_blocks(context->state, context->buffer, &context->buffered, &context->length, data, size,
+                  sha1_blocks);
+}
+
+void sha1_final(Sha1Context *context, uint8_t digest[SHA1_DIGEST_LENGTH]) {
+    finish_blocks(context->state, context->buffer, context->buffered, context->length, sha1_blocks);
+    for (int i = 0; i < 5; i++) {
+        store_be32(digest + 4 * i, context->state[i]);
+    }
+}
+
+void sha256_init(Sha256Context *context) {
+    pthread_once(&detect_once, detect_implementation);
+    static const uint32_t initial[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+    memcpy(context->state, initial, sizeof(initial));
+    context->length = 0;
+    context->buffered = 0;
+}
+
+void sha256_update(Sha256Context *context, const void *data, size_t size) {
+    update_blocks(context->state, context->buffer, &context->buffered, &context->length, data, size,
+                  sha256_blocks);
+}
+
+void sha256_final(Sha256Context *context, uint8_t digest[SHA256_DIGEST_LENGTH]) {
+    finish_blocks(context->state, context->buffer, context->buffered, context->length, sha256_blocks);
+    for (int i = 0; i < 8; i++) {
+        store_be32(digest + 4 * i, context->state[i]);
+    }
+}
+
+void sha1(const void *data, size_t size, uint8_t digest[SHA1_DIGEST_LENGTH]) {
+    Sha1Context context;
+    sha1_init(&context);
+    sha1_update(&context, data, size);
+    sha1_final(&context, digest);
+}
+
+void sha256(const void *data, size_t size, uint8_t digest[SHA256_DIGEST_LENGTH]) {
+    Sha256Context context;
+    sha256_init(&context);
+    sha256_update(&context, data, size);
+    sha256_final(&context, digest);
+}
@@ -0,0 +1,305 @@
+#include "signature_scanner.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SIGNATURE_SCANNER_X86 1
+#include <immintrin.h>
+#endif
+
+// Максимальное число различных пар первых байтов для векторных реализаций
+#define SIGNATURE_SCANNER_VECTOR_PAIRS 16
+
+/**
+ * Пара первых байтов, с которой начинается хотя бы одна сигнатура.
+ */
+typedef struct {
+    uint8_t first;
+    uint8_t second;
+    bool any_second;  // Сигнатура из одного байта: второй байт не проверяется
+} SignaturePair;
+
+struct SignatureScanner {
+    const char *const *needles;  // Сигнатуры
+    size_t *lengths;             // Длины сигнатур
+    size_t count;                // Количество сигнатур
+
+    SignaturePair *pairs;        // Различные пары первых байтов
+    size_t pair_count;
+
+    uint8_t first_bytes[256];    // Ненулевой, если с байта начинается сигнатура
+    uint8_t single_bytes[256];   // Ненулевой, если есть сигнатура из одного этого байта
+    uint8_t *pair_bits;          // Битовая карта пар (65536 бит) для скалярного поиска
+
+    SignatureScanImpl impl;
+};
+
+/**
+ * Состояние одного вызова signature_scanner_scan.
+ */
+typedef struct {
+    SignatureHitCallback callback;
+    void *context;
+    int64_t hits;
+    bool stopped;
+} ScanState;
+
+/**
+ * Проверяет все сигнатуры в позиции-кандидате и сообщает совпадения.
+ */
+static void verify_candidate(const SignatureScanner *scanner, const uint8_t *data, uint64_t size,
+                             uint64_t pos, ScanState *state) {
+    uint64_t remaining = size - pos;
+    for (size_t i = 0; i < scanner->count && !state->stopped; i++) {
+        size_t length = scanner->lengths[i];
+        if (length > remaining || (uint8_t)scanner->needles[i][0] != data[pos]) {
+            continue;
+        }
+        if (memcmp(data + pos, scanner->needles[i], length) != 0) {
+            continue;
+        }
+        state->hits++;
+        if (state->callback && state->callback((uint32_t)i, pos, state->context) != 0) {
+            state->stopped = true;
+        }
+    }
+}
+
+/**
+ * Скалярный поиск в диапазоне [start, size).
+ */
+static void scan_scalar(const SignatureScanner *scanner, const uint8_t *data, uint64_t size, uint64_t start,
+                        ScanState *state) {
+    for (uint64_t pos = start; pos < size && !state->stopped; pos++) {
+        uint8_t b0 = data[pos];
+        if (!scanner->first_bytes[b0]) {
+            continue;
+        }
+        bool candidate = scanner->single_bytes[b0] != 0;
+        if (!candidate && pos + 1 < size) {
+            uint32_t key = ((uint32_t)b0 << 8) | data[pos + 1];
+            candidate = (scanner->pair_bits[key >> 3] >> (key & 7)) & 1;
+        }
+        if (candidate) {
+            verify_candidate(scanner, data, size, pos, state);
+        }
+    }
+}
+
+#ifdef SIGNATURE_SCANNER_X86
+
+__attribute__((target("sse2")))
+static void scan_sse2(const SignatureScanner *scanner, const uint8_t *data, uint64_t size, ScanState *state) {
+    __m128i first[SIGNATURE_SCANNER_VECTOR_PAIRS];
+    __m128i second[SIGNATURE_SCANNER_VECTOR_PAIRS];
+    size_t pair_count = scanner->pair_count;
+    for (size_t p = 0; p < pair_count; p++) {
+        first[p] = _mm_set1_epi8((char)scanner->pairs[p].first);
+        second[p] = _mm_set1_epi8((char)scanner->pairs[p].second);
+    }
+
+    // Второй блок читается со сдвигом на байт, поэтому нужен запас в 17 байт
+    uint64_t pos = 0;
+    while (size >= 17 && pos <= size - 17 && !state->stopped) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(data + pos));
+        __m128i b = _mm_loadu_si128((const __m128i *)(data + pos + 1));
+        uint32_t mask = 0;
+        for (size_t p = 0; p < pair_count; p++) {
+            __m128i m = _mm_cmpeq_epi8(a, first[p]);
+            if (!scanner->pairs[p].any_second) {
+                m = _mm_and_si128(m, _mm_cmpeq_epi8(b, second[p]));
+            }
+            mask |= (uint32_t)_mm_movemask_epi8(m);
+        }
+        while (mask && !state->stopped) {
+            verify_candidate(scanner, data, size, pos + (uint64_t)__builtin_ctz(mask), state);
+            mask &= mask - 1;
+        }
+        pos += 16;
+    }
+
+    if (!state->stopped) {
+        scan_scalar(scanner, data, size, pos, state);
+    }
+}
+
+__attribute__((target("avx2")))
+static void scan_avx2(const SignatureScanner *scanner, const uint8_t *data, uint64_t size, ScanState *state) {
+    __m256i first[SIGNATURE_SCANNER_VECTOR_PAIRS];
+    __m256i second[SIGNATURE_SCANNER_VECTOR_PAIRS];
+    size_t pair_count = scanner->pair_count;
+    for (size_t p = 0; p < pair_count; p++) {
+        first[p] = _mm256_set1_epi8((char)scanner->pairs[p].first);
+        second[p] = _mm256_set1_epi8((char)scanner->pairs[p].second);
+    }
+
+    uint64_t pos = 0;
+    while (size >= 33 && pos <= size - 33 && !state->stopped) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(data + pos));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(data + pos + 1));
+        uint32_t mask = 0;
+        for (size_t p = 0; p < pair_count; p++) {
+            __m256i m = _mm256_cmpeq_epi8(a, first[p]);
+            if (!scanner->pairs[p].any_second) {
+                m = _mm256_and_si256(m, _mm256_cmpeq_epi8(b, second[p]));
+            }
+            mask |= (uint32_t)_mm256_movemask_epi8(m);
+        }
+        while (mask && !state->stopped) {
+            verify_candidate(scanner, data, size, pos + (uint64_t)__builtin_ctz(mask), state);
+            mask &= mask - 1;
+        }
+        pos += 32;
+    }
+
+    if (!state->stopped) {
+        scan_scalar(scanner, data, size, pos, state);
+    }
+}
+
+#endif // SIGNATURE_SCANNER_X86
+
+/**
+ * Проверяет, может ли сканер использовать реализацию на этом процессоре.
+ */
+static bool impl_supported(const SignatureScanner *scanner, SignatureScanImpl impl) {
+    switch (impl) {
+        case SIGNATURE_SCAN_SCALAR:
+            return true;
+#ifdef SIGNATURE_SCANNER_X86
+        case SIGNATURE_SCAN_SSE2:
+            return scanner->pair_count <= SIGNATURE_SCANNER_VECTOR_PAIRS && __builtin_cpu_supports("sse2");
+        case SIGNATURE_SCAN_AVX2:
+            return scanner->pair_count <= SIGNATURE_SCANNER_VECTOR_PAIRS && __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+SignatureScanner *signature_scanner_create(const char *const *needles, size_t count) {
+    if (!needles && count > 0) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в signature_scanner_create\n");
+        return NULL;
+    }
+
+    SignatureScanner *scanner = calloc(1, sizeof(SignatureScanner));
+    if (!scanner) {
+        fprintf(stderr, "Ошибка: Не удалось выделить память для сканера сигнатур\n");
+        return NULL;
+    }
+    scanner->needles = needles;
+    scanner->count = count;
+    scanner->lengths = calloc(count ? count : 1, sizeof(size_t));
+    scanner->pairs = calloc(count ? count : 1, sizeof(SignaturePair));
+    scanner->pair_bits = calloc(65536 / 8, 1);
+    if (!scanner->lengths || !scanner->pairs || !scanner->pair_bits) {
+        fprintf(stderr, "Ошибка: Не удалось выделить память для сканера сигнатур\n");
+        signature_scanner_destroy(scanner);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (!needles[i] || !needles[i][0]) {
+            fprintf(stderr, "Ошибка: Пустая сигнатура в сканере сигнатур\n");
+            signature_scanner_destroy(scanner);
+            return NULL;
+        }
+
+        size_t length = strlen(needles[i]);
+        scanner->lengths[i] = length;
+
+        SignaturePair pair = {(uint8_t)needles[i][0], length > 1 ? (uint8_t)needles[i][1] : 0, length == 1};
+        scanner->first_bytes[pair.first] = 1;
+        if (pair.any_second) {
+            scanner->single_bytes[pair.first] = 1;
+        } else {
+            uint32_t key = ((uint32_t)pair.first << 8) | pair.second;
+            scanner->pair_bits[key >> 3] |= (uint8_t)(1u << (key & 7));
+        }
+
+        bool known = false;
+        for (size_t p = 0; p < scanner->pair_count; p++) {
+            const SignaturePair *existing = &scanner->pairs[p];
+            if (existing->first == pair.first && existing->any_second == pair.any_second &&
+                (pair.any_second || existing->second == pair.second)) {
+                known = true;
+                break;
+            }
+        }
+        if (!known) {
+            scanner->pairs[scanner->pair_count++] = pair;
+        }
+    }
+
+    scanner->impl = SIGNATURE_SCAN_SCALAR;
+    if (impl_supported(scanner, SIGNATURE_SCAN_AVX2)) {
+        scanner->impl = SIGNATURE_SCAN_AVX2;
+    } else if (impl_supported(scanner, SIGNATURE_SCAN_SSE2)) {
+        scanner->impl = SIGNATURE_SCAN_SSE2;
+    }
+    return scanner;
+}
+
+void signature_scanner_destroy(SignatureScanner *scanner) {
+    if (!scanner) {
+        return;
+    }
+    free(scanner->lengths);
+    free(scanner->pairs);
+    free(scanner->pair_bits);
+    free(scanner);
+}
+
+int64_t signature_scanner_scan(const SignatureScanner *scanner, const void *data, uint64_t size,
+                               SignatureHitCallback callback, void *context) {
+    if (!scanner || (!data && size > 0)) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в signature_scanner_scan\n");
+        return -1;
+    }
+
+    ScanState state = {callback, context, 0, false};
+    if (size == 0 || scanner->count == 0) {
+        return 0;
+    }
+
+    switch (scanner->impl) {
+#ifdef SIGNATURE_SCANNER_X86
+        case SIGNATURE_SCAN_AVX2:
+            scan_avx2(scanner, data, size, &state);
+            break;
+        case SIGNATURE_SCAN_SSE2:
+            scan_sse2(scanner, data, size, &state);
+            break;
+#endif
+        default:
+            scan_scalar(scanner, data, size, 0, &state);
+            break;
+    }
+    return state.hits;
+}
+
+SignatureScanImpl signature_scanner_impl(const SignatureScanner *scanner) {
+    return scanner ? scanner->impl : SIGNATURE_SCAN_SCALAR;
+}
+
+int signature_scanner_set_impl(SignatureScanner *scanner, SignatureScanImpl impl) {
+    if (!scanner || !impl_supported(scanner, impl)) {
+        return -1;
+    }
+    scanner->impl = impl;
+    return 0;
+}
+
+const char *signature_scan_impl_name(SignatureScanImpl impl) {
+    switch (impl) {
+        case SIGNATURE_SCAN_SSE2:
+            return "SSE2";
+        case SIGNATURE_SCAN_AVX2:
+            return "AVX2";
+        default:
+            return "scalar";
+    }
+}
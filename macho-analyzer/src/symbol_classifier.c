@@ -0,0 +1,288 @@
+#include "symbol_classifier.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct SymbolClassifier {
+    // Исходные сопоставления
+    SymbolMapping *mappings;      // Массив сопоставлений
+    uint32_t *mapping_language;   // Идентификатор языка для каждого сопоставления
+    int32_t *next_same_node;      // Следующий префикс, заканчивающийся в том же узле (-1 — нет)
+    size_t count;                 // Количество сопоставлений
+    size_t capacity;              // Ёмкость массивов сопоставлений
+
+    // Интернированные языки
+    const char *languages[SYMBOL_CLASSIFIER_MAX_LANGUAGES];
+    size_t language_count;
+
+    // Скомпилированный автомат
+    uint8_t byte_class[256];      // Класс байта (0 — байт не встречается ни в одном префиксе)
+    uint32_t class_count;         // Количество классов, включая нулевой
+    uint32_t *transitions;        // Переходы: transitions[node * class_count + class], 0 — нет перехода
+    uint64_t *node_languages;     // Маска языков префиксов, заканчивающихся в узле
+    int32_t *node_pattern;        // Первый префикс, заканчивающийся в узле (-1 — нет)
+    uint32_t node_count;          // Количество узлов (узел 0 — корень)
+};
+
+/**
+ * Возвращает идентификатор языка, добавляя его при необходимости.
+ *
+ * @return Идентификатор языка или -1, если превышен лимит языков.
+ */
+static int intern_language(SymbolClassifier *classifier, const char *language) {
+    for (size_t i = 0; i < classifier->language_count; i++) {
+        if (strcmp(classifier->languages[i], language) == 0) {
+            return (int)i;
+        }
+    }
+    if (classifier->language_count >= SYMBOL_CLASSIFIER_MAX_LANGUAGES) {
+        fprintf(stderr, "Ошибка: Превышено максимальное число языков в классификаторе символов\n");
+        return -1;
+    }
+    classifier->languages[classifier->language_count] = language;
+    return (int)classifier->language_count++;
+}
+
+/**
+ * Добавляет сопоставление без перестроения автомата.
+ */
+static int append_mapping(SymbolClassifier *classifier, const SymbolMapping *mapping) {
+    if (!mapping || !mapping->prefix || !mapping->prefix[0] || !mapping->language) {
+        fprintf(stderr, "Ошибка: Неверное сопоставление для классификатора символов\n");
+        return -1;
+    }
+
+    int language = intern_language(classifier, mapping->language);
+    if (language < 0) {
+        return -1;
+    }
+
+    if (classifier->count == classifier->capacity) {
+        size_t new_capacity = classifier->capacity ? classifier->capacity * 2 : 64;
+        SymbolMapping *mappings = realloc(classifier->mappings, new_capacity * sizeof(SymbolMapping));
+        if (!mappings) {
+            fprintf(stderr, "Ошибка: Не удалось выделить память для классификатора символов\n");
+            return -1;
+        }
+        classifier->mappings = mappings;
+        uint32_t *languages = realloc(classifier->mapping_language, new_capacity * sizeof(uint32_t));
+        if (!languages) {
+            fprintf(stderr, "Ошибка: Не удалось выделить память для классификатора символов\n");
+            return -1;
+        }
+        classifier->mapping_language = languages;
+        int32_t *next = realloc(classifier->next_same_node, new_capacity * sizeof(int32_t));
+        if (!next) {
+            fprintf(stderr, "Ошибка: Не удалось выделить память для классификатора символов\n");
+            return -1;
+        }
+        classifier->next_same_node = next;
+        classifier->capacity = new_capacity;
+    }
+
+    classifier->mappings[classifier->count] = *mapping;
+    classifier->mapping_language[classifier->count] = (uint32_t)language;
+    return (int)classifier->count++;
+}
+
+/**
+ * Строит автомат заново по всем сопоставлениям.
+ * Каждый байт, встречающийся в префиксах, получает свой класс, поэтому строка
+ * таблицы переходов занимает class_count ячеек, а не 256.
+ */
+static int rebuild(SymbolClassifier *classifier) {
+    uint8_t byte_class[256] = {0};
+    uint32_t class_count = 1;
+    size_t total_length = 0;
+
+    for (size_t i = 0; i < classifier->count; i++) {
+        for (const unsigned char *p = (const unsigned char *)classifier->mappings[i].prefix; *p; p++) {
+            if (!byte_class[*p]) {
+                byte_class[*p] = (uint8_t)class_count++;
+            }
+            total_length++;
+        }
+    }
+
+    // Узлов не больше, чем суммарная длина префиксов плюс корень
+    size_t max_nodes = total_length + 1;
+    uint32_t *transitions = calloc(max_nodes * class_count, sizeof(uint32_t));
+    uint64_t *node_languages = calloc(max_nodes, sizeof(uint64_t));
+    int32_t *node_pattern = malloc(max_nodes * sizeof(int32_t));
+    if (!transitions || !node_languages || !node_pattern) {
+        fprintf(stderr, "Ошибка: Не удалось выделить память для автомата классификатора символов\n");
+        free(transitions);
+        free(node_languages);
+        free(node_pattern);
+        return -1;
+    }
+    for (size_t i = 0; i < max_nodes; i++) {
+        node_pattern[i] = -1;
+    }
+
+    uint32_t node_count = 1;
+    for (size_t i = 0; i < classifier->count; i++) {
+        uint32_t state = 0;
+        for (const unsigned char *p = (const unsigned char *)classifier->mappings[i].prefix; *p; p++) {
+            uint32_t *slot = &transitions[(size_t)state * class_count + byte_class[*p]];
+            if (!*slot) {
+                *slot = node_count++;
+            }
+            state = *slot;
+        }
+
+        node_languages[state] |= UINT64_C(1) << classifier->mapping_language[i];
+
+        // Префиксы с одинаковым текстом выстраиваются в цепочку по возрастанию идентификатора
+        classifier->next_same_node[i] = -1;
+        if (node_pattern[state] < 0) {
+            node_pattern[state] = (int32_t)i;
+        } else {
+            int32_t tail = node_pattern[state];
+            while (classifier->next_same_node[tail] >= 0) {
+                tail = classifier->next_same_node[tail];
+            }
+            classifier->next_same_node[tail] = (int32_t)i;
+        }
+    }
+
+    free(classifier->transitions);
+    free(classifier->node_languages);
+    free(classifier->node_pattern);
+    memcpy(classifier->byte_class, byte_class, sizeof(byte_class));
+    classifier->class_count = class_count;
+    classifier->transitions = transitions;
+    classifier->node_languages = node_languages;
+    classifier->node_pattern = node_pattern;
+    classifier->node_count = node_count;
+    return 0;
+}
+
+SymbolClassifier *symbol_classifier_create(const SymbolMapping *mappings, size_t count) {
+    SymbolClassifier *classifier = calloc(1, sizeof(SymbolClassifier));
+    if (!classifier) {
+        fprintf(stderr, "Ошибка: Не удалось выделить память для классификатора символов\n");
+        return NULL;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (append_mapping(classifier, &mappings[i]) < 0) {
+            symbol_classifier_destroy(classifier);
+            return NULL;
+        }
+    }
+
+    if (rebuild(classifier) != 0) {
+        symbol_classifier_destroy(classifier);
+        return NULL;
+    }
+    return classifier;
+}
+
+void symbol_classifier_destroy(SymbolClassifier *classifier) {
+    if (!classifier) {
+        return;
+    }
+    free(classifier->mappings);
+    free(classifier->mapping_language);
+    free(classifier->next_same_node);
+    free(classifier->transitions);
+    free(classifier->node_languages);
+    free(classifier->node_pattern);
+    free(classifier);
+}
+
+int symbol_classifier_add(SymbolClassifier *classifier, const SymbolMapping *mapping) {
+    if (!classifier) {
+        return -1;
+    }
+    // При ошибке откатываются и сопоставление, и добавленный им язык, чтобы массивы
+    // счётчиков размера language_count по-прежнему соответствовали автомату
+    size_t language_count = classifier->language_count;
+    size_t count = classifier->count;
+    int id = append_mapping(classifier, mapping);
+    if (id < 0 || rebuild(classifier) != 0) {
+        classifier->language_count = language_count;
+        classifier->count = count;
+        return -1;
+    }
+    return id;
+}
+
+size_t symbol_classifier_match(const SymbolClassifier *classifier, const char *name, uint32_t *ids, size_t max_ids) {
+    if (!classifier || !name) {
+        return 0;
+    }
+
+    size_t found = 0;
+    uint32_t state = 0;
+    for (const unsigned char *p = (const unsigned char *)name; *p; p++) {
+        uint8_t cls = classifier->byte_class[*p];
+        if (!cls) {
+            break;
+        }
+        state = classifier->transitions[(size_t)state * classifier->class_count + cls];
+        if (!state) {
+            break;
+        }
+        for (int32_t id = classifier->node_pattern[state]; id >= 0; id = classifier->next_same_node[id]) {
+            if (ids && found < max_ids) {
+                ids[found] = (uint32_t)id;
+            }
+            found++;
+        }
+    }
+    return found;
+}
+
+uint64_t symbol_classifier_tally(const SymbolClassifier *classifier, const char *name, uint32_t *counts) {
+    if (!classifier || !name) {
+        return 0;
+    }
+
+    uint64_t mask = 0;
+    uint32_t state = 0;
+    for (const unsigned char *p = (const unsigned char *)name; *p; p++) {
+        uint8_t cls = classifier->byte_class[*p];
+        if (!cls) {
+            break;
+        }
+        state = classifier->transitions[(size_t)state * classifier->class_count + cls];
+        if (!state) {
+            break;
+        }
+        mask |= classifier->node_languages[state];
+    }
+
+    if (counts) {
+        for (uint64_t bits = mask; bits; bits &= bits - 1) {
+            counts[__builtin_ctzll(bits)]++;
+        }
+    }
+    return mask;
+}
+
+const SymbolMapping *symbol_classifier_mapping(const SymbolClassifier *classifier, uint32_t id) {
+    if (!classifier || id >= classifier->count) {
+        return NULL;
+    }
+    return &classifier->mappings[id];
+}
+
+size_t symbol_classifier_language_count(const SymbolClassifier *classifier) {
+    return classifier ? classifier->language_count : 0;
+}
+
+const char *symbol_classifier_language(const SymbolClassifier *classifier, uint32_t language_id) {
+    if (!classifier || language_id >= classifier->language_count) {
+        return NULL;
+    }
+    return classifier->languages[language_id];
+}
+
+uint32_t symbol_classifier_language_of(const SymbolClassifier *classifier, uint32_t id) {
+    if (!classifier || id >= classifier->count) {
+        return 0;
+    }
+    return classifier->mapping_language[id];
+}
@@ -0,0 +1,193 @@
+#include "symbol_index.h"
+#include "macho_types.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Ищет команду LC_SYMTAB среди команд загрузки.
+ *
+ * @param mach_o_file Указатель на структуру MachOFile.
+ * @return Указатель на команду или NULL, если она отсутствует.
+ */
+static const struct symtab_command *find_symtab_command(const MachOFile *mach_o_file) {
+    const struct load_command *cmd = mach_o_file->commands;
+    for (uint32_t i = 0; i < mach_o_file->load_command_count; i++) {
+        if (macho_command_type(mach_o_file, cmd) == LC_SYMTAB &&
+            macho_command_size(mach_o_file, cmd) >= sizeof(struct symtab_command)) {
+            return (const struct symtab_command *)cmd;
+        }
+        cmd = macho_next_command(mach_o_file, cmd);
+    }
+    return NULL;
+}
+
+/**
+ * Возвращает имя символа, если оно целиком (вместе с завершающим нулём) лежит в таблице строк.
+ */
+static const char *decode_name(const char *string_table, uint32_t strsize, uint32_t strx) {
+    if (strx >= strsize || !memchr(string_table + strx, '\0', strsize - strx)) {
+        return "";
+    }
+    return string_table + strx;
+}
+
+/**
+ * Заполняет запись индекса по полям nlist.
+ */
+static void fill_symbol(MachOSymbol *out, const char *name, uint8_t n_type, uint8_t n_sect,
+                        uint16_t n_desc, uint64_t n_value) {
+    out->name = name;
+    out->n_type = n_type;
+    out->n_sect = n_sect;
+    out->n_desc = n_desc;
+    out->n_value = n_value;
+    out->is_undefined = !(n_type & N_STAB) && (n_type & N_TYPE) == N_UNDF;
+    out->is_external = (n_type & N_EXT) != 0;
+}
+
+/**
+ * Заполняет записи индекса по массиву nlist или nlist_64. Вызывается с константным
+ * swap, поэтому для образов в порядке байтов хоста цикл не содержит перестановок.
+ */
+static inline __attribute__((always_inline)) void fill_symbols(MachOSymbol *out, const void *symbols, uint32_t nsyms,
+                                                               bool is_64_bit, const char *string_table,
+                                                               uint32_t strsize, const bool swap) {
+    if (is_64_bit) {
+        const struct nlist_64 *nl = symbols;
+        for (uint32_t i = 0; i < nsyms; i++) {
+            fill_symbol(&out[i], decode_name(string_table, strsize, macho_swap_if32(swap, nl[i].n_un.n_strx)),
+                        nl[i].n_type, nl[i].n_sect, macho_swap_if16(swap, nl[i].n_desc),
+                        macho_swap_if64(swap, nl[i].n_value));
+        }
+    } else {
+        const struct nlist *nl = symbols;
+        for (uint32_t i = 0; i < nsyms; i++) {
+            fill_symbol(&out[i], decode_name(string_table, strsize, macho_swap_if32(swap, nl[i].n_un.n_strx)),
+                        nl[i].n_type, nl[i].n_sect, macho_swap_if16(swap, (uint16_t)nl[i].n_desc),
+                        macho_swap_if32(swap, nl[i].n_value));
+        }
+    }
+}
+
+/**
+ * Строит индекс по таблице символов Mach-O файла.
+ */
+static MachOSymbolIndex *build_symbol_index(const MachOFile *mach_o_file, const struct symtab_command *symtab_cmd) {
+    MachOSymbolIndex *index = calloc(1, sizeof(MachOSymbolIndex));
+    if (!index) {
+        fprintf(stderr, "Ошибка: Не удалось выделить память для индекса символов\n");
+        return NULL;
+    }
+
+    uint32_t nsyms = symtab_cmd ? macho_get32(mach_o_file, symtab_cmd->nsyms) : 0;
+    if (nsyms == 0) {
+        return index; // Пустой индекс: таблицы символов нет
+    }
+    uint32_t symoff = macho_get32(mach_o_file, symtab_cmd->symoff);
+    uint32_t stroff = macho_get32(mach_o_file, symtab_cmd->stroff);
+    uint32_t strsize = macho_get32(mach_o_file, symtab_cmd->strsize);
+
+    // Таблицы символов и строк читаются прямо из образа
+    size_t symbol_size = mach_o_file->is_64_bit ? sizeof(struct nlist_64) : sizeof(struct nlist);
+    const void *symbols = macho_file_slice(mach_o_file, symoff, (uint64_t)nsyms * symbol_size);
+    if (!symbols) {
+        fprintf(stderr, "Ошибка: Таблица символов выходит за границы файла\n");
+        free(index);
+        return NULL;
+    }
+
+    const char *string_table = macho_file_slice(mach_o_file, stroff, strsize);
+    if (!string_table) {
+        fprintf(stderr, "Ошибка: Таблица строк выходит за границы файла\n");
+        free(index);
+        return NULL;
+    }
+
+    index->symbols = malloc((size_t)nsyms * sizeof(MachOSymbol));
+    if (!index->symbols) {
+        fprintf(stderr, "Ошибка: Не удалось выделить память для индекса символов\n");
+        free(index);
+        return NULL;
+    }
+    index->count = nsyms;
+
+    if (mach_o_file->swapped) {
+        fill_symbols(index->symbols, symbols, nsyms, mach_o_file->is_64_bit, string_table, strsize, true);
+    } else {
+        fill_symbols(index->symbols, symbols, nsyms, mach_o_file->is_64_bit, string_table, strsize, false);
+    }
+
+    return index;
+}
+
+/**
+ * Возвращает индекс из кеша или строит и публикует его.
+ *
+ * @param symtab Найденная команда LC_SYMTAB или NULL, чтобы найти её самостоятельно.
+ * @param searched Команда уже искалась (symtab == NULL означает, что её нет).
+ */
+static const MachOSymbolIndex *cached_symbol_index(const MachOFile *mach_o_file, const struct symtab_command *symtab,
+                                                   bool searched) {
+    // Кеш не меняет наблюдаемого состояния MachOFile, поэтому const снимается
+    MachOFile *cache = (MachOFile *)mach_o_file;
+    MachOSymbolIndex *index = __atomic_load_n(&cache->symbol_index, __ATOMIC_ACQUIRE);
+    if (index || (__atomic_load_n(&cache->cache_failed, __ATOMIC_ACQUIRE) & MACHO_CACHE_SYMBOL_INDEX)) {
+        return index;
+    }
+
+    index = build_symbol_index(mach_o_file, searched ? symtab : find_symtab_command(mach_o_file));
+    if (!index) {
+        __atomic_fetch_or(&cache->cache_failed, MACHO_CACHE_SYMBOL_INDEX, __ATOMIC_RELEASE);
+        return NULL;
+    }
+    MachOSymbolIndex *published = NULL;
+    if (!__atomic_compare_exchange_n(&cache->symbol_index, &published, index, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        // Другой поток построил кеш раньше: используется его результат
+        macho_symbol_index_free(index);
+        index = published;
+    }
+    return index;
+}
+
+const MachOSymbolIndex *macho_get_symbol_index(const MachOFile *mach_o_file) {
+    if (!mach_o_file || !mach_o_file->commands) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в macho_get_symbol_index\n");
+        return NULL;
+    }
+    return cached_symbol_index(mach_o_file, NULL, false);
+}
+
+const MachOSymbolIndex *macho_get_symbol_index_from(const MachOFile *mach_o_file,
+                                                     const struct symtab_command *symtab) {
+    if (!mach_o_file || !mach_o_file->commands) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в macho_get_symbol_index_from\n");
+        return NULL;
+    }
+    return cached_symbol_index(mach_o_file, symtab, true);
+}
+
+static int visit_symtab(const MachOFile *mach_o_file, const struct load_command *cmd, void *context) {
+    if (macho_command_size(mach_o_file, cmd) < sizeof(struct symtab_command)) {
+        return MACHO_VISIT_CONTINUE;
+    }
+    *(const struct symtab_command **)context = (const struct symtab_command *)cmd;
+    return MACHO_VISIT_DONE;
+}
+
+int macho_symtab_subscribe(MachOCommandVisitor *visitor, const struct symtab_command **symtab) {
+    if (!visitor || !symtab) {
+        fprintf(stderr, "Ошибка: Неверные аргументы в macho_symtab_subscribe\n");
+        return -1;
+    }
+    *symtab = NULL;
+    return macho_visitor_subscribe(visitor, LC_SYMTAB, visit_symtab, (void *)symtab);
+}
+
+void macho_symbol_index_free(MachOSymbolIndex *index) {
+    if (!index) {
+        return;
+    }
+    free(index->symbols);
+    free(index);
+}
@@ -0,0 +1,180 @@
+#include "thread_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <unistd.h>
+
+// Задач в очереди на один рабочий поток по умолчанию
+#define THREAD_POOL_QUEUE_PER_WORKER 4
+
+typedef struct {
+    ThreadPoolTask task;
+    void *arg;
+} PoolItem;
+
+typedef struct {
+    ThreadPool *pool;
+    size_t index;
+} PoolWorker;
+
+struct ThreadPool {
+    pthread_mutex_t lock;
+    pthread_cond_t has_work;    // В очереди появилась задача или пул останавливается
+    pthread_cond_t has_space;   // В очереди освободилось место
+    pthread_cond_t idle;        // Очередь пуста и ни одна задача не выполняется
+
+    PoolItem *queue;            // Кольцевой буфер задач
+    size_t capacity;
+    size_t head;                // Индекс следующей задачи для выполнения
+    size_t count;               // Задач в очереди
+    size_t active;              // Задач, выполняющихся прямо сейчас
+    bool stopping;
+
+    pthread_t *threads;
+    PoolWorker *workers;
+    size_t worker_count;        // Количество успешно запущенных потоков
+};
+
+static void *worker_main(void *arg) {
+    PoolWorker *worker = arg;
+    ThreadPool *pool = worker->pool;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (pool->count == 0 && !pool->stopping) {
+            pthread_cond_wait(&pool->has_work, &pool->lock);
+        }
+        if (pool->count == 0) {
+            break; // Пул останавливается, и задач больше нет
+        }
+
+        PoolItem item = pool->queue[pool->head];
+        pool->head = (pool->head + 1) % pool->capacity;
+        pool->count--;
+        pool->active++;
+        pthread_cond_signal(&pool->has_space);
+        pthread_mutex_unlock(&pool->lock);
+
+        item.task(item.arg, worker->index);
+
+        pthread_mutex_lock(&pool->lock);
+        pool->active--;
+        if (pool->count == 0 && pool->active == 0) {
+            pthread_cond_broadcast(&pool->idle);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+size_t thread_pool_cpu_count(void) {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (size_t)count : 1;
+}
+
+ThreadPool *thread_pool_create(size_t workers, size_t queue_capacity) {
+    if (workers == 0) {
+        workers = thread_pool_cpu_count();
+    }
+    if (queue_capacity == 0) {
+        queue_capacity = workers * THREAD_POOL_QUEUE_PER_WORKER;
+    }
+
+    ThreadPool *pool = calloc(1, sizeof(ThreadPool));
+    if (!pool) {
+        fprintf(stderr, "Ошибка: Не удалось выделить память для пула потоков\n");
+        return NULL;
+    }
+    pool->queue = calloc(queue_capacity, sizeof(PoolItem));
+    pool->threads = calloc(workers, sizeof(pthread_t));
+    pool->workers = calloc(workers, sizeof(PoolWorker));
+    if (!pool->queue || !pool->threads || !pool->workers) {
+        fprintf(stderr, "Ошибка: Не удалось выделить память для пула потоков\n");
+        free(pool->queue);
+        free(pool->threads);
+        free(pool->workers);
+        free(pool);
+        return NULL;
+    }
+    pool->capacity = queue_capacity;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->has_work, NULL);
+    pthread_cond_init(&pool->has_space, NULL);
+    pthread_cond_init(&pool->idle, NULL);
+
+    for (size_t i = 0; i < workers; i++) {
+        pool->workers[i].pool = pool;
+        pool->workers[i].index = i;
+        if (pthread_create(&pool->threads[i], NULL, worker_main, &pool->workers[i]) != 0) {
+            fprintf(stderr, "Ошибка: Не удалось запустить рабочий поток %zu\n", i + 1);
+            break;
+        }
+        pool->worker_count++;
+    }
+    if (pool->worker_count == 0) {
+        thread_pool_destroy(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+int thread_pool_submit(ThreadPool *pool, ThreadPoolTask task, void *arg) {
+    if (!pool || !task) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->count == pool->capacity && !pool->stopping) {
+        pthread_cond_wait(&pool->has_space, &pool->lock);
+    }
+    if (pool->stopping) {
+        pthread_mutex_unlock(&pool->lock);
+        return -1;
+    }
+    pool->queue[(pool->head + pool->count) % pool->capacity] = (PoolItem){task, arg};
+    pool->count++;
+    pthread_cond_signal(&pool->has_work);
+    pthread_mutex_unlock(&pool->lock);
+    return 0;
+}
+
+void thread_pool_wait(ThreadPool *pool) {
+    if (!pool) {
+        return;
+    }
+    pthread_mutex_lock(&pool->lock);
+    while (pool->count > 0 || pool->active > 0) {
+        pthread_cond_wait(&pool->idle, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void thread_pool_destroy(ThreadPool *pool) {
+    if (!pool) {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = true;
+    pthread_cond_broadcast(&pool->has_work);
+    pthread_cond_broadcast(&pool->has_space);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (size_t i = 0; i < pool->worker_count; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->has_work);
+    pthread_cond_destroy(&pool->has_space);
+    pthread_cond_destroy(&pool->idle);
+    free(pool->queue);
+    free(pool->threads);
+    free(pool->workers);
+    free(pool);
+}
+
+size_t thread_pool_size(const ThreadPool *pool) {
+    return pool ? pool->worker_count : 0;
+}
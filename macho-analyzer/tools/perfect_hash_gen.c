@@ -0,0 +1,225 @@
+/**
+ * Генератор минимальных совершенных хеш-функций для статических таблиц анализатора.
+ *
+ * Ключи берутся из тех же .def файлов, из которых строятся сами таблицы, поэтому
+ * порядок элементов совпадает. Для каждой корзины подбирается seed, при котором все
+ * её ключи попадают в свободные слоты; результат записывается в заголовок с двумя
+ * массивами только для чтения.
+ *
+ * Использование: perfect_hash_gen <таблица> <выходной файл>
+ * Таблицы: lc_commands, unsafe_functions.
+ */
+#include "perfect_hash.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+// Наибольший допустимый seed (хранится в uint16_t)
+#define MAX_SEED 65535
+
+static const char *const lc_command_keys[] = {
+#define LC_COMMAND(name, decoder, description_en, description_ru) #name,
+#include "lc_commands.def"
+#undef LC_COMMAND
+};
+
+static const char *const unsafe_function_keys[] = {
+#define UNSAFE_FUNCTION(name, category, severity) name,
+#include "unsafe_functions.def"
+#undef UNSAFE_FUNCTION
+};
+
+typedef struct {
+    const char *name;          // Имя таблицы
+    const char *macro;         // Префикс макросов в заголовке
+    const char *const *keys;
+    size_t count;
+} KeySet;
+
+static const KeySet key_sets[] = {
+        {"lc_commands", "LC_COMMANDS", lc_command_keys, sizeof(lc_command_keys) / sizeof(lc_command_keys[0])},
+        {"unsafe_functions", "UNSAFE_FUNCTIONS", unsafe_function_keys,
+         sizeof(unsafe_function_keys) / sizeof(unsafe_function_keys[0])},
+};
+
+typedef struct {
+    uint32_t bucket;
+    uint32_t size;
+} BucketOrder;
+
+static int compare_buckets(const void *a, const void *b) {
+    const BucketOrder *left = a;
+    const BucketOrder *right = b;
+    if (left->size != right->size) {
+        return left->size > right->size ? -1 : 1;
+    }
+    return left->bucket < right->bucket ? -1 : (left->bucket > right->bucket);
+}
+
+/**
+ * Подбирает seed для всех корзин.
+ *
+ * @param seeds Массив seed по корзинам (count элементов).
+ * @param slots Массив индексов ключей по слотам (count элементов).
+ * @return 0 при успехе, -1 если построить функцию не удалось.
+ */
+static int build(const KeySet *set, uint16_t *seeds, uint16_t *slots) {
+    uint32_t n = (uint32_t)set->count;
+    uint64_t *hashes = malloc(n * sizeof(uint64_t));
+    uint32_t *bucket_of = malloc(n * sizeof(uint32_t));
+    BucketOrder *order = calloc(n, sizeof(BucketOrder));
+    bool *taken = calloc(n, sizeof(bool));
+    uint32_t *candidate = malloc(n * sizeof(uint32_t));
+    int result = -1;
+
+    if (!hashes || !bucket_of || !order || !taken || !candidate) {
+        fprintf(stderr, "perfect_hash_gen: недостаточно памяти\n");
+        goto done;
+    }
+
+    for (uint32_t i = 0; i < n; i++) {
+        for (uint32_t j = 0; j < i; j++) {
+            if (strcmp(set->keys[i], set->keys[j]) == 0) {
+                fprintf(stderr, "perfect_hash_gen: повторяющийся ключ %s в таблице %s\n", set->keys[i], set->name);
+                goto done;
+            }
+        }
+        hashes[i] = perfect_hash_key(set->keys[i]);
+        bucket_of[i] = perfect_hash_bucket(hashes[i], n);
+    }
+
+    for (uint32_t b = 0; b < n; b++) {
+        order[b].bucket = b;
+        seeds[b] = 0;
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        order[bucket_of[i]].size++;
+    }
+    qsort(order, n, sizeof(BucketOrder), compare_buckets);
+
+    // Сначала размещаются самые большие корзины, пока свободных слотов много
+    for (uint32_t k = 0; k < n && order[k].size > 0; k++) {
+        uint32_t bucket = order[k].bucket;
+        bool placed = false;
+
+        for (uint32_t seed = 0; seed <= MAX_SEED && !placed; seed++) {
+            uint32_t used = 0;
+            placed = true;
+            for (uint32_t i = 0; i < n && placed; i++) {
+                if (bucket_of[i] != bucket) {
+                    continue;
+                }
+                uint32_t slot = perfect_hash_slot(hashes[i], seed, n);
+                if (taken[slot]) {
+                    placed = false;
+                }
+                for (uint32_t j = 0; j < used && placed; j++) {
+                    if (slots[candidate[j]] == slot) {
+                        placed = false;
+                    }
+                }
+                if (placed) {
+                    slots[i] = (uint16_t)slot; // Временно: слот ключа i
+                    candidate[used++] = i;
+                }
+            }
+
+            if (placed) {
+                seeds[bucket] = (uint16_t)seed;
+                for (uint32_t j = 0; j < used; j++) {
+                    taken[slots[candidate[j]]] = true;
+                }
+            }
+        }
+
+        if (!placed) {
+            fprintf(stderr, "perfect_hash_gen: не удалось подобрать seed для таблицы %s\n", set->name);
+            goto done;
+        }
+    }
+
+    // Переход от «слот ключа» к «ключ слота»
+    for (uint32_t i = 0; i < n; i++) {
+        candidate[i] = slots[i];
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        slots[candidate[i]] = (uint16_t)i;
+    }
+    result = 0;
+
+done:
+    free(hashes);
+    free(bucket_of);
+    free(order);
+    free(taken);
+    free(candidate);
+    return result;
+}
+
+static void write_array(FILE *out, const char *type, const char *name, const uint16_t *values, size_t count) {
+    fprintf(out, "static const %s %s[%zu] = {", type, name, count);
+    for (size_t i = 0; i < count; i++) {
+        fprintf(out, "%s%u%s", i % 16 == 0 ? "\n        " : " ", values[i], i + 1 < count ? "," : "");
+    }
+    fprintf(out, "\n};\n\n");
+}
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        fprintf(stderr, "Использование: %s <таблица> <выходной файл>\n", argv[0]);
+        return 1;
+    }
+
+    const KeySet *set = NULL;
+    for (size_t i = 0; i < sizeof(key_sets) / sizeof(key_sets[0]); i++) {
+        if (strcmp(argv[1], key_sets[i].name) == 0) {
+            set = &key_sets[i];
+        }
+    }
+    if (!set) {
+        fprintf(stderr, "perfect_hash_gen: неизвестная таблица %s\n", argv[1]);
+        return 1;
+    }
+    if (set->count == 0 || set->count > MAX_SEED) {
+        fprintf(stderr, "perfect_hash_gen: неподдерживаемый размер таблицы %s\n", set->name);
+        return 1;
+    }
+
+    uint16_t *seeds = malloc(set->count * sizeof(uint16_t));
+    uint16_t *slots = malloc(set->count * sizeof(uint16_t));
+    if (!seeds || !slots || build(set, seeds, slots) != 0) {
+        free(seeds);
+        free(slots);
+        return 1;
+    }
+
+    FILE *out = fopen(argv[2], "w");
+    if (!out) {
+        fprintf(stderr, "perfect_hash_gen: не удалось открыть %s\n", argv[2]);
+        free(seeds);
+        free(slots);
+        return 1;
+    }
+
+    char name[128];
+    fprintf(out, "// Сгенерировано perfect_hash_gen из %s.def. Не редактировать.\n", set->name);
+    fprintf(out, "#ifndef MACHO_ANALYZER_%s_HASH_H\n#define MACHO_ANALYZER_%s_HASH_H\n\n", set->macro, set->macro);
+    fprintf(out, "#include <stdint.h>\n\n");
+    fprintf(out, "#define %s_HASH_SIZE %zuu\n\n", set->macro, set->count);
+    snprintf(name, sizeof(name), "%s_hash_seeds", set->name);
+    write_array(out, "uint16_t", name, seeds, set->count);
+    snprintf(name, sizeof(name), "%s_hash_slots", set->name);
+    write_array(out, "uint16_t", name, slots, set->count);
+    fprintf(out, "#endif // MACHO_ANALYZER_%s_HASH_H\n", set->macro);
+
+    int failed = ferror(out) != 0;
+    failed |= fclose(out) != 0;
+    free(seeds);
+    free(slots);
+    if (failed) {
+        fprintf(stderr, "perfect_hash_gen: ошибка записи %s\n", argv[2]);
+        return 1;
+    }
+    return 0;
+}
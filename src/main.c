@@ -1,140 +1,471 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <stdbool.h>
 #include <stdint.h>
-#include <mach-o/fat.h>
-#include <libkern/OSByteOrder.h>
 
 #include "../macho-analyzer/include/macho_printer.h"
 #include "../macho-analyzer/include/language_detector.h"
+#include "../macho-analyzer/include/batch_scanner.h"
+#include "../macho-analyzer/include/macho_json.h"
+#include "../macho-analyzer/include/macho_types.h"
+#include "../macho-analyzer/include/macho_endian.h"
 
-#define MAX_ARCHS 8
-#define MAX_FILE_SIZE (1L << 30) // 1 ГБ
 
-int main(int argc, char *argv[]) {
-    if (argc < 2) {
-        fprintf(stderr, "Использование: %s <файл Mach-O>\n", argv[0]);
+static void print_usage(const char *program) {
+    fprintf(stderr, "Использование: %s <файл Mach-O>\n", program);
+    fprintf(stderr, "       %s --json <файл Mach-O>\n", program);
+    fprintf(stderr, "       %s --batch [-j <потоков>] [--cache <каталог>] [--manifest <файл>] "
+            "[--json | --output <файл результатов>] <файл или каталог>...\n", program);
+    fprintf(stderr, "       %s --results <файл результатов>\n", program);
+}
+
+/**
+ * Выводит запись пакетного анализа одной строкой с полями через табуляцию.
+ * В повторном проходе с манифестом первое поле записи файла — вид изменения.
+ */
+static void print_batch_record(const BatchRecord *record, void *context) {
+    (void)context;
+    if (record->kind == BATCH_RECORD_FILE) {
+        const char *change = batch_change_name(record->change);
+        printf("%s\t%s\t%s\t%u\t%llu\t%s\n", change ? change : "file", record->path,
+               record->is_fat ? "fat" : "thin", record->arch_count, (unsigned long long)record->file_size,
+               record->status == 0 ? "ok" : record->error);
+    } else {
+        printf("arch\t%s\t%u\t%s\t%u\t%u\t%s\t%s\t%s\n", record->path, record->arch_index,
+               record->arch_name, record->file_type, record->load_command_count,
+               record->language.language[0] ? record->language.language : "Неизвестно",
+               record->language.compiler[0] ? record->language.compiler : "Неизвестно",
+               record->status == 0 ? "ok" : record->error);
+    }
+}
+
+/**
+ * Выводит запись пакетного анализа строкой NDJSON.
+ */
+static void write_batch_record(const BatchRecord *record, void *context) {
+    JsonWriter *writer = context;
+    write_batch_record_json(writer, record);
+    json_end_record(writer);
+}
+
+/**
+ * Дописывает записи архитектур в двоичный файл результатов.
+ */
+static void store_batch_record(const BatchRecord *record, void *context) {
+    ResultWriter *writer = context;
+    if (record->kind != BATCH_RECORD_ARCH) {
+        return;
+    }
+    if (record->cache_reader) {
+        result_writer_add_view(writer, record->cache_reader, &record->cached, record->path, record->arch_index,
+                               &record->arch);
+        return;
+    }
+    if (!record->mach_o_file) {
+        return;
+    }
+    ResultArchInput input = {record->path, record->arch_index, &record->arch, record->mach_o_file,
+                             &record->security, &record->language, &record->findings};
+    result_writer_add(writer, &input);
+}
+
+/**
+ * Пакетный анализ с манифестом: загружает манифест прошлого прохода (если он
+ * есть), сообщает только изменения и сохраняет манифест текущего прохода.
+ *
+ * @param manifest Путь к файлу манифеста или NULL (обычный проход).
+ * @return Результат batch_scan или -1, если манифест не удалось прочитать или сохранить.
+ */
+static int scan_incremental(const char *const *paths, size_t count, BatchOptions *options,
+                            BatchRecordCallback callback, void *context, BatchStats *stats, const char *manifest) {
+    if (!manifest) {
+        return batch_scan(paths, count, options, callback, context, stats);
+    }
+    ScanManifest previous;
+    ScanManifest next;
+    if (scan_manifest_load(&previous, manifest) != 0) {
+        return -1;
+    }
+    if (scan_manifest_init(&next) != 0) {
+        scan_manifest_free(&previous);
+        return -1;
+    }
+    options->previous = &previous;
+    options->next = &next;
+    int rc = batch_scan(paths, count, options, callback, context, stats);
+    if (scan_manifest_save(&next, manifest) != 0) {
+        rc = -1;
+    }
+    options->previous = NULL;
+    options->next = NULL;
+    scan_manifest_free(&previous);
+    scan_manifest_free(&next);
+    return rc;
+}
+
+/**
+ * Пакетный режим: рекурсивный анализ файлов и каталогов на пуле потоков.
+ */
+static int run_batch(int argc, char *argv[]) {
+    BatchOptions options = batch_default_options();
+    bool json = false;
+    const char *output = NULL;
+    const char *cache_directory = NULL;
+    const char *manifest = NULL;
+    int first = 2;
+    while (first < argc && argv[first][0] == '-') {
+        if (strcmp(argv[first], "--json") == 0) {
+            json = true;
+            first++;
+        } else if (strcmp(argv[first], "--cache") == 0 && first + 1 < argc) {
+            cache_directory = argv[first + 1];
+            first += 2;
+        } else if (strcmp(argv[first], "--manifest") == 0 && first + 1 < argc) {
+            manifest = argv[first + 1];
+            first += 2;
+        } else if (strcmp(argv[first], "--output") == 0 && first + 1 < argc) {
+            output = argv[first + 1];
+            first += 2;
+        } else if (strcmp(argv[first], "-j") == 0 && first + 1 < argc) {
+            char *end = NULL;
+            unsigned long threads = strtoul(argv[first + 1], &end, 10);
+            if (!end || *end != '\0' || threads == 0) {
+                fprintf(stderr, "Ошибка: Неверное число потоков: %s\n", argv[first + 1]);
+                return 1;
+            }
+            options.threads = threads;
+            first += 2;
+        } else {
+            break;
+        }
+    }
+    if (first >= argc || (json && output)) {
+        print_usage(argv[0]);
         return 1;
     }
 
-    const char *filename = argv[1];
-    FILE *file = fopen(filename, "rb");
-    if (!file) {
-        fprintf(stderr, "Ошибка: Не удалось открыть файл %s\n", filename);
+    BatchRecordCallback callback = print_batch_record;
+    void *context = NULL;
+    JsonWriter writer;
+    ResultWriter results;
+    FILE *results_file = NULL;
+    if (json) {
+        if (json_writer_init(&writer, stdout, 0) != 0) {
+            return 1;
+        }
+        callback = write_batch_record;
+        context = &writer;
+    } else if (output) {
+        results_file = fopen(output, "wb");
+        if (!results_file) {
+            fprintf(stderr, "Ошибка: Не удалось создать файл %s\n", output);
+            return 1;
+        }
+        if (result_writer_open(&results, results_file) != 0) {
+            fclose(results_file);
+            return 1;
+        }
+        options.collect_findings = true;
+        callback = store_batch_record;
+        context = &results;
+    }
+    if (json || output) {
+        options.check_security = true;
+        options.keep_details = true;
+    }
+
+    BatchStats stats = {0};
+    ResultCache cache;
+    int rc = -1;
+    if (!cache_directory || result_cache_open(&cache, cache_directory) == 0) {
+        options.cache = cache_directory ? &cache : NULL;
+        rc = scan_incremental((const char *const *)&argv[first], (size_t)(argc - first), &options,
+                              callback, context, &stats, manifest);
+        if (cache_directory) {
+            result_cache_close(&cache);
+        }
+    }
+    if (json && json_writer_close(&writer) != 0) {
+        fprintf(stderr, "Ошибка: Не удалось записать JSON\n");
+        rc = -1;
+    }
+    if (results_file) {
+        if (result_writer_close(&results) != 0) {
+            rc = -1;
+        }
+        if (fclose(results_file) != 0) {
+            fprintf(stderr, "Ошибка: Не удалось записать файл %s\n", output);
+            rc = -1;
+        }
+    }
+    fprintf(stderr, "Просмотрено файлов: %llu, Mach-O: %llu, архитектур: %llu, ошибок: %llu\n",
+            (unsigned long long)stats.files_seen, (unsigned long long)stats.macho_files,
+            (unsigned long long)stats.arch_records, (unsigned long long)stats.errors);
+    if (cache_directory) {
+        fprintf(stderr, "Из кеша: %llu\n", (unsigned long long)stats.cache_hits);
+    }
+    if (manifest) {
+        fprintf(stderr, "Без изменений: %llu\n", (unsigned long long)stats.unchanged);
+    }
+    return rc == 0 ? 0 : 1;
+}
+
+/**
+ * Перечисляет все архитектуры образа в массив нужного размера.
+ * Количество архитектур ограничено только размером файла: таблица fat_arch
+ * должна целиком помещаться в образ.
+ *
+ * @param image Образ файла.
+ * @param count Сюда записывается количество архитектур.
+ * @return Массив архитектур (освобождается через free) или NULL в случае ошибки.
+ */
+static MachOArchitecture *list_architectures(const MachOImage *image, uint32_t *count) {
+    int64_t arch_count = macho_list_architectures(image, NULL, 0, NULL);
+    if (arch_count <= 0) {
+        fprintf(stderr, "Ошибка: Не удалось прочитать заголовок Mach-O или FAT\n");
+        return NULL;
+    }
+    MachOArchitecture *archs = calloc((size_t)arch_count, sizeof(MachOArchitecture));
+    if (!archs) {
+        fprintf(stderr, "Ошибка: Не удалось выделить память для архитектур\n");
+        return NULL;
+    }
+    macho_list_architectures(image, archs, (uint32_t)arch_count, NULL);
+    *count = (uint32_t)arch_count;
+    return archs;
+}
+
+/**
+ * Режим JSON для одного файла: по строке NDJSON на каждую архитектуру.
+ */
+static int run_json(const char *filename) {
+    MachOImage image;
+    if (macho_image_open(filename, &image) != 0) {
         return 1;
     }
 
-    fseek(file, 0, SEEK_END);
-    long file_size = ftell(file);
-    if (file_size < sizeof(uint32_t)) {
-        fprintf(stderr, "Ошибка: Файл слишком мал для Mach-O\n");
-        fclose(file);
+    uint32_t arch_count = 0;
+    MachOArchitecture *archs = list_architectures(&image, &arch_count);
+    if (!archs) {
+        macho_image_close(&image);
         return 1;
     }
-    if (file_size > MAX_FILE_SIZE) {
-        fprintf(stderr, "Ошибка: Файл слишком велик (%ld байт, максимум %ld)\n", file_size, MAX_FILE_SIZE);
-        fclose(file);
+
+    JsonWriter writer;
+    if (json_writer_init(&writer, stdout, 0) != 0) {
+        free(archs);
+        macho_image_close(&image);
         return 1;
     }
-    rewind(file);
 
-    uint32_t magic = 0;
-    if (fread(&magic, sizeof(uint32_t), 1, file) != 1) {
-        fprintf(stderr, "Ошибка: Не удалось прочитать magic number\n");
-        fclose(file);
+    int rc = 0;
+    for (uint32_t i = 0; i < arch_count; i++) {
+        MachOFile mf = {0};
+        if (analyze_mach_o_image(&image, archs[i].offset, archs[i].size, &mf) != 0) {
+            fprintf(stderr, "Ошибка: Не удалось проанализировать архитектуру %u\n", i + 1);
+            free_mach_o_file(&mf);
+            rc = 1;
+            continue;
+        }
+
+        SecurityFeatures security;
+        LanguageInfo language = {0};
+        MachOJsonRecord record = {filename, i, &archs[i], &mf, NULL, NULL};
+        if (check_security_features(&mf, &security) == 0) {
+            record.security = &security;
+        }
+        if (detect_language_and_compiler(&mf, &language) == 0) {
+            record.language = &language;
+        }
+        write_mach_o_json(&writer, &record);
+        json_end_record(&writer);
+        free_mach_o_file(&mf);
+    }
+
+    if (json_writer_close(&writer) != 0) {
+        fprintf(stderr, "Ошибка: Не удалось записать JSON\n");
+        rc = 1;
+    }
+    free(archs);
+    macho_image_close(&image);
+    return rc;
+}
+
+/**
+ * Выводит содержимое двоичного файла результатов как NDJSON без повторного разбора бинарников.
+ */
+static int run_results(const char *filename) {
+    ResultReader reader;
+    if (result_reader_open(filename, &reader) != 0) {
         return 1;
     }
-    rewind(file);
+    JsonWriter writer;
+    if (json_writer_init(&writer, stdout, 0) != 0) {
+        result_reader_close(&reader);
+        return 1;
+    }
+
+    ResultArchView view;
+    while (result_reader_next(&reader, &view)) {
+        write_result_arch_json(&writer, &reader, &view);
+        json_end_record(&writer);
+    }
+
+    int rc = 0;
+    if (json_writer_close(&writer) != 0) {
+        fprintf(stderr, "Ошибка: Не удалось записать JSON\n");
+        rc = 1;
+    }
+    result_reader_close(&reader);
+    return rc;
+}
+
+/**
+ * Результаты анализа архитектур FAT-файла, заполняемые рабочими потоками.
+ */
+typedef struct {
+    MachOReportOptions options;
+    MachOReport *reports;
+} ArchitectureReports;
 
-    MachOFile first_arch = {0};
-    bool first_arch_initialized = false;
+/**
+ * Анализирует разобранную архитектуру в рабочем потоке analyze_mach_o_architectures.
+ * Каждый поток пишет только в свой элемент reports, вывод остаётся главному потоку.
+ */
+static void analyze_architecture_report(const MachOFile *mach_o_file, uint32_t index, void *context) {
+    ArchitectureReports *reports = context;
+    macho_report_analyze(mach_o_file, &reports->options, &reports->reports[index]);
+}
 
-    if (magic == FAT_MAGIC || magic == FAT_CIGAM) {
-        struct fat_header fh;
-        if (fread(&fh, sizeof(struct fat_header), 1, file) != 1) {
-            fprintf(stderr, "Ошибка: Не удалось прочитать заголовок FAT\n");
-            fclose(file);
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (strcmp(argv[1], "--batch") == 0) {
+        return run_batch(argc, argv);
+    }
+    if (strcmp(argv[1], "--json") == 0) {
+        if (argc != 3) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        return run_json(argv[2]);
+    }
+    if (strcmp(argv[1], "--results") == 0) {
+        if (argc != 3) {
+            print_usage(argv[0]);
             return 1;
         }
+        return run_results(argv[2]);
+    }
 
-        uint32_t narch = OSSwapBigToHostInt32(fh.nfat_arch);
-        printf("FAT бинарник с %u архитектурами:\n\n", narch);
+    const char *filename = argv[1];
+    MachOImage image;
+    if (macho_image_open(filename, &image) != 0) {
+        return 1;
+    }
+
+    if (image.size < sizeof(uint32_t)) {
+        fprintf(stderr, "Ошибка: Файл слишком мал для Mach-O\n");
+        macho_image_close(&image);
+        return 1;
+    }
+
+    uint32_t magic = *(const uint32_t *)image.base;
 
-        if (narch > MAX_ARCHS) {
-            fprintf(stderr, "Ошибка: Слишком много архитектур: %u (максимум %d)\n", narch, MAX_ARCHS);
-            fclose(file);
+    // Язык определяется по первой разобранной архитектуре
+    LanguageInfo language = {0};
+    int language_status = -1;
+    bool language_checked = false;
+
+    if (magic == FAT_MAGIC || magic == FAT_CIGAM || magic == FAT_MAGIC_64 || magic == FAT_CIGAM_64) {
+        uint32_t narch = 0;
+        MachOArchitecture *archs = list_architectures(&image, &narch);
+        if (!archs) {
+            macho_image_close(&image);
             return 1;
         }
 
-        struct fat_arch archs[MAX_ARCHS];
-        if (fread(archs, sizeof(struct fat_arch), narch, file) != narch) {
-            fprintf(stderr, "Ошибка: Не удалось прочитать архитектуры FAT\n");
-            fclose(file);
+        printf("FAT бинарник с %u архитектурами:\n\n", narch);
+
+        // Архитектуры разбираются и анализируются параллельно, а выводятся по порядку
+        MachOFile *files = calloc(narch, sizeof(MachOFile));
+        int *statuses = calloc(narch, sizeof(int));
+        MachOReport *reports = calloc(narch, sizeof(MachOReport));
+        if (!files || !statuses || !reports) {
+            fprintf(stderr, "Ошибка: Не удалось выделить память для архитектур\n");
+            free(files);
+            free(statuses);
+            free(reports);
+            free(archs);
+            macho_image_close(&image);
             return 1;
         }
+        ArchitectureReports context = {macho_report_default_options(), reports};
+        // Потоки уже заняты архитектурами, поэтому страницы подписи каждой хешируются последовательно
+        context.options.threads = narch > 1 ? 1 : 0;
+        context.options.detect_language = true;
+        analyze_mach_o_architectures(&image, archs, narch, 0, files, statuses, analyze_architecture_report, &context);
 
         for (uint32_t i = 0; i < narch; i++) {
-            uint32_t offset = OSSwapBigToHostInt32(archs[i].offset);
-            if (fseek(file, offset, SEEK_SET) != 0) {
-                fprintf(stderr, "Ошибка: Не удалось переместиться к смещению %u для архитектуры %u\n", offset, i + 1);
-                continue;
-            }
-
-            MachOFile mf = {0};
-            printf("---- Архитектура %u (смещение: %u) ----\n", i + 1, offset);
+            MachOFile *mf = &files[i];
+            printf("---- Архитектура %u (смещение: %llu) ----\n", i + 1, (unsigned long long)archs[i].offset);
 
-            if (analyze_mach_o(file, &mf) == 0) {
+            if (statuses[i] == 0) {
                 printf("После analyze_mach_o: magic=0x%x, cputype=0x%x, ncmds=%u\n",
-                       mf.magic, mf.cpu_type, mf.load_command_count);
+                       mf->magic, mf->cpu_type, mf->load_command_count);
 
-                print_mach_o_info(&mf, file);
+                print_mach_o_report(mf, &reports[i]);
 
-                if (!first_arch_initialized) {
-                    first_arch = mf;
-                    mf.commands = NULL;
-                    mf.segments = NULL;
-                    mf.dylibs = NULL;
-                    first_arch_initialized = true;
+                if (!language_checked) {
+                    language = reports[i].language;
+                    language_status = reports[i].language_status;
+                    language_checked = true;
                 }
+                macho_report_free(&reports[i]);
+                free_mach_o_file(mf);
             } else {
                 fprintf(stderr, "Ошибка: Не удалось проанализировать архитектуру %u\n", i + 1);
             }
-
-            if (!first_arch_initialized || &mf != &first_arch) {
-                free_mach_o_file(&mf);
-            }
-
             printf("\n");
         }
+        free(files);
+        free(statuses);
+        free(reports);
+        free(archs);
     } else {
         MachOFile mf = {0};
-        if (analyze_mach_o(file, &mf) == 0) {
+        if (analyze_mach_o_image(&image, 0, 0, &mf) == 0) {
             printf("После analyze_mach_o: magic=0x%x, cputype=0x%x, ncmds=%u\n",
                    mf.magic, mf.cpu_type, mf.load_command_count);
 
-            print_mach_o_info(&mf, file);
+            MachOReportOptions options = macho_report_default_options();
+            options.detect_language = true;
+            MachOReport report;
+            macho_report_analyze(&mf, &options, &report);
+            print_mach_o_report(&mf, &report);
 
-            first_arch = mf;
-            mf.commands = NULL;
-            mf.segments = NULL;
-            mf.dylibs = NULL;
-            first_arch_initialized = true;
+            language = report.language;
+            language_status = report.language_status;
+            language_checked = true;
+            macho_report_free(&report);
         } else {
             fprintf(stderr, "Ошибка: Не удалось проанализировать файл Mach-O\n");
-            free_mach_o_file(&mf);
         }
+        free_mach_o_file(&mf);
     }
 
-    if (first_arch_initialized) {
-        LanguageInfo info = {0};
-        if (detect_language_and_compiler(&first_arch, file, &info) == 0) {
-            printf("Язык программирования: %s\n", info.language && info.language[0] ? info.language : "Неизвестно");
-            printf("Компилятор: %s\n", info.compiler && info.compiler[0] ? info.compiler : "Неизвестно");
+    if (language_checked) {
+        if (language_status == 0) {
+            printf("Язык программирования: %s\n", language.language[0] ? language.language : "Неизвестно");
+            printf("Компилятор: %s\n", language.compiler[0] ? language.compiler : "Неизвестно");
         } else {
             printf("Не удалось определить язык или компилятор.\n");
         }
-        free_mach_o_file(&first_arch);
     }
 
-    fclose(file);
+    macho_image_close(&image);
     return 0;
 }
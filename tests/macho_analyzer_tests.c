@@ -1,35 +1,69 @@
 #include "macho_printer.h"
+#include "macho_report.h"
 #include "macho_analyzer.h"
+#include "symbol_classifier.h"
+#include "language_detector.h"
+#include "signature_scanner.h"
+#include "lc_commands.h"
+#include "security_analyzer.h"
+#include "thread_pool.h"
+#include "batch_scanner.h"
+#include "macho_json.h"
+#include "result_store.h"
+#include "result_cache.h"
+#include "content_hash.h"
+#include "sha_digest.h"
+#include "symbol_index.h"
+#include "command_visitor.h"
+#include "import_table.h"
+#include "function_starts.h"
+#include "export_trie.h"
+#include "leb128.h"
+#include "macho_types.h"
+#include "macho_endian.h"
 #include <stdio.h>
 #include <assert.h>
 #include <string.h>
 #include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
-void test_print_header_info() {
-    MachOFile mock_file;
-    mock_file.is_64_bit = 1;
-    mock_file.header.header64.magic = 0xFEEDFACF;
-    mock_file.header.header64.cputype = 16777223;
-
-    FILE *output = freopen("output.txt", "w", stdout);
-    if (!output) {
-        perror("freopen failed");
-        return;
-    }
+/**
+ * Перенаправляет stdout в файл output.txt на время вызова print_fn и читает
+ * вывод обратно в buffer (с завершающим нулём).
+ */
+static void capture_stdout(void (*print_fn)(const MachOFile *), const MachOFile *mach_o_file,
+                           char *buffer, size_t size) {
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    assert(saved >= 0);
+    FILE *redirected = freopen("output.txt", "w", stdout);
+    assert(redirected != NULL);
 
-    print_header_info(&mock_file);
+    print_fn(mach_o_file);
     fflush(stdout);
+    int rc = dup2(saved, STDOUT_FILENO);
+    assert(rc >= 0);
+    close(saved);
+
+    FILE *output = fopen("output.txt", "r");
+    assert(output != NULL);
+    size_t length = fread(buffer, 1, size - 1, output);
+    buffer[length] = '\0';
     fclose(output);
-    output = fopen("output.txt", "r");
-    if (!output) {
-        perror("fopen failed");
-        return;
-    }
+    remove("output.txt");
+}
+
+void test_print_header_info() {
+    MachOFile mock_file;
+    memset(&mock_file, 0, sizeof(mock_file));
+    mock_file.is_64_bit = 1;
+    mock_file.magic = MH_MAGIC_64;
+    mock_file.cpu_type = CPU_TYPE_X86_64;
 
     char buffer[1024];
-    fread(buffer, sizeof(char), sizeof(buffer), output);
-    assert(strstr(buffer, "64-bit Mach-O File") != NULL);
-    fclose(output);
+    capture_stdout(print_header_info, &mock_file, buffer, sizeof(buffer));
+    assert(strstr(buffer, "64-битный Mach-O файл") != NULL);
 }
 
 /**
@@ -37,30 +71,16 @@ void test_print_header_info() {
  */
 void test_print_header_info_64_bit() {
     MachOFile mock_file;
+    memset(&mock_file, 0, sizeof(mock_file));
     mock_file.is_64_bit = 1;
-    mock_file.header.header64.magic = 0xFEEDFACF;
-    mock_file.header.header64.cputype = 16777223;
-
-    FILE *output = freopen("output.txt", "w", stdout);
-    if (!output) {
-        perror("freopen failed");
-        return;
-    }
-
-    print_header_info(&mock_file);
-    fflush(stdout);
-    fclose(output);
-    output = fopen("output.txt", "r");
-    if (!output) {
-        perror("fopen failed");
-        return;
-    }
+    mock_file.magic = MH_MAGIC_64;
+    mock_file.cpu_type = CPU_TYPE_X86_64;
 
     char buffer[1024];
-    fread(buffer, sizeof(char), sizeof(buffer), output);
-    assert(strstr(buffer, "64-bit Mach-O File") != NULL);
-    assert(strstr(buffer, "CPU Type: 16777223") != NULL);
-    fclose(output);
+    capture_stdout(print_header_info, &mock_file, buffer, sizeof(buffer));
+    assert(strstr(buffer, "64-битный Mach-O файл") != NULL);
+    assert(strstr(buffer, "Magic: 0xfeedfacf") != NULL);
+    assert(strstr(buffer, "Тип процессора: 0x1000007 (x86_64)") != NULL);
 }
 
 /**
@@ -68,74 +88,56 @@ void test_print_header_info_64_bit() {
  */
 void test_print_header_info_32_bit() {
     MachOFile mock_file;
+    memset(&mock_file, 0, sizeof(mock_file));
     mock_file.is_64_bit = 0;
-    mock_file.header.header32.magic = 0xFEEDFACE;
-    mock_file.header.header32.cputype = 7;  // CPU_TYPE_X86
-
-    FILE *output = freopen("output.txt", "w", stdout);
-    if (!output) {
-        perror("freopen failed");
-        return;
-    }
-
-    print_header_info(&mock_file);
-    fflush(stdout);
-    fclose(output);
-    output = fopen("output.txt", "r");
-    if (!output) {
-        perror("fopen failed");
-        return;
-    }
+    mock_file.magic = MH_MAGIC;
+    mock_file.cpu_type = CPU_TYPE_X86;
 
     char buffer[1024];
-    fread(buffer, sizeof(char), sizeof(buffer), output);
-    assert(strstr(buffer, "32-bit Mach-O File") != NULL);
-    assert(strstr(buffer, "CPU Type: 7") != NULL);
-    fclose(output);
+    capture_stdout(print_header_info, &mock_file, buffer, sizeof(buffer));
+    assert(strstr(buffer, "32-битный Mach-O файл") != NULL);
+    assert(strstr(buffer, "Тип процессора: 0x7 (i386)") != NULL);
 }
 
 /**
- * Тест на анализ команд загрузки (заглушка с тестовыми данными)
+ * Тест на разбор и вывод команд загрузки минимального 64-битного Mach-O
  */
 void test_analyze_load_commands() {
-    MachOFile mock_file;
-    mock_file.is_64_bit = 1;
-    mock_file.header.header64.ncmds = 2;
-    mock_file.header.header64.sizeofcmds = sizeof(struct load_command) * 2;
+    struct {
+        struct mach_header_64 header;
+        struct segment_command_64 segment;
+        struct symtab_command symtab;
+    } image_data;
+    memset(&image_data, 0, sizeof(image_data));
+    image_data.header.magic = MH_MAGIC_64;
+    image_data.header.cputype = CPU_TYPE_X86_64;
+    image_data.header.filetype = MH_EXECUTE;
+    image_data.header.ncmds = 2;
+    image_data.header.sizeofcmds = sizeof(image_data.segment) + sizeof(image_data.symtab);
+    image_data.segment.cmd = LC_SEGMENT_64;
+    image_data.segment.cmdsize = sizeof(image_data.segment);
+    strcpy(image_data.segment.segname, "__TEXT");
+    image_data.symtab.cmd = LC_SYMTAB;
+    image_data.symtab.cmdsize = sizeof(image_data.symtab);
 
-    struct load_command *commands = malloc(sizeof(struct load_command) * 2);
-    commands[0].cmd = LC_SEGMENT_64;
-    commands[0].cmdsize = sizeof(struct load_command);
-    commands[1].cmd = LC_SYMTAB;
-    commands[1].cmdsize = sizeof(struct load_command);
+    MachOImage image;
+    int rc = macho_image_from_memory(&image_data, sizeof(image_data), &image);
+    assert(rc == 0);
+    MachOFile mach_o_file;
+    rc = analyze_mach_o_image(&image, 0, 0, &mach_o_file);
+    assert(rc == 0);
+    assert(mach_o_file.load_command_count == 2);
+    assert(mach_o_file.segment_count == 1);
 
-    mock_file.commands = commands;
-    mock_file.load_command_count = 2;
-
-    FILE *output = freopen("output.txt", "w", stdout);
-    if (!output) {
-        perror("freopen failed");
-        return;
-    }
-
-    print_mach_o_info(&mock_file, stdout);
-    fflush(stdout);
-    fclose(output);
-    output = fopen("output.txt", "r");
-    if (!output) {
-        perror("fopen failed");
-        return;
-    }
-
-    char buffer[1024];
-    fread(buffer, sizeof(char), sizeof(buffer), output);
-    assert(strstr(buffer, "Load Command 1:") != NULL);
-    assert(strstr(buffer, "Load Command 2:") != NULL);
+    char buffer[8192];
+    capture_stdout(print_mach_o_info, &mach_o_file, buffer, sizeof(buffer));
+    assert(strstr(buffer, "Команда загрузки 1:") != NULL);
+    assert(strstr(buffer, "Команда загрузки 2:") != NULL);
     assert(strstr(buffer, "LC_SEGMENT_64") != NULL);
     assert(strstr(buffer, "LC_SYMTAB") != NULL);
 
-    free(commands);
-    fclose(output);
+    free_mach_o_file(&mach_o_file);
+    macho_image_close(&image);
 }
 
 /**
@@ -143,11 +145,8 @@ void test_analyze_load_commands() {
  */
 void test_analyze_mach_o_invalid_data() {
     MachOFile mock_file;
-    FILE *fake_file = fopen("fake_file.bin", "w+");
-    if (!fake_file) {
-        perror("fopen failed");
-        return;
-    }
+    FILE *fake_file = tmpfile();
+    assert(fake_file != NULL);
 
     uint32_t bad_magic = 0xFFFFFFFF;
     fwrite(&bad_magic, sizeof(bad_magic), 1, fake_file);
@@ -159,12 +158,1717 @@ void test_analyze_mach_o_invalid_data() {
     fclose(fake_file);
 }
 
+/**
+ * Тест классификатора символов: все совпавшие префиксы и подсчёт языков
+ */
+void test_symbol_classifier() {
+    static const SymbolMapping mappings[] = {
+            {"_Z",   "C++",   "GCC or Clang"},
+            {"_ZN",  "C++",   "GCC or Clang"},
+            {"_$s",  "Swift", "Apple Swift Compiler"},
+            {"_R",   "Rust",  "rustc"},
+    };
+    SymbolClassifier *classifier = symbol_classifier_create(mappings, 4);
+    assert(classifier != NULL);
+    assert(symbol_classifier_language_count(classifier) == 3);
+
+    uint32_t ids[4];
+    size_t matched = symbol_classifier_match(classifier, "_ZN3foo3barEv", ids, 4);
+    assert(matched == 2);
+    assert(ids[0] == 0 && ids[1] == 1);
+    matched = symbol_classifier_match(classifier, "_main", ids, 4);
+    assert(matched == 0);
+    matched = symbol_classifier_match(classifier, "", ids, 4);
+    assert(matched == 0);
+
+    uint32_t counts[3] = {0};
+    symbol_classifier_tally(classifier, "_ZN3foo3barEv", counts);
+    symbol_classifier_tally(classifier, "_$s4main", counts);
+    symbol_classifier_tally(classifier, "_ZSt4cout", counts);
+    assert(counts[0] == 2 && counts[1] == 1 && counts[2] == 0);
+
+    SymbolMapping go = {"_runtime.", "Go", "gc (Go compiler)"};
+    int id = symbol_classifier_add(classifier, &go);
+    assert(id == 4);
+    matched = symbol_classifier_match(classifier, "_runtime.main", ids, 4);
+    assert(matched == 1 && ids[0] == 4);
+    matched = symbol_classifier_match(classifier, "_R123", ids, 4);
+    assert(matched == 1 && ids[0] == 3);
+
+    symbol_classifier_destroy(classifier);
+}
+
+/**
+ * Собирает в buffer минимальный 64-битный Mach-O с одной командой LC_SYMTAB
+ * и определёнными внешними символами names.
+ *
+ * @return Размер собранного файла.
+ */
+static uint32_t build_symbol_macho(uint8_t *buffer, const char **names, uint32_t nsyms) {
+    struct mach_header_64 *header = (struct mach_header_64 *)buffer;
+    header->magic = MH_MAGIC_64;
+    header->cputype = CPU_TYPE_X86_64;
+    header->filetype = MH_EXECUTE;
+    header->ncmds = 1;
+    header->sizeofcmds = sizeof(struct symtab_command);
+
+    struct symtab_command *symtab = (struct symtab_command *)(header + 1);
+    symtab->cmd = LC_SYMTAB;
+    symtab->cmdsize = sizeof(struct symtab_command);
+    symtab->symoff = sizeof(struct mach_header_64) + sizeof(struct symtab_command);
+    symtab->nsyms = nsyms;
+    symtab->stroff = symtab->symoff + nsyms * sizeof(struct nlist_64);
+
+    struct nlist_64 *symbols = (struct nlist_64 *)(buffer + symtab->symoff);
+    uint32_t strx = 1;
+    for (uint32_t i = 0; i < nsyms; i++) {
+        symbols[i].n_un.n_strx = strx;
+        symbols[i].n_type = N_SECT | N_EXT;
+        symbols[i].n_sect = 1;
+        memcpy(buffer + symtab->stroff + strx, names[i], strlen(names[i]) + 1);
+        strx += (uint32_t)strlen(names[i]) + 1;
+    }
+    symtab->strsize = strx;
+
+    return symtab->stroff + strx;
+}
+
+/**
+ * Тест голосования языков: один символ с префиксом Rust не перевешивает C
+ */
+void test_language_scores() {
+    static const char *names[] = {"_main", "_RSA_new", "_parse_args", "_print_usage", "_ZN3foo3barEv"};
+    const uint32_t nsyms = sizeof(names) / sizeof(names[0]);
+
+    uint8_t buffer[512] = {0};
+    uint32_t size = build_symbol_macho(buffer, names, nsyms);
+
+    MachOImage image;
+    int rc = macho_image_from_memory(buffer, size, &image);
+    assert(rc == 0);
+    MachOFile mach_o_file;
+    rc = analyze_mach_o_image(&image, 0, 0, &mach_o_file);
+    assert(rc == 0);
+
+    LanguageScores scores;
+    rc = detect_language_scores(&mach_o_file, NULL, &scores);
+    assert(rc == 0);
+    assert(scores.best >= 0);
+    assert(strcmp(scores.entries[scores.best].language, "C") == 0);
+    assert(!scores.early_stop);
+
+    int rust = -1;
+    for (size_t i = 0; i < scores.count; i++) {
+        if (strcmp(scores.entries[i].language, "Rust") == 0) {
+            rust = (int)i;
+        }
+    }
+    assert(rust >= 0);
+    assert(scores.entries[rust].symbol_hits == 1);
+    assert(scores.entries[scores.best].score > scores.entries[rust].score);
+
+    LanguageInfo info;
+    rc = detect_language_and_compiler(&mach_o_file, &info);
+    assert(rc == 0);
+    assert(strcmp(info.language, "C") == 0);
+
+    free_mach_o_file(&mach_o_file);
+}
+
+typedef struct {
+    uint32_t ids[64];
+    uint64_t offsets[64];
+    size_t count;
+} ScanHits;
+
+static int record_hit(uint32_t signature_id, uint64_t offset, void *context) {
+    ScanHits *hits = context;
+    if (hits->count < 64) {
+        hits->ids[hits->count] = signature_id;
+        hits->offsets[hits->count] = offset;
+    }
+    hits->count++;
+    return 0;
+}
+
+/**
+ * Тест сканера сигнатур: все вхождения после нулевых байтов, одинаковый результат во всех реализациях
+ */
+void test_signature_scanner() {
+    static const char *const needles[] = {"go.buildid", "Python", "Py_InitModule", "J"};
+    SignatureScanner *scanner = signature_scanner_create(needles, 4);
+    assert(scanner != NULL);
+
+    char data[200];
+    memset(data, 'x', sizeof(data));
+    memcpy(data + 3, "abc\0Python\0", 11);
+    memcpy(data + 40, "Py_InitModule", 13);
+    memcpy(data + 120, "go.buildid", 10);
+    data[190] = 'J';
+    memcpy(data + 194, "Python", 6); // Вплотную к концу данных
+
+    SignatureScanImpl impls[] = {SIGNATURE_SCAN_SCALAR, SIGNATURE_SCAN_SSE2, SIGNATURE_SCAN_AVX2};
+    for (size_t i = 0; i < sizeof(impls) / sizeof(impls[0]); i++) {
+        if (signature_scanner_set_impl(scanner, impls[i]) != 0) {
+            continue;
+        }
+        ScanHits hits = {0};
+        int64_t found = signature_scanner_scan(scanner, data, sizeof(data), record_hit, &hits);
+        assert(found == 5);
+        assert(hits.count == 5);
+        assert(hits.ids[0] == 1 && hits.offsets[0] == 7);
+        assert(hits.ids[1] == 2 && hits.offsets[1] == 40);
+        assert(hits.ids[2] == 0 && hits.offsets[2] == 120);
+        assert(hits.ids[3] == 3 && hits.offsets[3] == 190);
+        assert(hits.ids[4] == 1 && hits.offsets[4] == 194);
+
+        // Короткий хвост меньше одного вектора
+        hits.count = 0;
+        found = signature_scanner_scan(scanner, data + 190, 10, record_hit, &hits);
+        assert(found == 2);
+    }
+
+    signature_scanner_destroy(scanner);
+}
+
+/**
+ * Тест таблиц с совершенной хеш-функцией: находится каждый ключ и только он
+ */
+void test_perfect_hash_tables() {
+    const LCCommandInfo *info = get_lc_command_info("LC_SEGMENT_64");
+    assert(info != NULL && strcmp(info->name, "LC_SEGMENT_64") == 0);
+    assert(get_lc_command_info("LC_UNIXTHREAD") != NULL);
+    assert(get_lc_command_info("LC_SEGMENT_6") == NULL);
+    assert(get_lc_command_info("") == NULL);
+
+    size_t count = 0;
+    for (const UnsafeFunctionInfo *function = unsafe_functions; function->function_name; function++) {
+        assert(find_unsafe_function(function->function_name) == function);
+        count++;
+    }
+    assert(count > 0);
+    assert(find_unsafe_function("strlcpy") == NULL);
+    assert(find_unsafe_function("_strcpy") == NULL);
+}
+
+/**
+ * Тест прямой таблицы LC команд по числовому значению
+ */
+void test_lc_command_by_id() {
+    const LCCommandInfo *info = get_lc_command_info_by_id(LC_SEGMENT_64);
+    assert(info != NULL && info->cmd == LC_SEGMENT_64 && info->decode != NULL);
+    assert(info == get_lc_command_info("LC_SEGMENT_64"));
+
+    // Бит LC_REQ_DYLD различает команды с одинаковыми младшими битами
+    info = get_lc_command_info_by_id(LC_DYLD_INFO_ONLY);
+    assert(info != NULL && strcmp(info->name, "LC_DYLD_INFO_ONLY") == 0);
+    info = get_lc_command_info_by_id(LC_DYLD_INFO);
+    assert(info != NULL && strcmp(info->name, "LC_DYLD_INFO") == 0);
+    assert(get_lc_command_info_by_id(LC_MAIN & ~LC_REQ_DYLD) == NULL);
+
+    assert(get_lc_command_info_by_id(0) == NULL);
+    assert(get_lc_command_info_by_id(0x7fffffff) == NULL);
+    assert(get_lc_command_info_by_id(LC_REQ_DYLD | 0x3f) == NULL);
+}
+
+/**
+ * Тест передачи MachOFile: получатель забирает таблицы и кеши, источник обнуляется
+ */
+void test_macho_file_move() {
+    static const char *names[] = {"_main", "__stack_chk_fail"};
+    uint8_t buffer[512] = {0};
+    uint32_t size = build_symbol_macho(buffer, names, sizeof(names) / sizeof(names[0]));
+
+    MachOImage image;
+    int status = macho_image_from_memory(buffer, size, &image);
+    assert(status == 0);
+    MachOFile source;
+    status = analyze_mach_o_image(&image, 0, 0, &source);
+    assert(status == 0);
+    const MachOSymbolIndex *index = macho_get_symbol_index(&source);
+    assert(index != NULL);
+
+    MachOFile target;
+    macho_file_move(&target, &source);
+    assert(source.segments == NULL && source.sections == NULL && source.symbol_index == NULL);
+    const MachOSymbolIndex *moved = macho_get_symbol_index(&target);
+    assert(target.symbol_index == index && moved == index);
+
+    // Обнулённый источник можно освободить повторно без двойного освобождения
+    free_mach_o_file(&source);
+    free_mach_o_file(&target);
+}
+
+typedef struct {
+    const MachOFile *mach_o_file;
+    const MachOSymbolIndex *index;
+} CacheProbe;
+
+static void probe_symbol_index(void *arg, size_t worker) {
+    (void)worker;
+    CacheProbe *probe = arg;
+    probe->index = macho_get_symbol_index(probe->mach_o_file);
+}
+
+/**
+ * Тест ленивых кешей: потоки, обращающиеся к одному MachOFile, получают один
+ * и тот же индекс, а неудачное построение запоминается
+ */
+void test_lazy_cache_threads() {
+    static const char *names[] = {"_main", "_helper", "_strcpy"};
+    uint8_t buffer[512] = {0};
+    uint32_t size = build_symbol_macho(buffer, names, sizeof(names) / sizeof(names[0]));
+
+    MachOImage image;
+    int status = macho_image_from_memory(buffer, size, &image);
+    assert(status == 0);
+    MachOFile mach_o_file;
+    status = analyze_mach_o_image(&image, 0, 0, &mach_o_file);
+    assert(status == 0);
+
+    enum { PROBES = 32 };
+    CacheProbe probes[PROBES];
+    ThreadPool *pool = thread_pool_create(8, PROBES);
+    assert(pool != NULL);
+    for (size_t i = 0; i < PROBES; i++) {
+        probes[i].mach_o_file = &mach_o_file;
+        probes[i].index = NULL;
+        status = thread_pool_submit(pool, probe_symbol_index, &probes[i]);
+        assert(status == 0);
+    }
+    thread_pool_destroy(pool);
+    for (size_t i = 0; i < PROBES; i++) {
+        assert(probes[i].index != NULL && probes[i].index == mach_o_file.symbol_index);
+    }
+    assert(mach_o_file.symbol_index->count == 3);
+    free_mach_o_file(&mach_o_file);
+
+    // Таблица строк за концом файла: ошибка выводится один раз и больше не повторяется
+    struct symtab_command *symtab = (struct symtab_command *)(buffer + sizeof(struct mach_header_64));
+    symtab->stroff = size;
+    status = analyze_mach_o_image(&image, 0, 0, &mach_o_file);
+    assert(status == 0);
+    const MachOSymbolIndex *index = macho_get_symbol_index(&mach_o_file);
+    assert(index == NULL && (mach_o_file.cache_failed & MACHO_CACHE_SYMBOL_INDEX));
+    index = macho_get_symbol_index(&mach_o_file);
+    assert(index == NULL && mach_o_file.symbol_index == NULL);
+    free_mach_o_file(&mach_o_file);
+    assert(mach_o_file.cache_failed == 0);
+}
+
+/**
+ * Тест структур результатов: проверки заполняют структуры, вывод — отдельно
+ */
+void test_security_results() {
+    static const char *names[] = {"_strcpy", "_gets", "_main", "__stack_chk_fail", "__stack_chk_guard"};
+    uint8_t buffer[512] = {0};
+    uint32_t size = build_symbol_macho(buffer, names, sizeof(names) / sizeof(names[0]));
+
+    MachOImage image;
+    int rc = macho_image_from_memory(buffer, size, &image);
+    assert(rc == 0);
+    MachOFile mach_o_file;
+    rc = analyze_mach_o_image(&image, 0, 0, &mach_o_file);
+    assert(rc == 0);
+
+    SecurityFeatures features;
+    rc = check_security_features(&mach_o_file, &features);
+    assert(rc == 0);
+    assert(!features.aslr && features.stack_canaries && features.sandbox_dylib_count == 0 && !features.bitcode);
+
+    SecurityFindings findings = {0};
+    rc = analyze_unsafe_functions(&mach_o_file, &findings);
+    assert(rc == 0);
+    rc = analyze_section_permissions(&mach_o_file, &findings);
+    assert(rc == 0);
+    rc = analyze_debug_symbols(&mach_o_file, &findings);
+    assert(rc == 0);
+    assert(findings.count == 2);
+    assert(security_findings_count(&findings, SECURITY_FINDING_UNSAFE_FUNCTION) == 2);
+    assert(strcmp(findings.items[0].function->function_name, "strcpy") == 0);
+
+    CodeSignatureInfo signature;
+    rc = analyze_code_signature(&mach_o_file, 0, &signature);
+    assert(rc == 0);
+    assert(signature.status == CODE_SIGNATURE_ABSENT);
+
+    char output[1024] = {0};
+    FILE *out = fmemopen(output, sizeof(output) - 1, "w");
+    assert(out != NULL);
+    print_security_features(&features, out);
+    print_security_findings(&findings, out);
+    fclose(out);
+    assert(strstr(output, "Stack Canaries: Поддерживаются") != NULL);
+    assert(strstr(output, "Всего обнаружено небезопасных функций: 2") != NULL);
+
+    security_findings_free(&findings);
+    assert(findings.items == NULL && findings.count == 0);
+    free_mach_o_file(&mach_o_file);
+}
+
+static void put_be32(uint8_t *p, uint32_t value) {
+    value = macho_host_to_big32(value);
+    memcpy(p, &value, sizeof(value));
+}
+
+/**
+ * Собирает директорию кода версии 0x20100 без специальных слотов для первых code_limit байт.
+ */
+static uint32_t build_code_directory(uint8_t *cd, const uint8_t *code, uint32_t code_limit, uint8_t page_shift,
+                                     uint8_t hash_type) {
+    uint32_t hash_size = hash_type == CS_HASHTYPE_SHA1 ? SHA1_DIGEST_LENGTH : SHA256_DIGEST_LENGTH;
+    uint32_t page_size = 1u << page_shift;
+    uint32_t pages = (code_limit + page_size - 1) / page_size;
+    uint32_t hash_offset = 56;
+    uint32_t length = hash_offset + pages * hash_size;
+    memset(cd, 0, hash_offset);
+    put_be32(cd, CSMAGIC_CODEDIRECTORY);
+    put_be32(cd + 4, length);
+    put_be32(cd + 8, 0x20100);
+    put_be32(cd + 16, hash_offset);
+    put_be32(cd + 20, 48);
+    put_be32(cd + 28, pages);
+    put_be32(cd + 32, code_limit);
+    cd[36] = (uint8_t)hash_size;
+    cd[37] = hash_type;
+    cd[39] = page_shift;
+    memcpy(cd + 48, "test", 5);
+    for (uint32_t i = 0; i < pages; i++) {
+        uint32_t size = code_limit - i * page_size < page_size ? code_limit - i * page_size : page_size;
+        uint8_t digest[SHA256_DIGEST_LENGTH];
+        if (hash_type == CS_HASHTYPE_SHA1) {
+            sha1(code + i * page_size, size, digest);
+        } else {
+            sha256(code + i * page_size, size, digest);
+        }
+        memcpy(cd + hash_offset + i * hash_size, digest, hash_size);
+    }
+    return length;
+}
+
+/**
+ * Тест проверки подписи кода: SuperBlob с директориями SHA-1 и SHA-256,
+ * постраничная проверка на пуле потоков и в одном потоке, поиск изменённых страниц
+ */
+void test_code_signature() {
+    const uint32_t code_limit = 16384 + 8;  // 1025 страниц по 16 байт, последняя неполная
+    const uint32_t blob_offset = 12 + 2 * 8;
+    uint8_t *buffer = calloc(1, 128 * 1024);
+    assert(buffer != NULL);
+    for (uint32_t i = 0; i < code_limit; i++) {
+        buffer[i] = (uint8_t)(i * 7);
+    }
+
+    struct mach_header_64 *header = (struct mach_header_64 *)buffer;
+    memset(header, 0, sizeof(*header));
+    header->magic = MH_MAGIC_64;
+    header->cputype = CPU_TYPE_X86_64;
+    header->filetype = MH_EXECUTE;
+    header->ncmds = 1;
+    header->sizeofcmds = sizeof(struct linkedit_data_command);
+    struct linkedit_data_command *signature_cmd = (struct linkedit_data_command *)(header + 1);
+    signature_cmd->cmd = LC_CODE_SIGNATURE;
+    signature_cmd->cmdsize = sizeof(struct linkedit_data_command);
+    signature_cmd->dataoff = code_limit;
+
+    // Размер подписи входит в заголовок, поэтому сначала считается, потом хешируется
+    uint32_t pages = code_limit / 16 + 1;
+    uint32_t sha1_length = 56 + pages * SHA1_DIGEST_LENGTH;
+    uint32_t sha256_length = 56 + pages * SHA256_DIGEST_LENGTH;
+    uint32_t length = blob_offset + sha1_length + sha256_length;
+    signature_cmd->datasize = length;
+
+    uint8_t *blob = buffer + code_limit;
+    put_be32(blob, CSMAGIC_EMBEDDED_SIGNATURE);
+    put_be32(blob + 4, length);
+    put_be32(blob + 8, 2);
+    put_be32(blob + 12, CSSLOT_ALTERNATE_CODEDIRECTORIES);
+    put_be32(blob + 16, blob_offset + sha1_length);
+    put_be32(blob + 20, CSSLOT_CODEDIRECTORY);
+    put_be32(blob + 24, blob_offset);
+    uint32_t cd_length = build_code_directory(blob + blob_offset, buffer, code_limit, 4, CS_HASHTYPE_SHA1);
+    assert(cd_length == sha1_length);
+    cd_length = build_code_directory(blob + blob_offset + sha1_length, buffer, code_limit, 4, CS_HASHTYPE_SHA256);
+    assert(cd_length == sha256_length);
+
+    MachOImage image;
+    int rc = macho_image_from_memory(buffer, code_limit + length, &image);
+    assert(rc == 0);
+    MachOFile mach_o_file;
+    rc = analyze_mach_o_image(&image, 0, 0, &mach_o_file);
+    assert(rc == 0);
+
+    CodeSignatureInfo info;
+    rc = analyze_code_signature(&mach_o_file, 4, &info);
+    assert(rc == 0);
+    assert(info.status == CODE_SIGNATURE_VALID && info.directory_count == 2);
+    assert(strcmp(info.identifier, "test") == 0 && info.version == 0x20100);
+    assert(info.directories[0].slot == CSSLOT_CODEDIRECTORY && info.directories[0].hash_type == CS_HASHTYPE_SHA1);
+    assert(info.directories[1].hash_type == CS_HASHTYPE_SHA256 && info.directories[1].page_count == pages);
+
+    // Изменённые страницы находятся в обеих директориях при любом числе потоков
+    buffer[3 * 16 + 1] ^= 1;
+    buffer[code_limit - 1] ^= 1;
+    for (size_t threads = 1; threads <= 4; threads += 3) {
+        rc = analyze_code_signature(&mach_o_file, threads, &info);
+        assert(rc == -1);
+        assert(info.status == CODE_SIGNATURE_PAGE_MISMATCH);
+        for (uint32_t d = 0; d < info.directory_count; d++) {
+            assert(info.directories[d].mismatch_count == 2);
+            assert(info.directories[d].mismatched_pages[0] == 3 && info.directories[d].mismatched_pages[1] == pages - 1);
+        }
+    }
+
+    char output[2048] = {0};
+    FILE *out = fmemopen(output, sizeof(output) - 1, "w");
+    assert(out != NULL);
+    print_code_signature(&info, out);
+    fclose(out);
+    assert(strstr(output, "Не совпали хеши страниц: 2 (3, 1024)") != NULL);
+
+    free_mach_o_file(&mach_o_file);
+    free(buffer);
+}
+
+void test_json_writer() {
+    char output[256] = {0};
+    FILE *out = fmemopen(output, sizeof(output) - 1, "w");
+    assert(out != NULL);
+
+    JsonWriter writer;
+    int rc = json_writer_init(&writer, out, 8);
+    assert(rc == 0);  // Маленький буфер проверяет сброс
+    json_begin_object(&writer);
+    json_key(&writer, "s");
+    json_string(&writer, "a\"b\\c\n\x01\xff\xd0\xb6");
+    json_key(&writer, "seg");
+    json_string_n(&writer, "__TEXT\0\0garbage", 16);
+    json_key(&writer, "list");
+    json_begin_array(&writer);
+    json_uint(&writer, 18446744073709551615ULL);
+    json_int(&writer, -42);
+    json_bool(&writer, true);
+    json_string(&writer, NULL);
+    json_end_array(&writer);
+    json_end_object(&writer);
+    json_end_record(&writer);
+    json_begin_array(&writer);
+    json_end_array(&writer);
+    json_end_record(&writer);
+    rc = json_writer_close(&writer);
+    assert(rc == 0);
+    fclose(out);
+
+    assert(strcmp(output,
+                  "{\"s\":\"a\\\"b\\\\c\\n\\u0001\\u00ff\xd0\xb6\",\"seg\":\"__TEXT\","
+                  "\"list\":[18446744073709551615,-42,true,null]}\n[]\n") == 0);
+}
+
+void test_result_store() {
+    static const char *names[] = {"_strcpy", "_main"};
+    uint8_t buffer[512] = {0};
+    uint32_t size = build_symbol_macho(buffer, names, sizeof(names) / sizeof(names[0]));
+
+    MachOImage image;
+    int rc = macho_image_from_memory(buffer, size, &image);
+    assert(rc == 0);
+    MachOFile mach_o_file;
+    rc = analyze_mach_o_image(&image, 0, 0, &mach_o_file);
+    assert(rc == 0);
+    SecurityFeatures features;
+    rc = check_security_features(&mach_o_file, &features);
+    assert(rc == 0);
+    SecurityFindings findings = {0};
+    rc = analyze_unsafe_functions(&mach_o_file, &findings);
+    assert(rc == 0);
+    LanguageInfo language = {"C", "Clang"};
+
+    char *data = NULL;
+    size_t data_size = 0;
+    FILE *out = open_memstream(&data, &data_size);
+    assert(out != NULL);
+    ResultWriter writer;
+    rc = result_writer_open(&writer, out);
+    assert(rc == 0);
+    ResultArchInput input = {"/bin/a", 0, NULL, &mach_o_file, &features, &language, &findings};
+    rc = result_writer_add(&writer, &input);
+    assert(rc == 0);
+    input.arch_index = 1;
+    rc = result_writer_add(&writer, &input);
+    assert(rc == 0);
+    rc = result_writer_close(&writer);
+    assert(rc == 0);
+    fclose(out);
+
+    // Строки второй записи повторно не пишутся
+    assert(writer.string_count == 4);  // путь, язык, компилятор, strcpy
+
+    ResultReader reader;
+    rc = result_reader_from_memory(data, data_size, &reader);
+    assert(rc == 0);
+    assert(reader.arch_count == 2);
+    ResultArchView view;
+    for (uint32_t i = 0; i < 2; i++) {
+        rc = result_reader_next(&reader, &view);
+        assert(rc == 1);
+        assert(view.arch->arch_index == i);
+        assert(strcmp(result_reader_string(&reader, view.arch->path), "/bin/a") == 0);
+        assert(strcmp(result_reader_string(&reader, view.arch->compiler), "Clang") == 0);
+        assert(view.arch->finding_count == 1);
+        assert(strcmp(result_reader_string(&reader, view.findings[0].name), "strcpy") == 0);
+        assert(((view.arch->security & RESULT_SECURITY_STACK_CANARIES) != 0) == features.stack_canaries);
+    }
+    rc = result_reader_next(&reader, &view);
+    assert(rc == 0);
+    result_reader_close(&reader);
+
+    // Обрезанный файл отвергается при открытии
+    rc = result_reader_from_memory(data, data_size - 8, &reader);
+    assert(rc == -1);
+
+    free(data);
+    security_findings_free(&findings);
+    free_mach_o_file(&mach_o_file);
+}
+
+/**
+ * Тест библиотек песочницы: учитываются все LC_LOAD_DYLIB, а не только первая,
+ * и все они выводятся и сохраняются в файле результатов.
+ */
+void test_sandbox_dylibs() {
+    static const char *names[] = {"/usr/lib/libsandbox.1.dylib", "/usr/lib/libSystem.B.dylib",
+                                  "/usr/lib/system/libsystem_sandbox.dylib"};
+    const uint32_t dylib_size = 80;
+    uint8_t buffer[512] = {0};
+    struct mach_header_64 *header = (struct mach_header_64 *)buffer;
+    header->magic = MH_MAGIC_64;
+    header->cputype = CPU_TYPE_ARM64;
+    header->filetype = MH_EXECUTE;
+    header->ncmds = 3;
+    header->sizeofcmds = 3 * dylib_size;
+    for (uint32_t i = 0; i < 3; i++) {
+        struct dylib_command *dylib = (struct dylib_command *)(buffer + sizeof(*header) + i * dylib_size);
+        dylib->cmd = LC_LOAD_DYLIB;
+        dylib->cmdsize = dylib_size;
+        dylib->dylib.name.offset = sizeof(struct dylib_command);
+        strcpy((char *)(dylib + 1), names[i]);
+    }
+
+    MachOImage image;
+    int rc = macho_image_from_memory(buffer, sizeof(*header) + 3 * dylib_size, &image);
+    assert(rc == 0);
+    MachOFile mach_o_file;
+    rc = analyze_mach_o_image(&image, 0, 0, &mach_o_file);
+    assert(rc == 0);
+    SecurityFeatures features;
+    rc = check_security_features(&mach_o_file, &features);
+    assert(rc == 0);
+    assert(features.sandbox_dylib_count == 2);
+    assert(strcmp(features.sandbox_dylibs[0], names[0]) == 0);
+    assert(strcmp(features.sandbox_dylibs[1], names[2]) == 0);
+
+    char *text = NULL;
+    size_t text_size = 0;
+    FILE *out = open_memstream(&text, &text_size);
+    assert(out != NULL);
+    print_security_features(&features, out);
+    fclose(out);
+    assert(strstr(text, "Обнаружена песочница: /usr/lib/libsandbox.1.dylib\n") != NULL);
+    assert(strstr(text, "Обнаружена песочница: /usr/lib/system/libsystem_sandbox.dylib\n") != NULL);
+    free(text);
+
+    // Все имена переживают запись в файл результатов и чтение обратно
+    char *data = NULL;
+    size_t data_size = 0;
+    out = open_memstream(&data, &data_size);
+    assert(out != NULL);
+    ResultWriter writer;
+    rc = result_writer_open(&writer, out);
+    assert(rc == 0);
+    ResultArchInput input = {"/bin/sandboxed", 0, NULL, &mach_o_file, &features, NULL, NULL};
+    rc = result_writer_add(&writer, &input);
+    assert(rc == 0);
+    rc = result_writer_close(&writer);
+    assert(rc == 0);
+    fclose(out);
+
+    ResultReader reader;
+    rc = result_reader_from_memory(data, data_size, &reader);
+    assert(rc == 0);
+    ResultArchView view;
+    rc = result_reader_next(&reader, &view);
+    assert(rc == 1);
+    SecurityFeatures stored;
+    bool ok = result_security_features(&reader, &view, &stored);
+    assert(ok);
+    assert(stored.sandbox_dylib_count == 2);
+    assert(strcmp(stored.sandbox_dylibs[0], names[0]) == 0);
+    assert(strcmp(stored.sandbox_dylibs[1], names[2]) == 0);
+    result_reader_close(&reader);
+
+    free(data);
+    free_mach_o_file(&mach_o_file);
+}
+
+static void assert_digest(const uint8_t *digest, const char *expected) {
+    char hex[2 * SHA256_DIGEST_LENGTH + 1] = {0};
+    for (size_t i = 0; i < strlen(expected) / 2; i++) {
+        snprintf(hex + 2 * i, 3, "%02x", digest[i]);
+    }
+    assert(strcmp(hex, expected) == 0);
+}
+
+/**
+ * Тест SHA-1 и SHA-256: эталонные значения FIPS 180 для каждой реализации,
+ * доступной на этом процессоре, в том числе при подаче данных кусками
+ */
+void test_sha_digest() {
+    static const char two_blocks[] = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+    ShaImplementation detected = sha_implementation();
+    ShaImplementation implementations[] = {SHA_IMPLEMENTATION_SCALAR, SHA_IMPLEMENTATION_SHA_NI};
+    for (size_t n = 0; n < sizeof(implementations) / sizeof(implementations[0]); n++) {
+        if (!sha_select_implementation(implementations[n])) {
+            continue;
+        }
+        uint8_t digest[SHA256_DIGEST_LENGTH];
+        sha1("abc", 3, digest);
+        assert_digest(digest, "a9993e364706816aba3e25717850c26c9cd0d89d");
+        sha1(two_blocks, sizeof(two_blocks) - 1, digest);
+        assert_digest(digest, "84983e441c3bd26ebaae4aa1f95129e5e54670f1");
+        sha256("", 0, digest);
+        assert_digest(digest, "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+        sha256("abc", 3, digest);
+        assert_digest(digest, "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+        sha256(two_blocks, sizeof(two_blocks) - 1, digest);
+        assert_digest(digest, "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+
+        // Миллион 'a' кусками по 1000 байт: неполные блоки переходят между вызовами update
+        char chunk[1000];
+        memset(chunk, 'a', sizeof(chunk));
+        Sha1Context sha1_context;
+        Sha256Context sha256_context;
+        sha1_init(&sha1_context);
+        sha256_init(&sha256_context);
+        for (int i = 0; i < 1000; i++) {
+            sha1_update(&sha1_context, chunk, sizeof(chunk));
+            sha256_update(&sha256_context, chunk, sizeof(chunk));
+        }
+        sha1_final(&sha1_context, digest);
+        assert_digest(digest, "34aa973cd4c4daa4f61eeb2bdbad27316534016f");
+        sha256_final(&sha256_context, digest);
+        assert_digest(digest, "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+    }
+    bool ok = sha_select_implementation(detected);
+    assert(ok);
+}
+
+void test_result_cache() {
+    // Эталонные значения XXH64
+    assert(xxh64("", 0, 0) == UINT64_C(0xEF46DB3751D8E999));
+    assert(xxh64("abc", 3, 0) == UINT64_C(0x44BC2CF5AD770999));
+    static const char long_input[] = "Nobody inspects the spammish repetition";
+    assert(xxh64(long_input, sizeof(long_input) - 1, 0) == UINT64_C(0xFBCEA83C8A378BF1));
+
+    static const char *names[] = {"_gets", "_main"};
+    uint8_t buffer[512] = {0};
+    uint32_t size = build_symbol_macho(buffer, names, sizeof(names) / sizeof(names[0]));
+    MachOImage image;
+    int rc = macho_image_from_memory(buffer, size, &image);
+    assert(rc == 0);
+    MachOArchitecture arch = {0, size, 0, 0};
+
+    char directory[] = "/tmp/macho_cache_XXXXXX";
+    char *created = mkdtemp(directory);
+    assert(created != NULL);
+    ResultCache cache;
+    rc = result_cache_open(&cache, directory);
+    assert(rc == 0);
+
+    ResultCacheKey key;
+    rc = result_cache_key(&image, &arch, &key);
+    assert(rc == 0);
+    assert(key.size == size);
+    ResultReader reader;
+    ResultArchView view;
+    rc = result_cache_lookup(&cache, &key, &reader, &view);
+    assert(rc == 0);
+
+    MachOFile mach_o_file;
+    rc = analyze_mach_o_image(&image, 0, 0, &mach_o_file);
+    assert(rc == 0);
+    SecurityFindings findings = {0};
+    rc = analyze_unsafe_functions(&mach_o_file, &findings);
+    assert(rc == 0);
+    LanguageInfo language = {"C", "Clang"};
+    ResultArchInput input = {"/bin/a", 0, NULL, &mach_o_file, NULL, &language, &findings};
+    rc = result_cache_store(&cache, &key, &input);
+    assert(rc == 0);
+
+    rc = result_cache_lookup(&cache, &key, &reader, &view);
+    assert(rc == 1);
+    assert(result_reader_string(&reader, view.arch->path) == NULL);  // Путь в кеш не попадает
+    assert(strcmp(result_reader_string(&reader, view.arch->language), "C") == 0);
+    assert(view.arch->load_command_count == mach_o_file.load_command_count);
+    assert(view.arch->finding_count == 1);
+    result_reader_close(&reader);
+
+    // Другое содержимое — другой ключ
+    buffer[size - 1] ^= 1;
+    ResultCacheKey other;
+    rc = result_cache_key(&image, &arch, &other);
+    assert(rc == 0);
+    assert(other.hash != key.hash);
+    rc = result_cache_lookup(&cache, &other, &reader, &view);
+    assert(rc == 0);
+
+    security_findings_free(&findings);
+    free_mach_o_file(&mach_o_file);
+    result_cache_close(&cache);
+
+    char hash[17];
+    char entry[128];
+    char subdirectory[64];
+    snprintf(hash, sizeof(hash), "%016llx", (unsigned long long)key.hash);
+    snprintf(subdirectory, sizeof(subdirectory), "%s/%.2s", directory, hash);
+    snprintf(entry, sizeof(entry), "%s/%s-%016llx.v%u", subdirectory, hash + 2, (unsigned long long)key.size,
+             (unsigned)RESULT_CACHE_ANALYZER_VERSION);
+    rc = unlink(entry);
+    assert(rc == 0);
+    rmdir(subdirectory);
+    rmdir(directory);
+}
+
+typedef struct {
+    size_t workers;
+    int counter;
+    int bad_worker;
+} PoolCounter;
+
+static void count_task(void *arg, size_t worker) {
+    PoolCounter *counter = arg;
+    __atomic_add_fetch(&counter->counter, 1, __ATOMIC_RELAXED);
+    if (worker >= counter->workers) {
+        __atomic_store_n(&counter->bad_worker, 1, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * Собирает в buffer 64-битный Mach-O с сегментом из одной секции, библиотекой
+ * и двумя символами. При swap все поля записываются в обратном порядке байтов,
+ * как у PPC64-среза на little-endian хосте (magic читается как MH_CIGAM_64).
+ *
+ * @return Размер собранного файла.
+ */
+static uint32_t build_endian_macho(uint8_t *buffer, bool swap) {
+    static const char dylib_name[] = "/usr/lib/libSystem.B.dylib";
+    static const char strings[] = "\0_main\0_helper";
+    const uint32_t segment_size = sizeof(struct segment_command_64) + sizeof(struct section_64);
+    const uint32_t dylib_size = (uint32_t)(sizeof(struct dylib_command) + sizeof(dylib_name) + 5) & ~7u;
+    const uint32_t sizeofcmds = segment_size + dylib_size + (uint32_t)sizeof(struct symtab_command);
+    const uint32_t symoff = (uint32_t)sizeof(struct mach_header_64) + sizeofcmds;
+    const uint32_t stroff = symoff + 2 * (uint32_t)sizeof(struct nlist_64);
+
+    struct mach_header_64 *header = (struct mach_header_64 *)buffer;
+    header->magic = macho_swap_if32(swap, MH_MAGIC_64);
+    header->cputype = (cpu_type_t)macho_swap_if32(swap, CPU_TYPE_POWERPC64);
+    header->filetype = macho_swap_if32(swap, MH_EXECUTE);
+    header->ncmds = macho_swap_if32(swap, 3);
+    header->sizeofcmds = macho_swap_if32(swap, sizeofcmds);
+    header->flags = macho_swap_if32(swap, MH_PIE);
+
+    struct segment_command_64 *segment = (struct segment_command_64 *)(header + 1);
+    segment->cmd = macho_swap_if32(swap, LC_SEGMENT_64);
+    segment->cmdsize = macho_swap_if32(swap, segment_size);
+    strcpy(segment->segname, "__TEXT");
+    segment->vmaddr = macho_swap_if64(swap, 0x100000000ULL);
+    segment->vmsize = macho_swap_if64(swap, 0x4000);
+    segment->nsects = macho_swap_if32(swap, 1);
+    struct section_64 *section = (struct section_64 *)(segment + 1);
+    strcpy(section->sectname, "__text");
+    strcpy(section->segname, "__TEXT");
+    section->size = macho_swap_if64(swap, 0x10);
+
+    struct dylib_command *dylib = (struct dylib_command *)((uint8_t *)segment + segment_size);
+    dylib->cmd = macho_swap_if32(swap, LC_LOAD_DYLIB);
+    dylib->cmdsize = macho_swap_if32(swap, dylib_size);
+    dylib->dylib.name.offset = macho_swap_if32(swap, sizeof(struct dylib_command));
+    dylib->dylib.current_version = macho_swap_if32(swap, 0x050403);
+    memcpy(dylib + 1, dylib_name, sizeof(dylib_name));
+
+    struct symtab_command *symtab = (struct symtab_command *)((uint8_t *)dylib + dylib_size);
+    symtab->cmd = macho_swap_if32(swap, LC_SYMTAB);
+    symtab->cmdsize = macho_swap_if32(swap, sizeof(struct symtab_command));
+    symtab->symoff = macho_swap_if32(swap, symoff);
+    symtab->nsyms = macho_swap_if32(swap, 2);
+    symtab->stroff = macho_swap_if32(swap, stroff);
+    symtab->strsize = macho_swap_if32(swap, sizeof(strings));
+
+    struct nlist_64 *symbols = (struct nlist_64 *)(buffer + symoff);
+    for (uint32_t i = 0; i < 2; i++) {
+        symbols[i].n_un.n_strx = macho_swap_if32(swap, i == 0 ? 1 : 7);
+        symbols[i].n_type = N_SECT | N_EXT;
+        symbols[i].n_sect = 1;
+        symbols[i].n_desc = macho_swap_if16(swap, 0x0100);
+        symbols[i].n_value = macho_swap_if64(swap, 0x100000f00ULL + i * 0x10);
+    }
+    memcpy(buffer + stroff, strings, sizeof(strings));
+    return stroff + (uint32_t)sizeof(strings);
+}
+
+/**
+ * Тест образов с обратным порядком байтов: поля переставляются при чтении,
+ * и разбор совпадает с разбором того же образа в порядке байтов хоста
+ */
+void test_byte_swapped_image() {
+    for (int swap = 0; swap <= 1; swap++) {
+        uint8_t buffer[1024] = {0};
+        uint32_t size = build_endian_macho(buffer, swap);
+
+        MachOImage image;
+        int rc = macho_image_from_memory(buffer, size, &image);
+        assert(rc == 0);
+        MachOFile mach_o_file;
+        rc = analyze_mach_o_image(&image, 0, 0, &mach_o_file);
+        assert(rc == 0);
+        assert(mach_o_file.swapped == (bool)swap);
+        assert(mach_o_file.magic == (swap ? MH_CIGAM_64 : MH_MAGIC_64));
+        assert(mach_o_file.cpu_type == CPU_TYPE_POWERPC64);
+        assert(mach_o_file.flags == MH_PIE);
+        assert(mach_o_file.load_command_count == 3);
+
+        assert(mach_o_file.segment_count == 1);
+        assert(strcmp(mach_o_file.segments[0].segname, "__TEXT") == 0);
+        assert(mach_o_file.segments[0].vmaddr == 0x100000000ULL);
+        assert(mach_o_file.segments[0].nsects == 1);
+        assert(mach_o_file.dylib_count == 1);
+        assert(strcmp(mach_o_file.dylibs[0].name, "/usr/lib/libSystem.B.dylib") == 0);
+        assert(mach_o_file.dylibs[0].current_version == 0x050403);
+
+        const MachOSymbolIndex *index = macho_get_symbol_index(&mach_o_file);
+        assert(index != NULL && index->count == 2);
+        assert(strcmp(index->symbols[0].name, "_main") == 0);
+        assert(strcmp(index->symbols[1].name, "_helper") == 0);
+        assert(index->symbols[1].n_value == 0x100000f10ULL);
+        assert(index->symbols[1].n_desc == 0x0100);
+
+        SecurityFeatures features;
+        rc = check_security_features(&mach_o_file, &features);
+        assert(rc == 0);
+        assert(features.aslr);
+
+        free_mach_o_file(&mach_o_file);
+        macho_image_close(&image);
+    }
+
+    // Секции, не помещающиеся в команду сегмента, отклоняются до любых проходов
+    uint8_t buffer[1024] = {0};
+    uint32_t size = build_endian_macho(buffer, true);
+    struct segment_command_64 *segment = (struct segment_command_64 *)(buffer + sizeof(struct mach_header_64));
+    segment->nsects = macho_swap32(2);
+    MachOImage image;
+    int rc = macho_image_from_memory(buffer, size, &image);
+    assert(rc == 0);
+    MachOFile mach_o_file;
+    rc = analyze_mach_o_image(&image, 0, 0, &mach_o_file);
+    assert(rc == -1);
+    macho_image_close(&image);
+}
+
+/**
+ * Тест плоской таблицы секций: секции разобраны при разборе команд и
+ * находятся по паре (сегмент, секция)
+ */
+void test_section_table() {
+    uint8_t buffer[1024] = {0};
+    uint32_t size = build_endian_macho(buffer, true);
+
+    MachOImage image;
+    int rc = macho_image_from_memory(buffer, size, &image);
+    assert(rc == 0);
+    MachOFile mach_o_file;
+    rc = analyze_mach_o_image(&image, 0, 0, &mach_o_file);
+    assert(rc == 0);
+
+    assert(mach_o_file.section_count == 1);
+    assert(mach_o_file.segments[0].sections == &mach_o_file.sections[0]);
+    const MachOSection *text = macho_find_section(&mach_o_file, "__TEXT", "__text");
+    assert(text == &mach_o_file.sections[0]);
+    assert(text->size == 0x10 && text->segment_index == 0);
+    assert(macho_find_section(&mach_o_file, "__TEXT", "__cstring") == NULL);
+    assert(macho_find_section(&mach_o_file, "__DATA", "__text") == NULL);
+    assert(macho_find_section(&mach_o_file, "__TEXT", "__text_with_a_very_long_name") == NULL);
+
+    free_mach_o_file(&mach_o_file);
+    macho_image_close(&image);
+}
+
+typedef struct {
+    int calls;
+    int result;        // Код возврата обработчика
+    uint32_t last_cmd;
+} VisitCounter;
+
+static int count_command(const MachOFile *mach_o_file, const struct load_command *cmd, void *context) {
+    VisitCounter *counter = context;
+    counter->calls++;
+    counter->last_cmd = macho_command_type(mach_o_file, cmd);
+    return counter->result;
+}
+
+static int count_finish(const MachOFile *mach_o_file, void *context) {
+    (void)mach_o_file;
+    ((VisitCounter *)context)->calls++;
+    return 0;
+}
+
+/**
+ * Тест обхода команд с подпиской: обработчики вызываются только для своих
+ * типов команд, MACHO_VISIT_DONE снимает подписку, ошибка прерывает обход
+ */
+void test_command_visitor() {
+    uint8_t buffer[1024] = {0};
+    uint32_t size = build_endian_macho(buffer, true);
+
+    MachOImage image;
+    int rc = macho_image_from_memory(buffer, size, &image);
+    assert(rc == 0);
+    MachOFile mach_o_file;
+    rc = analyze_mach_o_image(&image, 0, 0, &mach_o_file);
+    assert(rc == 0);
+
+    VisitCounter dylib = {0, MACHO_VISIT_CONTINUE, 0};
+    VisitCounter symtab = {0, MACHO_VISIT_DONE, 0};
+    VisitCounter missing = {0, MACHO_VISIT_CONTINUE, 0};
+    VisitCounter finish = {0, 0, 0};
+    MachOCommandVisitor visitor;
+    macho_visitor_init(&visitor);
+    rc = macho_visitor_subscribe(&visitor, LC_LOAD_DYLIB, count_command, &dylib);
+    assert(rc == 0);
+    rc = macho_visitor_subscribe(&visitor, LC_SYMTAB, count_command, &symtab);
+    assert(rc == 0);
+    rc = macho_visitor_subscribe(&visitor, LC_DYLD_INFO_ONLY, count_command, &missing);
+    assert(rc == 0);
+    rc = macho_visitor_on_finish(&visitor, count_finish, &finish);
+    assert(rc == 0);
+
+    // Повторный запуск сбрасывает снятые подписки
+    for (int run = 1; run <= 2; run++) {
+        rc = macho_visitor_run(&visitor, &mach_o_file);
+        assert(rc == 0);
+        assert(dylib.calls == run && dylib.last_cmd == LC_LOAD_DYLIB);
+        assert(symtab.calls == run && symtab.last_cmd == LC_SYMTAB);
+        assert(missing.calls == 0);
+        assert(finish.calls == run);
+    }
+
+    // Проверки безопасности и подписи выполняются одним обходом
+    SecurityFeatures features;
+    SecurityCheck security;
+    CodeSignatureCheck check;
+    CodeSignatureInfo signature;
+    macho_visitor_init(&visitor);
+    int status = security_check_subscribe(&visitor, &security, &mach_o_file, &features);
+    assert(status == 0);
+    status = code_signature_subscribe(&visitor, &check, 0, &signature);
+    assert(status == 0);
+    assert(mach_o_file.symbol_index == NULL);
+    status = macho_visitor_run(&visitor, &mach_o_file);
+    assert(status == 0);
+    assert(features.aslr && !features.bitcode && features.sandbox_dylib_count == 0);
+    assert(signature.status == CODE_SIGNATURE_ABSENT && check.result == 0);
+    // Команды для Stack Canaries найдены тем же обходом, индекс построен в завершении
+    assert(security.symtab != NULL && security.imports.dyld_info == NULL && security.imports.chained_fixups == NULL);
+    assert(!features.stack_canaries && mach_o_file.symbol_index != NULL && mach_o_file.symbol_index->count == 2);
+
+    VisitCounter failing = {0, -1, 0};
+    macho_visitor_init(&visitor);
+    rc = macho_visitor_subscribe(&visitor, LC_SEGMENT_64, count_command, &failing);
+    assert(rc == 0);
+    rc = macho_visitor_subscribe(&visitor, LC_SYMTAB, count_command, &symtab);
+    assert(rc == 0);
+    rc = macho_visitor_run(&visitor, &mach_o_file);
+    assert(rc == -1);
+    assert(failing.calls == 1 && symtab.calls == 2);
+
+    free_mach_o_file(&mach_o_file);
+    macho_image_close(&image);
+}
+
+/**
+ * Собирает в buffer 64-битный Mach-O с библиотекой libSystem и одной командой
+ * LC_DYLD_INFO_ONLY или linkedit_data_command (LC_DYLD_CHAINED_FIXUPS,
+ * LC_DYLD_EXPORTS_TRIE), данные которой лежат после команд.
+ *
+ * @return Размер собранного файла.
+ */
+static uint32_t build_import_macho(uint8_t *buffer, uint32_t cmd, const uint8_t *bind, uint32_t bind_size,
+                                   const uint8_t *lazy_bind, uint32_t lazy_bind_size) {
+    static const char dylib_name[] = "/usr/lib/libSystem.B.dylib";
+    const uint32_t dylib_size = (uint32_t)(sizeof(struct dylib_command) + sizeof(dylib_name) + 5) & ~7u;
+    const uint32_t linkedit_size = cmd == LC_DYLD_INFO_ONLY ? sizeof(struct dyld_info_command)
+                                                            : sizeof(struct linkedit_data_command);
+    const uint32_t data_offset = (uint32_t)sizeof(struct mach_header_64) + dylib_size + linkedit_size;
+
+    struct mach_header_64 *header = (struct mach_header_64 *)buffer;
+    header->magic = MH_MAGIC_64;
+    header->cputype = CPU_TYPE_ARM64;
+    header->filetype = MH_EXECUTE;
+    header->ncmds = 2;
+    header->sizeofcmds = dylib_size + linkedit_size;
+
+    struct dylib_command *dylib = (struct dylib_command *)(header + 1);
+    dylib->cmd = LC_LOAD_DYLIB;
+    dylib->cmdsize = dylib_size;
+    dylib->dylib.name.offset = sizeof(struct dylib_command);
+    memcpy(dylib + 1, dylib_name, sizeof(dylib_name));
+
+    if (cmd == LC_DYLD_INFO_ONLY) {
+        struct dyld_info_command *dyld_info = (struct dyld_info_command *)((uint8_t *)dylib + dylib_size);
+        dyld_info->cmd = LC_DYLD_INFO_ONLY;
+        dyld_info->cmdsize = linkedit_size;
+        dyld_info->bind_off = data_offset;
+        dyld_info->bind_size = bind_size;
+        dyld_info->lazy_bind_off = data_offset + bind_size;
+        dyld_info->lazy_bind_size = lazy_bind_size;
+    } else {
+        struct linkedit_data_command *linkedit = (struct linkedit_data_command *)((uint8_t *)dylib + dylib_size);
+        linkedit->cmd = cmd;
+        linkedit->cmdsize = linkedit_size;
+        linkedit->dataoff = data_offset;
+        linkedit->datasize = bind_size;
+    }
+    memcpy(buffer + data_offset, bind, bind_size);
+    if (lazy_bind_size) {
+        memcpy(buffer + data_offset + bind_size, lazy_bind, lazy_bind_size);
+    }
+    return data_offset + bind_size + lazy_bind_size;
+}
+
+/**
+ * Тест таблицы импортов: опкоды bind и lazy bind, цепочки фиксапов,
+ * объединение повторных привязок и проверки по импортам
+ */
+void test_import_table() {
+    static const uint8_t bind[] = {
+            BIND_OPCODE_SET_DYLIB_ORDINAL_IMM | 1,
+            BIND_OPCODE_SET_SYMBOL_TRAILING_FLAGS_IMM, '_', 's', 't', 'r', 'c', 'p', 'y', 0,
+            BIND_OPCODE_SET_TYPE_IMM | 1,
+            BIND_OPCODE_SET_SEGMENT_AND_OFFSET_ULEB | 1, 0x90, 0x01,
+            BIND_OPCODE_DO_BIND,
+            BIND_OPCODE_SET_SYMBOL_TRAILING_FLAGS_IMM | BIND_SYMBOL_FLAGS_WEAK_IMPORT, '_', 'w', 'k', 0,
+            BIND_OPCODE_DO_BIND_ULEB_TIMES_SKIPPING_ULEB, 2, 8,
+            BIND_OPCODE_SET_DYLIB_SPECIAL_IMM | (BIND_SPECIAL_DYLIB_FLAT_LOOKUP & BIND_IMMEDIATE_MASK),
+            BIND_OPCODE_SET_SYMBOL_TRAILING_FLAGS_IMM, '_', 'f', 'l', 't', 0,
+            BIND_OPCODE_SET_ADDEND_SLEB, 0x7f,
+            BIND_OPCODE_DO_BIND_ADD_ADDR_IMM_SCALED | 1,
+            BIND_OPCODE_DONE,
+    };
+    static const uint8_t lazy_bind[] = {
+            BIND_OPCODE_SET_DYLIB_ORDINAL_IMM | 1,
+            BIND_OPCODE_SET_SYMBOL_TRAILING_FLAGS_IMM, '_', 'g', 'e', 't', 's', 0,
+            BIND_OPCODE_DO_BIND, BIND_OPCODE_DONE,
+            BIND_OPCODE_SET_SYMBOL_TRAILING_FLAGS_IMM, '_', 's', 't', 'r', 'c', 'p', 'y', 0,
+            BIND_OPCODE_DO_BIND, BIND_OPCODE_DONE,
+    };
+    uint8_t buffer[1024] = {0};
+    uint32_t size = build_import_macho(buffer, LC_DYLD_INFO_ONLY, bind, sizeof(bind), lazy_bind, sizeof(lazy_bind));
+
+    MachOImage image;
+    int rc = macho_image_from_memory(buffer, size, &image);
+    assert(rc == 0);
+    MachOFile mach_o_file;
+    rc = analyze_mach_o_image(&image, 0, 0, &mach_o_file);
+    assert(rc == 0);
+
+    const MachOImportTable *imports = macho_get_import_table(&mach_o_file);
+    assert(imports != NULL && imports->source == MACHO_IMPORTS_DYLD_INFO);
+    assert(imports->count == 4);
+    assert(strcmp(imports->imports[0].name, "_strcpy") == 0 && imports->imports[0].ordinal == 1);
+    assert(strcmp(imports->imports[0].library, "/usr/lib/libSystem.B.dylib") == 0);
+    assert(!imports->imports[0].weak && !imports->imports[0].lazy);
+    assert(strcmp(imports->imports[1].name, "_wk") == 0 && imports->imports[1].weak);
+    assert(strcmp(imports->imports[2].name, "_flt") == 0);
+    assert(imports->imports[2].ordinal == BIND_SPECIAL_DYLIB_FLAT_LOOKUP && imports->imports[2].library == NULL);
+    assert(strcmp(imports->imports[3].name, "_gets") == 0 && imports->imports[3].lazy);
+    const MachOImportTable *cached_imports = macho_get_import_table(&mach_o_file);
+    assert(cached_imports == imports);
+
+    SecurityFindings findings = {0};
+    rc = analyze_unsafe_functions(&mach_o_file, &findings);
+    assert(rc == 0);
+    assert(findings.count == 2);
+    assert(strcmp(findings.items[0].function->function_name, "strcpy") == 0);
+    assert(strcmp(findings.items[1].function->function_name, "gets") == 0);
+    security_findings_free(&findings);
+    free_mach_o_file(&mach_o_file);
+    macho_image_close(&image);
+
+    // Обрыв ULEB128 в конце потока
+    size = build_import_macho(buffer, LC_DYLD_INFO_ONLY, bind, 13, NULL, 0);
+    rc = macho_image_from_memory(buffer, size, &image);
+    assert(rc == 0);
+    rc = analyze_mach_o_image(&image, 0, 0, &mach_o_file);
+    assert(rc == 0);
+    cached_imports = macho_get_import_table(&mach_o_file);
+    assert(cached_imports == NULL);
+    free_mach_o_file(&mach_o_file);
+    macho_image_close(&image);
+
+    // Цепочки фиксапов: заголовок, два импорта DYLD_CHAINED_IMPORT и таблица имён
+    uint8_t fixups[64] = {0};
+    struct dyld_chained_fixups_header fixups_header = {0, 0, 32, 40, 2, DYLD_CHAINED_IMPORT, 0};
+    uint32_t entries[2] = {1u | (1u << 9), 0xfeu | (1u << 8) | (9u << 9)};
+    memcpy(fixups, &fixups_header, sizeof(fixups_header));
+    memcpy(fixups + 32, entries, sizeof(entries));
+    memcpy(fixups + 40, "\0_strcpy\0_printf", 17);
+    size = build_import_macho(buffer, LC_DYLD_CHAINED_FIXUPS, fixups, sizeof(fixups), NULL, 0);
+    rc = macho_image_from_memory(buffer, size, &image);
+    assert(rc == 0);
+    rc = analyze_mach_o_image(&image, 0, 0, &mach_o_file);
+    assert(rc == 0);
+
+    imports = macho_get_import_table(&mach_o_file);
+    assert(imports != NULL && imports->source == MACHO_IMPORTS_CHAINED_FIXUPS && imports->count == 2);
+    assert(strcmp(imports->imports[0].name, "_strcpy") == 0 && imports->imports[0].ordinal == 1);
+    assert(!imports->imports[0].weak && !imports->imports[0].lazy);
+    assert(strcmp(imports->imports[1].name, "_printf") == 0 && imports->imports[1].weak);
+    assert(imports->imports[1].ordinal == BIND_SPECIAL_DYLIB_FLAT_LOOKUP);
+
+    free_mach_o_file(&mach_o_file);
+    macho_image_close(&image);
+}
+
+static size_t encode_uleb128(uint64_t value, uint8_t *out) {
+    size_t length = 0;
+    do {
+        uint8_t byte = value & 0x7f;
+        value >>= 7;
+        out[length++] = byte | (value ? 0x80 : 0);
+    } while (value);
+    return length;
+}
+
+/**
+ * Тест LC_FUNCTION_STARTS: пакетный декодер ULEB128 совпадает с побайтовым
+ * на числах разной длины, адреса функций и их размеры восстанавливаются по разностям
+ */
+void test_function_starts() {
+    enum { VALUE_COUNT = 2000 };
+    uint64_t *expected = malloc(VALUE_COUNT * sizeof(uint64_t));
+    uint64_t *decoded = malloc(VALUE_COUNT * sizeof(uint64_t));
+    uint8_t *encoded = malloc(VALUE_COUNT * 10);
+    assert(expected && decoded && encoded);
+
+    // Длины от 1 до 10 байт, числа пересекают границы 8-байтовых слов
+    uint64_t state = 0x9e3779b97f4a7c15ULL;
+    size_t size = 0;
+    for (size_t i = 0; i < VALUE_COUNT; i++) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        expected[i] = (state >> (i % 64)) | 1;
+        size += encode_uleb128(expected[i], encoded + size);
+    }
+    size_t count = 0;
+    int rc = macho_decode_uleb128_run(encoded, size, decoded, VALUE_COUNT, &count);
+    assert(rc == 0);
+    assert(count == VALUE_COUNT);
+    assert(memcmp(decoded, expected, VALUE_COUNT * sizeof(uint64_t)) == 0);
+
+    rc = macho_decode_uleb128_run(encoded, size, decoded, VALUE_COUNT - 1, &count);
+    assert(rc == -1);
+    rc = macho_decode_uleb128_run(encoded, size - 1, decoded, VALUE_COUNT, &count);
+    assert(rc == -1);
+    free(expected);
+    free(decoded);
+    free(encoded);
+
+    // Сегмент __TEXT с секцией __text и LC_FUNCTION_STARTS: разности 0x1000, 0x10, 0x200 и терминатор
+    static const uint8_t deltas[] = {0x80, 0x20, 0x10, 0x80, 0x04, 0x00, 0x00, 0x00};
+    uint8_t buffer[512] = {0};
+    const uint32_t segment_size = sizeof(struct segment_command_64) + sizeof(struct section_64);
+    const uint32_t sizeofcmds = segment_size + sizeof(struct linkedit_data_command);
+    const uint32_t data_offset = sizeof(struct mach_header_64) + sizeofcmds;
+
+    struct mach_header_64 *header = (struct mach_header_64 *)buffer;
+    header->magic = MH_MAGIC_64;
+    header->cputype = CPU_TYPE_ARM64;
+    header->filetype = MH_EXECUTE;
+    header->ncmds = 2;
+    header->sizeofcmds = sizeofcmds;
+
+    struct segment_command_64 *segment = (struct segment_command_64 *)(header + 1);
+    segment->cmd = LC_SEGMENT_64;
+    segment->cmdsize = segment_size;
+    strcpy(segment->segname, "__TEXT");
+    segment->vmaddr = 0x100000000ULL;
+    segment->vmsize = 0x2000;
+    segment->nsects = 1;
+    struct section_64 *section = (struct section_64 *)(segment + 1);
+    strcpy(section->segname, "__TEXT");
+    strcpy(section->sectname, "__text");
+    section->addr = 0x100001000ULL;
+    section->size = 0x300;
+
+    struct linkedit_data_command *starts_cmd = (struct linkedit_data_command *)((uint8_t *)segment + segment_size);
+    starts_cmd->cmd = LC_FUNCTION_STARTS;
+    starts_cmd->cmdsize = sizeof(struct linkedit_data_command);
+    starts_cmd->dataoff = data_offset;
+    starts_cmd->datasize = sizeof(deltas);
+    memcpy(buffer + data_offset, deltas, sizeof(deltas));
+
+    MachOImage image;
+    rc = macho_image_from_memory(buffer, data_offset + sizeof(deltas), &image);
+    assert(rc == 0);
+    MachOFile mach_o_file;
+    rc = analyze_mach_o_image(&image, 0, 0, &mach_o_file);
+    assert(rc == 0);
+
+    const MachOFunctionStarts *starts = macho_get_function_starts(&mach_o_file);
+    assert(starts != NULL && starts->count == 3);
+    assert(starts->addresses[0] == 0x100001000ULL);
+    assert(starts->addresses[1] == 0x100001010ULL);
+    assert(starts->addresses[2] == 0x100001210ULL);
+    assert(macho_function_size(starts, 0) == 0x10);
+    assert(macho_function_size(starts, 1) == 0x200);
+    assert(macho_function_size(starts, 2) == 0xf0);
+    assert(macho_function_size(starts, 3) == 0);
+    const MachOFunctionStarts *cached_starts = macho_get_function_starts(&mach_o_file);
+    assert(cached_starts == starts);
+
+    free_mach_o_file(&mach_o_file);
+    macho_image_close(&image);
+}
+
+/**
+ * Тест дерева экспорта: поиск по имени спускается по рёбрам, обход в глубину
+ * возвращает все экспорты, цикл в повреждённом дереве обнаруживается
+ */
+void test_export_trie() {
+    // _foo (0x1000), _foobar (слабый, 0x2000), _bar (реэкспорт _baz из библиотеки 1)
+    static const uint8_t trie_data[] = {
+            0x00, 1, '_', 0, 5,                                              // 0: корень
+            0x00, 2, 'f', 'o', 'o', 0, 17, 'b', 'a', 'r', 0, 32,             // 5: "_"
+            0x03, EXPORT_SYMBOL_FLAGS_KIND_REGULAR, 0x80, 0x20, 1, 'b', 'a', 'r', 0, 27, // 17: "_foo"
+            0x03, EXPORT_SYMBOL_FLAGS_WEAK_DEFINITION, 0x80, 0x40, 0,        // 27: "_foobar"
+            0x07, EXPORT_SYMBOL_FLAGS_REEXPORT, 1, '_', 'b', 'a', 'z', 0, 0, // 32: "_bar"
+    };
+    uint8_t buffer[512] = {0};
+    uint32_t size = build_import_macho(buffer, LC_DYLD_EXPORTS_TRIE, trie_data, sizeof(trie_data), NULL, 0);
+
+    MachOImage image;
+    int rc = macho_image_from_memory(buffer, size, &image);
+    assert(rc == 0);
+    MachOFile mach_o_file;
+    rc = analyze_mach_o_image(&image, 0, 0, &mach_o_file);
+    assert(rc == 0);
+
+    MachOExportTrie trie;
+    rc = macho_get_export_trie(&mach_o_file, &trie);
+    assert(rc == 0);
+    assert(trie.data != NULL && trie.size == sizeof(trie_data));
+
+    MachOExport export;
+    rc = macho_export_trie_find(&trie, "_foo", &export);
+    assert(rc == 1);
+    assert(export.address == 0x1000 && export.flags == EXPORT_SYMBOL_FLAGS_KIND_REGULAR);
+    rc = macho_export_trie_find(&trie, "_foobar", &export);
+    assert(rc == 1);
+    assert(export.address == 0x2000 && (export.flags & EXPORT_SYMBOL_FLAGS_WEAK_DEFINITION));
+    rc = macho_export_trie_find(&trie, "_bar", &export);
+    assert(rc == 1);
+    assert(export.ordinal == 1 && strcmp(export.import_name, "_baz") == 0);
+    rc = macho_export_trie_find(&trie, "_", &export);
+    assert(rc == 0);
+    rc = macho_export_trie_find(&trie, "_fo", &export);
+    assert(rc == 0);
+    rc = macho_export_trie_find(&trie, "_foobarx", &export);
+    assert(rc == 0);
+    rc = macho_export_trie_find(&trie, "_baz", &export);
+    assert(rc == 0);
+
+    static const char *expected[] = {"_foo", "_foobar", "_bar"};
+    MachOExportIterator *iterator = malloc(sizeof(MachOExportIterator));
+    assert(iterator != NULL);
+    macho_export_iterator_init(iterator, &trie);
+    for (size_t i = 0; i < sizeof(expected) / sizeof(expected[0]); i++) {
+        rc = macho_export_iterator_next(iterator, &export);
+        assert(rc == 1);
+        assert(strcmp(export.name, expected[i]) == 0);
+    }
+    rc = macho_export_iterator_next(iterator, &export);
+    assert(rc == 0);
+
+    // Ребро корня ведёт в сам корень
+    static const uint8_t cyclic[] = {0x00, 1, '_', 0, 0};
+    MachOExportTrie cyclic_trie = {cyclic, sizeof(cyclic)};
+    macho_export_iterator_init(iterator, &cyclic_trie);
+    rc = macho_export_iterator_next(iterator, &export);
+    assert(rc == -1);
+    rc = macho_export_trie_find(&cyclic_trie, "___", &export);
+    assert(rc == 0);
+    free(iterator);
+
+    free_mach_o_file(&mach_o_file);
+    macho_image_close(&image);
+
+    // Без команд экспорта дерево пустое
+    static const char *names[] = {"_main"};
+    size = build_symbol_macho(buffer, names, 1);
+    rc = macho_image_from_memory(buffer, size, &image);
+    assert(rc == 0);
+    rc = analyze_mach_o_image(&image, 0, 0, &mach_o_file);
+    assert(rc == 0);
+    rc = macho_get_export_trie(&mach_o_file, &trie);
+    assert(rc == 0 && trie.data == NULL);
+    rc = macho_export_trie_find(&trie, "_main", &export);
+    assert(rc == 0);
+    free_mach_o_file(&mach_o_file);
+    macho_image_close(&image);
+}
+
+/**
+ * Тест пула потоков: очередь меньше числа задач, все задачи выполняются
+ */
+void test_fat64_architectures() {
+    static const char *names[] = {"_main"};
+    uint8_t *buffer = calloc(1, 8192);
+    assert(buffer != NULL);
+    uint32_t size = build_symbol_macho(buffer + 4096, names, 1);
+
+    struct fat_header header = {macho_big_to_host32(FAT_MAGIC_64), macho_big_to_host32(1)};
+    struct fat_arch_64 arch = {0};
+    arch.cputype = (cpu_type_t)macho_big_to_host32(CPU_TYPE_X86_64);
+    arch.offset = macho_big_to_host64(4096);
+    arch.size = macho_big_to_host64(size);
+    memcpy(buffer, &header, sizeof(header));
+    memcpy(buffer + sizeof(header), &arch, sizeof(arch));
+
+    MachOImage image;
+    int rc = macho_image_from_memory(buffer, 8192, &image);
+    assert(rc == 0);
+    MachOArchitecture archs[1];
+    bool is_fat = false;
+    int64_t listed = macho_list_architectures(&image, archs, 1, &is_fat);
+    assert(listed == 1);
+    assert(is_fat && archs[0].offset == 4096 && archs[0].size == size);
+    assert(archs[0].cpu_type == CPU_TYPE_X86_64);
+
+    MachOFile mach_o_file;
+    rc = analyze_mach_o_image(&image, archs[0].offset, archs[0].size, &mach_o_file);
+    assert(rc == 0);
+    assert(mach_o_file.data == buffer + 4096);
+    free_mach_o_file(&mach_o_file);
+
+    // FAT внутри файла: смещения архитектур отсчитываются от текущей позиции потока
+    FILE *file = tmpfile();
+    assert(file != NULL);
+    static const uint8_t prefix[512] = {0};
+    size_t written = fwrite(prefix, 1, sizeof(prefix), file);
+    assert(written == sizeof(prefix));
+    written = fwrite(buffer, 1, 8192, file);
+    assert(written == 8192);
+    rc = fseeko(file, sizeof(prefix), SEEK_SET);
+    assert(rc == 0);
+    rc = analyze_mach_o(file, &mach_o_file);
+    assert(rc == 0);
+    assert(mach_o_file.cpu_type == CPU_TYPE_X86_64 && mach_o_file.data_size == size);
+    free_mach_o_file(&mach_o_file);
+    fclose(file);
+    free(buffer);
+}
+
+typedef struct {
+    MachOReportOptions options;
+    MachOReport reports[4];
+} ArchitectureReportsTest;
+
+static void fill_architecture_report(const MachOFile *mach_o_file, uint32_t index, void *context) {
+    ArchitectureReportsTest *reports = context;
+    macho_report_analyze(mach_o_file, &reports->options, &reports->reports[index]);
+}
+
+void test_parallel_architectures() {
+    static const char *names[] = {"_strcpy", "_main"};
+    uint8_t buffer[512] = {0};
+    uint32_t size = build_symbol_macho(buffer, names, sizeof(names) / sizeof(names[0]));
+
+    MachOImage image;
+    int rc = macho_image_from_memory(buffer, size, &image);
+    assert(rc == 0);
+
+    // Несколько архитектур над одним срезом и одна за пределами образа
+    MachOArchitecture archs[4] = {
+        {0, size, 0, 0}, {0, size, 0, 0}, {0, size, 0, 0}, {size * 2, size, 0, 0}
+    };
+    MachOFile files[4];
+    int statuses[4];
+    rc = analyze_mach_o_architectures(&image, archs, 4, 3, files, statuses, NULL, NULL);
+    assert(rc == -1);
+    uint32_t load_command_count = files[0].load_command_count;
+    for (int i = 0; i < 3; i++) {
+        assert(statuses[i] == 0);
+        assert(files[i].load_command_count == load_command_count);
+        assert(files[i].data == buffer);
+        free_mach_o_file(&files[i]);
+    }
+    assert(statuses[3] == -1);
+
+    rc = analyze_mach_o_architectures(&image, archs, 1, 0, files, statuses, NULL, NULL);
+    assert(rc == 0);
+    free_mach_o_file(&files[0]);
+
+    // Проверки архитектур выполняются в рабочих потоках, каждая пишет свой отчёт
+    ArchitectureReportsTest context = {macho_report_default_options(), {{0}}};
+    context.options.threads = 1;
+    context.options.detect_language = true;
+    context.options.collect_findings = true;
+    for (int i = 0; i < 4; i++) {
+        context.reports[i].status = -2;
+    }
+    rc = analyze_mach_o_architectures(&image, archs, 4, 3, files, statuses, fill_architecture_report, &context);
+    assert(rc == -1);
+    for (int i = 0; i < 3; i++) {
+        assert(statuses[i] == 0);
+        assert(context.reports[i].status == 0);
+        assert(context.reports[i].language_status == 0);
+        assert(context.reports[i].findings_status == 0);
+        assert(context.reports[i].findings.count == 1);
+        assert(strcmp(context.reports[i].findings.items[0].function->function_name, "strcpy") == 0);
+        macho_report_free(&context.reports[i]);
+        assert(context.reports[i].findings.items == NULL);
+        free_mach_o_file(&files[i]);
+    }
+    // Для неразобранной архитектуры анализ не вызывается
+    assert(statuses[3] == -1 && context.reports[3].status == -2);
+}
+
+void test_thread_pool() {
+    ThreadPool *pool = thread_pool_create(3, 2);
+    assert(pool != NULL && thread_pool_size(pool) == 3);
+
+    PoolCounter counter = {3, 0, 0};
+    for (int i = 0; i < 1000; i++) {
+        int rc = thread_pool_submit(pool, count_task, &counter);
+        assert(rc == 0);
+    }
+    thread_pool_wait(pool);
+    assert(counter.counter == 1000 && !counter.bad_worker);
+    thread_pool_destroy(pool);
+}
+
+typedef struct {
+    int files;
+    int archs;
+    int current_archs;  // Архитектур, ожидаемых после последней записи файла
+} BatchCounts;
+
+static void count_record(const BatchRecord *record, void *context) {
+    BatchCounts *counts = context;
+    if (record->kind == BATCH_RECORD_FILE) {
+        assert(counts->current_archs == 0);
+        counts->files++;
+        counts->current_archs = (int)record->arch_count;
+    } else {
+        assert(counts->current_archs > 0 && record->status == 0);
+        assert(record->file_type == MH_EXECUTE && strcmp(record->arch_name, "x86_64") == 0);
+        counts->archs++;
+        counts->current_archs--;
+    }
+}
+
+static void write_file(const char *path, const void *data, size_t size) {
+    FILE *file = fopen(path, "wb");
+    assert(file != NULL);
+    size_t written = fwrite(data, 1, size, file);
+    assert(written == size);
+    fclose(file);
+}
+
+/**
+ * Тест пакетного режима: рекурсивный обход, отбор по magic, запись на файл и архитектуру
+ */
+void test_batch_scan() {
+    char root[] = "/tmp/macho_batch_XXXXXX";
+    char *created = mkdtemp(root);
+    assert(created != NULL);
+    char nested[64], thin[64], deep[64], text[64], fat[64], java[64];
+    snprintf(nested, sizeof(nested), "%s/nested", root);
+    snprintf(thin, sizeof(thin), "%s/thin", root);
+    snprintf(deep, sizeof(deep), "%s/nested/deep", root);
+    snprintf(text, sizeof(text), "%s/readme.txt", root);
+    snprintf(fat, sizeof(fat), "%s/universal", root);
+    snprintf(java, sizeof(java), "%s/Main.class", root);
+    int rc = mkdir(nested, 0700);
+    assert(rc == 0);
+
+    struct {
+        struct mach_header_64 header;
+        struct uuid_command uuid;
+    } binary = {0};
+    binary.header.magic = MH_MAGIC_64;
+    binary.header.cputype = CPU_TYPE_X86_64;
+    binary.header.filetype = MH_EXECUTE;
+    binary.header.ncmds = 1;
+    binary.header.sizeofcmds = sizeof(struct uuid_command);
+    binary.uuid.cmd = LC_UUID;
+    binary.uuid.cmdsize = sizeof(struct uuid_command);
+    write_file(thin, &binary, sizeof(binary));
+    write_file(deep, &binary, sizeof(binary));
+    write_file(text, "not a binary", 12);
+
+    // FAT с большим числом архитектур, чем начальная ёмкость буферов потока
+    enum { FAT_ARCHS = 24, FAT_SLICE_OFFSET = 4096 };
+    uint8_t *universal = calloc(1, FAT_SLICE_OFFSET + sizeof(binary));
+    assert(universal != NULL);
+    struct fat_header fat_header = {macho_big_to_host32(FAT_MAGIC), macho_big_to_host32(FAT_ARCHS)};
+    memcpy(universal, &fat_header, sizeof(fat_header));
+    for (uint32_t i = 0; i < FAT_ARCHS; i++) {
+        struct fat_arch slice = {0};
+        slice.cputype = (cpu_type_t)macho_big_to_host32(CPU_TYPE_X86_64);
+        slice.offset = macho_big_to_host32(FAT_SLICE_OFFSET);
+        slice.size = macho_big_to_host32(sizeof(binary));
+        memcpy(universal + sizeof(fat_header) + i * sizeof(slice), &slice, sizeof(slice));
+    }
+    memcpy(universal + FAT_SLICE_OFFSET, &binary, sizeof(binary));
+    write_file(fat, universal, FAT_SLICE_OFFSET + sizeof(binary));
+    free(universal);
+
+    // class-файл Java начинается с того же 0xCAFEBABE, но не является FAT
+    static const uint8_t class_file[] = {0xca, 0xfe, 0xba, 0xbe, 0x00, 0x00, 0x00, 0x34,
+                                         0x00, 0x1d, 0x0a, 0x00, 0x06, 0x00, 0x0f, 0x09};
+    write_file(java, class_file, sizeof(class_file));
+
+    BatchOptions options = batch_default_options();
+    options.threads = 2;
+    BatchCounts counts = {0};
+    BatchStats stats;
+    const char *paths[] = {root};
+    int status = batch_scan(paths, 1, &options, count_record, &counts, &stats);
+    assert(status == 0);
+    assert(counts.files == 3 && counts.archs == 2 + FAT_ARCHS && counts.current_archs == 0);
+    assert(stats.files_seen == 5 && stats.macho_files == 3 && stats.arch_records == 2 + FAT_ARCHS);
+    assert(stats.errors == 0);
+
+    unlink(thin);
+    unlink(deep);
+    unlink(text);
+    unlink(fat);
+    unlink(java);
+    rmdir(nested);
+    rmdir(root);
+}
+
+static void count_change(const BatchRecord *record, void *context) {
+    int *changes = context;
+    if (record->kind == BATCH_RECORD_FILE) {
+        changes[record->change]++;
+    }
+}
+
+/**
+ * Тест повторного прохода с манифестом: сохранение и загрузка, быстрый путь
+ * по метаданным, добавленные, изменённые и удалённые файлы
+ */
+void test_scan_manifest() {
+    char root[] = "/tmp/macho_manifest_XXXXXX";
+    char *created = mkdtemp(root);
+    assert(created != NULL);
+    char first[64], second[64], manifest_path[64];
+    snprintf(first, sizeof(first), "%s/first", root);
+    snprintf(second, sizeof(second), "%s/second", root);
+    snprintf(manifest_path, sizeof(manifest_path), "%s.manifest", root);
+
+    struct {
+        struct mach_header_64 header;
+        struct uuid_command uuid;
+    } binary = {0};
+    binary.header.magic = MH_MAGIC_64;
+    binary.header.cputype = CPU_TYPE_X86_64;
+    binary.header.filetype = MH_EXECUTE;
+    binary.header.ncmds = 1;
+    binary.header.sizeofcmds = sizeof(struct uuid_command);
+    binary.uuid.cmd = LC_UUID;
+    binary.uuid.cmdsize = sizeof(struct uuid_command);
+    write_file(first, &binary, sizeof(binary));
+    write_file(second, &binary, sizeof(binary));
+
+    const char *paths[] = {root};
+    BatchOptions options = batch_default_options();
+    options.threads = 2;
+    BatchStats stats;
+    for (int pass = 0; pass < 3; pass++) {
+        if (pass == 2) {
+            // Второй файл дописывается (размер меняется, даже если mtime остался прежним), первый удаляется
+            FILE *file = fopen(second, "ab");
+            assert(file != NULL);
+            int written = fputc(0, file);
+            assert(written == 0);
+            fclose(file);
+            unlink(first);
+        }
+        ScanManifest previous, next;
+        int rc = scan_manifest_load(&previous, manifest_path);
+        assert(rc == 0);
+        rc = scan_manifest_init(&next);
+        assert(rc == 0);
+        options.previous = &previous;
+        options.next = &next;
+        int changes[BATCH_CHANGE_REMOVED + 1] = {0};
+        rc = batch_scan(paths, 1, &options, count_change, changes, &stats);
+        assert(rc == 0);
+        rc = scan_manifest_save(&next, manifest_path);
+        assert(rc == 0);
+
+        if (pass == 0) {
+            assert(previous.count == 0 && next.count == 2 && changes[BATCH_CHANGE_ADDED] == 2);
+            ScanManifestEntry *entry = scan_manifest_find(&next, first);
+            assert(entry && entry->is_macho && entry->arch_count == 1 && entry->size == sizeof(binary));
+        } else if (pass == 1) {
+            assert(previous.count == 2 && stats.unchanged == 2 && stats.arch_records == 0);
+            assert(changes[BATCH_CHANGE_ADDED] + changes[BATCH_CHANGE_CHANGED] + changes[BATCH_CHANGE_REMOVED] == 0);
+        } else {
+            assert(changes[BATCH_CHANGE_CHANGED] == 1 && changes[BATCH_CHANGE_REMOVED] == 1);
+            assert(next.count == 1 && scan_manifest_find(&next, first) == NULL);
+        }
+        scan_manifest_free(&previous);
+        scan_manifest_free(&next);
+    }
+
+    unlink(second);
+    unlink(manifest_path);
+    rmdir(root);
+}
+
 int main() {
     test_print_header_info();
     test_print_header_info_64_bit();
     test_print_header_info_32_bit();
     test_analyze_load_commands();
     test_analyze_mach_o_invalid_data();
+    test_symbol_classifier();
+    test_language_scores();
+    test_signature_scanner();
+    test_perfect_hash_tables();
+    test_lc_command_by_id();
+    test_macho_file_move();
+    test_lazy_cache_threads();
+    test_security_results();
+    test_code_signature();
+    test_json_writer();
+    test_result_store();
+    test_sandbox_dylibs();
+    test_sha_digest();
+    test_result_cache();
+    test_thread_pool();
+    test_parallel_architectures();
+    test_fat64_architectures();
+    test_byte_swapped_image();
+    test_section_table();
+    test_command_visitor();
+    test_import_table();
+    test_function_starts();
+    test_export_trie();
+    test_batch_scan();
+    test_scan_manifest();
     printf("All tests passed!\n");
     return 0;
 }